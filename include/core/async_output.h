@@ -0,0 +1,98 @@
+#ifndef DLX_ASYNC_OUTPUT_H
+#define DLX_ASYNC_OUTPUT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+#include "core/solution_sink.h"
+
+namespace dlx::binary {
+class DlxSolutionStreamWriter;
+} // namespace dlx::binary
+
+namespace dlx::sink {
+
+struct AsyncOutputConfig
+{
+    size_t ring_words = 1u << 20;         /**< Ring capacity in u32 words, rounded up to a power of two. */
+    bool block_when_full = true;          /**< Block the search on a full ring; otherwise drop and count the solution. */
+    size_t text_batch_bytes = 256 * 1024; /**< Formatted text collected before it is handed to the text stream. */
+};
+
+/**
+ * @brief Write-behind solution output: the search thread queues row ids, a writer thread formats and writes them.
+ *
+ * Solutions are copied into a preallocated single-producer/single-consumer ring of u32 words ({count, row ids...}),
+ * so the search thread never formats, allocates or flushes. The writer thread drains whatever is queued, appends
+ * the text form ("id id ...\n") to a large buffer and DLXS records to a @ref binary::DlxSolutionStreamWriter, and
+ * only flushes the streams once the ring runs dry. Install it through @ref SolutionOutput::async_writer to bypass
+ * the per-solution text path of Core::search, or use it as an ordinary @ref SolutionSink, which parses the textual
+ * row ids back into integers.
+ */
+class AsyncSolutionWriter final : public SolutionSink
+{
+public:
+    /** @brief Start the writer thread; @p text and @p binary may each be nullptr to skip that output. */
+    AsyncSolutionWriter(std::ostream* text, std::ostream* binary, const AsyncOutputConfig& config = AsyncOutputConfig());
+    ~AsyncSolutionWriter() override;
+
+    AsyncSolutionWriter(const AsyncSolutionWriter&) = delete;
+    AsyncSolutionWriter& operator=(const AsyncSolutionWriter&) = delete;
+
+    /** @brief Close the current DLXS section, if any, and start one for @p column_count columns. Never dropped. */
+    int begin_section(uint32_t column_count);
+    /** @brief Queue one solution; returns false when it was dropped because the ring was full. */
+    bool push(const uint32_t* row_ids, int count);
+    void on_solution(const SolutionView& view) override;
+    /** @brief No-op: the writer thread flushes whenever it catches up with the search. */
+    void flush() override {}
+    /** @brief Drain the ring, finish the open DLXS section and join the writer thread; returns -1 on a write error. */
+    int stop();
+    /** @brief Solutions discarded because the ring was full and @ref AsyncOutputConfig::block_when_full was off. */
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    bool reserve(size_t words, bool may_drop);
+    void store(uint64_t position, const uint32_t* words, size_t count);
+    void publish(uint64_t head);
+    void run();
+    void drain(uint64_t head);
+    void write_text(const uint32_t* row_ids, uint32_t count);
+    void flush_outputs();
+
+    std::ostream* text_;
+    std::ostream* binary_;
+    std::unique_ptr<binary::DlxSolutionStreamWriter> writer_;
+    AsyncOutputConfig config_;
+    std::unique_ptr<uint32_t[]> ring_;
+    size_t mask_;
+
+    alignas(64) std::atomic<uint64_t> head_;
+    uint64_t cached_tail_;
+    std::vector<uint32_t> parsed_;
+    alignas(64) std::atomic<uint64_t> tail_;
+    std::vector<char> text_buffer_;
+    size_t text_used_;
+    std::vector<uint32_t> record_;
+    bool section_open_;
+
+    alignas(64) std::atomic<bool> consumer_waiting_;
+    std::atomic<bool> producer_waiting_;
+    std::atomic<bool> stopping_;
+    std::atomic<uint64_t> dropped_;
+    std::mutex mutex_;
+    std::condition_variable data_cv_;
+    std::condition_variable space_cv_;
+    bool failed_;
+    std::thread thread_;
+};
+
+} // namespace dlx::sink
+
+#endif
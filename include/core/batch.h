@@ -0,0 +1,99 @@
+#ifndef DLX_BATCH_H
+#define DLX_BATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <condition_variable>
+#include <deque>
+#include <istream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "core/binary.h"
+
+namespace dlx::batch {
+
+/** @brief Order in which solved problems are written to the DLXS output. */
+enum class OutputOrder
+{
+    InOrder,     /**< Sections appear in input order, byte-identical to a sequential batch. */
+    AsCompleted, /**< Sections appear as workers finish, tagged with DLX_SOLUTION_FLAG_PROBLEM_INDEX. */
+};
+
+struct BatchConfig
+{
+    unsigned int workers = 0;              /**< Solver threads; 0 uses every hardware thread. */
+    OutputOrder order = OutputOrder::InOrder;
+    size_t max_in_flight = 0;              /**< Problems read but not yet written; 0 uses four per worker. */
+};
+
+struct BatchStats
+{
+    uint64_t problems = 0;  /**< Problems written to the output. */
+    uint64_t solutions = 0; /**< Solution rows written across every problem. */
+};
+
+/**
+ * @brief Solves the independent problems of one DLXB stream on a pool of worker threads.
+ *
+ * One reader thread decodes problems into CSR arenas, each worker links its own matrix (reusing
+ * its node array between problems) and runs Core::search, and a single writer thread emits one
+ * DLXS section per problem. The number of problems between reader and writer is bounded, so
+ * memory stays flat however long the stream is. Reuse frames share their cover with the frame
+ * they reference, and a worker that already holds that cover skips relinking.
+ */
+class BatchSolver
+{
+public:
+    explicit BatchSolver(const BatchConfig& config);
+
+    BatchSolver(const BatchSolver&) = delete;
+    BatchSolver& operator=(const BatchSolver&) = delete;
+
+    int run(std::istream& input, std::ostream& output, BatchStats* stats = nullptr);
+    /** @brief Description of the first failure seen by the last @ref run, empty on success. */
+    const std::string& error() const { return error_; }
+
+private:
+    struct Task
+    {
+        uint32_t index;
+        std::shared_ptr<const dlx::binary::DlxCsrProblem> cover;
+        dlx::SearchAssumptions assumptions;
+    };
+    struct Result
+    {
+        uint32_t index;
+        uint32_t column_count;
+        std::vector<uint32_t> row_ids;
+        std::vector<uint16_t> lengths;
+    };
+
+    void read_problems(std::istream& input);
+    void solve_problems();
+    void write_results(std::ostream& output);
+    int write_result(std::ostream& output, const Result& result);
+    void fail(const std::string& message);
+
+    BatchConfig config_;
+    std::mutex mutex_;
+    std::condition_variable task_cv_;
+    std::condition_variable result_cv_;
+    std::condition_variable capacity_cv_;
+    std::deque<Task> tasks_;
+    std::deque<Result> results_;
+    size_t in_flight_;
+    bool reading_done_;
+    bool solving_done_;
+    bool failed_;
+    std::string error_;
+    BatchStats stats_;
+    std::unique_ptr<dlx::binary::DlxSolutionStreamWriter> writer_;
+};
+
+} // namespace dlx::batch
+
+#endif
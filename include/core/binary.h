@@ -5,6 +5,7 @@
 #include <istream>
 #include <ostream>
 #include <vector>
+#include "core/block_codec.h"
 #include "core/dlx.h"
 
 namespace dlx::binary {
@@ -15,8 +16,101 @@ namespace dlx::binary {
 /** @brief Magic constant that prefixes serialized solution sections (ASCII 'DLXS'). */
 #define DLX_SOLUTION_MAGIC 0x444C5853u /* 'DLXS' */
 
-/** @brief Version of the DLX binary interchange format understood by this library. */
-#define DLX_BINARY_VERSION 1
+/**
+ * @brief Version of the DLX binary interchange format written by this library.
+ *
+ * Version 1 covers store every row as a u32 id, a u16 entry count and u32 column indices. Version 2 covers
+ * store rows in delta-varint blocks closed by a terminator and block index (see DlxCoverBlockEncoder), unless
+ * DLX_COVER_FLAG_NATIVE_ENDIAN selects the fixed-width native layout. Readers accept both versions and reject
+ * any later one. Solution sections carry their own version, see DLX_SOLUTION_VERSION.
+ */
+#define DLX_BINARY_VERSION 2
+
+/** @brief First cover version whose rows are delta-varint blocks. */
+#define DLX_BINARY_VERSION_BLOCKS 2
+
+/**
+ * @brief First solution version whose records are prefix-shared delta varints (see DlxSolutionEncoder).
+ *
+ * Version 1 sections store every solution as a u32 id, a u16 row count and u32 row indices, closed by an
+ * empty row with id 0.
+ */
+#define DLX_SOLUTION_VERSION_COMPACT 2
+
+/** @brief Version of the DLX solution sections written by this library; readers reject any later version. */
+#define DLX_SOLUTION_VERSION 2
+
+/** @brief Cover flag: an assumption block (forced/forbidden rows) follows the cover header. */
+#define DLX_COVER_FLAG_ASSUMPTIONS 0x0100u
+
+/** @brief Cover flag: the frame carries no rows and reuses the previous cover on the same stream. */
+#define DLX_COVER_FLAG_REUSE_MATRIX 0x0200u
+
+/**
+ * @brief Cover flag: the assumption block and rows after this (still big-endian) header are little-endian and
+ * 4-byte aligned, each row padding its 16-bit entry count to 32 bits, so they can be used straight from a mapping.
+ */
+#define DLX_COVER_FLAG_NATIVE_ENDIAN 0x0400u
+
+/**
+ * @brief Cover flag: a big-endian u32 problem id chosen by the client follows the header, ahead of any assumption
+ * block. The TCP server echoes it as the DLX_SOLUTION_FLAG_PROBLEM_INDEX of the problem's solution section.
+ */
+#define DLX_COVER_FLAG_PROBLEM_ID 0x0800u
+
+/** @brief Cover flag: the TCP server sends this problem's solutions back on the connection that sent it. */
+#define DLX_COVER_FLAG_REPLY_INLINE 0x1000u
+
+/**
+ * @brief Cover flag bits holding the problem's priority, from 0 (the default) to DLX_COVER_PRIORITY_LEVELS - 1.
+ * The TCP server runs queued problems of a higher priority first.
+ */
+#define DLX_COVER_PRIORITY_MASK 0x6000u
+#define DLX_COVER_PRIORITY_SHIFT 13
+#define DLX_COVER_PRIORITY_LEVELS 4
+
+/**
+ * @brief Cover flag: a solve options block (see DlxSolveOptions) follows the header, after the problem id and
+ * ahead of any assumption block.
+ */
+#define DLX_COVER_FLAG_OPTIONS 0x8000u
+/** @brief Size of the solve options block in 32-bit words. */
+#define DLX_SOLVE_OPTIONS_WORDS 6
+/** @brief Size of the solve status trailer in 32-bit words. */
+#define DLX_SOLVE_STATUS_WORDS 5
+
+/** @brief Solve option flag: only count the solutions; the answer's section carries no rows, only its status. */
+#define DLX_SOLVE_FLAG_COUNT_ONLY 0x0001u
+
+/** @brief Solve engine: whatever the solver runs by default. */
+#define DLX_SOLVE_ENGINE_DEFAULT 0
+/** @brief Solve engine: dancing links (Algorithm X with the minimum-remaining-values heuristic). */
+#define DLX_SOLVE_ENGINE_DANCING_LINKS 1
+
+/** @brief Solve status: the search ran to the end; every solution was found. */
+#define DLX_SOLVE_COMPLETE 0
+/** @brief Solve status: the search stopped once it had found DlxSolveOptions::solution_limit solutions. */
+#define DLX_SOLVE_LIMIT_REACHED 1
+/** @brief Solve status: the deadline passed before the search ended. */
+#define DLX_SOLVE_DEADLINE 2
+/** @brief Solve status: the search visited DlxSolveOptions::node_budget nodes before it ended. */
+#define DLX_SOLVE_NODE_BUDGET 3
+/** @brief Solve status: the requested engine is not available; nothing was searched. */
+#define DLX_SOLVE_UNSUPPORTED 4
+/** @brief Solve status: the cover could not be linked (no columns, or a row outside them); nothing was searched. */
+#define DLX_SOLVE_INVALID 5
+
+/** @brief Solution flag: a big-endian u32 problem index follows the solution header. */
+#define DLX_SOLUTION_FLAG_PROBLEM_INDEX 0x0100u
+
+/** @brief Solution flag (version 2): each solution's rows are stored in ascending order instead of search order. */
+#define DLX_SOLUTION_FLAG_SORTED_ROWS 0x0200u
+
+/** @brief Solution flag (version 2): every record carries its id; otherwise ids count up from 1. */
+#define DLX_SOLUTION_FLAG_EXPLICIT_IDS 0x0400u
+
+/** @brief Solution flag: a status trailer (see DlxSolveStatus) follows the section's terminator. */
+#define DLX_SOLUTION_FLAG_STATUS 0x0800u
 
 /**
  * @brief Binary file preamble describing the cover matrix serialization.
@@ -30,6 +124,31 @@ struct DlxCoverHeader
     uint32_t row_count;         /**< Number of option rows present in the file. */
 };
 
+/**
+ * @brief How a problem should be solved, sent as the DLX_COVER_FLAG_OPTIONS block: six big-endian u32 words,
+ * the limit and the budget each high word first, then the deadline, then the flags in the high and the engine in
+ * the low half of the last word. Zero in any field means no restriction.
+ */
+struct DlxSolveOptions
+{
+    uint64_t solution_limit; /**< Stop once this many solutions were found. */
+    uint64_t node_budget;    /**< Stop once the search has visited this many nodes. */
+    uint32_t deadline_ms;    /**< Stop this long after the problem was received, queueing included. */
+    uint16_t flags;          /**< DLX_SOLVE_FLAG_* bits. */
+    uint16_t engine;         /**< DLX_SOLVE_ENGINE_* value. */
+};
+
+/**
+ * @brief How a search ended, sent after the terminator of sections flagged DLX_SOLUTION_FLAG_STATUS: five
+ * big-endian u32 words, the code, then the solution and node counts each high word first.
+ */
+struct DlxSolveStatus
+{
+    uint32_t code;      /**< DLX_SOLVE_* status. */
+    uint64_t solutions; /**< Solutions found, including those a count-only answer leaves out. */
+    uint64_t nodes;     /**< Search nodes visited; 0 for answers that needed no search. */
+};
+
 /**
  * @brief Chunked streaming representation of a DLX row.
  */
@@ -47,7 +166,7 @@ struct DlxRowChunk
 struct DlxSolutionHeader
 {
     uint32_t magic;        /**< Magic constant (DLX_SOLUTION_MAGIC). */
-    uint16_t version;      /**< File format version (DLX_BINARY_VERSION). */
+    uint16_t version;      /**< Solution format version (DLX_SOLUTION_VERSION). */
     uint16_t flags;        /**< Reserved flags for future binary features. */
     uint32_t column_count; /**< Number of columns required to interpret rows. */
 };
@@ -57,7 +176,7 @@ struct DlxSolutionHeader
  */
 struct DlxSolutionRow
 {
-    uint32_t solution_id;  /**< Sequential identifier for the solution. */
+    uint64_t solution_id;  /**< Sequential identifier for the solution (at most 32 bits in version 1). */
     uint16_t entry_count;  /**< Number of row indices stored in @ref row_indices. */
     uint16_t capacity;     /**< Allocated capacity for the @ref row_indices buffer. */
     uint32_t* row_indices; /**< References to the rows that compose this solution. */
@@ -73,6 +192,9 @@ struct DlxProblem
 {
     DlxCoverHeader header;          /**< Cover header metadata. */
     std::vector<DlxRowChunk> rows;  /**< Row chunk data sized to header.row_count. */
+    dlx::SearchAssumptions assumptions; /**< Forced/forbidden rows from the assumption block. */
+    uint32_t problem_id;            /**< Client-chosen id; read and written when header.flags has DLX_COVER_FLAG_PROBLEM_ID. */
+    DlxSolveOptions options;        /**< Read and written when header.flags has DLX_COVER_FLAG_OPTIONS. */
 
     DlxProblem();
     ~DlxProblem();
@@ -85,6 +207,81 @@ struct DlxProblem
     void clear();
 };
 
+/**
+ * @brief Compressed-sparse-row DLX cover problem backed by a single arena allocation.
+ *
+ * Row @c i spans columns [offset(i), offset(i + 1)) of one shared column array, so a problem of
+ * any size costs one allocation and is laid out contiguously for matrix linking. The offsets,
+ * row ids and columns live in the same arena, which grows geometrically and is reused across
+ * @ref clear calls. Move-only, like @ref DlxProblem.
+ */
+struct DlxCsrProblem
+{
+    DlxCoverHeader header;              /**< Cover header metadata. */
+    dlx::SearchAssumptions assumptions; /**< Forced/forbidden rows from the assumption block. */
+    uint32_t problem_id;                /**< Client-chosen id; read and written when header.flags has DLX_COVER_FLAG_PROBLEM_ID. */
+    DlxSolveOptions options;            /**< Read and written when header.flags has DLX_COVER_FLAG_OPTIONS. */
+
+    DlxCsrProblem();
+    ~DlxCsrProblem();
+
+    DlxCsrProblem(const DlxCsrProblem&) = delete;
+    DlxCsrProblem& operator=(const DlxCsrProblem&) = delete;
+    DlxCsrProblem(DlxCsrProblem&& other) noexcept;
+    DlxCsrProblem& operator=(DlxCsrProblem&& other) noexcept;
+
+    /** @brief Drop all rows and metadata but keep the arena for the next problem. */
+    void clear();
+    /** @brief Drop all rows and release the arena. */
+    void release();
+    /** @brief Ensure room for @p rows rows holding @p entries column entries in total. */
+    int reserve(size_t rows, size_t entries);
+
+    /** @brief Return writable space for the next row's columns without committing it. */
+    uint32_t* prepare_row(uint16_t column_count);
+    /** @brief Commit the row whose columns were written through @ref prepare_row. */
+    void commit_row(uint32_t row_id, uint16_t column_count);
+    int append_row(uint32_t row_id, const uint32_t* columns, uint16_t column_count);
+
+    size_t row_count() const { return row_count_; }
+    size_t entry_count() const { return row_count_ == 0 ? 0 : static_cast<size_t>(offsets_[row_count_]); }
+    uint32_t row_id(size_t row) const { return row_ids_[row]; }
+    uint16_t row_size(size_t row) const { return static_cast<uint16_t>(offsets_[row + 1] - offsets_[row]); }
+    uint32_t* row_columns(size_t row) { return columns_ + offsets_[row]; }
+    const uint32_t* row_columns(size_t row) const { return columns_ + offsets_[row]; }
+
+    /**
+     * @brief Size the problem to exactly @p rows rows holding @p entries entries, to be filled by @ref place_row.
+     *
+     * Existing rows are discarded, but the arena is reused when it is large enough.
+     */
+    int resize(size_t rows, size_t entries);
+    /**
+     * @brief Record row @p row as starting at entry @p first_entry and return its column slots.
+     *
+     * Distinct rows may be placed concurrently, which is how blocks of one file are decoded on several threads.
+     */
+    uint32_t* place_row(size_t row, uint32_t row_id, uint64_t first_entry, uint16_t column_count);
+
+    /** @brief Borrowed DlxRowChunk view of a row for existing chunk consumers; never free its columns. */
+    DlxRowChunk row_chunk(size_t row) const;
+    /** @brief Replace the contents with a copy of a chunk-based problem. */
+    int assign(const DlxProblem& problem);
+    /** @brief Copy the contents into a chunk-based problem. */
+    int to_problem(DlxProblem* problem) const;
+
+private:
+    int grow(size_t rows, size_t entries);
+
+    void* arena_;
+    uint64_t* offsets_;
+    uint32_t* row_ids_;
+    uint32_t* columns_;
+    size_t row_capacity_;
+    size_t entry_capacity_;
+    size_t row_count_;
+};
+
 /**
  * @brief RAII-owned aggregate for a DLX solution set.
  *
@@ -95,6 +292,8 @@ struct DlxSolution
 {
     DlxSolutionHeader header;           /**< Solution header metadata. */
     std::vector<DlxSolutionRow> rows;   /**< Solution rows read from the stream. */
+    uint32_t problem_index;             /**< Input position of the solved problem (DLX_SOLUTION_FLAG_PROBLEM_INDEX). */
+    DlxSolveStatus status;              /**< Trailer of sections flagged DLX_SOLUTION_FLAG_STATUS. */
 
     DlxSolution();
     ~DlxSolution();
@@ -110,7 +309,9 @@ struct DlxSolution
 /**
  * @brief Streaming reader for DLX cover problems.
  *
- * Reads the cover header once, then returns one row at a time.
+ * Reads the cover header once, then returns one row at a time. The stream is pulled through a
+ * @ref DlxBlockReader, so the reader may hold bytes of the next problem; use @ref at_end rather than
+ * peeking at the stream to find the end of a multi-problem stream.
  */
 class DlxProblemStreamReader
 {
@@ -124,10 +325,121 @@ public:
     int read_header(struct DlxCoverHeader* header);
     int read_chunk(struct DlxRowChunk* chunk);
     int read_row(uint32_t* row_id, std::vector<uint32_t>* columns);
+    /** @brief Read the next row straight into @p problem's arena; returns 1, 0 at end of rows, or -1. */
+    int read_row(struct DlxCsrProblem* problem);
+    /** @brief Decode the next row in place and return a view of it; returns 1, 0 at end of rows, or -1. */
+    int read_row(struct DlxRowSpan* span);
+    /** @brief True when no further problem follows on the stream. */
+    bool at_end() { return input_.at_end(); }
+    /** @brief Assumption block read alongside the most recent header (empty when absent). */
+    const dlx::SearchAssumptions& assumptions() const { return assumptions_; }
+    /** @brief Problem id read alongside the most recent header (0 when the header carries none). */
+    uint32_t problem_id() const { return problem_id_; }
+    /** @brief Solve options read alongside the most recent header (all zero when the header carries none). */
+    const DlxSolveOptions& options() const { return options_; }
 
 private:
-    std::istream* input_;
+    int next_row_status(int status);
+    int read_compressed_chunk(struct DlxRowChunk* chunk);
+
+    DlxBlockReader input_;
+    DlxCoverBlockDecoder block_;
     DlxRowChunk scratch_;
+    dlx::SearchAssumptions assumptions_;
+    uint32_t problem_id_;
+    DlxSolveOptions options_;
+    uint32_t remaining_rows_;
+    bool has_row_count_;
+    bool header_active_;
+    bool native_;
+    bool compressed_;
+};
+
+/**
+ * @brief Finds where DLXB frames end in bytes that arrive piecemeal, without decoding any rows.
+ *
+ * Meant for non-blocking readers: append whatever arrived to a buffer that starts at the current
+ * frame and call @ref scan again. The scanner remembers how far it got, so every byte is examined
+ * once however the frame is split. Once a frame is complete, decode it with a
+ * @ref DlxProblemStreamReader over exactly those bytes. Frames without a row count and without
+ * blocks (version 1 or native rows, row_count 0) end with the stream; see @ref needs_eof.
+ */
+class DlxFrameScanner
+{
+public:
+    DlxFrameScanner();
+
+    /**
+     * @brief Advance through @p data, which holds the start of the current frame and @p size bytes in total.
+     * @return int 1 with @p frame_bytes set once the frame is complete (the scanner then resets for the next
+     *         frame), 0 when more bytes are needed, or -1 when the bytes cannot be a DLXB frame.
+     */
+    int scan(const char* data, size_t size, size_t* frame_bytes);
+    /** @brief True when the current frame's rows only end at end of stream. */
+    bool needs_eof() const { return stage_ == Stage::RowsToEof; }
+    /** @brief True when no byte of a frame has been scanned yet. */
+    bool idle() const { return stage_ == Stage::Header && offset_ == 0; }
+    void reset();
+
+private:
+    enum class Stage
+    {
+        Header,
+        Assumptions,
+        Rows,
+        RowsToEof,
+        Blocks,
+        Done
+    };
+
+    Stage stage_;
+    size_t offset_;
+    uint32_t remaining_rows_;
+    uint16_t flags_;
+    bool native_;
+    bool compressed_;
+};
+
+/**
+ * @brief Zero-copy reader for native-endian DLXB files.
+ *
+ * Maps the whole file read-only and walks it in place with the same interface as
+ * @ref DlxProblemStreamReader. Row spans point straight into the mapping, so reading rows performs no
+ * allocation or copy. Only problems flagged DLX_COVER_FLAG_NATIVE_ENDIAN are accepted, and only on
+ * little-endian hosts; when @ref open or @ref read_header fails, fall back to DlxProblemStreamReader,
+ * which decodes either encoding.
+ */
+class DlxMappedProblemReader
+{
+public:
+    DlxMappedProblemReader();
+    ~DlxMappedProblemReader();
+
+    DlxMappedProblemReader(const DlxMappedProblemReader&) = delete;
+    DlxMappedProblemReader& operator=(const DlxMappedProblemReader&) = delete;
+
+    int open(const char* path);
+    void close();
+
+    int read_header(struct DlxCoverHeader* header);
+    /** @brief Return a view of the next row inside the mapping; returns 1, 0 at end of rows, or -1. */
+    int read_row(struct DlxRowSpan* span);
+    /** @brief True when no further problem follows in the file. */
+    bool at_end() const { return cursor_ >= size_; }
+    /** @brief Assumption block read alongside the most recent header (empty when absent). */
+    const dlx::SearchAssumptions& assumptions() const { return assumptions_; }
+    /** @brief Problem id read alongside the most recent header (0 when the header carries none). */
+    uint32_t problem_id() const { return problem_id_; }
+    /** @brief Solve options read alongside the most recent header (all zero when the header carries none). */
+    const DlxSolveOptions& options() const { return options_; }
+
+private:
+    const char* mapping_;
+    size_t size_;
+    size_t cursor_;
+    dlx::SearchAssumptions assumptions_;
+    uint32_t problem_id_;
+    DlxSolveOptions options_;
     uint32_t remaining_rows_;
     bool has_row_count_;
     bool header_active_;
@@ -136,33 +448,72 @@ private:
 /**
  * @brief Streaming writer for DLX cover problems.
  *
- * Writes the header on construction and supports appending rows.
+ * Writes the header on construction and supports appending rows. Output is buffered in a
+ * @ref DlxBlockWriter and reaches the stream on @ref finish, @ref flush, or destruction.
+ * Version 2 problems are closed by their terminator and block index as soon as the declared
+ * number of rows has been written, or by @ref finish when no row count was declared.
  */
 class DlxProblemStreamWriter
 {
 public:
     DlxProblemStreamWriter(std::ostream& output, const struct DlxCoverHeader& header);
+    DlxProblemStreamWriter(std::ostream& output,
+                           const struct DlxCoverHeader& header,
+                           const dlx::SearchAssumptions& assumptions);
+    /** @brief Bind to @p output without writing anything until the first @ref start. */
+    explicit DlxProblemStreamWriter(std::ostream& output);
+    ~DlxProblemStreamWriter();
 
     DlxProblemStreamWriter(const DlxProblemStreamWriter&) = delete;
     DlxProblemStreamWriter& operator=(const DlxProblemStreamWriter&) = delete;
 
     /** @brief Start a new problem on the same stream by writing a fresh header. */
     int start(const struct DlxCoverHeader& header);
+    /** @brief Start a new problem whose header is followed by an assumption block. */
+    int start(const struct DlxCoverHeader& header, const dlx::SearchAssumptions& assumptions);
+    /**
+     * @brief Start a new problem tagged with @p problem_id (DLX_COVER_FLAG_PROBLEM_ID); the assumption block is
+     * written when @p assumptions is not empty or the header already asks for one.
+     */
+    int start(const struct DlxCoverHeader& header, const dlx::SearchAssumptions& assumptions, uint32_t problem_id);
+    /**
+     * @brief Start a new problem that carries solve options (DLX_COVER_FLAG_OPTIONS); the problem id is written
+     * when the header asks for one, the assumption block as for the overload above.
+     */
+    int start(const struct DlxCoverHeader& header,
+              const dlx::SearchAssumptions& assumptions,
+              uint32_t problem_id,
+              const DlxSolveOptions& options);
     int write_row(uint32_t row_id, const uint32_t* columns, uint16_t column_count);
     /** @brief Finish the current problem and allow a new header to be written. */
     int finish();
+    /** @brief Pass buffered output to the stream. */
+    int flush() { return output_.flush(); }
 
 private:
-    std::ostream* output_;
+    int begin(const struct DlxCoverHeader& header,
+              const dlx::SearchAssumptions& assumptions,
+              uint32_t problem_id,
+              const DlxSolveOptions& options);
+    void begin_body(const struct DlxCoverHeader& header);
+    int end_body();
+
+    DlxBlockWriter output_;
+    DlxCoverBlockEncoder encoder_;
     uint32_t remaining_rows_;
     bool has_row_count_;
     bool started_;
+    bool native_;
+    bool compressed_;
+    bool body_open_;
 };
 
 /**
  * @brief Streaming reader for DLX solutions.
  *
- * Reads the solution header once, then returns one solution row at a time.
+ * Reads the solution header once, then returns one solution row at a time. Seekable streams are read
+ * ahead a block at a time and any unread bytes are given back on destruction; other streams are read
+ * exactly, so a new reader can pick up the next section.
  */
 class DlxSolutionStreamReader
 {
@@ -174,52 +525,102 @@ public:
     DlxSolutionStreamReader& operator=(const DlxSolutionStreamReader&) = delete;
 
     int read_header(struct DlxSolutionHeader* header);
+    int read_row(uint64_t* solution_id, std::vector<uint32_t>* row_indices);
+    /** @brief Same as the 64-bit overload, but fails on ids that do not fit in 32 bits. */
     int read_row(uint32_t* solution_id, std::vector<uint32_t>* row_indices);
+    /** @brief Problem index read alongside the most recent header (0 when the header carries none). */
+    uint32_t problem_index() const { return problem_index_; }
+    /** @brief Status trailer read after the terminator, once @ref read_row returned 0 (all zero when none). */
+    const DlxSolveStatus& status() const { return status_; }
 
 private:
-    std::istream* input_;
+    int end_section();
+
+    DlxBlockReader input_;
     DlxSolutionRow scratch_;
+    DlxSolutionDecoder decoder_;
+    uint32_t problem_index_;
+    DlxSolveStatus status_;
     bool header_active_;
+    bool compact_;
+    bool has_status_;
 };
 
 /**
  * @brief Streaming writer for DLX solutions.
  *
- * Writes the header on construction, emits rows, and can write a terminator row.
+ * Writes the header on construction, emits rows, and can write a terminator row. Output is buffered in a
+ * @ref DlxBlockWriter and reaches the stream on @ref finish, @ref flush, or destruction. Headers with
+ * version DLX_SOLUTION_VERSION_COMPACT or later select the compact record encoding, honouring
+ * DLX_SOLUTION_FLAG_SORTED_ROWS; ids count up from 1 either way.
  */
 class DlxSolutionStreamWriter
 {
 public:
     DlxSolutionStreamWriter(std::ostream& output, const struct DlxSolutionHeader& header);
+    /** @brief Bind to @p output without writing anything until the first @ref start. */
+    explicit DlxSolutionStreamWriter(std::ostream& output);
 
     DlxSolutionStreamWriter(const DlxSolutionStreamWriter&) = delete;
     DlxSolutionStreamWriter& operator=(const DlxSolutionStreamWriter&) = delete;
 
     /** @brief Start a new solution stream on the same writer instance. */
     int start(const struct DlxSolutionHeader& header);
+    /** @brief Start a new solution stream tagged with the index of the problem it answers. */
+    int start(const struct DlxSolutionHeader& header, uint32_t problem_index);
     int write_row(const uint32_t* row_indices, uint16_t row_count);
-    /** @brief Write the terminator row and allow a new header to be written. */
+    /**
+     * @brief Write the terminator row and allow a new header to be written. Sections started with
+     * DLX_SOLUTION_FLAG_STATUS report DLX_SOLVE_COMPLETE with the rows written.
+     */
     int finish();
+    /** @brief Write the terminator followed by @p status, for sections started with DLX_SOLUTION_FLAG_STATUS. */
+    int finish(const DlxSolveStatus& status);
+    /** @brief Pass buffered rows to the stream without ending the section. */
+    int flush() { return output_.flush(); }
+    /** @brief Encoded bytes not yet passed to the stream. */
+    size_t buffered_bytes() const { return output_.size(); }
 
 private:
-    std::ostream* output_;
-    uint32_t next_solution_id_;
+    DlxBlockWriter output_;
+    DlxSolutionEncoder encoder_;
+    uint64_t next_solution_id_;
     bool finished_;
     bool started_;
+    bool compact_;
+    bool has_status_;
 };
 
 // Read API
+// The aggregate readers consume exactly one problem or section: they read ahead only on seekable
+// streams and seek back over whatever they did not use.
 /**
  * @brief Read a full DLX cover problem into a RAII-owned aggregate.
  *
- * Reads the cover header and exactly header.row_count row chunks.
+ * Reads the cover header, the assumption block when DLX_COVER_FLAG_ASSUMPTIONS is set,
+ * and exactly header.row_count row chunks (version 1) or every block up to the terminator (version 2).
  */
 int dlx_read_problem(std::istream& input, struct DlxProblem* problem);
+/**
+ * @brief Read a full DLX cover problem into a CSR aggregate.
+ *
+ * Same framing as @ref dlx_read_problem, but rows are decoded directly into the problem's arena,
+ * so no per-row allocation takes place.
+ */
+int dlx_read_problem(std::istream& input, struct DlxCsrProblem* problem);
+/**
+ * @brief Decode the single version 2 problem held in @p data (e.g. a mapped file) on up to @p workers threads.
+ *
+ * The block index at the end of the buffer locates every block, the blocks' headers size the arena
+ * exactly, and workers then decode disjoint blocks straight into it. Returns -1 for other encodings,
+ * which must be read with @ref dlx_read_problem.
+ */
+int dlx_decode_problem(const char* data, size_t size, struct DlxCsrProblem* problem, unsigned int workers);
 /**
  * @brief Read a full DLX solution stream into a RAII-owned aggregate.
  *
- * Reads the solution header and consumes rows until EOF or a terminating
- * empty row (solution_id == 0 and entry_count == 0).
+ * Reads the solution header and consumes rows until EOF or the section terminator
+ * (an empty row with solution_id 0 in version 1, a zero tag in version 2).
  */
 int dlx_read_solution(std::istream& input, struct DlxSolution* solution);
 struct node* dlx_read_binary(std::istream& input,
@@ -229,12 +630,35 @@ struct node* dlx_read_binary(std::istream& input,
 // Write API
 /**
  * @brief Write a full DLX cover problem from a RAII-owned aggregate.
+ *
+ * Emits the assumption block (and sets DLX_COVER_FLAG_ASSUMPTIONS) whenever the
+ * problem carries assumptions.
  */
 int dlx_write_problem(std::ostream& output, const struct DlxProblem* problem);
+/**
+ * @brief Write a full DLX cover problem from a CSR aggregate.
+ */
+int dlx_write_problem(std::ostream& output, const struct DlxCsrProblem* problem);
 /**
  * @brief Write a full DLX solution stream from a RAII-owned aggregate.
+ *
+ * Version 2 sections set DLX_SOLUTION_FLAG_EXPLICIT_IDS unless the ids run 1, 2, 3, ..., and end with a
+ * terminator. Version 1 sections fail on ids wider than 32 bits.
  */
 int dlx_write_solution(std::ostream& output, const struct DlxSolution* solution);
+// Encoding API
+/**
+ * @brief Re-encode every problem of a DLXB stream as native-endian (@p native) or big-endian DLXB.
+ *
+ * Headers, assumption blocks, reuse frames and row order are preserved; only the
+ * DLX_COVER_FLAG_NATIVE_ENDIAN bit, the version (when @p version is non-zero) and the body
+ * encoding change. Version 2 bodies store each row's columns in ascending order.
+ */
+int dlx_convert_problems(std::istream& input, std::ostream& output, bool native, uint16_t version = 0);
+/**
+ * @brief Report whether the first problem in @p path is native-endian, i.e. can be read by DlxMappedProblemReader.
+ */
+bool dlx_is_native_problem_file(const char* path);
 
 } // namespace dlx::binary
 
@@ -0,0 +1,252 @@
+#ifndef DLX_BLOCK_CODEC_H
+#define DLX_BLOCK_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+namespace dlx::binary {
+
+/** @brief Default buffer size for block readers and writers. */
+#define DLX_BLOCK_SIZE (256u * 1024u)
+
+/** @brief 1 when the host stores integers most significant byte first. */
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define DLX_HOST_BIG_ENDIAN 1
+#else
+#define DLX_HOST_BIG_ENDIAN 0
+#endif
+
+void dlx_byteswap_u32_array(uint32_t* values, size_t count);
+void dlx_byteswap_u32_copy(void* dst, const void* src, size_t count);
+/** @brief Copy u32 values between host order and big- (@p big_endian) or little-endian order. */
+void dlx_convert_u32_copy(void* dst, const void* src, size_t count, bool big_endian);
+
+/**
+ * @brief Row decoded in place inside a block reader's buffer.
+ *
+ * @ref columns are in host order and stay valid until the next call on the reader that produced them.
+ */
+struct DlxRowSpan
+{
+    uint32_t row_id;         /**< Identifier of the serialized row. */
+    uint16_t entry_count;    /**< Number of column indices in @ref columns. */
+    const uint32_t* columns; /**< Column indices, borrowed from the reader's buffer. */
+};
+
+/**
+ * @brief Pulls a binary stream through one large buffer and hands out views into it.
+ *
+ * Refills are single read() calls. Seekable streams (files, strings) end rather than stall, so they are read a
+ * whole block ahead; other streams (pipes, sockets, std::cin) are only asked for the bytes the caller needs or
+ * has declared with @ref expect, so a peer waiting on a reply is never stalled by read-ahead. A block size of 0
+ * disables read-ahead entirely, which callers that hand the stream on to other readers rely on. Unconsumed
+ * bytes are given back to seekable streams when the reader is destroyed.
+ */
+class DlxBlockReader
+{
+public:
+    explicit DlxBlockReader(std::istream& input, size_t block_size = DLX_BLOCK_SIZE);
+    ~DlxBlockReader();
+
+    DlxBlockReader(const DlxBlockReader&) = delete;
+    DlxBlockReader& operator=(const DlxBlockReader&) = delete;
+
+    /** @brief Consume @p bytes and return them, or nullptr when the stream ends first. */
+    const char* take(size_t bytes);
+    /**
+     * @brief Consume @p count u32 values stored big- (or little-) endian and return them aligned and in host order.
+     *
+     * The values are decoded in place, which may overwrite bytes returned by earlier @ref take calls.
+     */
+    const uint32_t* take_u32_array(size_t count, bool big_endian = true);
+    /** @brief Consume one base-128 varint; returns 1, 0 when the stream ended cleanly before it, or -1. */
+    int take_varint(uint64_t* value);
+    /** @brief True once the stream is exhausted and nothing is left buffered. */
+    bool at_end();
+    /** @brief Declare that at least @p bytes more follow in the stream, e.g. a block whose length is known. */
+    void expect(size_t bytes);
+    /** @brief True when the last failed @ref take ran into the end of the stream. */
+    bool eof() const { return input_->eof(); }
+
+private:
+    int fill(size_t bytes);
+
+    std::istream* input_;
+    char* buffer_;
+    size_t capacity_;
+    size_t block_size_;
+    size_t begin_;
+    size_t end_;
+    size_t expected_; /**< Declared bytes beyond end_ that the stream has yet to deliver. */
+    bool seekable_;
+};
+
+/**
+ * @brief Collects encoded output in one large buffer and hands it to the stream in whole blocks.
+ *
+ * Nothing reaches the stream until the buffer fills, @ref flush is called, or the writer is destroyed.
+ */
+class DlxBlockWriter
+{
+public:
+    explicit DlxBlockWriter(std::ostream& output, size_t block_size = DLX_BLOCK_SIZE);
+    ~DlxBlockWriter();
+
+    DlxBlockWriter(const DlxBlockWriter&) = delete;
+    DlxBlockWriter& operator=(const DlxBlockWriter&) = delete;
+
+    /** @brief Return room for @p bytes at the end of the buffer; pair with @ref commit. */
+    char* reserve(size_t bytes);
+    void commit(size_t bytes) { end_ += bytes; }
+    int write(const void* data, size_t bytes);
+    /** @brief Append @p count u32 values in big-endian (or little-endian) order. */
+    int write_u32_array(const uint32_t* values, size_t count, bool big_endian = true);
+    /** @brief Pass everything buffered to the stream; returns 0 when the stream accepted it. */
+    int flush();
+    /** @brief Bytes buffered and not yet passed to the stream. */
+    size_t size() const { return end_; }
+
+private:
+    std::ostream* output_;
+    char* buffer_;
+    size_t capacity_;
+    size_t end_;
+};
+
+/** @brief Payload size at which a compressed cover block is closed and a new one started. */
+#define DLX_COVER_BLOCK_BYTES (64u * 1024u)
+
+/** @brief Largest block or index payload a reader accepts, so a corrupt length cannot force a huge allocation. */
+#define DLX_COVER_BLOCK_MAX_BYTES (16u * 1024u * 1024u)
+
+/** @brief Magic constant that closes the block index of a compressed cover (ASCII 'DLXI'). */
+#define DLX_COVER_INDEX_MAGIC 0x444C5849u /* 'DLXI' */
+
+/**
+ * @brief Big-endian header in front of every compressed cover block.
+ *
+ * A header with @ref row_count 0 terminates the rows and is followed by @ref payload_bytes of block index.
+ */
+struct DlxCoverBlockHeader
+{
+    uint32_t row_count;     /**< Rows in the block (0 for the terminator). */
+    uint32_t entry_count;   /**< Column entries across every row of the block. */
+    uint32_t payload_bytes; /**< Encoded bytes that follow the header. */
+};
+
+/** @brief Encoded size of a @ref DlxCoverBlockHeader. */
+#define DLX_COVER_BLOCK_HEADER_BYTES 12u
+
+void dlx_encode_block_header(const struct DlxCoverBlockHeader& header, char* out);
+struct DlxCoverBlockHeader dlx_decode_block_header(const char* bytes);
+
+/**
+ * @brief Encodes cover rows into delta-varint blocks followed by a terminator and block index.
+ *
+ * Each row is a zigzag varint row id delta (from the previous row of the same block), a varint entry count,
+ * then its columns in ascending order as a varint first column and varint gaps. Blocks restart the row id
+ * delta so every block decodes on its own. @ref finish closes the last block and appends the terminator and
+ * an index of block offsets, measured from the first block header, that ends in a block count and
+ * DLX_COVER_INDEX_MAGIC so it can be found from the end of a buffer.
+ */
+class DlxCoverBlockEncoder
+{
+public:
+    DlxCoverBlockEncoder();
+
+    int add_row(uint32_t row_id, const uint32_t* columns, uint16_t column_count);
+    /** @brief True once the open block has reached DLX_COVER_BLOCK_BYTES and should be flushed. */
+    bool full() const { return payload_.size() >= DLX_COVER_BLOCK_BYTES; }
+    /** @brief Write the open block, if any, to @p output. */
+    int flush(DlxBlockWriter& output);
+    /** @brief Write the open block, the terminator and the block index, then start over for the next problem. */
+    int finish(DlxBlockWriter& output);
+
+private:
+    std::vector<uint8_t> payload_;
+    std::vector<uint32_t> sorted_;
+    std::vector<uint64_t> offsets_;
+    uint64_t body_bytes_;
+    uint32_t block_rows_;
+    uint32_t block_entries_;
+    uint32_t previous_row_id_;
+};
+
+/**
+ * @brief Decodes the rows of one compressed cover block in place.
+ *
+ * The decoder only borrows the payload, so it stays valid as long as the buffer it came from.
+ */
+class DlxCoverBlockDecoder
+{
+public:
+    DlxCoverBlockDecoder();
+
+    void reset(const char* payload, const struct DlxCoverBlockHeader& header);
+    /** @brief True when every row of the block has been decoded. */
+    bool done() const { return rows_left_ == 0; }
+    /** @brief Decode the next row's id and entry count; the columns must then be read with @ref read_columns. */
+    int next_row(uint32_t* row_id, uint16_t* column_count);
+    int read_columns(uint32_t* columns, uint16_t column_count);
+
+private:
+    const uint8_t* cursor_;
+    const uint8_t* end_;
+    uint32_t rows_left_;
+    uint32_t entries_left_;
+    uint32_t previous_row_id_;
+};
+
+/**
+ * @brief Encodes solution records for DLXS version 2 sections.
+ *
+ * A record is a varint tag (0 terminates the section, otherwise the number of leading rows shared with the
+ * previous solution plus one), a zigzag varint id delta when ids are explicit, a varint count of the
+ * remaining rows, and those rows as varint deltas from the row before them: zigzagged for rows kept in
+ * search order, plain gaps for sorted rows. Implicit ids count up from 1.
+ */
+class DlxSolutionEncoder
+{
+public:
+    DlxSolutionEncoder();
+
+    /** @brief Start a section; @p sorted stores each solution's rows in ascending order. */
+    void reset(bool sorted, bool explicit_ids);
+    int write(DlxBlockWriter& output, uint64_t solution_id, const uint32_t* rows, uint16_t row_count);
+    int terminate(DlxBlockWriter& output);
+
+private:
+    std::vector<uint32_t> previous_;
+    std::vector<uint32_t> sorted_;
+    uint64_t previous_id_;
+    bool sorted_rows_;
+    bool explicit_ids_;
+};
+
+/**
+ * @brief Decodes the records written by @ref DlxSolutionEncoder.
+ */
+class DlxSolutionDecoder
+{
+public:
+    DlxSolutionDecoder();
+
+    void reset(bool sorted, bool explicit_ids);
+    /** @brief Decode the next solution into @ref rows; returns 1, 0 at the terminator or end of stream, or -1. */
+    int read(DlxBlockReader& input, uint64_t* solution_id);
+    /** @brief Rows of the most recently decoded solution. */
+    const std::vector<uint32_t>& rows() const { return rows_; }
+
+private:
+    std::vector<uint32_t> rows_;
+    uint64_t previous_id_;
+    bool sorted_rows_;
+    bool explicit_ids_;
+};
+
+} // namespace dlx::binary
+
+#endif
@@ -6,6 +6,7 @@
 #include <istream>
 #include <ostream>
 #include <stdint.h>
+#include <utility>
 #include "core/solution_sink.h"
 
 // Forward declaration of binary types.
@@ -13,9 +14,20 @@ namespace dlx::binary {
 struct DlxCoverHeader;
 struct DlxProblem;
 struct DlxRowChunk;
+struct DlxCsrProblem;
+class DlxProblemStreamReader;
+class DlxMappedProblemReader;
 class DlxSolutionStreamWriter;
 } // namespace dlx::binary
 
+namespace dlx::matrix {
+class MatrixBuilder;
+} // namespace dlx::matrix
+
+namespace dlx::sink {
+class AsyncSolutionWriter;
+} // namespace dlx::sink
+
 /**************************************************************************************************************
  *                                            DLX Application                                                 *
  *        DLX is a powerful backtracking, depth-first algorithm that solves exact cover problems.             *
@@ -53,10 +65,12 @@ struct SolutionOutput
     std::ostream* binary_stream;
     BinaryRowCallback binary_callback;
     void* binary_context;
-    uint32_t next_solution_id;
+    uint64_t next_solution_id;
     uint32_t column_count;
     std::vector<std::vector<uint32_t>> binary_rows;
     dlx::binary::DlxSolutionStreamWriter* binary_writer;
+    /** When set, solutions are only queued here (text and DLXS are written on its thread); the sink is skipped. */
+    dlx::sink::AsyncSolutionWriter* async_writer;
 
     SolutionOutput()
         : sink(nullptr)
@@ -67,10 +81,43 @@ struct SolutionOutput
         , column_count(0)
         , binary_rows()
         , binary_writer(nullptr)
+        , async_writer(nullptr)
     {}
     void emit_binary_row(const uint32_t* row_ids, int level);
 };
 
+/**
+ * @brief Row-level constraints applied to an already linked matrix before searching.
+ *
+ * Forced rows are placed into every reported solution by covering their columns up front,
+ * while forbidden rows are unlinked from their columns so the search never selects them.
+ * Row identifiers use the same numbering as the DLXB row chunks.
+ */
+struct SearchAssumptions
+{
+    std::vector<uint32_t> forced_rows;      /**< Rows that must appear in every solution. */
+    std::vector<uint32_t> forbidden_rows;   /**< Rows that may not appear in any solution. */
+
+    bool empty() const { return forced_rows.empty() && forbidden_rows.empty(); }
+};
+
+/**
+ * @brief Lookup table from row identifiers to the first option node of each row.
+ *
+ * Built once from a pristine matrix (no columns covered) and reused across any number of
+ * @ref Core::searchWithAssumptions calls on the same matrix.
+ */
+class RowIndex
+{
+public:
+    int build(struct node* head);
+    struct node* find(uint32_t row_id) const;
+    size_t size() const { return rows_.size(); }
+
+private:
+    std::vector<std::pair<uint32_t, struct node*>> rows_;
+};
+
 class Core
 {
 public:
@@ -83,18 +130,73 @@ public:
                                                      char*** solutions_out,
                                                      int* item_count_out,
                                                      int* option_count_out);
+    static struct node* generateMatrixFromCsr(const dlx::binary::DlxCsrProblem& problem,
+                                              char*** solutions_out,
+                                              int* item_count_out,
+                                              int* option_count_out);
+    static struct node* generateMatrixFromCsr(const dlx::binary::DlxCsrProblem& problem,
+                                              dlx::matrix::MatrixBuilder& builder,
+                                              int* item_count_out,
+                                              int* option_count_out);
+    static struct node* generateMatrixFromStream(dlx::binary::DlxProblemStreamReader& reader,
+                                                 const struct dlx::binary::DlxCoverHeader& header,
+                                                 char*** solutions_out,
+                                                 int* item_count_out,
+                                                 int* option_count_out);
+    static struct node* generateMatrixFromStream(dlx::binary::DlxProblemStreamReader& reader,
+                                                 const struct dlx::binary::DlxCoverHeader& header,
+                                                 dlx::matrix::MatrixBuilder& builder,
+                                                 int* item_count_out,
+                                                 int* option_count_out);
+    static struct node* generateMatrixFromStream(dlx::binary::DlxMappedProblemReader& reader,
+                                                 const struct dlx::binary::DlxCoverHeader& header,
+                                                 char*** solutions_out,
+                                                 int* item_count_out,
+                                                 int* option_count_out);
     static void setMatrixDumpStream(std::ostream* stream);
     static void search(struct node*, int, char**, uint32_t*, SolutionOutput&);
+    static int searchWithAssumptions(struct node* head,
+                                     const RowIndex& index,
+                                     const SearchAssumptions& assumptions,
+                                     char** solutions,
+                                     uint32_t* row_ids,
+                                     SolutionOutput& output);
+    /** @brief Search that hands each solution to a compile-time policy; defined in core/search.h. */
+    template <typename Policy>
+    static void search(struct node* head, int level, uint32_t* row_ids, Policy& policy);
+    template <typename Policy>
+    static int searchWithAssumptions(struct node* head,
+                                     const RowIndex& index,
+                                     const SearchAssumptions& assumptions,
+                                     uint32_t* row_ids,
+                                     Policy& policy);
     static void freeMemory(struct node*, char**);
     static int dlx_enable_binary_solution_output(SolutionOutput& output_ctx, std::ostream& output, uint32_t column_count);
     static void dlx_disable_binary_solution_output(SolutionOutput& output_ctx);
     static void dlx_set_stdout_suppressed(bool suppressed);
 
 private:
+    /** Links changed by @ref applyAssumptions, undone by @ref restoreAssumptions. */
+    struct AssumptionState
+    {
+        std::vector<struct node*> forced;
+        std::vector<struct node*> hidden;
+        int level = 0;
+        bool conflict = false;
+    };
+    struct OutputPolicy;
+
+    static int applyAssumptions(const RowIndex& index,
+                                const SearchAssumptions& assumptions,
+                                uint32_t* row_ids,
+                                AssumptionState& state);
+    static void restoreAssumptions(AssumptionState& state);
     static void hide(struct node*);
     static void cover(struct node*);
     static void unhide(struct node*);
     static void uncover(struct node*);
+    static void hideRow(struct node*);
+    static void unhideRow(struct node*);
     static void printSolutions(char**, const uint32_t*, int, SolutionOutput&);
     static struct node* pickConstraint(struct node*);
     static struct node* generateMatrixBinaryImpl(const struct dlx::binary::DlxCoverHeader& header,
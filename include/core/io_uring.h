@@ -0,0 +1,172 @@
+#ifndef DLX_IO_URING_H
+#define DLX_IO_URING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Optional io_uring transport for the TCP server.
+ *
+ * DLX_HAVE_IO_URING is defined by the build when the DLX_WITH_IO_URING option is on and the kernel headers
+ * provide the opcodes used here. Without it only @ref dlx::io::io_uring_built_in is available and the server
+ * always runs on epoll. The ring is driven through the raw system calls, so no liburing is needed.
+ */
+namespace dlx::io {
+
+/** @brief True when this build contains the io_uring backend. */
+constexpr bool io_uring_built_in()
+{
+#if defined(DLX_HAVE_IO_URING)
+    return true;
+#else
+    return false;
+#endif
+}
+
+} // namespace dlx::io
+
+#if defined(DLX_HAVE_IO_URING)
+
+#include <linux/io_uring.h>
+#include <sys/uio.h>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace dlx::io {
+
+/**
+ * @brief Minimal owner of one io_uring instance: submission and completion queues mapped from the kernel.
+ *
+ * Not thread safe; each ring belongs to the thread that drives it.
+ */
+class IoUring
+{
+public:
+    IoUring();
+    ~IoUring();
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    /**
+     * @brief Create the ring with room for @p entries submissions.
+     * @return int 0 on success, -1 when the kernel refuses io_uring or lacks an opcode the server relies on.
+     */
+    int init(unsigned entries);
+    /** @brief Zeroed submission entry to fill in, queued for the next @ref submit; submits first when full. */
+    struct io_uring_sqe* next_sqe();
+    /** @brief Hand every queued entry to the kernel and wait for @p wait_count completions, in one system call. */
+    int submit(unsigned wait_count = 0);
+    /** @brief Take the oldest completion; returns false when none is ready. */
+    bool pop(struct io_uring_cqe* cqe);
+    /** @brief Register @p count buffers for IORING_RECVSEND_FIXED_BUF; returns 0 on success. */
+    int register_buffers(const struct iovec* buffers, unsigned count);
+    bool supports(uint8_t opcode) const { return opcode < supported_.size() && supported_[opcode]; }
+
+private:
+    void release();
+
+    int fd_;
+    void* sq_map_;
+    size_t sq_map_bytes_;
+    void* cq_map_;
+    size_t cq_map_bytes_;
+    struct io_uring_sqe* sqes_;
+    size_t sqes_bytes_;
+    unsigned* sq_head_;
+    unsigned* sq_tail_;
+    unsigned* sq_array_;
+    unsigned sq_mask_;
+    unsigned sq_entries_;
+    unsigned sqe_tail_;
+    unsigned* cq_head_;
+    unsigned* cq_tail_;
+    unsigned cq_mask_;
+    struct io_uring_cqe* cqes_;
+    std::vector<bool> supported_;
+};
+
+/** @brief Ordered byte stream to one socket through a @ref UringSendQueue. */
+struct SendChannel
+{
+    struct Pending
+    {
+        uint32_t slot;
+        size_t size;
+    };
+
+    explicit SendChannel(int socket_fd) : fd(socket_fd) {}
+
+    int fd;
+    bool failed = false; /**< A send failed; everything queued afterwards is dropped. */
+    bool closed = false; /**< The owner went away; queued sends are dropped instead of started. */
+    bool busy = false;   /**< A send of this channel is in the kernel; the next one waits for it. */
+    std::deque<Pending> queue;
+};
+
+/**
+ * @brief Sends fixed-size buffers to many sockets through one ring.
+ *
+ * Callers fill slots of one registered region and queue them on a channel per socket. Each channel has at most
+ * one send in flight, so its bytes arrive in order and short sends simply continue from where they stopped,
+ * while sends to different sockets are submitted together: a broadcast to N subscribers costs one system call
+ * instead of N. Full slots are sent with IORING_OP_SEND_ZC straight from the registered buffers, shorter ones
+ * (and every slot when the buffers could not be registered) with IORING_OP_SEND. Not thread safe; the server
+ * serializes every call under its subscriber mutex.
+ */
+class UringSendQueue
+{
+public:
+    UringSendQueue();
+    ~UringSendQueue();
+
+    UringSendQueue(const UringSendQueue&) = delete;
+    UringSendQueue& operator=(const UringSendQueue&) = delete;
+
+    /** @brief Set up the ring and @p slots buffers of @p slot_bytes; returns -1 when io_uring is unusable. */
+    int init(unsigned slots, size_t slot_bytes);
+    size_t slot_bytes() const { return slot_bytes_; }
+    /**
+     * @brief A free slot to fill, reclaiming finished sends (and waiting for one when some are in flight).
+     * @return char* The slot's buffer, or nullptr when every slot is held by a caller.
+     */
+    char* acquire(uint32_t* slot);
+    /** @brief Return a slot that was acquired but not sent. */
+    void release(uint32_t slot);
+    /** @brief Queue the first @p size bytes of @p slot on @p channel; the slot is released once sent. */
+    void send(const std::shared_ptr<SendChannel>& channel, uint32_t slot, size_t size);
+    /** @brief Submit queued sends without waiting and reclaim whatever has completed. */
+    void poll();
+    /** @brief Wait until every queued send has completed or failed. */
+    void drain();
+
+private:
+    struct Slot
+    {
+        std::shared_ptr<SendChannel> channel;
+        size_t offset = 0;
+        size_t size = 0;
+        unsigned outstanding = 0; /**< Completions still expected: the send result and a zero-copy notification. */
+        bool sending = false;
+    };
+
+    void start(uint32_t slot);
+    void start_next(SendChannel& channel);
+    void complete(const struct io_uring_cqe& cqe);
+    bool busy() const { return in_flight_ > 0; }
+
+    IoUring ring_;
+    std::unique_ptr<char[]> region_;
+    size_t slot_bytes_;
+    std::vector<Slot> slots_;
+    std::vector<uint32_t> free_;
+    unsigned in_flight_;
+    bool zero_copy_;
+};
+
+} // namespace dlx::io
+
+#endif
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef DLX_LOCAL_CLIENT_H
+#define DLX_LOCAL_CLIENT_H
+
+#include "core/shm_ring.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+
+namespace dlx {
+
+/**
+ * @brief Client for a server on the same host, over its Unix domain socket and a shared segment.
+ *
+ * Problems are encoded straight into the segment's problem area through @ref problem and handed over with
+ * @ref submit, which only sends a sixteen-byte request; the server decodes the frame from the mapping. Every
+ * submitted problem is answered in the segment's ring, in submission order, as the same DLXS sections an inline
+ * TCP answer carries, and @ref solutions reads them in place. No byte of a problem or a solution crosses the
+ * socket.
+ *
+ * The problem area holds one frame at a time: @ref problem waits until the server has decoded the previous one,
+ * which happens long before its search ends, so problems still pipeline. A frame larger than the area fails.
+ *
+ * @code
+ * dlx::DlxLocalClient client;
+ * client.connect("/run/dlx.sock");
+ * dlx::binary::DlxProblemStreamWriter writer(client.problem(), header);
+ * // ... write_row, finish
+ * client.submit();
+ * dlx::binary::DlxSolutionStreamReader reader(client.solutions());
+ * @endcode
+ */
+class DlxLocalClient
+{
+public:
+    static constexpr size_t kDefaultProblemBytes = 16u << 20;
+    static constexpr size_t kDefaultRingBytes = 4u << 20;
+
+    DlxLocalClient();
+    ~DlxLocalClient();
+
+    DlxLocalClient(const DlxLocalClient&) = delete;
+    DlxLocalClient& operator=(const DlxLocalClient&) = delete;
+
+    /**
+     * @brief Connect to the server listening at @p path and attach a new segment with the given area sizes.
+     * @return int 0 on success, -1 otherwise.
+     */
+    int connect(const std::string& path,
+                size_t problem_bytes = kDefaultProblemBytes,
+                size_t ring_bytes = kDefaultRingBytes);
+    /**
+     * @brief Stream to encode the next problem into, at the start of the problem area. Waits until the server has
+     * decoded the previously submitted problem; the stream is bad when the server went away.
+     */
+    std::ostream& problem();
+    /**
+     * @brief Hand the problem written to @ref problem to the server.
+     * @return int 0 on success, -1 when nothing was written, the frame did not fit, or the request failed.
+     */
+    int submit();
+    /** @brief The answers of every submitted problem, one DLXS section each; ends once the server is done. */
+    std::istream& solutions();
+    /** @brief Tell the server no more problems follow; answers still arrive until the last one is complete. */
+    void finish();
+    /** @brief Disconnect, abandoning answers not read yet. */
+    void close();
+
+private:
+    class ProblemBuffer;
+    class RingBuffer;
+
+    int send_request(uint32_t op, uint32_t offset, uint32_t length, int passed_fd);
+    bool server_gone() const;
+
+    int fd_;
+    std::unique_ptr<shm::ShmSegment> segment_;
+    std::unique_ptr<shm::ShmRing> ring_;
+    uint32_t submitted_;
+    std::unique_ptr<ProblemBuffer> problem_buffer_;
+    std::unique_ptr<RingBuffer> ring_buffer_;
+    std::ostream problem_stream_;
+    std::istream solution_stream_;
+};
+
+} // namespace dlx
+
+#endif
@@ -1,7 +1,10 @@
 #ifndef DLX_MATRIX_H
 #define DLX_MATRIX_H
 
+#include <stddef.h>
+#include <stdint.h>
 #include <ostream>
+#include <vector>
 
 struct node;
 
@@ -16,6 +19,51 @@ void dumpMatrixStructure(const struct node* matrix,
                          int total_nodes,
                          int itemCount,
                          std::ostream& output);
+void rebaseMatrixLinks(struct node* matrix, size_t last_index, uintptr_t old_base);
+size_t countMatrixNodes(const struct node* matrix, int itemCount, int optionCount);
+
+/**
+ * @brief Incremental builder that links option rows into a Dancing Links matrix as they arrive.
+ *
+ * Rows are appended in O(row length): each option node is linked beneath the current tail of its
+ * column (the column header's @c up pointer) instead of walking the column. The node array is
+ * sized from the caller's hints and grows geometrically when the hints are exceeded, so the full
+ * cover never has to be held in memory before linking starts.
+ */
+class MatrixBuilder
+{
+public:
+    MatrixBuilder();
+    ~MatrixBuilder();
+
+    MatrixBuilder(const MatrixBuilder&) = delete;
+    MatrixBuilder& operator=(const MatrixBuilder&) = delete;
+
+    /** @brief Lay out the head, column headers, and leading spacer, reusing any existing node array. */
+    int begin(uint32_t column_count, size_t row_hint, size_t entry_hint);
+    /** @brief Append one option row; @p columns may be unsorted and duplicates are ignored. */
+    int append_row(uint32_t row_id, const uint32_t* columns, uint16_t column_count);
+    /** @brief Hand the finished matrix and its solution buffer over to the caller. */
+    struct node* finish(char*** solutions_out, int* item_count_out, int* option_count_out);
+    /** @brief Borrow the matrix built so far; it stays owned by the builder until the next begin or reset. */
+    struct node* matrix(int* item_count_out, int* option_count_out) const;
+    /** @brief Release any partially built matrix. */
+    void reset();
+
+    /** @brief Total nodes in use excluding the head, matching generateHeadNode's nodeCount. */
+    int node_count() const { return static_cast<int>(last_index_); }
+
+private:
+    int reserve(size_t nodes);
+
+    struct node* matrix_;
+    size_t capacity_;
+    size_t last_index_;
+    size_t spacer_index_;
+    uint32_t column_count_;
+    size_t row_count_;
+    std::vector<uint32_t> scratch_;
+};
 
 } // namespace dlx::matrix
 
@@ -0,0 +1,126 @@
+#ifndef DLX_RESULT_CACHE_H
+#define DLX_RESULT_CACHE_H
+
+#include "core/binary.h"
+#include "core/dlx.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace dlx {
+
+/**
+ * @brief Identity of a problem for @ref ResultCache: its cover in canonical form plus its assumptions.
+ *
+ * The canonical cover lists the column count, then every row as {row id, size, columns} with each row's columns
+ * sorted and the rows sorted by id (then by columns), so covers that only differ in the order their rows or
+ * columns were written share one key. Reuse frames share their cover's words through the pointer.
+ */
+struct ResultKey
+{
+    uint64_t hash = 0;
+    std::shared_ptr<const std::vector<uint32_t>> cover;
+    std::vector<uint32_t> assumptions; /**< Sorted forced rows, their count, then sorted forbidden rows. */
+
+    bool operator==(const ResultKey& other) const;
+    size_t bytes() const { return (cover->size() + assumptions.size()) * sizeof(uint32_t); }
+};
+
+/** @brief Canonical form of @p problem's cover; see @ref ResultKey. */
+std::shared_ptr<const std::vector<uint32_t>> canonical_cover(const binary::DlxCsrProblem& problem);
+/** @brief Key of a search of @p cover (from @ref canonical_cover) under @p assumptions. */
+ResultKey make_result_key(std::shared_ptr<const std::vector<uint32_t>> cover, const SearchAssumptions& assumptions);
+
+/**
+ * @brief The solutions of one problem, recorded by the search that solved it and replayed for every identical
+ * problem after it.
+ */
+struct SolvedProblem
+{
+    enum class State : uint8_t
+    {
+        Solving,  /**< The first copy is being searched; identical problems wait for it. */
+        Complete, /**< @ref records holds every solution. */
+        Abandoned /**< The solutions did not fit the cache; waiting problems are searched after all. */
+    };
+
+    explicit SolvedProblem(ResultKey problem_key) : key(std::move(problem_key)) {}
+
+    size_t bytes() const { return key.bytes() + records.size() * sizeof(uint32_t); }
+
+    ResultKey key;
+    uint32_t column_count = 0;
+    std::vector<uint32_t> records; /**< Every solution as {row count, row ids...}, in search order. */
+    size_t reserved = 0;           /**< Words of @ref records charged against the budget while solving. */
+    std::atomic<State> state{State::Solving};
+};
+
+/**
+ * @brief LRU cache of solved problems within a memory budget, which also coalesces identical problems in flight.
+ *
+ * The first problem with a given key becomes the leader: it is searched and records its solutions into the entry.
+ * Identical problems that arrive meanwhile receive the same entry and wait for it; once it completes they, and
+ * every later identical problem, replay the recorded solutions instead of searching. Complete entries and the
+ * solutions leaders are still recording share the budget; only complete entries are evicted, least recently used
+ * first. Thread safe.
+ */
+class ResultCache
+{
+public:
+    explicit ResultCache(size_t budget_bytes);
+
+    /**
+     * @brief The entry for @p key, creating it (and making the caller its leader) when there is none.
+     * @return std::shared_ptr<SolvedProblem> The entry, or nullptr when another problem holds the key's hash;
+     *         such a problem is simply searched.
+     */
+    std::shared_ptr<SolvedProblem> acquire(ResultKey key, bool* leader);
+    /**
+     * @brief The complete entry for @p key, if there is one, without creating or waiting for any. For problems
+     * whose own search may stop early and so could not fill an entry.
+     */
+    std::shared_ptr<SolvedProblem> lookup(const ResultKey& key);
+    /**
+     * @brief Leader side: charge the budget so @p entry may record @p words solution words in all, evicting cached
+     * entries to make room.
+     * @return bool false when the budget cannot hold them next to the other recordings in flight; the leader then
+     *         stops recording and abandons the entry.
+     */
+    bool reserve(SolvedProblem& entry, size_t words);
+    /**
+     * @brief Leader side: publish the entry as complete and cache it, or, when @p complete is false, abandon it,
+     * and release its reservation. Waiting problems see the new state right away; the caller wakes them.
+     */
+    void finish(const std::shared_ptr<SolvedProblem>& entry, bool complete);
+
+    uint64_t hits() const { return hits_.load(); }
+    uint64_t coalesced() const { return coalesced_.load(); }
+    size_t cached_bytes();
+
+private:
+    bool make_room(size_t bytes);
+
+    struct Slot
+    {
+        std::shared_ptr<SolvedProblem> entry;
+        std::list<uint64_t>::iterator recent; /**< Position in recent_; valid once the entry is complete. */
+    };
+
+    size_t budget_bytes_;
+    std::mutex mutex_;
+    std::unordered_map<uint64_t, Slot> entries_;
+    std::list<uint64_t> recent_; /**< Hashes of complete entries, most recently used first. */
+    size_t bytes_ = 0;          /**< Held by complete entries. */
+    size_t reserved_bytes_ = 0; /**< Reserved by recordings in flight. */
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> coalesced_{0};
+};
+
+} // namespace dlx
+
+#endif
@@ -0,0 +1,275 @@
+#ifndef DLX_SEARCH_H
+#define DLX_SEARCH_H
+
+#include <stdint.h>
+#include <chrono>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "core/binary.h"
+#include "core/dlx.h"
+
+/**
+ * Compile-time solution policies for @ref dlx::Core::search.
+ *
+ * A policy is any type with a member `void on_solution(const uint32_t* row_ids, int level)`. It receives the row
+ * identifiers of each solution in search order (forced rows first) and is called directly from the search, so the
+ * compiler can inline it into the leaf instead of going through SolutionOutput's run-time modes and the virtual
+ * SolutionSink. The classic SolutionOutput overload of Core::search is itself one instantiation of this template.
+ *
+ * A policy that also has `bool visit()` and `bool stopped() const` can end the search early: visit is called on
+ * every node before it is expanded and returns false to stop, and once stopped() is true the search unwinds,
+ * restoring the matrix, without trying further options. Policies without them cost nothing extra.
+ */
+namespace dlx::search {
+
+template <typename Policy, typename = void>
+struct is_stoppable : std::false_type
+{};
+
+template <typename Policy>
+struct is_stoppable<Policy,
+                    std::void_t<decltype(bool(std::declval<Policy&>().visit())),
+                                decltype(bool(std::declval<const Policy&>().stopped()))>> : std::true_type
+{};
+
+/** @brief Counts solutions and discards them. */
+struct CountPolicy
+{
+    uint64_t solutions = 0;
+
+    void on_solution(const uint32_t*, int) { ++solutions; }
+};
+
+/** @brief Appends every solution's row ids to one flat vector, with one length per solution. */
+struct CollectPolicy
+{
+    std::vector<uint32_t> row_ids;
+    std::vector<uint16_t> lengths;
+
+    void on_solution(const uint32_t* ids, int level)
+    {
+        if (level > 0 && level <= UINT16_MAX)
+        {
+            row_ids.insert(row_ids.end(), ids, ids + level);
+            lengths.push_back(static_cast<uint16_t>(level));
+        }
+    }
+};
+
+/** @brief Writes every solution to an already started DLXS section; @ref status holds the first write error. */
+struct DlxsWriterPolicy
+{
+    explicit DlxsWriterPolicy(dlx::binary::DlxSolutionStreamWriter& writer) : writer(&writer) {}
+
+    dlx::binary::DlxSolutionStreamWriter* writer;
+    int status = 0;
+
+    void on_solution(const uint32_t* ids, int level)
+    {
+        if (status == 0 && level > 0)
+        {
+            status = (level <= UINT16_MAX) ? writer->write_row(ids, static_cast<uint16_t>(level)) : -1;
+        }
+    }
+};
+
+/** @brief Forwards every solution to a callable taking (const uint32_t* row_ids, int level). */
+template <typename Fn>
+struct CallbackPolicy
+{
+    Fn fn;
+
+    void on_solution(const uint32_t* ids, int level) { fn(ids, level); }
+};
+
+template <typename Fn>
+CallbackPolicy<Fn> make_callback_policy(Fn fn)
+{
+    return CallbackPolicy<Fn>{std::move(fn)};
+}
+
+/**
+ * @brief Forwards solutions to @p Inner (unless counting only) and stops the search at a solution limit, node
+ * budget or deadline, whichever comes first; zero limits and a default deadline mean none. @ref status tells which
+ * one ended the search, as a DLX_SOLVE_* code.
+ */
+template <typename Inner>
+struct BoundedPolicy
+{
+    /** Nodes between two looks at the clock. */
+    static constexpr uint64_t kClockInterval = 4096;
+
+    Inner inner;
+    uint64_t solution_limit = 0;
+    uint64_t node_budget = 0;
+    std::chrono::steady_clock::time_point deadline{};
+    bool count_only = false;
+
+    uint64_t solutions = 0;
+    uint64_t nodes = 0;
+    uint32_t status = DLX_SOLVE_COMPLETE;
+
+    bool visit()
+    {
+        if (stopped())
+        {
+            return false;
+        }
+        if (node_budget != 0 && nodes == node_budget)
+        {
+            status = DLX_SOLVE_NODE_BUDGET;
+            return false;
+        }
+        if (deadline != std::chrono::steady_clock::time_point() && nodes % kClockInterval == 0
+            && std::chrono::steady_clock::now() >= deadline)
+        {
+            status = DLX_SOLVE_DEADLINE;
+            return false;
+        }
+        ++nodes;
+        return true;
+    }
+
+    bool stopped() const { return status != DLX_SOLVE_COMPLETE; }
+
+    void on_solution(const uint32_t* ids, int level)
+    {
+        ++solutions;
+        if (!count_only)
+        {
+            inner.on_solution(ids, level);
+        }
+        if (solution_limit != 0 && solutions >= solution_limit)
+        {
+            status = DLX_SOLVE_LIMIT_REACHED;
+        }
+    }
+};
+
+} // namespace dlx::search
+
+namespace dlx {
+
+/**
+ * Templated form of the DLX search: identical traversal, with every solution handed to @p policy.
+ *
+ * @param struct node* A node pointer to the head of the matrix.
+ * @param int An integer representing the current level of the recursive search.
+ * @param uint32_t* Buffer receiving the row identifiers of the partial solution, one slot per level.
+ * @param Policy& Receives each solution through on_solution.
+ * @return void
+ */
+template <typename Policy>
+void Core::search(struct node* head, int level, uint32_t* row_ids, Policy& policy)
+{
+    if constexpr (search::is_stoppable<Policy>::value)
+    {
+        if (!policy.visit())
+        {
+            return;
+        }
+    }
+
+    // If all items have been covered, output a found solution.
+    if (head->right == head)
+    {
+        policy.on_solution(row_ids, level);
+        return;
+    }
+
+    // Pick an item i (column constraint), and cover the item.
+    struct node* constraint = pickConstraint(head);
+    cover(constraint);
+
+    // Try each option xl (row) of the item in turn
+    for (struct node* option = constraint->down; option != constraint; option = option->down)
+    {
+        // Traverse through the row until the option's spacer node is found; it holds the negated row id
+        struct node* optionNumber = option;
+        while (optionNumber->data > 0)
+        {
+            optionNumber += 1;
+        }
+        row_ids[level] = static_cast<uint32_t>(-optionNumber->data);
+
+        // Cover each option parts' column until the options' space node is reached
+        struct node* optionPart = option + 1;
+        while (optionPart != option)
+        {
+            struct node* optionColumn = optionPart->top;
+
+            if (optionColumn == head) // spacer has been reached
+            {
+                optionPart = optionPart->up;
+            }
+            else
+            {
+                cover(optionColumn);
+                optionPart += 1;
+            }
+        }
+
+        // Recursively search for potential solutions...
+        search(head, level + 1, row_ids, policy);
+
+        // Uncover each option parts' column in reverse, wrapping from the previous options' space node to the
+        // last part of this option, until the chosen node is reached again
+        optionPart = option - 1;
+        while (optionPart != option)
+        {
+            struct node* optionColumn = optionPart->top;
+
+            if (optionColumn == head) // Previous options' spacer has been reached.
+            {
+                optionPart = optionPart->down;
+            }
+            else
+            {
+                uncover(optionColumn);
+                optionPart -= 1;
+            }
+        }
+
+        if constexpr (search::is_stoppable<Policy>::value)
+        {
+            if (policy.stopped())
+            {
+                break;
+            }
+        }
+    }
+
+    uncover(constraint);
+}
+
+/**
+ * Templated form of @ref Core::searchWithAssumptions; see the SolutionOutput overload for the semantics.
+ *
+ * @return int 0 on success, -1 when an assumption references an unknown row.
+ */
+template <typename Policy>
+int Core::searchWithAssumptions(struct node* head,
+                                const RowIndex& index,
+                                const SearchAssumptions& assumptions,
+                                uint32_t* row_ids,
+                                Policy& policy)
+{
+    AssumptionState state;
+    if (applyAssumptions(index, assumptions, row_ids, state) != 0)
+    {
+        return -1;
+    }
+
+    if (!state.conflict)
+    {
+        search(head, state.level, row_ids, policy);
+    }
+
+    restoreAssumptions(state);
+    return 0;
+}
+
+} // namespace dlx
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef DLX_SEARCH_ESTIMATE_H
+#define DLX_SEARCH_ESTIMATE_H
+
+#include "core/binary.h"
+#include <stdint.h>
+
+namespace dlx {
+
+/**
+ * @brief Rough cost of solving @p problem, in node updates, for ordering work before it is linked.
+ *
+ * Adds the problem's entries (the cost of linking it) to Knuth's random-probe estimate of the search tree: each
+ * probe walks one root-to-leaf path the way the search would, branching on the column with the fewest rows and
+ * following a random row of it, and sums the running product of the branching factors. The estimate is unbiased
+ * but noisy; @p probes walks are averaged. It runs on the CSR rows without linking them. Each probe is cut off
+ * after O(entries + columns) steps and extrapolates the rest of its path, so the whole estimate costs
+ * O(probes * (entries + columns)) however deep the search would go. It ignores assumptions, so reuse frames share
+ * their cover's estimate.
+ * Seeded from the problem's shape, so the same cover always gets the same estimate.
+ */
+uint64_t estimate_search_cost(const binary::DlxCsrProblem& problem, unsigned int probes = 4);
+
+} // namespace dlx
+
+#endif
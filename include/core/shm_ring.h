@@ -0,0 +1,171 @@
+#ifndef DLX_SHM_RING_H
+#define DLX_SHM_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/uio.h>
+#include <atomic>
+#include <chrono>
+
+/**
+ * Shared-memory transport between the TCP server and clients on the same host.
+ *
+ * A client creates one anonymous segment (a sealed memfd) and passes its descriptor over the server's Unix domain
+ * socket. The segment starts with a @ref ShmSegmentHeader, followed by a byte ring that carries the DLXS sections
+ * answering the client's problems and by a problem area the client encodes its DLXB frames into. The socket stays
+ * open beside it: it carries the small @ref LocalRequest frames that attach the segment and submit problems, and
+ * its hang-up tells either side that the other is gone. Solutions never pass through the socket, and the server
+ * decodes problems straight from the mapping.
+ */
+namespace dlx::shm {
+
+/** @brief Magic constant of a shared segment's header (ASCII 'DLXR'). */
+#define DLX_SHM_MAGIC 0x444C5852u
+
+/** @brief Magic constant that prefixes requests on the server's Unix domain socket (ASCII 'DLXL'). */
+#define DLX_LOCAL_MAGIC 0x444C584Cu
+
+#define DLX_SHM_VERSION 1
+
+/** @brief LocalRequest::op: map the segment whose descriptor travels with the request (SCM_RIGHTS). */
+constexpr uint32_t kLocalAttach = 1;
+/** @brief LocalRequest::op: decode the DLXB frame at [offset, offset + length) of the problem area. */
+constexpr uint32_t kLocalSubmit = 2;
+
+/**
+ * @brief Request a local client writes to the server's Unix domain socket, as four big-endian u32 words.
+ *
+ * Requests may sit between ordinary DLXB frames on the same connection; frames written to the socket itself are
+ * handled exactly as on the problem port.
+ */
+struct LocalRequest
+{
+    uint32_t magic;  /**< Magic constant (DLX_LOCAL_MAGIC). */
+    uint32_t op;     /**< kLocalAttach or kLocalSubmit. */
+    uint32_t offset; /**< kLocalSubmit: start of the frame in the problem area. */
+    uint32_t length; /**< kLocalSubmit: bytes in the frame. */
+};
+
+/**
+ * @brief Start of a shared segment. The client fills in the layout once; afterwards each side only writes its own
+ * counters. Every counter lives on its own cache line, so the two processes do not share lines they both write.
+ */
+struct ShmSegmentHeader
+{
+    uint32_t magic;          /**< DLX_SHM_MAGIC. */
+    uint32_t version;        /**< DLX_SHM_VERSION. */
+    uint64_t ring_offset;    /**< Start of the solution ring, from the start of the segment. */
+    uint64_t ring_bytes;     /**< Ring capacity; a power of two. */
+    uint64_t problem_offset; /**< Start of the problem area. */
+    uint64_t problem_bytes;  /**< Size of the problem area. */
+
+    alignas(64) std::atomic<uint64_t> head;      /**< Bytes the server has written to the ring. */
+    std::atomic<uint32_t> data_seq;              /**< Futex word the client sleeps on while the ring is empty. */
+    std::atomic<uint32_t> reader_waiting;
+    std::atomic<uint32_t> writer_closed;         /**< The server will write nothing more. */
+
+    alignas(64) std::atomic<uint64_t> tail;      /**< Bytes the client has consumed from the ring. */
+    std::atomic<uint32_t> space_seq;             /**< Futex word the server sleeps on while the ring is full. */
+    std::atomic<uint32_t> writer_waiting;
+    std::atomic<uint32_t> reader_closed;         /**< The client reads nothing more. */
+
+    alignas(64) std::atomic<uint32_t> decoded;   /**< Submitted problems the server has decoded; a futex word. */
+};
+
+/**
+ * @brief Owner of one mapped segment: creates it on the client side or maps a received one on the server side.
+ */
+class ShmSegment
+{
+public:
+    ShmSegment();
+    ~ShmSegment();
+
+    ShmSegment(const ShmSegment&) = delete;
+    ShmSegment& operator=(const ShmSegment&) = delete;
+
+    /**
+     * @brief Create a sealed segment with a ring of at least @p ring_bytes (rounded up to a power of two) and a
+     * problem area of @p problem_bytes.
+     * @return int 0 on success, -1 otherwise.
+     */
+    int create(size_t ring_bytes, size_t problem_bytes);
+    /**
+     * @brief Map the segment behind @p fd, which the segment takes over. The file has to be sealed against
+     * shrinking and its header has to describe a layout that fits inside it.
+     * @return int 0 on success, -1 when the descriptor is not a usable segment.
+     */
+    int attach(int fd);
+
+    int fd() const { return fd_; }
+    ShmSegmentHeader* header() const { return static_cast<ShmSegmentHeader*>(map_); }
+    char* ring_data() const { return static_cast<char*>(map_) + ring_offset_; }
+    size_t ring_bytes() const { return ring_bytes_; }
+    char* problem_area() const { return static_cast<char*>(map_) + problem_offset_; }
+    size_t problem_bytes() const { return problem_bytes_; }
+
+private:
+    void release();
+
+    int fd_;
+    void* map_;
+    size_t map_bytes_;
+    size_t ring_offset_; /**< Layout as validated by create or attach; the header is never trusted again. */
+    size_t ring_bytes_;
+    size_t problem_offset_;
+    size_t problem_bytes_;
+};
+
+/**
+ * @brief One side of the single-producer/single-consumer byte ring of a @ref ShmSegment.
+ *
+ * The writer (the server) copies gather lists in and publishes them with one store; the reader (the client) reads
+ * them in place. Each side keeps its own position and only reads the other's counter, so a misbehaving peer can at
+ * worst make the ring look corrupt, never move this side's position. A side only enters the kernel to sleep, or to
+ * wake the other side when it went to sleep: a busy stream costs no system calls.
+ */
+class ShmRing
+{
+public:
+    explicit ShmRing(const ShmSegment& segment);
+
+    /**
+     * @brief Writer: copy as much of @p iov as fits without waiting.
+     * @return ssize_t Bytes copied (0 when the ring is full), or -1 when the reader's counter is corrupt.
+     */
+    ssize_t write(const struct iovec* iov, size_t count);
+    /** @brief Writer: wait up to @p timeout for free space; returns false on timeout. */
+    bool wait_writable(std::chrono::milliseconds timeout);
+    /** @brief Writer: tell the reader nothing more follows. */
+    void close_writer();
+
+    /**
+     * @brief Reader: the readable bytes that are contiguous in the ring, without waiting.
+     * @return size_t Number of bytes at @p data (0 when the ring is empty or the writer's counter is corrupt).
+     */
+    size_t peek(const char** data);
+    /** @brief Reader: hand @p bytes from the front of the ring back to the writer. */
+    void consume(size_t bytes);
+    /** @brief Reader: wait up to @p timeout for data; returns false on timeout. */
+    bool wait_readable(std::chrono::milliseconds timeout);
+    /** @brief Reader: tell the writer nothing more will be read. */
+    void close_reader();
+
+    bool writer_closed() const { return header_->writer_closed.load(std::memory_order_acquire) != 0; }
+    bool reader_closed() const { return header_->reader_closed.load(std::memory_order_acquire) != 0; }
+
+private:
+    ShmSegmentHeader* header_;
+    char* data_;
+    size_t mask_;
+    uint64_t position_; /**< This side's counter: head for the writer, tail for the reader. */
+};
+
+/** @brief Wait up to @p timeout while @p word still holds @p expected; shared across processes. */
+void futex_wait(std::atomic<uint32_t>* word, uint32_t expected, std::chrono::milliseconds timeout);
+/** @brief Wake every process waiting on @p word. */
+void futex_wake(std::atomic<uint32_t>* word);
+
+} // namespace dlx::shm
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef DLX_SNAPSHOT_H
+#define DLX_SNAPSHOT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <ostream>
+
+struct node;
+
+namespace dlx::snapshot {
+
+/** @brief Magic constant that prefixes prebuilt matrix snapshots (ASCII 'DLXM'), stored in host byte order. */
+#define DLX_SNAPSHOT_MAGIC 0x444C584Du /* 'DLXM' */
+
+/** @brief Version of the matrix snapshot layout understood by this library. */
+#define DLX_SNAPSHOT_VERSION 1
+
+/** @brief File offset of the node array; a multiple of every supported page size so it can be mapped directly. */
+#define DLX_SNAPSHOT_NODE_OFFSET 65536u
+
+/**
+ * @brief Preamble of a DLXM snapshot.
+ *
+ * The node array that follows is a verbatim image of a freshly linked matrix. Every link is encoded as
+ * @c base_address plus the target's byte offset from the head (null links stay zero), so the image is
+ * position independent: mapping it at @c base_address needs no fixup, and any other address needs only
+ * a single sequential rebase. The rebase, or a load asked to verify, rejects images with a link that does
+ * not name one of their nodes; an image mapped at its base unverified is trusted as its writer left it.
+ */
+struct DlxSnapshotHeader
+{
+    uint32_t magic;          /**< Magic constant (DLX_SNAPSHOT_MAGIC) in host byte order. */
+    uint16_t version;        /**< Snapshot layout version, see DLX_SNAPSHOT_VERSION. */
+    uint16_t node_size;      /**< sizeof(struct node) on the writing host. */
+    uint32_t column_count;   /**< Number of item columns. */
+    uint32_t option_count;   /**< Number of option rows. */
+    uint64_t node_count;     /**< Highest node index in use; the array holds node_count + 1 nodes. */
+    uint64_t base_address;   /**< Address the encoded links are relative to. */
+    uint64_t node_offset;    /**< File offset of the node array (DLX_SNAPSHOT_NODE_OFFSET). */
+};
+
+/**
+ * @brief Read-only mapping of a DLXM snapshot that can be searched in place.
+ *
+ * The file is mapped copy-on-write, so cover/uncover only dirties the pages a search touches and the
+ * snapshot on disk is never modified. The mapping and the per-level solution buffer are released on
+ * destruction or @ref reset; they must not be passed to Core::freeMemory.
+ */
+class MatrixSnapshot
+{
+public:
+    MatrixSnapshot();
+    ~MatrixSnapshot();
+
+    MatrixSnapshot(const MatrixSnapshot&) = delete;
+    MatrixSnapshot& operator=(const MatrixSnapshot&) = delete;
+
+    int load(const char* path, bool verify = false);
+    void reset();
+
+    struct node* matrix() const { return matrix_; }
+    char** solutions() const { return solutions_; }
+    int item_count() const { return item_count_; }
+    int option_count() const { return option_count_; }
+    size_t node_count() const { return node_count_; }
+    /** @brief True when the mapping landed away from the recorded base and links were rebased. */
+    bool relocated() const { return relocated_; }
+
+private:
+    void* mapping_;
+    size_t mapping_size_;
+    struct node* matrix_;
+    char** solutions_;
+    int item_count_;
+    int option_count_;
+    size_t node_count_;
+    bool relocated_;
+};
+
+int write_snapshot(std::ostream& output, const struct node* matrix, int item_count, int option_count);
+bool is_snapshot_file(const char* path);
+
+} // namespace dlx::snapshot
+
+#endif
@@ -1,7 +1,11 @@
 #ifndef DLX_SOLUTION_SINK_H
 #define DLX_SOLUTION_SINK_H
 
+#include <stddef.h>
+#include <stdint.h>
+#include <chrono>
 #include <ostream>
+#include <string>
 #include <vector>
 
 namespace dlx::sink {
@@ -31,6 +35,51 @@ private:
     std::ostream& stream_;
 };
 
+struct TextSinkConfig
+{
+    std::string value_separator = " ";                 /**< Written between the row ids of one solution. */
+    std::string solution_separator = "\n";             /**< Written after every solution. */
+    size_t flush_bytes = 1u << 20;                     /**< Buffered bytes that force a write. */
+    std::chrono::milliseconds flush_interval{100};     /**< Oldest unwritten output @ref flush lets stand; 0 writes on every flush. */
+};
+
+/**
+ * @brief Text sink that formats solutions into a private buffer and hands it to a file descriptor with write(2).
+ *
+ * Row ids are formatted with std::to_chars (or copied when they arrive as strings) and written in large chunks.
+ * Because Core::search calls @ref flush after every solution, @ref flush only writes once @ref
+ * TextSinkConfig::flush_bytes are buffered or the oldest buffered solution is @ref TextSinkConfig::flush_interval
+ * old; @ref sync and the destructor write everything. The sink also works as a dlx::search policy.
+ */
+class FdTextSolutionSink final : public SolutionSink
+{
+public:
+    explicit FdTextSolutionSink(int fd, const TextSinkConfig& config = TextSinkConfig());
+    ~FdTextSolutionSink() override;
+
+    FdTextSolutionSink(const FdTextSolutionSink&) = delete;
+    FdTextSolutionSink& operator=(const FdTextSolutionSink&) = delete;
+
+    void on_solution(const SolutionView& view) override;
+    /** @brief Format row ids directly; lets the sink serve as a compile-time search policy. */
+    void on_solution(const uint32_t* row_ids, int count);
+    void flush() override;
+    /** @brief Write everything buffered; returns -1 once any write has failed. */
+    int sync();
+    bool failed() const { return failed_; }
+
+private:
+    char* reserve(size_t bytes);
+    void finish_solution();
+
+    int fd_;
+    TextSinkConfig config_;
+    std::vector<char> buffer_;
+    size_t used_;
+    std::chrono::steady_clock::time_point oldest_;
+    bool failed_;
+};
+
 class CompositeSolutionSink final : public SolutionSink
 {
 public:
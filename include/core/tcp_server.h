@@ -2,22 +2,170 @@
 #define DLX_TCP_SERVER_H
 
 #include "core/binary.h"
+#include <stddef.h>
 #include <stdint.h>
+#include <sys/types.h>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <deque>
 #include <memory>
 #include <mutex>
 #include <optional>
+#include <string>
 #include <thread>
 #include <vector>
 
+struct io_uring_cqe;
+
+namespace dlx::shm {
+class ShmSegment;
+}
+
 namespace dlx {
 
+class ResultCache;
+struct SolvedProblem;
+
+/** @brief Magic constant that prefixes subscription frames sent on the solution port (ASCII 'DLXU'). */
+#define DLX_SUBSCRIBE_MAGIC 0x444C5855u
+
+/** @brief Distinct subscriptions one solution client may hold; a client that sends more is dropped. */
+#define DLX_SUBSCRIPTION_LIMIT 64
+
+/**
+ * @brief Subscription a solution client sends to the server, as three big-endian u32 words.
+ *
+ * Once the server has read one, the client only receives the sections of problems tagged with
+ * DLX_COVER_FLAG_PROBLEM_ID whose id matches @ref problem_id in the bits set in @ref mask (mask 0 matches every
+ * tagged problem, UINT32_MAX one id). Further subscriptions add to the set, up to DLX_SUBSCRIPTION_LIMIT distinct
+ * ones; repeating a subscription the client already holds changes nothing. Clients that never subscribe keep
+ * receiving every problem that is not answered inline. A subscription applies from the next problem whose stream
+ * the server begins after reading it.
+ */
+struct DlxSubscription
+{
+    uint32_t magic;      /**< Magic constant (DLX_SUBSCRIBE_MAGIC). */
+    uint32_t problem_id; /**< Id, or id prefix, of the problems to receive. */
+    uint32_t mask;       /**< Bits of the problem id that have to match. */
+};
+
+/** @brief Magic constant that prefixes flush policy frames sent on the solution port (ASCII 'DLXF'). */
+#define DLX_FLUSH_MAGIC 0x444C5846u
+
+/** @brief Bit of @ref DlxFlushRequest::max_micros that asks for corked sends. */
+#define DLX_FLUSH_CORK 0x80000000u
+
+/**
+ * @brief When the server hands a solution client's encoded rows to its socket.
+ *
+ * Rows are batched, then sent with one gather write once @ref max_bytes are buffered or the oldest of them has
+ * waited @ref max_micros, and always when the problem's section ends. Solution sockets run with TCP_NODELAY, so
+ * a send is never held back by Nagle's algorithm; @ref cork instead holds back partial segments explicitly.
+ */
+struct DlxFlushPolicy
+{
+    uint32_t max_bytes;  /**< Send once this many bytes are buffered; 0 sends every batch of rows as it arrives. */
+    uint32_t max_micros; /**< Send once the oldest buffered row is this old; 0 leaves it to max_bytes. */
+    bool cork;           /**< Send batches before the end of a section with MSG_MORE, so only full segments leave. */
+};
+
+/** @brief Lowest latency: every batch of rows is sent at once, and the solvers hand over every solution. */
+constexpr DlxFlushPolicy kDlxLatencyFlush = {0, 100, false};
+/** @brief Default: quarter-megabyte batches, none held for more than 2 ms. */
+constexpr DlxFlushPolicy kDlxDefaultFlush = {256u << 10, 2000, false};
+/** @brief Highest throughput: megabyte batches, corked until the section ends. */
+constexpr DlxFlushPolicy kDlxBulkFlush = {1u << 20, 0, true};
+
+/**
+ * @brief Flush policy a solution client sends to the server, as three big-endian u32 words.
+ *
+ * Replaces the server's @ref TcpServerConfig::flush for this client only, from the next batch on. How soon the
+ * solvers hand solutions to the output thread stays a server-wide setting.
+ */
+struct DlxFlushRequest
+{
+    uint32_t magic;      /**< Magic constant (DLX_FLUSH_MAGIC). */
+    uint32_t max_bytes;  /**< @ref DlxFlushPolicy::max_bytes. */
+    uint32_t max_micros; /**< @ref DlxFlushPolicy::max_micros, with DLX_FLUSH_CORK set for corked sends. */
+};
+
+/**
+ * @brief What the server does with a solution client that reads slower than the solvers produce.
+ *
+ * Drop and Spill isolate clients from each other: every client has its own outbound queue, written without
+ * blocking, so a stalled reader only ever costs its own queue. Block trades that isolation for never losing a
+ * client: one stalled reader holds up every other client and, once the solver rings fill, the searches.
+ */
+enum class SlowClientPolicy
+{
+    Block, /**< Wait for the client; once the solver rings fill up, the searches pause. */
+    Drop,  /**< Queue up to client_buffer_bytes for it, then disconnect it. */
+    Spill  /**< Queue up to client_buffer_bytes in memory, then up to client_spill_bytes in a temporary file. */
+};
+
+/**
+ * @brief Which queued problem an idle solver takes next.
+ *
+ * Every policy only picks among the oldest queued frame of each connection, so the frames of one connection are
+ * still solved in order, and always prefers a higher DLX_COVER_PRIORITY_MASK priority. A problem queued longer
+ * than TcpServerConfig::schedule_max_wait_ms goes ahead of all of them.
+ */
+enum class ProblemSchedule
+{
+    Fifo,          /**< In arrival order. */
+    ShortestFirst, /**< Lowest estimated cost first (see core/search_estimate.h), so small jobs pass large ones. */
+    FairShare      /**< The connection that has been given the least estimated work so far first. */
+};
+
 struct TcpServerConfig
 {
     uint16_t request_port;
     uint16_t solution_port;
+    unsigned int workers = 0;    /**< Solver threads; 0 uses every hardware thread. */
+    unsigned int io_threads = 2; /**< Reactor threads serving both ports; at least one is started. */
+    bool io_uring = true;        /**< Run the reactors on io_uring when it is built in and the kernel allows it. */
+    SlowClientPolicy slow_clients = SlowClientPolicy::Drop;
+    size_t client_buffer_bytes = 4u << 20; /**< Unsent bytes one client may hold in memory (Drop and Spill). */
+    uint64_t client_spill_bytes = 1u << 30; /**< Unsent bytes one client may spill to disk before it is dropped. */
+    unsigned int client_lag_ms = 30000;     /**< Drop and Spill: a client that takes no queued byte for this long is
+                                                 dropped, however little it owes; 0 waits as long as the queue has room. */
+    int socket_send_buffer = 0;              /**< SO_SNDBUF of solution sockets; 0 keeps the kernel's autotuning. */
+    DlxFlushPolicy flush = kDlxDefaultFlush; /**< Batching of every client that does not send a DlxFlushRequest. With
+                                                  max_bytes 0 the solvers also publish every solution at once. */
+    std::string local_socket_path;           /**< Unix domain socket for clients on this host (see core/shm_ring.h);
+                                                  empty serves TCP only. */
+    size_t result_cache_bytes = 64u << 20;   /**< Memory for the solutions of solved problems, replayed to identical
+                                                  problems (see core/result_cache.h); 0 disables the cache and the
+                                                  coalescing of identical problems in flight. */
+    ProblemSchedule schedule = ProblemSchedule::ShortestFirst;
+    unsigned int schedule_max_wait_ms = 1000; /**< A problem queued this long runs next, whatever its priority or
+                                                   estimate, so none starves; 0 lets the schedule alone decide. */
+};
+
+/** @brief How long the problems of one priority waited in the queue for a solver. */
+struct TcpServerWaitStats
+{
+    uint64_t problems;    /**< Problems of this priority taken by a solver so far. */
+    uint64_t mean_micros; /**< Mean wait. */
+    uint64_t p99_micros;  /**< 99th percentile wait, within an eighth of its value. */
+    uint64_t max_micros;  /**< Longest wait. */
+};
+
+/** @brief Queue depths of a running server, sampled by @ref DlxTcpServer::stats. */
+struct TcpServerStats
+{
+    size_t queued_problems;   /**< Decoded frames waiting for a solver. */
+    size_t queued_slabs;      /**< Solution slabs published by the solvers and not yet sent, over every ring. */
+    size_t slab_capacity;     /**< Slabs all rings hold together; a solver pauses while its own ring is full. */
+    size_t subscribers;       /**< Connected solution clients. */
+    uint64_t backlog_bytes;   /**< Unsent solution bytes held in memory for slow clients. */
+    uint64_t spilled_bytes;   /**< Unsent solution bytes spilled to temporary files. */
+    uint64_t dropped_clients; /**< Clients disconnected for falling too far behind. */
+    uint64_t cache_hits;      /**< Problems answered from the result cache without a search. */
+    uint64_t coalesced;       /**< Problems that waited for an identical problem already being solved. */
+    size_t cached_bytes;      /**< Memory held by the result cache. */
+    TcpServerWaitStats waits[DLX_COVER_PRIORITY_LEVELS]; /**< Queue waits per cover priority. */
 };
 
 class DlxTcpServer
@@ -32,62 +180,139 @@ public:
 
     uint16_t request_port() const { return request_port_; }
     uint16_t solution_port() const { return solution_port_; }
+    /** @brief Path of the Unix domain socket, or an empty string when the server only listens on TCP. */
+    const std::string& local_socket_path() const { return config_.local_socket_path; }
+    /** @brief Number of solver threads started by @ref start. */
+    size_t worker_count() const { return worker_threads_.size(); }
+    /** @brief True when @ref start selected the io_uring backend; false means epoll. */
+    bool uses_io_uring() const { return using_io_uring_; }
+    /** @brief Current queue depths; safe to call from any thread while the server runs. */
+    TcpServerStats stats();
 
 private:
     struct SolutionClient;
-    struct ProblemTask
+    struct SolutionRing;
+    struct OutputSignal;
+    struct Reactor;
+    struct ProblemStream;
+    struct SubscriberSends;
+    struct QueueWaits;
+    /**
+     * While frames of one problem connection are in flight they are all solved by the same worker, so their streams
+     * stay in order; once every answer is out the next frame may go to any worker.
+     */
+    struct ProblemConnection
     {
-        dlx::binary::DlxCoverHeader header;
-        std::vector<dlx::binary::DlxRowChunk> rows;
+        int worker = -1;      /**< Worker running the frames in flight, or -1; guarded by problem_queue_mutex_. */
+        size_t in_flight = 0; /**< Frames taken by a worker whose sections are not fully streamed yet. */
+        std::shared_ptr<SolutionClient> reply; /**< Writer for DLX_COVER_FLAG_REPLY_INLINE frames, made on the first. */
+        uint64_t served = 0; /**< FairShare: estimated work taken so far, on the server's fair clock; guarded by
+                                  problem_queue_mutex_ like the fields below. */
+        size_t queued = 0;   /**< Frames in the queue. */
+        uint64_t scan = 0;   /**< Last queue scan that met the connection's oldest frame. */
     };
-    struct SolutionEvent
+    /** Where the solutions of one problem go. */
+    struct SolutionRoute
     {
-        enum class Type
-        {
-            Begin,
-            Row,
-            End
-        };
-
-        Type type;
-        uint32_t column_count;
-        std::vector<uint32_t> row_ids;
+        uint32_t problem_id = 0;
+        bool tagged = false;                   /**< The frame carried a problem id, echoed in the DLXS header. */
+        bool report_status = false;            /**< The frame carried solve options; the section ends with a status. */
+        std::shared_ptr<SolutionClient> reply; /**< Request connection to answer on; nullptr publishes to subscribers. */
+        std::shared_ptr<ProblemConnection> connection; /**< Released from its worker once the section is out. */
+    };
+    struct ProblemTask
+    {
+        std::shared_ptr<const dlx::binary::DlxCsrProblem> cover;
+        dlx::SearchAssumptions assumptions;
+        dlx::binary::DlxSolveOptions options = {};
+        std::shared_ptr<ProblemConnection> connection;
+        SolutionRoute route;
+        std::shared_ptr<SolvedProblem> result; /**< Cache entry of the problem; nullptr when not cached. */
+        bool leader = false;                   /**< This task solves @ref result; otherwise it replays it. */
+        uint64_t cost = 0;                     /**< Estimated work, for the schedule. */
+        unsigned int priority = 0;
+        std::chrono::steady_clock::time_point queued_at;
     };
-
     static int create_listening_socket(uint16_t requested_port, uint16_t* bound_port);
-    static void emit_solution_row(void* ctx, const uint32_t* row_ids, int level);
+    static int create_local_socket(const std::string& path);
 
-    void accept_request_loop();
-    void accept_solution_loop();
-    void process_problem_queue();
+    void run_reactor(size_t index);
+    void run_epoll_reactor(Reactor& reactor);
+    void accept_problem_connections(Reactor& reactor, int listen_fd);
+    void accept_solution_clients(Reactor& reactor, int listen_fd);
+    void accept_local_connections(Reactor& reactor, int listen_fd);
+    uint32_t add_solution_client_locked(int client_fd);
+    void read_problem_stream(Reactor& reactor, int fd);
+    static void reserve_receive_space(ProblemStream& stream);
+    static ssize_t receive_problem_bytes(ProblemStream& stream);
+    bool consume_problem_bytes(ProblemStream& stream, ssize_t received);
+    int handle_local_request(ProblemStream& stream, const char* data);
+    void watch_solution_client(Reactor& reactor, uint32_t serial);
+    int check_solution_client_locked(uint32_t serial);
+    void drop_solution_client_locked(uint32_t serial);
+#if defined(DLX_HAVE_IO_URING)
+    void run_uring_reactor(Reactor& reactor);
+    void handle_uring_completion(Reactor& reactor, const ::io_uring_cqe& cqe);
+    void arm_uring_wake(Reactor& reactor);
+    void arm_uring_accept(Reactor& reactor, int listen_fd);
+    void arm_uring_receive(Reactor& reactor, ProblemStream& stream);
+    void arm_uring_poll(Reactor& reactor, int fd, uint32_t serial);
+    void arm_uring_local_poll(Reactor& reactor, int fd);
+#endif
+    int submit_problem_frame(ProblemStream& stream, const char* data, size_t bytes);
+    void process_problem_queue(size_t worker);
+    std::deque<ProblemTask>::iterator pick_problem_locked(size_t worker);
+    bool runs_before(const ProblemTask& task, const ProblemTask& other, std::chrono::steady_clock::time_point now) const;
+    void finish_cached_result(ProblemTask& task, uint32_t column_count, bool complete);
     void process_solution_queue();
-    void process_problem_connection(int client_fd);
-    void enqueue_solution_row(const uint32_t* row_ids, int level);
-    void begin_solution_stream(uint32_t column_count);
-    void finish_solution_stream();
-    void broadcast_solution_row(const uint32_t* row_ids, int level);
-    void broadcast_problem_complete();
+    void drain_solution_slab(SolutionRing& ring, const uint32_t* words, size_t used);
+    void begin_solution_stream(SolutionRing& ring, uint32_t column_count, SolutionRoute route);
+    void finish_solution_stream(SolutionRing& ring);
+    void broadcast_solution_rows(SolutionRing& ring, const uint32_t* records, size_t words);
+    void broadcast_problem_complete(SolutionRing& ring, const dlx::binary::DlxSolveStatus& status);
     void remove_disconnected_clients_locked();
+    bool start_solution_section_locked(SolutionClient& client, const SolutionRoute& route, uint32_t column_count);
+    std::shared_ptr<SolutionClient> make_solution_client(int client_fd,
+                                                         uint32_t serial,
+                                                         bool subscriber,
+                                                         std::shared_ptr<shm::ShmSegment> segment = nullptr);
+    bool apply_flush_policy_locked(SolutionClient& client, std::chrono::steady_clock::time_point now);
+    bool flush_solution_client_locked(SolutionClient& client, bool more);
+    void flush_due_clients();
+    void release_failed_client_locked(std::shared_ptr<SolutionClient>& client);
+    void drain_client_backlogs();
 
     TcpServerConfig config_;
     uint16_t request_port_;
     uint16_t solution_port_;
     int request_listen_fd_;
     int solution_listen_fd_;
-    std::thread request_thread_;
-    std::thread solution_thread_;
-    std::mutex problem_mutex_;
+    int local_listen_fd_;
+    std::vector<std::unique_ptr<Reactor>> reactors_;
+    std::vector<std::thread> io_threads_;
     std::mutex solution_mutex_;
     std::vector<std::shared_ptr<SolutionClient>> solution_clients_;
+    uint32_t next_client_serial_ = 0;
+    std::unique_ptr<SubscriberSends> subscriber_sends_;
+    bool using_io_uring_ = false;
     std::mutex problem_queue_mutex_;
     std::condition_variable problem_queue_cv_;
     std::deque<ProblemTask> problem_queue_;
-    std::mutex solution_queue_mutex_;
-    std::condition_variable solution_queue_cv_;
-    std::deque<SolutionEvent> solution_queue_;
-    std::thread worker_thread_;
+    std::unique_ptr<ResultCache> result_cache_;
+    std::unique_ptr<QueueWaits> queue_waits_; /**< Guarded by problem_queue_mutex_, like the two below. */
+    uint64_t fair_clock_ = 0;                 /**< FairShare: the served work of the connection taken last. */
+    uint64_t queue_scan_ = 0;
+    std::unique_ptr<OutputSignal> output_signal_;
+    std::vector<std::unique_ptr<SolutionRing>> solution_rings_;
+    std::vector<std::thread> worker_threads_;
     std::thread output_thread_;
-    std::optional<uint32_t> active_column_count_;
+    std::chrono::microseconds output_poll_; /**< Idle wait of the output thread, at most the flush deadline. */
+    const SolutionRing* broadcasting_ = nullptr; /**< Ring whose broadcast section is open; guarded by solution_mutex_. */
+    std::vector<std::shared_ptr<SolutionClient>> lagging_replies_; /**< Inline answers still draining. */
+    std::atomic<size_t> subscriber_count_{0};
+    std::atomic<uint64_t> backlog_bytes_{0};
+    std::atomic<uint64_t> spilled_bytes_{0};
+    std::atomic<uint64_t> dropped_clients_{0};
     std::atomic<bool> shutting_down_;
 };
 
@@ -9,7 +9,9 @@
 #include <memory>
 #include <ostream>
 
+#include "core/async_output.h"
 #include "core/dlx.h"
+#include "core/snapshot.h"
 
 namespace dlx::util {
 
@@ -25,6 +27,7 @@ struct MatrixContext
     char** solutions = nullptr;
     int item_count = 0;
     int option_count = 0;
+    std::unique_ptr<dlx::snapshot::MatrixSnapshot> snapshot;
 
     MatrixContext() = default;
     ~MatrixContext()
@@ -37,7 +40,12 @@ struct MatrixContext
 
     void reset()
     {
-        if (matrix != nullptr || solutions != nullptr)
+        // Snapshot-backed matrices are unmapped by their owner rather than freed
+        if (snapshot)
+        {
+            snapshot.reset();
+        }
+        else if (matrix != nullptr || solutions != nullptr)
         {
             dlx::Core::freeMemory(matrix, solutions);
         }
@@ -81,8 +89,9 @@ struct OutputContext
     bool write_to_stdout = false;
     bool stdout_suppressed = false;
     bool binary_output_enabled = false;
-    std::unique_ptr<dlx::sink::OstreamSolutionSink> console_sink;
+    std::unique_ptr<dlx::sink::SolutionSink> console_sink;
     dlx::sink::CompositeSolutionSink sink_router;
+    std::unique_ptr<dlx::sink::AsyncSolutionWriter> async_writer;
 
     OutputContext() = default;
     ~OutputContext()
@@ -97,7 +106,18 @@ struct OutputContext
     {
         if (binary_output_enabled)
         {
-            dlx::Core::dlx_disable_binary_solution_output(output);
+            if (async_writer)
+            {
+                // Drains the queued solutions and closes the last DLXS section
+                if (async_writer->stop() != 0)
+                {
+                    fprintf(stderr, "Failed to write binary solution output\n");
+                }
+            }
+            else
+            {
+                dlx::Core::dlx_disable_binary_solution_output(output);
+            }
             binary_output_enabled = false;
         }
     }
@@ -105,6 +125,7 @@ struct OutputContext
     void reset()
     {
         disable_binary_output();
+        async_writer.reset();
         if (stdout_suppressed)
         {
             dlx::Core::dlx_set_stdout_suppressed(false);
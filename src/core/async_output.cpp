@@ -0,0 +1,371 @@
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include "core/async_output.h"
+#include "core/binary.h"
+
+namespace dlx::sink {
+
+namespace {
+
+// Count word of a section marker; the next word holds the section's column count.
+constexpr uint32_t kSectionMarker = UINT32_MAX;
+
+// Spins a full producer does before parking on the condition variable.
+constexpr int kFullSpins = 64;
+
+// An idle writer thread is only woken once this fraction of the ring is queued, and otherwise polls at
+// kIdlePoll, so a search producing a steady trickle of solutions does not pay a wakeup per solution.
+constexpr size_t kWakeDivisor = 16;
+constexpr std::chrono::milliseconds kIdlePoll(2);
+
+size_t round_up_pow2(size_t value)
+{
+    size_t result = 2;
+    while (result < value)
+    {
+        result <<= 1;
+    }
+    return result;
+}
+
+} // namespace
+
+AsyncSolutionWriter::AsyncSolutionWriter(std::ostream* text, std::ostream* binary, const AsyncOutputConfig& config)
+    : text_(text)
+    , binary_(binary)
+    , config_(config)
+    , mask_(round_up_pow2(config.ring_words) - 1)
+    , head_(0)
+    , cached_tail_(0)
+    , tail_(0)
+    , text_used_(0)
+    , section_open_(false)
+    , consumer_waiting_(false)
+    , producer_waiting_(false)
+    , stopping_(false)
+    , dropped_(0)
+    , failed_(false)
+{
+    ring_.reset(new uint32_t[mask_ + 1]);
+    text_buffer_.resize(config_.text_batch_bytes + 64);
+    if (binary_ != nullptr)
+    {
+        writer_ = std::make_unique<binary::DlxSolutionStreamWriter>(*binary_);
+    }
+    thread_ = std::thread(&AsyncSolutionWriter::run, this);
+}
+
+AsyncSolutionWriter::~AsyncSolutionWriter()
+{
+    stop();
+}
+
+/**
+ * Queues a section marker. Markers always wait for room, whatever the drop policy, so sections stay framed.
+ *
+ * @param uint32_t Column count written to the new DLXS header.
+ * @return int 0 once queued, -1 after @ref stop.
+ */
+int AsyncSolutionWriter::begin_section(uint32_t column_count)
+{
+    if (!thread_.joinable() || !reserve(2, false))
+    {
+        return -1;
+    }
+
+    const uint64_t head = head_.load(std::memory_order_relaxed);
+    const uint32_t marker[2] = {kSectionMarker, column_count};
+    store(head, marker, 2);
+    publish(head + 2);
+    return 0;
+}
+
+/**
+ * Called on the search thread for every solution: copies the row ids into the ring and returns.
+ *
+ * @param const uint32_t* Row ids of the solution, in search order.
+ * @param int Number of row ids.
+ * @return bool False when the solution was dropped (ring full and not blocking, or the writer stopped).
+ */
+bool AsyncSolutionWriter::push(const uint32_t* row_ids, int count)
+{
+    if (count <= 0)
+    {
+        return true;
+    }
+
+    const size_t words = static_cast<size_t>(count) + 1;
+    if (!thread_.joinable() || count > UINT16_MAX || !reserve(words, !config_.block_when_full))
+    {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    const uint64_t head = head_.load(std::memory_order_relaxed);
+    const uint32_t length = static_cast<uint32_t>(count);
+    store(head, &length, 1);
+    store(head + 1, row_ids, static_cast<size_t>(count));
+    publish(head + words);
+    return true;
+}
+
+void AsyncSolutionWriter::on_solution(const SolutionView& view)
+{
+    parsed_.resize(static_cast<size_t>(view.count > 0 ? view.count : 0));
+    for (int i = 0; i < view.count; i++)
+    {
+        parsed_[i] = static_cast<uint32_t>(strtoul(view.values[i], nullptr, 10));
+    }
+    push(parsed_.data(), view.count);
+}
+
+int AsyncSolutionWriter::stop()
+{
+    if (thread_.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_.store(true);
+        }
+        data_cv_.notify_one();
+        thread_.join();
+    }
+    return failed_ ? -1 : 0;
+}
+
+/**
+ * Waits (or, with @p may_drop, refuses) until @p words fit behind the producer's head.
+ */
+bool AsyncSolutionWriter::reserve(size_t words, bool may_drop)
+{
+    const size_t capacity = mask_ + 1;
+    if (words > capacity)
+    {
+        return false;
+    }
+
+    const uint64_t head = head_.load(std::memory_order_relaxed);
+    if (head + words - cached_tail_ <= capacity)
+    {
+        return true;
+    }
+    cached_tail_ = tail_.load(std::memory_order_acquire);
+    if (head + words - cached_tail_ <= capacity)
+    {
+        return true;
+    }
+    if (may_drop)
+    {
+        return false;
+    }
+
+    for (int spin = 0; spin < kFullSpins; spin++)
+    {
+        std::this_thread::yield();
+        cached_tail_ = tail_.load(std::memory_order_acquire);
+        if (head + words - cached_tail_ <= capacity)
+        {
+            return true;
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    producer_waiting_.store(true);
+    space_cv_.wait(lock, [&]() {
+        cached_tail_ = tail_.load();
+        return head + words - cached_tail_ <= capacity;
+    });
+    producer_waiting_.store(false);
+    return true;
+}
+
+void AsyncSolutionWriter::store(uint64_t position, const uint32_t* words, size_t count)
+{
+    const size_t offset = static_cast<size_t>(position) & mask_;
+    const size_t first = std::min(count, mask_ + 1 - offset);
+    memcpy(ring_.get() + offset, words, first * sizeof(uint32_t));
+    memcpy(ring_.get(), words + first, (count - first) * sizeof(uint32_t));
+}
+
+/**
+ * Makes everything below @p head visible to the writer thread and wakes it if it went idle with a batch now
+ * waiting. Smaller batches are picked up by the writer's idle poll.
+ */
+void AsyncSolutionWriter::publish(uint64_t head)
+{
+    head_.store(head, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (consumer_waiting_.load(std::memory_order_relaxed)
+        && head - tail_.load(std::memory_order_relaxed) >= (mask_ + 1) / kWakeDivisor)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        data_cv_.notify_one();
+    }
+}
+
+/**
+ * Writer thread: drains the ring in batches and flushes the streams only when the ring runs dry.
+ */
+void AsyncSolutionWriter::run()
+{
+    while (true)
+    {
+        const uint64_t head = head_.load(std::memory_order_acquire);
+        if (head != tail_.load(std::memory_order_relaxed))
+        {
+            drain(head);
+            continue;
+        }
+
+        flush_outputs();
+        std::unique_lock<std::mutex> lock(mutex_);
+        consumer_waiting_.store(true);
+        data_cv_.wait_for(lock, kIdlePoll, [&]() {
+            return head_.load() - tail_.load(std::memory_order_relaxed) >= (mask_ + 1) / kWakeDivisor
+                || stopping_.load();
+        });
+        consumer_waiting_.store(false);
+        if (stopping_.load() && head_.load() == tail_.load(std::memory_order_relaxed))
+        {
+            break;
+        }
+    }
+
+    if (section_open_ && writer_->finish() != 0)
+    {
+        failed_ = true;
+    }
+    flush_outputs();
+}
+
+/**
+ * Encodes every record up to @p head, handing space back to the producer every eighth of the ring.
+ */
+void AsyncSolutionWriter::drain(uint64_t head)
+{
+    const size_t release_words = (mask_ + 1) / 8;
+    uint64_t tail = tail_.load(std::memory_order_relaxed);
+    uint64_t released = tail;
+
+    while (tail != head)
+    {
+        const uint32_t count = ring_[static_cast<size_t>(tail) & mask_];
+        if (count == kSectionMarker)
+        {
+            const uint32_t column_count = ring_[static_cast<size_t>(tail + 1) & mask_];
+            tail += 2;
+
+            binary::DlxSolutionHeader header = {
+                .magic = DLX_SOLUTION_MAGIC,
+                .version = DLX_SOLUTION_VERSION,
+                .flags = 0,
+                .column_count = column_count,
+            };
+            if (writer_ != nullptr)
+            {
+                if ((section_open_ && writer_->finish() != 0) || writer_->start(header) != 0)
+                {
+                    failed_ = true;
+                }
+                section_open_ = true;
+            }
+        }
+        else
+        {
+            // Records that wrap around the end of the ring are copied out; the rest are read in place.
+            const size_t offset = static_cast<size_t>(tail + 1) & mask_;
+            const uint32_t* row_ids = ring_.get() + offset;
+            if (offset + count > mask_ + 1)
+            {
+                record_.resize(count);
+                const size_t first = mask_ + 1 - offset;
+                memcpy(record_.data(), row_ids, first * sizeof(uint32_t));
+                memcpy(record_.data() + first, ring_.get(), (count - first) * sizeof(uint32_t));
+                row_ids = record_.data();
+            }
+
+            if (text_ != nullptr)
+            {
+                write_text(row_ids, count);
+            }
+            if (section_open_ && writer_->write_row(row_ids, static_cast<uint16_t>(count)) != 0)
+            {
+                failed_ = true;
+            }
+            tail += count + 1;
+        }
+
+        if (tail - released >= release_words || tail == head)
+        {
+            tail_.store(tail);
+            released = tail;
+            if (producer_waiting_.load())
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                space_cv_.notify_one();
+            }
+        }
+    }
+}
+
+void AsyncSolutionWriter::write_text(const uint32_t* row_ids, uint32_t count)
+{
+    // Every id takes at most ten digits and a separator.
+    const size_t needed = static_cast<size_t>(count) * 11;
+    if (text_used_ + needed > text_buffer_.size())
+    {
+        if (text_used_ > 0 && !text_->write(text_buffer_.data(), static_cast<std::streamsize>(text_used_)))
+        {
+            failed_ = true;
+        }
+        text_used_ = 0;
+        if (needed > text_buffer_.size())
+        {
+            text_buffer_.resize(needed);
+        }
+    }
+
+    char* out = text_buffer_.data() + text_used_;
+    char* const end = text_buffer_.data() + text_buffer_.size();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        out = std::to_chars(out, end, row_ids[i]).ptr;
+        *out++ = (i + 1 == count) ? '\n' : ' ';
+    }
+    text_used_ = static_cast<size_t>(out - text_buffer_.data());
+
+    if (text_used_ >= config_.text_batch_bytes)
+    {
+        if (!text_->write(text_buffer_.data(), static_cast<std::streamsize>(text_used_)))
+        {
+            failed_ = true;
+        }
+        text_used_ = 0;
+    }
+}
+
+void AsyncSolutionWriter::flush_outputs()
+{
+    if (text_ != nullptr)
+    {
+        if (text_used_ > 0 && !text_->write(text_buffer_.data(), static_cast<std::streamsize>(text_used_)))
+        {
+            failed_ = true;
+        }
+        text_used_ = 0;
+        text_->flush();
+    }
+    if (section_open_ && writer_->flush() != 0)
+    {
+        failed_ = true;
+    }
+    if (binary_ != nullptr)
+    {
+        binary_->flush();
+    }
+}
+
+} // namespace dlx::sink
@@ -0,0 +1,352 @@
+#include <algorithm>
+#include <thread>
+#include "core/batch.h"
+#include "core/dlx.h"
+#include "core/matrix.h"
+#include "core/search.h"
+
+namespace dlx::batch {
+
+namespace {
+
+// Most rows reserved up front from a header's row count; larger problems grow their arena as rows arrive,
+// so a header that overstates its rows cannot claim more memory than the stream delivers.
+constexpr size_t kRowReserveHint = 64 * 1024;
+
+} // namespace
+
+BatchSolver::BatchSolver(const BatchConfig& config)
+    : config_(config)
+    , in_flight_(0)
+    , reading_done_(false)
+    , solving_done_(false)
+    , failed_(false)
+{}
+
+/**
+ * Solves every problem in @p input and writes one DLXS section per problem to @p output.
+ *
+ * @param std::istream& DLXB stream holding any number of problems, each with an explicit row count.
+ * @param std::ostream& Destination for the DLXS sections.
+ * @param BatchStats* Optional counters for the run.
+ * @return int 0 when every problem was read and solved, -1 otherwise (see @ref error).
+ */
+int BatchSolver::run(std::istream& input, std::ostream& output, BatchStats* stats)
+{
+    unsigned int workers = config_.workers;
+    if (workers == 0)
+    {
+        workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (config_.max_in_flight == 0)
+    {
+        config_.max_in_flight = static_cast<size_t>(workers) * 4;
+    }
+
+    tasks_.clear();
+    results_.clear();
+    in_flight_ = 0;
+    reading_done_ = false;
+    solving_done_ = false;
+    failed_ = false;
+    error_.clear();
+    stats_ = BatchStats();
+    writer_.reset();
+
+    std::thread reader_thread(&BatchSolver::read_problems, this, std::ref(input));
+    std::thread writer_thread(&BatchSolver::write_results, this, std::ref(output));
+    std::vector<std::thread> worker_threads;
+    worker_threads.reserve(workers);
+    for (unsigned int i = 0; i < workers; ++i)
+    {
+        worker_threads.emplace_back(&BatchSolver::solve_problems, this);
+    }
+
+    reader_thread.join();
+    for (auto& worker : worker_threads)
+    {
+        worker.join();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        solving_done_ = true;
+    }
+    result_cv_.notify_all();
+    writer_thread.join();
+
+    writer_.reset();
+    output.flush();
+
+    if (stats != nullptr)
+    {
+        *stats = stats_;
+    }
+    return failed_ ? -1 : 0;
+}
+
+void BatchSolver::fail(const std::string& message)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!failed_)
+    {
+        failed_ = true;
+        error_ = message;
+    }
+    capacity_cv_.notify_all();
+}
+
+/**
+ * Reader thread: decodes problems into CSR arenas and queues them, blocking while the number of
+ * problems in flight is at its limit.
+ */
+void BatchSolver::read_problems(std::istream& input)
+{
+    binary::DlxProblemStreamReader reader(input);
+    std::shared_ptr<binary::DlxCsrProblem> current;
+    uint32_t index = 0;
+
+    while (!reader.at_end())
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            capacity_cv_.wait(lock, [&]() {
+                return failed_ || in_flight_ < config_.max_in_flight;
+            });
+            if (failed_)
+            {
+                break;
+            }
+        }
+
+        binary::DlxCoverHeader header = {0};
+        if (reader.read_header(&header) != 0)
+        {
+            fail("Failed to read problem " + std::to_string(index + 1) + ".");
+            break;
+        }
+
+        if ((header.flags & DLX_COVER_FLAG_REUSE_MATRIX) == 0)
+        {
+            auto problem = std::make_shared<binary::DlxCsrProblem>();
+            problem->header = header;
+            int status = problem->reserve(std::min<size_t>(header.row_count, kRowReserveHint), 0);
+            while (status == 0 && (status = reader.read_row(problem.get())) == 1)
+            {
+                status = 0;
+            }
+            if (status != 0 || (header.row_count > 0 && problem->row_count() != header.row_count))
+            {
+                fail("Failed to parse problem " + std::to_string(index + 1) + ".");
+                break;
+            }
+            current = std::move(problem);
+        }
+        else if (current == nullptr)
+        {
+            fail("Problem " + std::to_string(index + 1) + " references a previous cover, but none precedes it.");
+            break;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.push_back(Task{index++, current, reader.assumptions()});
+            in_flight_ += 1;
+        }
+        task_cv_.notify_one();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        reading_done_ = true;
+    }
+    task_cv_.notify_all();
+}
+
+/**
+ * Worker thread: links each task's cover into a private builder (skipped when the worker already
+ * holds that cover) and collects the solutions for the writer.
+ */
+void BatchSolver::solve_problems()
+{
+    matrix::MatrixBuilder builder;
+    std::shared_ptr<const binary::DlxCsrProblem> linked;
+    struct node* matrix = nullptr;
+    int item_count = 0;
+    int option_count = 0;
+    std::vector<uint32_t> row_ids;
+    RowIndex row_index;
+    bool indexed = false;
+
+    while (true)
+    {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            task_cv_.wait(lock, [&]() {
+                return !tasks_.empty() || reading_done_;
+            });
+            if (tasks_.empty())
+            {
+                break;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+
+        if (task.cover != linked)
+        {
+            matrix = Core::generateMatrixFromCsr(*task.cover, builder, &item_count, &option_count);
+            linked = task.cover;
+            indexed = false;
+        }
+
+        Result result;
+        result.index = task.index;
+        result.column_count = task.cover->header.column_count;
+
+        if (matrix == nullptr)
+        {
+            fail("Failed to link problem " + std::to_string(task.index + 1) + ".");
+        }
+        else
+        {
+            const size_t depth = static_cast<size_t>(std::max(option_count, 1));
+            if (row_ids.size() < depth)
+            {
+                row_ids.resize(depth);
+            }
+
+            // Solutions go straight into the result; no text is formatted on worker threads
+            search::CollectPolicy collector;
+            if (task.assumptions.empty())
+            {
+                Core::search(matrix, 0, row_ids.data(), collector);
+            }
+            else
+            {
+                if (!indexed)
+                {
+                    row_index.build(matrix);
+                    indexed = true;
+                }
+                if (Core::searchWithAssumptions(matrix, row_index, task.assumptions, row_ids.data(), collector) != 0)
+                {
+                    fail("Assumptions in problem " + std::to_string(task.index + 1) + " reference unknown rows.");
+                }
+            }
+            result.row_ids = std::move(collector.row_ids);
+            result.lengths = std::move(collector.lengths);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            results_.push_back(std::move(result));
+        }
+        result_cv_.notify_one();
+    }
+}
+
+/**
+ * Writer thread: emits finished problems either in input order, parking early finishers in a
+ * reorder buffer, or immediately with their problem index in the DLXS header.
+ */
+void BatchSolver::write_results(std::ostream& output)
+{
+    std::map<uint32_t, Result> pending;
+    uint32_t next_index = 0;
+    bool write_failed = false;
+
+    while (true)
+    {
+        std::deque<Result> ready;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            result_cv_.wait(lock, [&]() {
+                return !results_.empty() || solving_done_;
+            });
+            if (results_.empty())
+            {
+                break;
+            }
+            ready.swap(results_);
+        }
+
+        size_t written = 0;
+        for (auto& result : ready)
+        {
+            if (config_.order == OutputOrder::AsCompleted)
+            {
+                if (!write_failed)
+                {
+                    write_failed = (write_result(output, result) != 0);
+                }
+                written++;
+                continue;
+            }
+
+            pending.emplace(result.index, std::move(result));
+            while (!pending.empty() && pending.begin()->first == next_index)
+            {
+                if (!write_failed)
+                {
+                    write_failed = (write_result(output, pending.begin()->second) != 0);
+                }
+                pending.erase(pending.begin());
+                next_index++;
+                written++;
+            }
+        }
+
+        if (written > 0)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                in_flight_ -= written;
+            }
+            capacity_cv_.notify_one();
+        }
+
+        if (write_failed)
+        {
+            fail("Failed to write binary solution output.");
+        }
+    }
+}
+
+/**
+ * Writes one problem's DLXS section: header (tagged with the problem index in as-completed mode),
+ * solution rows, and terminator. A single writer is reused for every section.
+ */
+int BatchSolver::write_result(std::ostream& output, const Result& result)
+{
+    binary::DlxSolutionHeader header = {
+        .magic = DLX_SOLUTION_MAGIC,
+        .version = DLX_SOLUTION_VERSION,
+        .flags = 0,
+        .column_count = result.column_count,
+    };
+
+    if (writer_ == nullptr)
+    {
+        writer_ = std::make_unique<binary::DlxSolutionStreamWriter>(output);
+    }
+
+    int status = (config_.order == OutputOrder::AsCompleted) ? writer_->start(header, result.index)
+                                                            : writer_->start(header);
+    const uint32_t* row = result.row_ids.data();
+    for (size_t i = 0; status == 0 && i < result.lengths.size(); ++i)
+    {
+        status = writer_->write_row(row, result.lengths[i]);
+        row += result.lengths[i];
+    }
+    if (status == 0)
+    {
+        status = writer_->finish();
+    }
+
+    stats_.problems += 1;
+    stats_.solutions += result.lengths.size();
+    return status;
+}
+
+} // namespace dlx::batch
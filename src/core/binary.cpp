@@ -1,10 +1,21 @@
 #include "core/binary.h"
+#include "core/block_codec.h"
 #include "core/dlx.h"
 #include <arpa/inet.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
 #include <climits>
 #include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <istream>
+#include <memory>
 #include <ostream>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -33,58 +44,101 @@ uint32_t dlx_ntohl(uint32_t value)
     return ntohl(value);
 }
 
-class StreamBinaryReader
+uint16_t dlx_htole16(uint16_t value)
 {
-public:
-    explicit StreamBinaryReader(std::istream& stream)
-        : stream_(stream)
-    {}
+    return DLX_HOST_BIG_ENDIAN ? __builtin_bswap16(value) : value;
+}
 
-    bool read_exact(void* buffer, size_t bytes)
-    {
-        stream_.read(static_cast<char*>(buffer), static_cast<std::streamsize>(bytes));
-        return static_cast<size_t>(stream_.gcount()) == bytes;
-    }
+uint32_t dlx_htole32(uint32_t value)
+{
+    return DLX_HOST_BIG_ENDIAN ? __builtin_bswap32(value) : value;
+}
 
-    bool eof() const
-    {
-        return stream_.eof();
-    }
+bool is_native(const struct DlxCoverHeader& header)
+{
+    return (header.flags & DLX_COVER_FLAG_NATIVE_ENDIAN) != 0;
+}
+
+/** True when this library understands @p header's version; later versions are rejected, never guessed at. */
+bool is_supported(const struct DlxCoverHeader& header)
+{
+    return header.version <= DLX_BINARY_VERSION;
+}
 
-private:
-    std::istream& stream_;
-};
+bool is_supported(const struct DlxSolutionHeader& header)
+{
+    return header.version <= DLX_SOLUTION_VERSION;
+}
+
+/** True when the rows of @p header's problem are delta-varint blocks; reuse frames carry no rows at all. */
+bool is_compressed(const struct DlxCoverHeader& header)
+{
+    return header.version >= DLX_BINARY_VERSION_BLOCKS && is_supported(header) && !is_native(header)
+           && (header.flags & DLX_COVER_FLAG_REUSE_MATRIX) == 0;
+}
 
-class StreamBinaryWriter
+/** Options from the DLX_COVER_FLAG_OPTIONS block, already in host order. */
+struct DlxSolveOptions unpack_solve_options(const uint32_t* words)
 {
-public:
-    explicit StreamBinaryWriter(std::ostream& stream)
-        : stream_(stream)
-    {}
+    struct DlxSolveOptions options;
+    options.solution_limit = (static_cast<uint64_t>(words[0]) << 32) | words[1];
+    options.node_budget = (static_cast<uint64_t>(words[2]) << 32) | words[3];
+    options.deadline_ms = words[4];
+    options.flags = static_cast<uint16_t>(words[5] >> 16);
+    options.engine = static_cast<uint16_t>(words[5] & 0xFFFFu);
+    return options;
+}
 
-    bool write_exact(const void* buffer, size_t bytes)
+/**
+ * Read-ahead for readers that may share @p input with later readers: a full block when unread bytes can
+ * be handed back by seeking, none otherwise.
+ */
+size_t shared_read_ahead(std::istream& input)
+{
+    std::streambuf* buffer = input.rdbuf();
+    if (buffer != nullptr && buffer->pubseekoff(0, std::ios::cur, std::ios::in) != std::streampos(std::streamoff(-1)))
     {
-        stream_.write(static_cast<const char*>(buffer), static_cast<std::streamsize>(bytes));
-        return stream_.good();
+        return DLX_BLOCK_SIZE;
     }
-
-private:
-    std::ostream& stream_;
-};
+    return 0;
+}
 
 int ensure_chunk_capacity(struct DlxRowChunk* chunk, uint16_t required);
 int ensure_solution_capacity(struct DlxSolutionRow* row, uint16_t required);
-int write_cover_header(std::ostream& output, const struct DlxCoverHeader* header);
-int read_cover_header(std::istream& input, struct DlxCoverHeader* header);
-int write_row_chunk(std::ostream& output, uint32_t row_id, const uint32_t* columns, uint16_t column_count);
-int read_row_chunk(std::istream& input, struct DlxRowChunk* chunk);
-int write_solution_header(std::ostream& output, const struct DlxSolutionHeader* header);
-int read_solution_header(std::istream& input, struct DlxSolutionHeader* header);
-int write_solution_row(std::ostream& output,
+int write_cover_header(DlxBlockWriter& output, const struct DlxCoverHeader* header);
+int read_cover_header(DlxBlockReader& input, struct DlxCoverHeader* header);
+int write_assumption_block(DlxBlockWriter& output, const dlx::SearchAssumptions& assumptions, bool native);
+int read_assumption_block(DlxBlockReader& input, dlx::SearchAssumptions* assumptions, bool native);
+int write_u32_row(DlxBlockWriter& output, uint32_t id, const uint32_t* values, uint16_t count, bool native);
+int read_row_prefix(DlxBlockReader& input, uint32_t* id, uint16_t* count, bool native);
+int write_row_chunk(DlxBlockWriter& output,
+                    uint32_t row_id,
+                    const uint32_t* columns,
+                    uint16_t column_count,
+                    bool native);
+int read_row_span(DlxBlockReader& input, struct DlxRowSpan* span, bool native);
+int read_row_chunk(DlxBlockReader& input, struct DlxRowChunk* chunk, bool native);
+int read_row_into(DlxBlockReader& input, struct DlxCsrProblem* problem, bool native);
+int read_compressed_prefix(DlxBlockReader& input, DlxCoverBlockDecoder& block, uint32_t* row_id, uint16_t* count);
+int write_cover_row(DlxBlockWriter& output,
+                    DlxCoverBlockEncoder* blocks,
+                    uint32_t row_id,
+                    const uint32_t* columns,
+                    uint16_t column_count,
+                    bool native);
+int write_solution_header(DlxBlockWriter& output, const struct DlxSolutionHeader* header);
+int read_solution_header(DlxBlockReader& input, struct DlxSolutionHeader* header);
+int write_problem_index(DlxBlockWriter& output, uint32_t problem_index);
+int read_problem_index(DlxBlockReader& input, uint32_t* problem_index);
+int write_solve_options(DlxBlockWriter& output, const struct DlxSolveOptions& options);
+int read_solve_options(DlxBlockReader& input, struct DlxSolveOptions* options);
+int write_solve_status(DlxBlockWriter& output, const struct DlxSolveStatus& status);
+int read_solve_status(DlxBlockReader& input, struct DlxSolveStatus* status);
+int write_solution_row(DlxBlockWriter& output,
                        uint32_t solution_id,
                        const uint32_t* row_indices,
                        uint16_t row_count);
-int read_solution_row(std::istream& input, struct DlxSolutionRow* row);
+int read_solution_row(DlxBlockReader& input, struct DlxSolutionRow* row);
 void free_solution_row(struct DlxSolutionRow* row);
 void free_row_chunk(struct DlxRowChunk* chunk);
 
@@ -93,6 +147,8 @@ void free_row_chunk(struct DlxRowChunk* chunk);
 DlxProblem::DlxProblem()
     : header{0}
     , rows()
+    , problem_id(0)
+    , options{0}
 {}
 
 DlxProblem::~DlxProblem()
@@ -103,6 +159,8 @@ DlxProblem::~DlxProblem()
 DlxProblem::DlxProblem(DlxProblem&& other) noexcept
     : header{0}
     , rows()
+    , problem_id(0)
+    , options{0}
 {
     *this = std::move(other);
 }
@@ -114,7 +172,12 @@ DlxProblem& DlxProblem::operator=(DlxProblem&& other) noexcept
         clear();
         header = other.header;
         rows = std::move(other.rows);
+        assumptions = std::move(other.assumptions);
+        problem_id = other.problem_id;
+        options = other.options;
         other.header = DlxCoverHeader{0};
+        other.problem_id = 0;
+        other.options = DlxSolveOptions{0};
     }
     return *this;
 }
@@ -126,12 +189,283 @@ void DlxProblem::clear()
         detail::free_row_chunk(&row);
     }
     rows.clear();
+    assumptions = dlx::SearchAssumptions();
+    problem_id = 0;
+    options = DlxSolveOptions{0};
+    header = DlxCoverHeader{0};
+}
+
+DlxCsrProblem::DlxCsrProblem()
+    : header{0}
+    , assumptions()
+    , problem_id(0)
+    , options{0}
+    , arena_(nullptr)
+    , offsets_(nullptr)
+    , row_ids_(nullptr)
+    , columns_(nullptr)
+    , row_capacity_(0)
+    , entry_capacity_(0)
+    , row_count_(0)
+{}
+
+DlxCsrProblem::~DlxCsrProblem()
+{
+    release();
+}
+
+DlxCsrProblem::DlxCsrProblem(DlxCsrProblem&& other) noexcept
+    : DlxCsrProblem()
+{
+    *this = std::move(other);
+}
+
+DlxCsrProblem& DlxCsrProblem::operator=(DlxCsrProblem&& other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        header = other.header;
+        assumptions = std::move(other.assumptions);
+        problem_id = other.problem_id;
+        std::swap(arena_, other.arena_);
+        std::swap(offsets_, other.offsets_);
+        std::swap(row_ids_, other.row_ids_);
+        std::swap(columns_, other.columns_);
+        std::swap(row_capacity_, other.row_capacity_);
+        std::swap(entry_capacity_, other.entry_capacity_);
+        std::swap(row_count_, other.row_count_);
+        options = other.options;
+        other.header = DlxCoverHeader{0};
+        other.problem_id = 0;
+        other.options = DlxSolveOptions{0};
+    }
+    return *this;
+}
+
+void DlxCsrProblem::clear()
+{
+    row_count_ = 0;
+    assumptions = dlx::SearchAssumptions();
+    problem_id = 0;
+    options = DlxSolveOptions{0};
     header = DlxCoverHeader{0};
 }
 
+void DlxCsrProblem::release()
+{
+    clear();
+    free(arena_);
+    arena_ = nullptr;
+    offsets_ = nullptr;
+    row_ids_ = nullptr;
+    columns_ = nullptr;
+    row_capacity_ = 0;
+    entry_capacity_ = 0;
+}
+
+/**
+ * Moves the arena to a block holding exactly @p rows rows and @p entries entries.
+ *
+ * The block is laid out as offsets (rows + 1), then row ids (rows), then columns (entries), so all
+ * three arrays share one allocation. Existing rows are copied section by section.
+ */
+int DlxCsrProblem::grow(size_t rows, size_t entries)
+{
+    const size_t offsets_bytes = (rows + 1) * sizeof(uint64_t);
+    const size_t row_id_bytes = rows * sizeof(uint32_t);
+    const size_t column_bytes = entries * sizeof(uint32_t);
+    if (rows > SIZE_MAX / (2 * sizeof(uint64_t)) || entries > SIZE_MAX / (2 * sizeof(uint32_t)))
+    {
+        return -1;
+    }
+
+    char* arena = static_cast<char*>(malloc(offsets_bytes + row_id_bytes + column_bytes));
+    if (arena == nullptr)
+    {
+        return -1;
+    }
+
+    uint64_t* offsets = reinterpret_cast<uint64_t*>(arena);
+    uint32_t* row_ids = reinterpret_cast<uint32_t*>(arena + offsets_bytes);
+    uint32_t* columns = reinterpret_cast<uint32_t*>(arena + offsets_bytes + row_id_bytes);
+
+    offsets[0] = 0;
+    if (arena_ != nullptr)
+    {
+        memcpy(offsets, offsets_, (row_count_ + 1) * sizeof(uint64_t));
+        memcpy(row_ids, row_ids_, row_count_ * sizeof(uint32_t));
+        memcpy(columns, columns_, entry_count() * sizeof(uint32_t));
+        free(arena_);
+    }
+
+    arena_ = arena;
+    offsets_ = offsets;
+    row_ids_ = row_ids;
+    columns_ = columns;
+    row_capacity_ = rows;
+    entry_capacity_ = entries;
+    return 0;
+}
+
+int DlxCsrProblem::reserve(size_t rows, size_t entries)
+{
+    if (arena_ != nullptr && rows <= row_capacity_ && entries <= entry_capacity_)
+    {
+        return 0;
+    }
+    return grow(std::max(rows, row_capacity_), std::max(entries, entry_capacity_));
+}
+
+uint32_t* DlxCsrProblem::prepare_row(uint16_t column_count)
+{
+    const size_t used = entry_count();
+    if (arena_ == nullptr || row_count_ + 1 > row_capacity_ || used + column_count > entry_capacity_)
+    {
+        // Double whichever section ran out so appends stay amortised O(1).
+        size_t rows = std::max(row_count_ + 1, row_capacity_);
+        size_t entries = std::max(used + column_count, entry_capacity_);
+        if (rows > row_capacity_)
+        {
+            rows = std::max(rows, row_capacity_ * 2);
+        }
+        if (entries > entry_capacity_)
+        {
+            entries = std::max(entries, entry_capacity_ * 2);
+        }
+        if (grow(rows, entries) != 0)
+        {
+            return nullptr;
+        }
+    }
+    return columns_ + used;
+}
+
+void DlxCsrProblem::commit_row(uint32_t row_id, uint16_t column_count)
+{
+    row_ids_[row_count_] = row_id;
+    offsets_[row_count_ + 1] = offsets_[row_count_] + column_count;
+    row_count_ += 1;
+}
+
+int DlxCsrProblem::append_row(uint32_t row_id, const uint32_t* columns, uint16_t column_count)
+{
+    if (column_count > 0 && columns == nullptr)
+    {
+        return -1;
+    }
+
+    uint32_t* slot = prepare_row(column_count);
+    if (slot == nullptr)
+    {
+        return -1;
+    }
+    if (column_count > 0)
+    {
+        memcpy(slot, columns, sizeof(uint32_t) * column_count);
+    }
+    commit_row(row_id, column_count);
+    return 0;
+}
+
+int DlxCsrProblem::resize(size_t rows, size_t entries)
+{
+    row_count_ = 0;
+    if (reserve(rows, entries) != 0)
+    {
+        return -1;
+    }
+    offsets_[0] = 0;
+    offsets_[rows] = entries;
+    row_count_ = rows;
+    return 0;
+}
+
+uint32_t* DlxCsrProblem::place_row(size_t row, uint32_t row_id, uint64_t first_entry, uint16_t column_count)
+{
+    row_ids_[row] = row_id;
+    offsets_[row + 1] = first_entry + column_count;
+    return columns_ + first_entry;
+}
+
+DlxRowChunk DlxCsrProblem::row_chunk(size_t row) const
+{
+    DlxRowChunk chunk = {0};
+    chunk.row_id = row_ids_[row];
+    chunk.entry_count = row_size(row);
+    chunk.capacity = 0;
+    chunk.columns = const_cast<uint32_t*>(row_columns(row));
+    return chunk;
+}
+
+int DlxCsrProblem::assign(const DlxProblem& problem)
+{
+    size_t entries = 0;
+    for (const auto& row : problem.rows)
+    {
+        entries += row.entry_count;
+    }
+
+    clear();
+    if (reserve(problem.rows.size(), entries) != 0)
+    {
+        return -1;
+    }
+
+    for (const auto& row : problem.rows)
+    {
+        if (append_row(row.row_id, row.columns, row.entry_count) != 0)
+        {
+            clear();
+            return -1;
+        }
+    }
+
+    header = problem.header;
+    assumptions = problem.assumptions;
+    problem_id = problem.problem_id;
+    options = problem.options;
+    return 0;
+}
+
+int DlxCsrProblem::to_problem(DlxProblem* problem) const
+{
+    if (problem == nullptr)
+    {
+        return -1;
+    }
+
+    problem->clear();
+    problem->rows.reserve(row_count_);
+    for (size_t i = 0; i < row_count_; i++)
+    {
+        DlxRowChunk chunk = {0};
+        if (detail::ensure_chunk_capacity(&chunk, row_size(i)) != 0)
+        {
+            problem->clear();
+            return -1;
+        }
+        chunk.row_id = row_ids_[i];
+        chunk.entry_count = row_size(i);
+        if (chunk.entry_count > 0)
+        {
+            memcpy(chunk.columns, row_columns(i), sizeof(uint32_t) * chunk.entry_count);
+        }
+        problem->rows.push_back(chunk);
+    }
+
+    problem->header = header;
+    problem->assumptions = assumptions;
+    problem->problem_id = problem_id;
+    problem->options = options;
+    return 0;
+}
+
 DlxSolution::DlxSolution()
     : header{0}
     , rows()
+    , problem_index(0)
+    , status{0}
 {}
 
 DlxSolution::~DlxSolution()
@@ -142,6 +476,8 @@ DlxSolution::~DlxSolution()
 DlxSolution::DlxSolution(DlxSolution&& other) noexcept
     : header{0}
     , rows()
+    , problem_index(0)
+    , status{0}
 {
     *this = std::move(other);
 }
@@ -153,7 +489,11 @@ DlxSolution& DlxSolution::operator=(DlxSolution&& other) noexcept
         clear();
         header = other.header;
         rows = std::move(other.rows);
+        problem_index = other.problem_index;
+        status = other.status;
         other.header = DlxSolutionHeader{0};
+        other.problem_index = 0;
+        other.status = DlxSolveStatus{0};
     }
     return *this;
 }
@@ -166,14 +506,20 @@ void DlxSolution::clear()
     }
     rows.clear();
     header = DlxSolutionHeader{0};
+    problem_index = 0;
+    status = DlxSolveStatus{0};
 }
 
 DlxProblemStreamReader::DlxProblemStreamReader(std::istream& input)
-    : input_(&input)
+    : input_(input)
     , scratch_{0}
+    , problem_id_(0)
+    , options_{0}
     , remaining_rows_(0)
     , has_row_count_(false)
     , header_active_(false)
+    , native_(false)
+    , compressed_(false)
 {}
 
 DlxProblemStreamReader::~DlxProblemStreamReader()
@@ -183,7 +529,24 @@ DlxProblemStreamReader::~DlxProblemStreamReader()
 
 int DlxProblemStreamReader::read_header(struct DlxCoverHeader* header)
 {
-    int status = detail::read_cover_header(*input_, header);
+    assumptions_ = dlx::SearchAssumptions();
+    problem_id_ = 0;
+    options_ = DlxSolveOptions{0};
+
+    int status = detail::read_cover_header(input_, header);
+    if (status == 0 && (header->flags & DLX_COVER_FLAG_PROBLEM_ID) != 0)
+    {
+        status = detail::read_problem_index(input_, &problem_id_);
+    }
+    if (status == 0 && (header->flags & DLX_COVER_FLAG_OPTIONS) != 0)
+    {
+        status = detail::read_solve_options(input_, &options_);
+    }
+    if (status == 0 && (header->flags & DLX_COVER_FLAG_ASSUMPTIONS) != 0)
+    {
+        status = detail::read_assumption_block(input_, &assumptions_, detail::is_native(*header));
+    }
+
     if (status != 0)
     {
         header_active_ = false;
@@ -192,8 +555,14 @@ int DlxProblemStreamReader::read_header(struct DlxCoverHeader* header)
         return status;
     }
 
-    remaining_rows_ = header->row_count;
-    has_row_count_ = (header->row_count > 0);
+    // Reuse frames never carry rows, so report end-of-rows on the first read_chunk. Compressed rows
+    // end at their terminator block whatever the header declares.
+    native_ = detail::is_native(*header);
+    compressed_ = detail::is_compressed(*header);
+    block_ = DlxCoverBlockDecoder();
+    const bool reuse = (header->flags & DLX_COVER_FLAG_REUSE_MATRIX) != 0;
+    remaining_rows_ = reuse ? 0 : header->row_count;
+    has_row_count_ = !compressed_ && (reuse || (header->row_count > 0));
     header_active_ = true;
     return 0;
 }
@@ -216,21 +585,11 @@ int DlxProblemStreamReader::read_chunk(struct DlxRowChunk* chunk)
         return 0;
     }
 
-    int status = detail::read_row_chunk(*input_, chunk);
-    if (status != 1)
-    {
-        if (status == 0 && !has_row_count_)
-        {
-            header_active_ = false;
-            return 0;
-        }
-        return status;
-    }
-    if (has_row_count_ && remaining_rows_ > 0)
+    if (compressed_)
     {
-        remaining_rows_ -= 1;
+        return next_row_status(read_compressed_chunk(chunk));
     }
-    return 1;
+    return next_row_status(detail::read_row_chunk(input_, chunk, native_));
 }
 
 int DlxProblemStreamReader::read_row(uint32_t* row_id, std::vector<uint32_t>* columns)
@@ -251,221 +610,1306 @@ int DlxProblemStreamReader::read_row(uint32_t* row_id, std::vector<uint32_t>* co
     return 1;
 }
 
-DlxProblemStreamWriter::DlxProblemStreamWriter(std::ostream& output, const struct DlxCoverHeader& header)
-    : output_(&output)
-    , remaining_rows_(0)
-    , has_row_count_(false)
-    , started_(false)
-{
-    start(header);
-}
-
-int DlxProblemStreamWriter::start(const struct DlxCoverHeader& header)
-{
-    remaining_rows_ = header.row_count;
-    has_row_count_ = (header.row_count > 0);
-    started_ = (detail::write_cover_header(*output_, &header) == 0);
-    return started_ ? 0 : -1;
-}
-
-int DlxProblemStreamWriter::write_row(uint32_t row_id, const uint32_t* columns, uint16_t column_count)
+int DlxProblemStreamReader::read_row(struct DlxCsrProblem* problem)
 {
-    if (!started_)
+    if (problem == nullptr || !header_active_)
     {
         return -1;
     }
 
-    if (has_row_count_)
+    if (has_row_count_ && remaining_rows_ == 0)
     {
-        if (remaining_rows_ == 0)
+        header_active_ = false;
+        return 0;
+    }
+
+    if (compressed_)
+    {
+        uint32_t row_id = 0;
+        uint16_t entry_count = 0;
+        int status = detail::read_compressed_prefix(input_, block_, &row_id, &entry_count);
+        if (status == 1)
         {
-            return -1;
+            uint32_t* columns = problem->prepare_row(entry_count);
+            if (columns == nullptr || block_.read_columns(columns, entry_count) != 0)
+            {
+                return -1;
+            }
+            problem->commit_row(row_id, entry_count);
         }
-        remaining_rows_ -= 1;
+        return next_row_status(status);
     }
-
-    return detail::write_row_chunk(*output_, row_id, columns, column_count);
+    return next_row_status(detail::read_row_into(input_, problem, native_));
 }
 
-int DlxProblemStreamWriter::finish()
+int DlxProblemStreamReader::read_row(struct DlxRowSpan* span)
 {
-    started_ = false;
-    remaining_rows_ = 0;
-    has_row_count_ = false;
-    return 0;
-}
-
-DlxSolutionStreamReader::DlxSolutionStreamReader(std::istream& input)
-    : input_(&input)
-    , scratch_{0}
-    , header_active_(false)
-{}
+    if (span == nullptr || !header_active_)
+    {
+        return -1;
+    }
 
-DlxSolutionStreamReader::~DlxSolutionStreamReader()
-{
-    detail::free_solution_row(&scratch_);
-}
+    if (has_row_count_ && remaining_rows_ == 0)
+    {
+        header_active_ = false;
+        return 0;
+    }
 
-int DlxSolutionStreamReader::read_header(struct DlxSolutionHeader* header)
-{
-    int status = detail::read_solution_header(*input_, header);
-    header_active_ = (status == 0);
-    return status;
+    if (compressed_)
+    {
+        // Varint rows cannot be viewed in place, so they are decoded into the reader's scratch row.
+        int status = read_compressed_chunk(&scratch_);
+        if (status == 1)
+        {
+            span->row_id = scratch_.row_id;
+            span->entry_count = scratch_.entry_count;
+            span->columns = scratch_.columns;
+        }
+        return next_row_status(status);
+    }
+    return next_row_status(detail::read_row_span(input_, span, native_));
 }
 
-int DlxSolutionStreamReader::read_row(uint32_t* solution_id, std::vector<uint32_t>* row_indices)
+int DlxProblemStreamReader::read_compressed_chunk(struct DlxRowChunk* chunk)
 {
-    if (solution_id == nullptr || row_indices == nullptr)
+    uint32_t row_id = 0;
+    uint16_t entry_count = 0;
+    int status = detail::read_compressed_prefix(input_, block_, &row_id, &entry_count);
+    if (status != 1)
     {
-        return -1;
+        return status;
     }
 
-    if (!header_active_)
+    if (detail::ensure_chunk_capacity(chunk, entry_count) != 0 || block_.read_columns(chunk->columns, entry_count) != 0)
     {
         return -1;
     }
+    chunk->row_id = row_id;
+    chunk->entry_count = entry_count;
+    return 1;
+}
 
-    int status = detail::read_solution_row(*input_, &scratch_);
+/**
+ * Accounts for one row read attempt: counts down framed rows and ends the problem when an unframed
+ * stream runs out.
+ */
+int DlxProblemStreamReader::next_row_status(int status)
+{
     if (status != 1)
     {
+        if (status == 0 && !has_row_count_)
+        {
+            header_active_ = false;
+            return 0;
+        }
         return status;
     }
-
-    if (scratch_.solution_id == 0 && scratch_.entry_count == 0)
+    if (has_row_count_ && remaining_rows_ > 0)
     {
-        header_active_ = false;
-        return 0;
+        remaining_rows_ -= 1;
     }
-
-    *solution_id = scratch_.solution_id;
-    row_indices->assign(scratch_.row_indices, scratch_.row_indices + scratch_.entry_count);
     return 1;
 }
 
-DlxSolutionStreamWriter::DlxSolutionStreamWriter(std::ostream& output, const struct DlxSolutionHeader& header)
-    : output_(&output)
-    , next_solution_id_(1)
-    , finished_(false)
-    , started_(false)
+DlxFrameScanner::DlxFrameScanner()
 {
-    start(header);
+    reset();
 }
 
-int DlxSolutionStreamWriter::start(const struct DlxSolutionHeader& header)
+void DlxFrameScanner::reset()
 {
-    next_solution_id_ = 1;
-    finished_ = false;
-    started_ = (detail::write_solution_header(*output_, &header) == 0);
+    stage_ = Stage::Header;
+    offset_ = 0;
+    remaining_rows_ = 0;
+    flags_ = 0;
+    native_ = false;
+    compressed_ = false;
+}
+
+int DlxFrameScanner::scan(const char* data, size_t size, size_t* frame_bytes)
+{
+    if ((data == nullptr && size > 0) || frame_bytes == nullptr)
+    {
+        return -1;
+    }
+
+    // Reads the u32 at @p at in the frame's byte order; the header and block headers are always big-endian.
+    auto u32_at = [&](size_t at, bool big_endian) {
+        uint32_t value;
+        memcpy(&value, data + at, sizeof(value));
+        return big_endian ? detail::dlx_ntohl(value) : detail::dlx_htole32(value);
+    };
+
+    while (true)
+    {
+        switch (stage_)
+        {
+        case Stage::Header:
+        {
+            if (size - offset_ < sizeof(struct DlxCoverHeader))
+            {
+                return 0;
+            }
+
+            struct DlxCoverHeader header;
+            memcpy(&header, data + offset_, sizeof(header));
+            header.magic = detail::dlx_ntohl(header.magic);
+            header.version = detail::dlx_ntohs(header.version);
+            header.flags = detail::dlx_ntohs(header.flags);
+            header.row_count = detail::dlx_ntohl(header.row_count);
+            if (header.magic != DLX_COVER_MAGIC || !detail::is_supported(header))
+            {
+                return -1;
+            }
+
+            offset_ += sizeof(header);
+            flags_ = header.flags;
+            native_ = detail::is_native(header);
+            compressed_ = detail::is_compressed(header);
+            remaining_rows_ = header.row_count;
+            stage_ = Stage::Assumptions;
+            break;
+        }
+        case Stage::Assumptions:
+        {
+            // The problem id, the options and the assumption block are skipped together, so a frame split inside
+            // them is simply rescanned from the end of the header.
+            uint64_t bytes = (flags_ & DLX_COVER_FLAG_PROBLEM_ID) != 0 ? sizeof(uint32_t) : 0;
+            bytes += (flags_ & DLX_COVER_FLAG_OPTIONS) != 0 ? DLX_SOLVE_OPTIONS_WORDS * sizeof(uint32_t) : 0;
+            if ((flags_ & DLX_COVER_FLAG_ASSUMPTIONS) != 0)
+            {
+                const size_t counts = offset_ + static_cast<size_t>(bytes);
+                if (size - offset_ < bytes + 2 * sizeof(uint32_t))
+                {
+                    return 0;
+                }
+                const uint64_t ids = static_cast<uint64_t>(u32_at(counts, !native_)) + u32_at(counts + 4, !native_);
+                bytes += 2 * sizeof(uint32_t) + ids * sizeof(uint32_t);
+            }
+            if (size - offset_ < bytes)
+            {
+                return 0;
+            }
+            offset_ += static_cast<size_t>(bytes);
+
+            if ((flags_ & DLX_COVER_FLAG_REUSE_MATRIX) != 0)
+            {
+                stage_ = Stage::Done;
+            }
+            else if (compressed_)
+            {
+                stage_ = Stage::Blocks;
+            }
+            else
+            {
+                stage_ = remaining_rows_ > 0 ? Stage::Rows : Stage::RowsToEof;
+            }
+            break;
+        }
+        case Stage::Rows:
+        {
+            // Version 1 rows are a u32 id, a u16 count and the columns; native rows pad the count to 32 bits.
+            const size_t prefix = native_ ? 2 * sizeof(uint32_t) : sizeof(uint32_t) + sizeof(uint16_t);
+            while (remaining_rows_ > 0)
+            {
+                if (size - offset_ < prefix)
+                {
+                    return 0;
+                }
+                uint16_t count;
+                memcpy(&count, data + offset_ + sizeof(uint32_t), sizeof(count));
+                count = native_ ? detail::dlx_htole16(count) : detail::dlx_ntohs(count);
+                const size_t bytes = prefix + static_cast<size_t>(count) * sizeof(uint32_t);
+                if (size - offset_ < bytes)
+                {
+                    return 0;
+                }
+                offset_ += bytes;
+                remaining_rows_ -= 1;
+            }
+            stage_ = Stage::Done;
+            break;
+        }
+        case Stage::RowsToEof:
+            return 0;
+        case Stage::Blocks:
+        {
+            while (true)
+            {
+                if (size - offset_ < DLX_COVER_BLOCK_HEADER_BYTES)
+                {
+                    return 0;
+                }
+                const struct DlxCoverBlockHeader block = dlx_decode_block_header(data + offset_);
+                if (block.payload_bytes > DLX_COVER_BLOCK_MAX_BYTES)
+                {
+                    return -1;
+                }
+                const size_t bytes = DLX_COVER_BLOCK_HEADER_BYTES + block.payload_bytes;
+                if (size - offset_ < bytes)
+                {
+                    return 0;
+                }
+                offset_ += bytes;
+                if (block.row_count == 0)
+                {
+                    break; // Terminator followed by the block index.
+                }
+            }
+            stage_ = Stage::Done;
+            break;
+        }
+        case Stage::Done:
+            *frame_bytes = offset_;
+            reset();
+            return 1;
+        }
+    }
+}
+
+DlxMappedProblemReader::DlxMappedProblemReader()
+    : mapping_(nullptr)
+    , size_(0)
+    , cursor_(0)
+    , problem_id_(0)
+    , options_{0}
+    , remaining_rows_(0)
+    , has_row_count_(false)
+    , header_active_(false)
+{}
+
+DlxMappedProblemReader::~DlxMappedProblemReader()
+{
+    close();
+}
+
+/**
+ * Maps @p path read-only for sequential access.
+ *
+ * @return int 0 on success, -1 when the file cannot be mapped, is too short to hold a header, or the host
+ *         is big-endian (native files are little-endian, so rows would need decoding anyway).
+ */
+int DlxMappedProblemReader::open(const char* path)
+{
+    close();
+    if (DLX_HOST_BIG_ENDIAN || path == nullptr)
+    {
+        return -1;
+    }
+
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(struct DlxCoverHeader)))
+    {
+        ::close(fd);
+        return -1;
+    }
+
+    void* mapping = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        return -1;
+    }
+
+    madvise(mapping, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+    mapping_ = static_cast<const char*>(mapping);
+    size_ = static_cast<size_t>(info.st_size);
+    cursor_ = 0;
+    return 0;
+}
+
+void DlxMappedProblemReader::close()
+{
+    if (mapping_ != nullptr)
+    {
+        munmap(const_cast<char*>(mapping_), size_);
+    }
+    mapping_ = nullptr;
+    size_ = 0;
+    cursor_ = 0;
+    assumptions_ = dlx::SearchAssumptions();
+    problem_id_ = 0;
+    options_ = DlxSolveOptions{0};
+    remaining_rows_ = 0;
+    has_row_count_ = false;
+    header_active_ = false;
+}
+
+/**
+ * Decodes the next header and its assumption block from the mapping.
+ *
+ * @return int 0 on success, -1 when no mapping is open, the header is truncated, or the problem is not
+ *         native-endian.
+ */
+int DlxMappedProblemReader::read_header(struct DlxCoverHeader* header)
+{
+    assumptions_ = dlx::SearchAssumptions();
+    problem_id_ = 0;
+    options_ = DlxSolveOptions{0};
+    header_active_ = false;
+    remaining_rows_ = 0;
+    has_row_count_ = false;
+
+    if (header == nullptr || mapping_ == nullptr || cursor_ % alignof(uint32_t) != 0
+        || size_ - cursor_ < sizeof(struct DlxCoverHeader))
+    {
+        return -1;
+    }
+
+    struct DlxCoverHeader readable;
+    memcpy(&readable, mapping_ + cursor_, sizeof(readable));
+    header->magic = detail::dlx_ntohl(readable.magic);
+    header->version = detail::dlx_ntohs(readable.version);
+    header->flags = detail::dlx_ntohs(readable.flags);
+    header->column_count = detail::dlx_ntohl(readable.column_count);
+    header->row_count = detail::dlx_ntohl(readable.row_count);
+    if (!detail::is_native(*header) || !detail::is_supported(*header))
+    {
+        return -1;
+    }
+    cursor_ += sizeof(struct DlxCoverHeader);
+
+    // Like the header, the problem id stays big-endian in native files.
+    if ((header->flags & DLX_COVER_FLAG_PROBLEM_ID) != 0)
+    {
+        if (size_ - cursor_ < sizeof(uint32_t))
+        {
+            return -1;
+        }
+        uint32_t problem_id;
+        memcpy(&problem_id, mapping_ + cursor_, sizeof(problem_id));
+        problem_id_ = detail::dlx_ntohl(problem_id);
+        cursor_ += sizeof(uint32_t);
+    }
+
+    // So are the solve options.
+    if ((header->flags & DLX_COVER_FLAG_OPTIONS) != 0)
+    {
+        if (size_ - cursor_ < DLX_SOLVE_OPTIONS_WORDS * sizeof(uint32_t))
+        {
+            return -1;
+        }
+        uint32_t words[DLX_SOLVE_OPTIONS_WORDS];
+        memcpy(words, mapping_ + cursor_, sizeof(words));
+        for (uint32_t& word : words)
+        {
+            word = detail::dlx_ntohl(word);
+        }
+        options_ = detail::unpack_solve_options(words);
+        cursor_ += sizeof(words);
+    }
+
+    if ((header->flags & DLX_COVER_FLAG_ASSUMPTIONS) != 0)
+    {
+        if (size_ - cursor_ < 2 * sizeof(uint32_t))
+        {
+            return -1;
+        }
+        const uint32_t* counts = reinterpret_cast<const uint32_t*>(mapping_ + cursor_);
+        cursor_ += 2 * sizeof(uint32_t);
+
+        std::vector<uint32_t>* lists[2] = {&assumptions_.forced_rows, &assumptions_.forbidden_rows};
+        for (int list = 0; list < 2; list++)
+        {
+            if ((size_ - cursor_) / sizeof(uint32_t) < counts[list])
+            {
+                return -1;
+            }
+            const uint32_t* values = reinterpret_cast<const uint32_t*>(mapping_ + cursor_);
+            lists[list]->assign(values, values + counts[list]);
+            cursor_ += sizeof(uint32_t) * counts[list];
+        }
+    }
+
+    const bool reuse = (header->flags & DLX_COVER_FLAG_REUSE_MATRIX) != 0;
+    remaining_rows_ = reuse ? 0 : header->row_count;
+    has_row_count_ = reuse || (header->row_count > 0);
+    header_active_ = true;
+    return 0;
+}
+
+int DlxMappedProblemReader::read_row(struct DlxRowSpan* span)
+{
+    if (span == nullptr || !header_active_)
+    {
+        return -1;
+    }
+
+    if ((has_row_count_ && remaining_rows_ == 0) || (!has_row_count_ && cursor_ == size_))
+    {
+        header_active_ = false;
+        return 0;
+    }
+
+    // Native rows: LE id, LE u16 count padded to 32 bits, then the LE column indices.
+    if (size_ - cursor_ < 2 * sizeof(uint32_t))
+    {
+        return -1;
+    }
+    const uint32_t* prefix = reinterpret_cast<const uint32_t*>(mapping_ + cursor_);
+    uint16_t entry_count;
+    memcpy(&entry_count, mapping_ + cursor_ + sizeof(uint32_t), sizeof(entry_count));
+    if ((size_ - cursor_ - 2 * sizeof(uint32_t)) / sizeof(uint32_t) < entry_count)
+    {
+        return -1;
+    }
+
+    span->row_id = prefix[0];
+    span->entry_count = entry_count;
+    span->columns = prefix + 2;
+    cursor_ += sizeof(uint32_t) * (2 + static_cast<size_t>(entry_count));
+    if (has_row_count_)
+    {
+        remaining_rows_ -= 1;
+    }
+    return 1;
+}
+
+DlxProblemStreamWriter::DlxProblemStreamWriter(std::ostream& output, const struct DlxCoverHeader& header)
+    : output_(output)
+    , remaining_rows_(0)
+    , has_row_count_(false)
+    , started_(false)
+    , native_(false)
+    , compressed_(false)
+    , body_open_(false)
+{
+    start(header);
+}
+
+DlxProblemStreamWriter::DlxProblemStreamWriter(std::ostream& output,
+                                               const struct DlxCoverHeader& header,
+                                               const dlx::SearchAssumptions& assumptions)
+    : output_(output)
+    , remaining_rows_(0)
+    , has_row_count_(false)
+    , started_(false)
+    , native_(false)
+    , compressed_(false)
+    , body_open_(false)
+{
+    start(header, assumptions);
+}
+
+DlxProblemStreamWriter::DlxProblemStreamWriter(std::ostream& output)
+    : output_(output)
+    , remaining_rows_(0)
+    , has_row_count_(false)
+    , started_(false)
+    , native_(false)
+    , compressed_(false)
+    , body_open_(false)
+{}
+
+DlxProblemStreamWriter::~DlxProblemStreamWriter()
+{
+    end_body();
+}
+
+void DlxProblemStreamWriter::begin_body(const struct DlxCoverHeader& header)
+{
+    const bool reuse = (header.flags & DLX_COVER_FLAG_REUSE_MATRIX) != 0;
+    remaining_rows_ = reuse ? 0 : header.row_count;
+    has_row_count_ = reuse || (header.row_count > 0);
+    native_ = detail::is_native(header);
+    compressed_ = detail::is_compressed(header);
+    body_open_ = compressed_;
+}
+
+/** Closes a compressed body with its terminator and block index; a no-op for other encodings. */
+int DlxProblemStreamWriter::end_body()
+{
+    if (!body_open_)
+    {
+        return 0;
+    }
+    body_open_ = false;
+    return encoder_.finish(output_);
+}
+
+int DlxProblemStreamWriter::start(const struct DlxCoverHeader& header)
+{
+    return begin(header, dlx::SearchAssumptions(), 0, DlxSolveOptions{0});
+}
+
+int DlxProblemStreamWriter::start(const struct DlxCoverHeader& header, const dlx::SearchAssumptions& assumptions)
+{
+    DlxCoverHeader flagged = header;
+    flagged.flags |= DLX_COVER_FLAG_ASSUMPTIONS;
+    return begin(flagged, assumptions, 0, DlxSolveOptions{0});
+}
+
+int DlxProblemStreamWriter::start(const struct DlxCoverHeader& header,
+                                  const dlx::SearchAssumptions& assumptions,
+                                  uint32_t problem_id)
+{
+    DlxCoverHeader flagged = header;
+    flagged.flags |= DLX_COVER_FLAG_PROBLEM_ID;
+    if (!assumptions.empty())
+    {
+        flagged.flags |= DLX_COVER_FLAG_ASSUMPTIONS;
+    }
+    return begin(flagged, assumptions, problem_id, DlxSolveOptions{0});
+}
+
+int DlxProblemStreamWriter::start(const struct DlxCoverHeader& header,
+                                  const dlx::SearchAssumptions& assumptions,
+                                  uint32_t problem_id,
+                                  const DlxSolveOptions& options)
+{
+    DlxCoverHeader flagged = header;
+    flagged.flags |= DLX_COVER_FLAG_OPTIONS;
+    if (!assumptions.empty())
+    {
+        flagged.flags |= DLX_COVER_FLAG_ASSUMPTIONS;
+    }
+    return begin(flagged, assumptions, problem_id, options);
+}
+
+/**
+ * Closes the previous problem and writes @p header, followed by the problem id, the solve options and the
+ * assumption block when its flags ask for them. A header flagged for any of them without a value gets id 0, no
+ * options or an empty block.
+ */
+int DlxProblemStreamWriter::begin(const struct DlxCoverHeader& header,
+                                  const dlx::SearchAssumptions& assumptions,
+                                  uint32_t problem_id,
+                                  const DlxSolveOptions& options)
+{
+    if (end_body() != 0)
+    {
+        return -1;
+    }
+    begin_body(header);
+    started_ = (detail::write_cover_header(output_, &header) == 0)
+               && ((header.flags & DLX_COVER_FLAG_PROBLEM_ID) == 0
+                   || detail::write_problem_index(output_, problem_id) == 0)
+               && ((header.flags & DLX_COVER_FLAG_OPTIONS) == 0
+                   || detail::write_solve_options(output_, options) == 0)
+               && ((header.flags & DLX_COVER_FLAG_ASSUMPTIONS) == 0
+                   || detail::write_assumption_block(output_, assumptions, native_) == 0);
     return started_ ? 0 : -1;
 }
 
-int DlxSolutionStreamWriter::write_row(const uint32_t* row_indices, uint16_t row_count)
+int DlxProblemStreamWriter::write_row(uint32_t row_id, const uint32_t* columns, uint16_t column_count)
+{
+    if (!started_)
+    {
+        return -1;
+    }
+
+    if (has_row_count_)
+    {
+        if (remaining_rows_ == 0)
+        {
+            return -1;
+        }
+        remaining_rows_ -= 1;
+    }
+
+    if (detail::write_cover_row(output_, compressed_ ? &encoder_ : nullptr, row_id, columns, column_count, native_) != 0)
+    {
+        return -1;
+    }
+    // A declared row count lets the body close itself, so readers never wait on a missing finish().
+    return (has_row_count_ && remaining_rows_ == 0) ? end_body() : 0;
+}
+
+int DlxProblemStreamWriter::finish()
+{
+    const int status = end_body();
+    started_ = false;
+    remaining_rows_ = 0;
+    has_row_count_ = false;
+    return (output_.flush() == 0 && status == 0) ? 0 : -1;
+}
+
+DlxSolutionStreamReader::DlxSolutionStreamReader(std::istream& input)
+    : input_(input, detail::shared_read_ahead(input))
+    , scratch_{0}
+    , problem_index_(0)
+    , status_{0}
+    , header_active_(false)
+    , compact_(false)
+    , has_status_(false)
+{}
+
+DlxSolutionStreamReader::~DlxSolutionStreamReader()
+{
+    detail::free_solution_row(&scratch_);
+}
+
+int DlxSolutionStreamReader::read_header(struct DlxSolutionHeader* header)
+{
+    problem_index_ = 0;
+    status_ = DlxSolveStatus{0};
+    int status = detail::read_solution_header(input_, header);
+    if (status == 0 && (header->flags & DLX_SOLUTION_FLAG_PROBLEM_INDEX) != 0)
+    {
+        status = detail::read_problem_index(input_, &problem_index_);
+    }
+    header_active_ = (status == 0);
+    if (header_active_)
+    {
+        compact_ = (header->version >= DLX_SOLUTION_VERSION_COMPACT);
+        has_status_ = (header->flags & DLX_SOLUTION_FLAG_STATUS) != 0;
+        decoder_.reset((header->flags & DLX_SOLUTION_FLAG_SORTED_ROWS) != 0,
+                       (header->flags & DLX_SOLUTION_FLAG_EXPLICIT_IDS) != 0);
+    }
+    return status;
+}
+
+int DlxSolutionStreamReader::read_row(uint32_t* solution_id, std::vector<uint32_t>* row_indices)
+{
+    uint64_t wide_id = 0;
+    int status = (solution_id == nullptr) ? -1 : read_row(&wide_id, row_indices);
+    if (status == 1)
+    {
+        if (wide_id > UINT32_MAX)
+        {
+            return -1;
+        }
+        *solution_id = static_cast<uint32_t>(wide_id);
+    }
+    return status;
+}
+
+int DlxSolutionStreamReader::read_row(uint64_t* solution_id, std::vector<uint32_t>* row_indices)
+{
+    if (solution_id == nullptr || row_indices == nullptr)
+    {
+        return -1;
+    }
+
+    if (!header_active_)
+    {
+        return -1;
+    }
+
+    if (compact_)
+    {
+        int status = decoder_.read(input_, solution_id);
+        if (status == 1)
+        {
+            row_indices->assign(decoder_.rows().begin(), decoder_.rows().end());
+        }
+        else if (status == 0)
+        {
+            return end_section();
+        }
+        else
+        {
+            header_active_ = false;
+        }
+        return status;
+    }
+
+    int status = detail::read_solution_row(input_, &scratch_);
+    if (status != 1)
+    {
+        return status;
+    }
+
+    if (scratch_.solution_id == 0 && scratch_.entry_count == 0)
+    {
+        return end_section();
+    }
+
+    *solution_id = scratch_.solution_id;
+    row_indices->assign(scratch_.row_indices, scratch_.row_indices + scratch_.entry_count);
+    return 1;
+}
+
+/** Reads the status trailer, if the section has one, once its terminator was read. */
+int DlxSolutionStreamReader::end_section()
+{
+    header_active_ = false;
+    if (has_status_ && detail::read_solve_status(input_, &status_) != 0)
+    {
+        return -1;
+    }
+    return 0;
+}
+
+DlxSolutionStreamWriter::DlxSolutionStreamWriter(std::ostream& output, const struct DlxSolutionHeader& header)
+    : output_(output)
+    , next_solution_id_(1)
+    , finished_(false)
+    , started_(false)
+    , compact_(false)
+    , has_status_(false)
+{
+    start(header);
+}
+
+DlxSolutionStreamWriter::DlxSolutionStreamWriter(std::ostream& output)
+    : output_(output)
+    , next_solution_id_(1)
+    , finished_(false)
+    , started_(false)
+    , compact_(false)
+    , has_status_(false)
+{}
+
+int DlxSolutionStreamWriter::start(const struct DlxSolutionHeader& header)
+{
+    next_solution_id_ = 1;
+    finished_ = false;
+    compact_ = (header.version >= DLX_SOLUTION_VERSION_COMPACT);
+    has_status_ = (header.flags & DLX_SOLUTION_FLAG_STATUS) != 0;
+    encoder_.reset((header.flags & DLX_SOLUTION_FLAG_SORTED_ROWS) != 0,
+                   (header.flags & DLX_SOLUTION_FLAG_EXPLICIT_IDS) != 0);
+    started_ = (detail::write_solution_header(output_, &header) == 0);
+    return started_ ? 0 : -1;
+}
+
+int DlxSolutionStreamWriter::start(const struct DlxSolutionHeader& header, uint32_t problem_index)
+{
+    struct DlxSolutionHeader tagged = header;
+    tagged.flags |= DLX_SOLUTION_FLAG_PROBLEM_INDEX;
+    if (start(tagged) != 0)
+    {
+        return -1;
+    }
+
+    started_ = (detail::write_problem_index(output_, problem_index) == 0);
+    return started_ ? 0 : -1;
+}
+
+int DlxSolutionStreamWriter::write_row(const uint32_t* row_indices, uint16_t row_count)
+{
+    if (!started_ || finished_)
+    {
+        return -1;
+    }
+
+    int status = -1;
+    if (compact_)
+    {
+        status = encoder_.write(output_, next_solution_id_, row_indices, row_count);
+    }
+    else if (next_solution_id_ <= UINT32_MAX)
+    {
+        status = detail::write_solution_row(output_, static_cast<uint32_t>(next_solution_id_), row_indices, row_count);
+    }
+    if (status == 0)
+    {
+        next_solution_id_ += 1;
+    }
+    return status;
+}
+
+int DlxSolutionStreamWriter::finish()
+{
+    return finish(DlxSolveStatus{DLX_SOLVE_COMPLETE, next_solution_id_ - 1, 0});
+}
+
+int DlxSolutionStreamWriter::finish(const DlxSolveStatus& status)
+{
+    if (!started_ || finished_)
+    {
+        return 0;
+    }
+
+    finished_ = true;
+    const int written = compact_ ? encoder_.terminate(output_) : detail::write_solution_row(output_, 0, nullptr, 0);
+    if (written != 0 || (has_status_ && detail::write_solve_status(output_, status) != 0))
+    {
+        return -1;
+    }
+    return output_.flush();
+}
+
+int detail::write_cover_header(DlxBlockWriter& output, const struct DlxCoverHeader* header)
+{
+    if (header == NULL || !detail::is_supported(*header))
+    {
+        return -1;
+    }
+
+    struct DlxCoverHeader writable = *header;
+    writable.magic = detail::dlx_htonl(header->magic);
+    writable.version = detail::dlx_htons(header->version);
+    writable.flags = detail::dlx_htons(header->flags);
+    writable.column_count = detail::dlx_htonl(header->column_count);
+    writable.row_count = detail::dlx_htonl(header->row_count);
+
+    return output.write(&writable, sizeof(writable));
+}
+
+int detail::read_cover_header(DlxBlockReader& input, struct DlxCoverHeader* header)
+{
+    if (header == NULL)
+    {
+        return -1;
+    }
+
+    const char* bytes = input.take(sizeof(struct DlxCoverHeader));
+    if (bytes == NULL)
+    {
+        return -1;
+    }
+
+    struct DlxCoverHeader readable;
+    memcpy(&readable, bytes, sizeof(readable));
+    header->magic = detail::dlx_ntohl(readable.magic);
+    header->version = detail::dlx_ntohs(readable.version);
+    header->flags = detail::dlx_ntohs(readable.flags);
+    header->column_count = detail::dlx_ntohl(readable.column_count);
+    header->row_count = detail::dlx_ntohl(readable.row_count);
+    return detail::is_supported(*header) ? 0 : -1;
+}
+
+int detail::write_assumption_block(DlxBlockWriter& output, const dlx::SearchAssumptions& assumptions, bool native)
+{
+    if (assumptions.forced_rows.size() > UINT32_MAX || assumptions.forbidden_rows.size() > UINT32_MAX)
+    {
+        return -1;
+    }
+
+    uint32_t counts[2] = {
+        static_cast<uint32_t>(assumptions.forced_rows.size()),
+        static_cast<uint32_t>(assumptions.forbidden_rows.size()),
+    };
+
+    const bool big_endian = !native;
+    if (output.write_u32_array(counts, 2, big_endian) != 0
+        || output.write_u32_array(assumptions.forced_rows.data(), assumptions.forced_rows.size(), big_endian) != 0
+        || output.write_u32_array(assumptions.forbidden_rows.data(), assumptions.forbidden_rows.size(), big_endian) != 0)
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+int detail::read_assumption_block(DlxBlockReader& input, dlx::SearchAssumptions* assumptions, bool native)
+{
+    if (assumptions == NULL)
+    {
+        return -1;
+    }
+
+    const uint32_t* counts_host = input.take_u32_array(2, !native);
+    if (counts_host == NULL)
+    {
+        return -1;
+    }
+    const uint32_t counts[2] = {counts_host[0], counts_host[1]};
+
+    // Lists are decoded in bounded batches so a corrupt count fails at end of stream instead of
+    // requesting one enormous buffer up front.
+    constexpr size_t kBatch = 16384;
+    std::vector<uint32_t>* lists[2] = {&assumptions->forced_rows, &assumptions->forbidden_rows};
+    for (int list = 0; list < 2; list++)
+    {
+        lists[list]->clear();
+        size_t remaining = counts[list];
+        while (remaining > 0)
+        {
+            const size_t batch = std::min(remaining, kBatch);
+            const uint32_t* values = input.take_u32_array(batch, !native);
+            if (values == NULL)
+            {
+                return -1;
+            }
+            lists[list]->insert(lists[list]->end(), values, values + batch);
+            remaining -= batch;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Encodes one id/count-prefixed u32 array (a cover row or a solution row) straight into the block buffer.
+ *
+ * Native rows are little-endian and pad the count to 32 bits so the values stay 4-byte aligned.
+ */
+int detail::write_u32_row(DlxBlockWriter& output, uint32_t id, const uint32_t* values, uint16_t count, bool native)
+{
+    if (count > 0 && values == NULL)
+    {
+        return -1;
+    }
+
+    const size_t prefix = native ? 2 * sizeof(uint32_t) : sizeof(uint32_t) + sizeof(uint16_t);
+    const size_t bytes = prefix + sizeof(uint32_t) * count;
+    char* slot = output.reserve(bytes);
+    if (slot == NULL)
+    {
+        return -1;
+    }
+
+    uint32_t id_encoded = native ? detail::dlx_htole32(id) : detail::dlx_htonl(id);
+    uint16_t count_encoded[2] = {native ? detail::dlx_htole16(count) : detail::dlx_htons(count), 0};
+    memcpy(slot, &id_encoded, sizeof(id_encoded));
+    memcpy(slot + sizeof(id_encoded), count_encoded, prefix - sizeof(id_encoded));
+    dlx_convert_u32_copy(slot + prefix, values, count, !native);
+    output.commit(bytes);
+    return 0;
+}
+
+/**
+ * Consumes the id and count that prefix a cover or solution row.
+ *
+ * @return int 1 when both were read, 0 when the stream ended cleanly before the row, or -1 on a truncated prefix.
+ */
+int detail::read_row_prefix(DlxBlockReader& input, uint32_t* id, uint16_t* count, bool native)
+{
+    const char* id_bytes = input.take(sizeof(uint32_t));
+    if (id_bytes == NULL)
+    {
+        return input.eof() ? 0 : -1; // No more rows.
+    }
+
+    uint32_t id_net;
+    memcpy(&id_net, id_bytes, sizeof(id_net));
+
+    const char* count_bytes = input.take(native ? sizeof(uint32_t) : sizeof(uint16_t));
+    if (count_bytes == NULL)
+    {
+        return -1;
+    }
+
+    uint16_t count_net;
+    memcpy(&count_net, count_bytes, sizeof(count_net));
+    *id = native ? detail::dlx_htole32(id_net) : detail::dlx_ntohl(id_net);
+    *count = native ? detail::dlx_htole16(count_net) : detail::dlx_ntohs(count_net);
+    return 1;
+}
+
+int detail::write_row_chunk(DlxBlockWriter& output,
+                            uint32_t row_id,
+                            const uint32_t* columns,
+                            uint16_t column_count,
+                            bool native)
+{
+    return detail::write_u32_row(output, row_id, columns, column_count, native);
+}
+
+/**
+ * Writes one cover row either as a fixed-width chunk or, when @p blocks is set, into the open compressed
+ * block, flushing the block once it is full.
+ */
+int detail::write_cover_row(DlxBlockWriter& output,
+                            DlxCoverBlockEncoder* blocks,
+                            uint32_t row_id,
+                            const uint32_t* columns,
+                            uint16_t column_count,
+                            bool native)
+{
+    if (blocks == NULL)
+    {
+        return detail::write_row_chunk(output, row_id, columns, column_count, native);
+    }
+
+    if (blocks->add_row(row_id, columns, column_count) != 0)
+    {
+        return -1;
+    }
+    return blocks->full() ? blocks->flush(output) : 0;
+}
+
+int detail::ensure_chunk_capacity(struct DlxRowChunk* chunk, uint16_t required)
 {
-    if (!started_ || finished_)
+    if (chunk->capacity >= required)
     {
-        return -1;
+        return 0;
     }
 
-    int status = detail::write_solution_row(*output_, next_solution_id_, row_indices, row_count);
-    if (status == 0)
+    uint16_t new_capacity = chunk->capacity == 0 ? required : chunk->capacity;
+    while (new_capacity < required)
     {
-        next_solution_id_ += 1;
+        if (new_capacity > UINT16_MAX / 2)
+        {
+            new_capacity = required;
+            break;
+        }
+        new_capacity *= 2;
     }
-    return status;
+
+    uint32_t* new_columns = static_cast<uint32_t*>(
+        realloc(chunk->columns, sizeof(uint32_t) * new_capacity));
+    if (new_columns == NULL)
+    {
+        return -1;
+    }
+
+    chunk->columns = new_columns;
+    chunk->capacity = new_capacity;
+    return 0;
 }
 
-int DlxSolutionStreamWriter::finish()
+int detail::read_row_span(DlxBlockReader& input, struct DlxRowSpan* span, bool native)
 {
-    if (!started_ || finished_)
+    if (span == NULL)
     {
-        return 0;
+        return -1;
     }
 
-    finished_ = true;
-    return detail::write_solution_row(*output_, 0, nullptr, 0);
+    uint32_t row_id = 0;
+    uint16_t entry_count = 0;
+    int status = detail::read_row_prefix(input, &row_id, &entry_count, native);
+    if (status != 1)
+    {
+        return status;
+    }
+
+    // Columns are converted inside the reader's buffer and handed back without a copy.
+    const uint32_t* columns = input.take_u32_array(entry_count, !native);
+    if (columns == NULL)
+    {
+        return -1;
+    }
+
+    span->row_id = row_id;
+    span->entry_count = entry_count;
+    span->columns = columns;
+    return 1;
 }
 
-int detail::write_cover_header(std::ostream& output, const struct DlxCoverHeader* header)
+int detail::read_row_chunk(DlxBlockReader& input, struct DlxRowChunk* chunk, bool native)
 {
-    if (header == NULL)
+    if (chunk == NULL)
     {
         return -1;
     }
 
-    struct DlxCoverHeader writable = *header;
-    writable.magic = detail::dlx_htonl(header->magic);
-    writable.version = detail::dlx_htons(header->version);
-    writable.flags = detail::dlx_htons(header->flags);
-    writable.column_count = detail::dlx_htonl(header->column_count);
-    writable.row_count = detail::dlx_htonl(header->row_count);
+    uint32_t row_id = 0;
+    uint16_t entry_count = 0;
+    int status = detail::read_row_prefix(input, &row_id, &entry_count, native);
+    if (status != 1)
+    {
+        return status;
+    }
+
+    if (detail::ensure_chunk_capacity(chunk, entry_count) != 0)
+    {
+        return -1;
+    }
 
-    detail::StreamBinaryWriter writer(output);
-    return writer.write_exact(&writable, sizeof(writable)) ? 0 : -1;
+    const char* columns = input.take(sizeof(uint32_t) * entry_count);
+    if (columns == NULL)
+    {
+        return -1;
+    }
+    dlx_convert_u32_copy(chunk->columns, columns, entry_count, !native);
+
+    chunk->row_id = row_id;
+    chunk->entry_count = entry_count;
+    return 1;
 }
 
-int detail::read_cover_header(std::istream& input, struct DlxCoverHeader* header)
+int detail::read_row_into(DlxBlockReader& input, struct DlxCsrProblem* problem, bool native)
 {
-    if (header == NULL)
+    if (problem == NULL)
     {
         return -1;
     }
 
-    detail::StreamBinaryReader reader(input);
-    struct DlxCoverHeader readable;
-    if (!reader.read_exact(&readable, sizeof(readable)))
+    uint32_t row_id = 0;
+    uint16_t entry_count = 0;
+    int status = detail::read_row_prefix(input, &row_id, &entry_count, native);
+    if (status != 1)
+    {
+        return status;
+    }
+
+    // Columns are converted on their single copy from the block buffer into the arena.
+    const char* encoded = input.take(sizeof(uint32_t) * entry_count);
+    uint32_t* columns = (encoded == NULL) ? NULL : problem->prepare_row(entry_count);
+    if (columns == NULL)
     {
         return -1;
     }
+    dlx_convert_u32_copy(columns, encoded, entry_count, !native);
 
-    header->magic = detail::dlx_ntohl(readable.magic);
-    header->version = detail::dlx_ntohs(readable.version);
-    header->flags = detail::dlx_ntohs(readable.flags);
-    header->column_count = detail::dlx_ntohl(readable.column_count);
-    header->row_count = detail::dlx_ntohl(readable.row_count);
-    return 0;
+    problem->commit_row(row_id, entry_count);
+    return 1;
+}
+
+int detail::write_problem_index(DlxBlockWriter& output, uint32_t problem_index)
+{
+    return output.write_u32_array(&problem_index, 1);
 }
 
-int detail::write_row_chunk(std::ostream& output, uint32_t row_id, const uint32_t* columns, uint16_t column_count)
+int detail::read_problem_index(DlxBlockReader& input, uint32_t* problem_index)
 {
-    if (column_count > 0 && columns == NULL)
+    const uint32_t* index = input.take_u32_array(1);
+    if (index == NULL)
     {
         return -1;
     }
 
-    uint32_t row_id_net = detail::dlx_htonl(row_id);
-    uint16_t entry_count_net = detail::dlx_htons(column_count);
+    *problem_index = *index;
+    return 0;
+}
+
+int detail::write_solve_options(DlxBlockWriter& output, const struct DlxSolveOptions& options)
+{
+    const uint32_t words[DLX_SOLVE_OPTIONS_WORDS] = {
+        static_cast<uint32_t>(options.solution_limit >> 32),
+        static_cast<uint32_t>(options.solution_limit),
+        static_cast<uint32_t>(options.node_budget >> 32),
+        static_cast<uint32_t>(options.node_budget),
+        options.deadline_ms,
+        (static_cast<uint32_t>(options.flags) << 16) | options.engine,
+    };
+    return output.write_u32_array(words, DLX_SOLVE_OPTIONS_WORDS);
+}
 
-    detail::StreamBinaryWriter writer(output);
-    if (!writer.write_exact(&row_id_net, sizeof(row_id_net)))
+int detail::read_solve_options(DlxBlockReader& input, struct DlxSolveOptions* options)
+{
+    const uint32_t* words = input.take_u32_array(DLX_SOLVE_OPTIONS_WORDS);
+    if (words == NULL)
     {
         return -1;
     }
 
-    if (!writer.write_exact(&entry_count_net, sizeof(entry_count_net)))
+    *options = detail::unpack_solve_options(words);
+    return 0;
+}
+
+int detail::write_solve_status(DlxBlockWriter& output, const struct DlxSolveStatus& status)
+{
+    const uint32_t words[DLX_SOLVE_STATUS_WORDS] = {
+        status.code,
+        static_cast<uint32_t>(status.solutions >> 32),
+        static_cast<uint32_t>(status.solutions),
+        static_cast<uint32_t>(status.nodes >> 32),
+        static_cast<uint32_t>(status.nodes),
+    };
+    return output.write_u32_array(words, DLX_SOLVE_STATUS_WORDS);
+}
+
+int detail::read_solve_status(DlxBlockReader& input, struct DlxSolveStatus* status)
+{
+    const uint32_t* words = input.take_u32_array(DLX_SOLVE_STATUS_WORDS);
+    if (words == NULL)
     {
         return -1;
     }
 
-    for (uint16_t i = 0; i < column_count; i++)
+    status->code = words[0];
+    status->solutions = (static_cast<uint64_t>(words[1]) << 32) | words[2];
+    status->nodes = (static_cast<uint64_t>(words[3]) << 32) | words[4];
+    return 0;
+}
+
+void detail::free_row_chunk(struct DlxRowChunk* chunk)
+{
+    if (chunk == NULL)
+    {
+        return;
+    }
+
+    free(chunk->columns);
+    chunk->columns = NULL;
+    chunk->entry_count = 0;
+    chunk->capacity = 0;
+}
+
+/**
+ * Starts the next row of a compressed cover, pulling in the next block when the current one is used up.
+ *
+ * @return int 1 when a row's id and count were decoded (its columns follow through @p block), 0 once the
+ *         terminator and block index have been consumed, or -1 on a truncated or malformed body.
+ */
+int detail::read_compressed_prefix(DlxBlockReader& input, DlxCoverBlockDecoder& block, uint32_t* row_id, uint16_t* count)
+{
+    if (block.done())
     {
-        uint32_t col_net = detail::dlx_htonl(columns[i]);
-        if (!writer.write_exact(&col_net, sizeof(col_net)))
+        const char* bytes = input.take(DLX_COVER_BLOCK_HEADER_BYTES);
+        if (bytes == NULL)
+        {
+            return -1;
+        }
+
+        const struct DlxCoverBlockHeader header = dlx_decode_block_header(bytes);
+        if (header.payload_bytes > DLX_COVER_BLOCK_MAX_BYTES)
+        {
+            return -1;
+        }
+
+        // The payload stays in the reader's buffer until the block is used up; nothing else is taken meanwhile.
+        // Every data block is followed by at least the terminator's header, so it is read in the same call.
+        input.expect(header.payload_bytes + (header.row_count == 0 ? 0 : DLX_COVER_BLOCK_HEADER_BYTES));
+        const char* payload = input.take(header.payload_bytes);
+        if (payload == NULL)
         {
             return -1;
         }
+        if (header.row_count == 0)
+        {
+            return 0; // Terminator; its payload is the block index, which sequential readers skip.
+        }
+        block.reset(payload, header);
     }
 
-    return 0;
+    return block.next_row(row_id, count) == 0 ? 1 : -1;
 }
 
-int detail::ensure_chunk_capacity(struct DlxRowChunk* chunk, uint16_t required)
+int detail::write_solution_header(DlxBlockWriter& output, const struct DlxSolutionHeader* header)
 {
-    if (chunk->capacity >= required)
+    if (header == NULL || !detail::is_supported(*header))
+    {
+        return -1;
+    }
+
+    struct DlxSolutionHeader writable = *header;
+    writable.magic = detail::dlx_htonl(header->magic);
+    writable.version = detail::dlx_htons(header->version);
+    writable.flags = detail::dlx_htons(header->flags);
+    writable.column_count = detail::dlx_htonl(header->column_count);
+
+    return output.write(&writable, sizeof(writable));
+}
+
+int detail::read_solution_header(DlxBlockReader& input, struct DlxSolutionHeader* header)
+{
+    if (header == NULL)
+    {
+        return -1;
+    }
+
+    const char* bytes = input.take(sizeof(struct DlxSolutionHeader));
+    if (bytes == NULL)
+    {
+        return -1;
+    }
+
+    struct DlxSolutionHeader readable;
+    memcpy(&readable, bytes, sizeof(readable));
+    header->magic = detail::dlx_ntohl(readable.magic);
+    header->version = detail::dlx_ntohs(readable.version);
+    header->flags = detail::dlx_ntohs(readable.flags);
+    header->column_count = detail::dlx_ntohl(readable.column_count);
+    return detail::is_supported(*header) ? 0 : -1;
+}
+
+int detail::write_solution_row(DlxBlockWriter& output,
+                               uint32_t solution_id,
+                               const uint32_t* row_indices,
+                               uint16_t row_count)
+{
+    return detail::write_u32_row(output, solution_id, row_indices, row_count, false);
+}
+
+int detail::ensure_solution_capacity(struct DlxSolutionRow* row, uint16_t required)
+{
+    if (row->capacity >= required)
     {
         return 0;
     }
 
-    uint16_t new_capacity = chunk->capacity == 0 ? required : chunk->capacity;
+    uint16_t new_capacity = row->capacity == 0 ? required : row->capacity;
     while (new_capacity < required)
     {
         if (new_capacity > UINT16_MAX / 2)
@@ -473,147 +1917,234 @@ int detail::ensure_chunk_capacity(struct DlxRowChunk* chunk, uint16_t required)
             new_capacity = required;
             break;
         }
+
         new_capacity *= 2;
     }
 
-    uint32_t* new_columns = static_cast<uint32_t*>(
-        realloc(chunk->columns, sizeof(uint32_t) * new_capacity));
-    if (new_columns == NULL)
+    uint32_t* new_indices = static_cast<uint32_t*>(
+        realloc(row->row_indices, sizeof(uint32_t) * new_capacity));
+    if (new_indices == NULL)
     {
         return -1;
     }
 
-    chunk->columns = new_columns;
-    chunk->capacity = new_capacity;
+    row->row_indices = new_indices;
+    row->capacity = new_capacity;
     return 0;
 }
 
-int detail::read_row_chunk(std::istream& input, struct DlxRowChunk* chunk)
+int detail::read_solution_row(DlxBlockReader& input, struct DlxSolutionRow* row)
 {
-    if (chunk == NULL)
+    if (row == NULL)
     {
         return -1;
     }
 
-    detail::StreamBinaryReader reader(input);
-
-    uint32_t row_id_net;
-    if (!reader.read_exact(&row_id_net, sizeof(row_id_net)))
+    uint32_t solution_id = 0;
+    uint16_t count = 0;
+    int status = detail::read_row_prefix(input, &solution_id, &count, false);
+    if (status != 1)
     {
-        if (reader.eof())
+        if (status == 0)
         {
-            return 0; // No more rows.
+            row->entry_count = 0;
         }
+        return status;
+    }
+
+    if (detail::ensure_solution_capacity(row, count) != 0)
+    {
         return -1;
     }
 
-    uint16_t entry_count_net;
-    if (!reader.read_exact(&entry_count_net, sizeof(entry_count_net)))
+    const char* indices = input.take(sizeof(uint32_t) * count);
+    if (indices == NULL)
     {
         return -1;
     }
+    dlx_byteswap_u32_copy(row->row_indices, indices, count);
 
-    uint16_t entry_count = detail::dlx_ntohs(entry_count_net);
-    if (detail::ensure_chunk_capacity(chunk, entry_count) != 0)
+    row->solution_id = solution_id;
+    row->entry_count = count;
+    return 1;
+}
+
+void detail::free_solution_row(struct DlxSolutionRow* row)
+{
+    if (row == NULL)
+    {
+        return;
+    }
+
+    free(row->row_indices);
+    row->row_indices = NULL;
+    row->entry_count = 0;
+    row->capacity = 0;
+}
+
+int dlx_read_problem(std::istream& input, struct DlxProblem* problem)
+{
+    if (problem == NULL)
+    {
+        return -1;
+    }
+
+    problem->clear();
+    DlxBlockReader reader(input, detail::shared_read_ahead(input));
+
+    if (detail::read_cover_header(reader, &problem->header) != 0)
+    {
+        return -1;
+    }
+
+    if ((problem->header.flags & DLX_COVER_FLAG_PROBLEM_ID) != 0
+        && detail::read_problem_index(reader, &problem->problem_id) != 0)
+    {
+        problem->clear();
+        return -1;
+    }
+
+    if ((problem->header.flags & DLX_COVER_FLAG_OPTIONS) != 0
+        && detail::read_solve_options(reader, &problem->options) != 0)
+    {
+        problem->clear();
+        return -1;
+    }
+
+    if ((problem->header.flags & DLX_COVER_FLAG_ASSUMPTIONS) != 0
+        && detail::read_assumption_block(reader, &problem->assumptions, detail::is_native(problem->header)) != 0)
     {
+        problem->clear();
         return -1;
     }
 
-    for (uint16_t i = 0; i < entry_count; i++)
+    if ((problem->header.flags & DLX_COVER_FLAG_REUSE_MATRIX) != 0)
+    {
+        return 0;
+    }
+
+    if (detail::is_compressed(problem->header))
     {
-        uint32_t column_net;
-        if (!reader.read_exact(&column_net, sizeof(column_net)))
+        DlxCoverBlockDecoder block;
+        problem->rows.reserve(problem->header.row_count);
+        while (true)
         {
-            return -1;
+            uint32_t row_id = 0;
+            uint16_t entry_count = 0;
+            int status = detail::read_compressed_prefix(reader, block, &row_id, &entry_count);
+            if (status == 0)
+            {
+                return 0;
+            }
+
+            DlxRowChunk chunk = {0};
+            if (status != 1 || detail::ensure_chunk_capacity(&chunk, entry_count) != 0
+                || block.read_columns(chunk.columns, entry_count) != 0)
+            {
+                detail::free_row_chunk(&chunk);
+                problem->clear();
+                return -1;
+            }
+            chunk.row_id = row_id;
+            chunk.entry_count = entry_count;
+            problem->rows.push_back(chunk);
         }
-        chunk->columns[i] = detail::dlx_ntohl(column_net);
     }
 
-    chunk->row_id = detail::dlx_ntohl(row_id_net);
-    chunk->entry_count = entry_count;
-    return 1;
-}
+    if (problem->header.row_count > 0)
+    {
+        problem->rows.resize(problem->header.row_count);
+    }
 
-void detail::free_row_chunk(struct DlxRowChunk* chunk)
-{
-    if (chunk == NULL)
+    for (uint32_t i = 0; i < problem->header.row_count; i++)
     {
-        return;
+        int status = detail::read_row_chunk(reader, &problem->rows[i], detail::is_native(problem->header));
+        if (status != 1)
+        {
+            problem->clear();
+            return -1;
+        }
     }
 
-    free(chunk->columns);
-    chunk->columns = NULL;
-    chunk->entry_count = 0;
-    chunk->capacity = 0;
+    return 0;
 }
 
-int detail::write_solution_header(std::ostream& output, const struct DlxSolutionHeader* header)
+int dlx_read_problem(std::istream& input, struct DlxCsrProblem* problem)
 {
-    if (header == NULL)
+    if (problem == NULL)
     {
         return -1;
     }
 
-    struct DlxSolutionHeader writable = *header;
-    writable.magic = detail::dlx_htonl(header->magic);
-    writable.version = detail::dlx_htons(header->version);
-    writable.flags = detail::dlx_htons(header->flags);
-    writable.column_count = detail::dlx_htonl(header->column_count);
-
-    detail::StreamBinaryWriter writer(output);
-    return writer.write_exact(&writable, sizeof(writable)) ? 0 : -1;
-}
+    problem->clear();
+    DlxBlockReader reader(input, detail::shared_read_ahead(input));
 
-int detail::read_solution_header(std::istream& input, struct DlxSolutionHeader* header)
-{
-    if (header == NULL)
+    if (detail::read_cover_header(reader, &problem->header) != 0)
     {
         return -1;
     }
 
-    detail::StreamBinaryReader reader(input);
-    struct DlxSolutionHeader readable;
-    if (!reader.read_exact(&readable, sizeof(readable)))
+    if ((problem->header.flags & DLX_COVER_FLAG_PROBLEM_ID) != 0
+        && detail::read_problem_index(reader, &problem->problem_id) != 0)
     {
+        problem->clear();
         return -1;
     }
 
-    header->magic = detail::dlx_ntohl(readable.magic);
-    header->version = detail::dlx_ntohs(readable.version);
-    header->flags = detail::dlx_ntohs(readable.flags);
-    header->column_count = detail::dlx_ntohl(readable.column_count);
-    return 0;
-}
+    if ((problem->header.flags & DLX_COVER_FLAG_OPTIONS) != 0
+        && detail::read_solve_options(reader, &problem->options) != 0)
+    {
+        problem->clear();
+        return -1;
+    }
 
-int detail::write_solution_row(std::ostream& output,
-                           uint32_t solution_id,
-                           const uint32_t* row_indices,
-                           uint16_t row_count)
-{
-    if (row_count > 0 && row_indices == NULL)
+    if ((problem->header.flags & DLX_COVER_FLAG_ASSUMPTIONS) != 0
+        && detail::read_assumption_block(reader, &problem->assumptions, detail::is_native(problem->header)) != 0)
     {
+        problem->clear();
         return -1;
     }
 
-    uint32_t id_net = detail::dlx_htonl(solution_id);
-    uint16_t count_net = detail::dlx_htons(row_count);
+    if ((problem->header.flags & DLX_COVER_FLAG_REUSE_MATRIX) != 0)
+    {
+        return 0;
+    }
 
-    detail::StreamBinaryWriter writer(output);
-    if (!writer.write_exact(&id_net, sizeof(id_net)))
+    if (problem->reserve(problem->header.row_count, 0) != 0)
     {
+        problem->clear();
         return -1;
     }
 
-    if (!writer.write_exact(&count_net, sizeof(count_net)))
+    if (detail::is_compressed(problem->header))
     {
-        return -1;
+        DlxCoverBlockDecoder block;
+        while (true)
+        {
+            uint32_t row_id = 0;
+            uint16_t entry_count = 0;
+            int status = detail::read_compressed_prefix(reader, block, &row_id, &entry_count);
+            if (status == 0)
+            {
+                return 0;
+            }
+
+            uint32_t* columns = (status == 1) ? problem->prepare_row(entry_count) : NULL;
+            if (columns == NULL || block.read_columns(columns, entry_count) != 0)
+            {
+                problem->clear();
+                return -1;
+            }
+            problem->commit_row(row_id, entry_count);
+        }
     }
 
-    for (uint16_t i = 0; i < row_count; i++)
+    for (uint32_t i = 0; i < problem->header.row_count; i++)
     {
-        uint32_t value_net = detail::dlx_htonl(row_indices[i]);
-        if (!writer.write_exact(&value_net, sizeof(value_net)))
+        int status = detail::read_row_into(reader, problem, detail::is_native(problem->header));
+        if (status != 1)
         {
+            problem->clear();
             return -1;
         }
     }
@@ -621,128 +2152,203 @@ int detail::write_solution_row(std::ostream& output,
     return 0;
 }
 
-int detail::ensure_solution_capacity(struct DlxSolutionRow* row, uint16_t required)
+/**
+ * Decodes a whole version 2 problem from memory, splitting its blocks across worker threads.
+ *
+ * @param const char* Bytes of exactly one problem, e.g. a mapped single-problem file.
+ * @param size_t Number of bytes at @p data.
+ * @param DlxCsrProblem* Destination, sized once from the block headers.
+ * @param unsigned int Worker threads; 0 uses every hardware thread.
+ * @return int 0 on success, -1 when the buffer is not a well-formed version 2 problem.
+ */
+int dlx_decode_problem(const char* data, size_t size, struct DlxCsrProblem* problem, unsigned int workers)
 {
-    if (row->capacity >= required)
-    {
-        return 0;
-    }
-
-    uint16_t new_capacity = row->capacity == 0 ? required : row->capacity;
-    while (new_capacity < required)
+    if (data == NULL || problem == NULL || size < sizeof(struct DlxCoverHeader))
     {
-        if (new_capacity > UINT16_MAX / 2)
-        {
-            new_capacity = required;
-            break;
-        }
-
-        new_capacity *= 2;
+        return -1;
     }
 
-    uint32_t* new_indices = static_cast<uint32_t*>(
-        realloc(row->row_indices, sizeof(uint32_t) * new_capacity));
-    if (new_indices == NULL)
+    problem->clear();
+    struct DlxCoverHeader header;
+    memcpy(&header, data, sizeof(header));
+    header.magic = detail::dlx_ntohl(header.magic);
+    header.version = detail::dlx_ntohs(header.version);
+    header.flags = detail::dlx_ntohs(header.flags);
+    header.column_count = detail::dlx_ntohl(header.column_count);
+    header.row_count = detail::dlx_ntohl(header.row_count);
+    if (!detail::is_compressed(header))
     {
         return -1;
     }
 
-    row->row_indices = new_indices;
-    row->capacity = new_capacity;
-    return 0;
-}
+    auto load_u32 = [&](size_t at) {
+        uint32_t value;
+        memcpy(&value, data + at, sizeof(value));
+        return detail::dlx_ntohl(value);
+    };
 
-int detail::read_solution_row(std::istream& input, struct DlxSolutionRow* row)
-{
-    if (row == NULL)
+    size_t cursor = sizeof(struct DlxCoverHeader);
+    uint32_t problem_id = 0;
+    if ((header.flags & DLX_COVER_FLAG_PROBLEM_ID) != 0)
     {
-        return -1;
+        if (size - cursor < sizeof(uint32_t))
+        {
+            return -1;
+        }
+        problem_id = load_u32(cursor);
+        cursor += sizeof(uint32_t);
     }
 
-    detail::StreamBinaryReader reader(input);
-
-    uint32_t solution_id_net;
-    uint16_t count_net;
+    struct DlxSolveOptions options = {0};
+    if ((header.flags & DLX_COVER_FLAG_OPTIONS) != 0)
+    {
+        if (size - cursor < DLX_SOLVE_OPTIONS_WORDS * sizeof(uint32_t))
+        {
+            return -1;
+        }
+        uint32_t words[DLX_SOLVE_OPTIONS_WORDS];
+        for (size_t i = 0; i < DLX_SOLVE_OPTIONS_WORDS; i++)
+        {
+            words[i] = load_u32(cursor + i * sizeof(uint32_t));
+        }
+        options = detail::unpack_solve_options(words);
+        cursor += sizeof(words);
+    }
 
-    if (!reader.read_exact(&solution_id_net, sizeof(solution_id_net)))
+    dlx::SearchAssumptions assumptions;
+    if ((header.flags & DLX_COVER_FLAG_ASSUMPTIONS) != 0)
     {
-        if (reader.eof())
+        if (size - cursor < 2 * sizeof(uint32_t))
         {
-            row->entry_count = 0;
-            return 0;
+            return -1;
+        }
+        const uint32_t counts[2] = {load_u32(cursor), load_u32(cursor + sizeof(uint32_t))};
+        cursor += 2 * sizeof(uint32_t);
+
+        std::vector<uint32_t>* lists[2] = {&assumptions.forced_rows, &assumptions.forbidden_rows};
+        for (int list = 0; list < 2; list++)
+        {
+            if ((size - cursor) / sizeof(uint32_t) < counts[list])
+            {
+                return -1;
+            }
+            lists[list]->resize(counts[list]);
+            dlx_convert_u32_copy(lists[list]->data(), data + cursor, counts[list], true);
+            cursor += sizeof(uint32_t) * counts[list];
         }
-        return -1;
     }
 
-    if (!reader.read_exact(&count_net, sizeof(count_net)))
+    // The index ends the buffer: u64 offsets, block count, magic; the terminator header sits right before it.
+    const size_t body = cursor;
+    if (size - body < DLX_COVER_BLOCK_HEADER_BYTES + 2 * sizeof(uint32_t)
+        || load_u32(size - sizeof(uint32_t)) != DLX_COVER_INDEX_MAGIC)
     {
         return -1;
     }
-
-    uint16_t count = detail::dlx_ntohs(count_net);
-    if (detail::ensure_solution_capacity(row, count) != 0)
+    const size_t block_count = load_u32(size - 2 * sizeof(uint32_t));
+    const size_t room = size - body - DLX_COVER_BLOCK_HEADER_BYTES - 2 * sizeof(uint32_t);
+    if (block_count > room / sizeof(uint64_t))
+    {
+        return -1;
+    }
+    const size_t index_bytes = block_count * sizeof(uint64_t) + 2 * sizeof(uint32_t);
+    const size_t terminator = size - index_bytes - DLX_COVER_BLOCK_HEADER_BYTES;
+    const struct DlxCoverBlockHeader end = dlx_decode_block_header(data + terminator);
+    if (end.row_count != 0 || end.entry_count != 0 || end.payload_bytes != index_bytes)
     {
         return -1;
     }
 
-    for (uint16_t i = 0; i < count; i++)
+    // Blocks must tile the body exactly, which also keeps every worker's writes inside its own rows.
+    struct Block
+    {
+        const char* payload;
+        struct DlxCoverBlockHeader header;
+        size_t first_row;
+        uint64_t first_entry;
+    };
+    std::vector<Block> blocks(block_count);
+    size_t expected = body;
+    size_t rows = 0;
+    uint64_t entries = 0;
+    for (size_t i = 0; i < block_count; i++)
     {
-        uint32_t value_net;
-        if (!reader.read_exact(&value_net, sizeof(value_net)))
+        const size_t at = terminator + DLX_COVER_BLOCK_HEADER_BYTES + i * sizeof(uint64_t);
+        const uint64_t offset = (static_cast<uint64_t>(load_u32(at)) << 32) | load_u32(at + sizeof(uint32_t));
+        if (offset != expected - body || terminator - expected < DLX_COVER_BLOCK_HEADER_BYTES)
         {
             return -1;
         }
-
-        row->row_indices[i] = detail::dlx_ntohl(value_net);
+        blocks[i].header = dlx_decode_block_header(data + expected);
+        blocks[i].payload = data + expected + DLX_COVER_BLOCK_HEADER_BYTES;
+        blocks[i].first_row = rows;
+        blocks[i].first_entry = entries;
+        if (blocks[i].header.row_count == 0
+            || blocks[i].header.payload_bytes > terminator - expected - DLX_COVER_BLOCK_HEADER_BYTES)
+        {
+            return -1;
+        }
+        expected += DLX_COVER_BLOCK_HEADER_BYTES + blocks[i].header.payload_bytes;
+        rows += blocks[i].header.row_count;
+        entries += blocks[i].header.entry_count;
     }
-
-    row->solution_id = detail::dlx_ntohl(solution_id_net);
-    row->entry_count = count;
-    return 1;
-}
-
-void detail::free_solution_row(struct DlxSolutionRow* row)
-{
-    if (row == NULL)
+    if (expected != terminator || rows > UINT32_MAX || problem->resize(rows, entries) != 0)
     {
-        return;
+        return -1;
     }
 
-    free(row->row_indices);
-    row->row_indices = NULL;
-    row->entry_count = 0;
-    row->capacity = 0;
-}
-
-int dlx_read_problem(std::istream& input, struct DlxProblem* problem)
-{
-    if (problem == NULL)
+    if (workers == 0)
     {
-        return -1;
+        workers = std::max(1u, std::thread::hardware_concurrency());
     }
+    workers = static_cast<unsigned int>(std::min<size_t>(workers, std::max<size_t>(block_count, 1)));
 
-    problem->clear();
+    std::atomic<size_t> next_block(0);
+    std::atomic<bool> failed(false);
+    auto decode_blocks = [&]() {
+        DlxCoverBlockDecoder decoder;
+        for (size_t i = next_block++; i < block_count && !failed; i = next_block++)
+        {
+            const Block& block = blocks[i];
+            decoder.reset(block.payload, block.header);
+            uint64_t first_entry = block.first_entry;
+            for (uint32_t row = 0; row < block.header.row_count; row++)
+            {
+                uint32_t row_id = 0;
+                uint16_t entry_count = 0;
+                if (decoder.next_row(&row_id, &entry_count) != 0
+                    || decoder.read_columns(problem->place_row(block.first_row + row, row_id, first_entry, entry_count),
+                                            entry_count)
+                           != 0)
+                {
+                    failed = true;
+                    break;
+                }
+                first_entry += entry_count;
+            }
+        }
+    };
 
-    if (detail::read_cover_header(input, &problem->header) != 0)
+    std::vector<std::thread> threads;
+    for (unsigned int i = 1; i < workers; i++)
     {
-        return -1;
+        threads.emplace_back(decode_blocks);
     }
-
-    if (problem->header.row_count > 0)
+    decode_blocks();
+    for (auto& thread : threads)
     {
-        problem->rows.resize(problem->header.row_count);
+        thread.join();
     }
 
-    for (uint32_t i = 0; i < problem->header.row_count; i++)
+    if (failed)
     {
-        int status = detail::read_row_chunk(input, &problem->rows[i]);
-        if (status != 1)
-        {
-            problem->clear();
-            return -1;
-        }
+        problem->clear();
+        return -1;
     }
-
+    problem->header = header;
+    problem->assumptions = std::move(assumptions);
+    problem->problem_id = problem_id;
+    problem->options = options;
     return 0;
 }
 
@@ -754,16 +2360,56 @@ int dlx_read_solution(std::istream& input, struct DlxSolution* solution)
     }
 
     solution->clear();
+    DlxBlockReader reader(input, detail::shared_read_ahead(input));
+
+    if (detail::read_solution_header(reader, &solution->header) != 0)
+    {
+        return -1;
+    }
 
-    if (detail::read_solution_header(input, &solution->header) != 0)
+    if ((solution->header.flags & DLX_SOLUTION_FLAG_PROBLEM_INDEX) != 0
+        && detail::read_problem_index(reader, &solution->problem_index) != 0)
     {
+        solution->clear();
         return -1;
     }
 
+    const bool has_status = (solution->header.flags & DLX_SOLUTION_FLAG_STATUS) != 0;
+
+    if (solution->header.version >= DLX_SOLUTION_VERSION_COMPACT)
+    {
+        DlxSolutionDecoder decoder;
+        decoder.reset((solution->header.flags & DLX_SOLUTION_FLAG_SORTED_ROWS) != 0,
+                      (solution->header.flags & DLX_SOLUTION_FLAG_EXPLICIT_IDS) != 0);
+        uint64_t solution_id = 0;
+        int status = 0;
+        while ((status = decoder.read(reader, &solution_id)) == 1)
+        {
+            DlxSolutionRow row = {0};
+            const auto& rows = decoder.rows();
+            if (detail::ensure_solution_capacity(&row, static_cast<uint16_t>(rows.size())) != 0)
+            {
+                detail::free_solution_row(&row);
+                status = -1;
+                break;
+            }
+            std::copy(rows.begin(), rows.end(), row.row_indices);
+            row.solution_id = solution_id;
+            row.entry_count = static_cast<uint16_t>(rows.size());
+            solution->rows.push_back(row);
+        }
+        if (status != 0 || (has_status && detail::read_solve_status(reader, &solution->status) != 0))
+        {
+            solution->clear();
+            return -1;
+        }
+        return 0;
+    }
+
     while (true)
     {
         DlxSolutionRow row = {0};
-        int status = detail::read_solution_row(input, &row);
+        int status = detail::read_solution_row(reader, &row);
         if (status == 0)
         {
             break;
@@ -778,6 +2424,11 @@ int dlx_read_solution(std::istream& input, struct DlxSolution* solution)
         if (row.solution_id == 0 && row.entry_count == 0)
         {
             detail::free_solution_row(&row);
+            if (has_status && detail::read_solve_status(reader, &solution->status) != 0)
+            {
+                solution->clear();
+                return -1;
+            }
             break;
         }
 
@@ -801,21 +2452,116 @@ int dlx_write_problem(std::ostream& output, const struct DlxProblem* problem)
 
     DlxCoverHeader header = problem->header;
     header.row_count = static_cast<uint32_t>(problem->rows.size());
+    if (!problem->assumptions.empty())
+    {
+        header.flags |= DLX_COVER_FLAG_ASSUMPTIONS;
+    }
+
+    DlxBlockWriter writer(output);
+    if (detail::write_cover_header(writer, &header) != 0)
+    {
+        return -1;
+    }
 
-    if (detail::write_cover_header(output, &header) != 0)
+    if ((header.flags & DLX_COVER_FLAG_PROBLEM_ID) != 0
+        && detail::write_problem_index(writer, problem->problem_id) != 0)
     {
         return -1;
     }
 
+    if ((header.flags & DLX_COVER_FLAG_OPTIONS) != 0 && detail::write_solve_options(writer, problem->options) != 0)
+    {
+        return -1;
+    }
+
+    if ((header.flags & DLX_COVER_FLAG_ASSUMPTIONS) != 0
+        && detail::write_assumption_block(writer, problem->assumptions, detail::is_native(header)) != 0)
+    {
+        return -1;
+    }
+
+    DlxCoverBlockEncoder encoder;
+    DlxCoverBlockEncoder* blocks = detail::is_compressed(header) ? &encoder : NULL;
     for (const auto& row : problem->rows)
     {
-        if (detail::write_row_chunk(output, row.row_id, row.columns, row.entry_count) != 0)
+        if (detail::write_cover_row(writer, blocks, row.row_id, row.columns, row.entry_count, detail::is_native(header))
+            != 0)
         {
             return -1;
         }
     }
 
-    return 0;
+    if (blocks != NULL && blocks->finish(writer) != 0)
+    {
+        return -1;
+    }
+    return writer.flush();
+}
+
+int dlx_write_problem(std::ostream& output, const struct DlxCsrProblem* problem)
+{
+    if (problem == NULL)
+    {
+        return -1;
+    }
+
+    if (problem->row_count() > UINT32_MAX)
+    {
+        return -1;
+    }
+
+    DlxCoverHeader header = problem->header;
+    header.row_count = static_cast<uint32_t>(problem->row_count());
+    if (!problem->assumptions.empty())
+    {
+        header.flags |= DLX_COVER_FLAG_ASSUMPTIONS;
+    }
+
+    DlxBlockWriter writer(output);
+    if (detail::write_cover_header(writer, &header) != 0)
+    {
+        return -1;
+    }
+
+    if ((header.flags & DLX_COVER_FLAG_PROBLEM_ID) != 0
+        && detail::write_problem_index(writer, problem->problem_id) != 0)
+    {
+        return -1;
+    }
+
+    if ((header.flags & DLX_COVER_FLAG_OPTIONS) != 0 && detail::write_solve_options(writer, problem->options) != 0)
+    {
+        return -1;
+    }
+
+    if ((header.flags & DLX_COVER_FLAG_ASSUMPTIONS) != 0
+        && detail::write_assumption_block(writer, problem->assumptions, detail::is_native(header)) != 0)
+    {
+        return -1;
+    }
+
+    DlxCoverBlockEncoder encoder;
+    DlxCoverBlockEncoder* blocks = detail::is_compressed(header) ? &encoder : NULL;
+    for (size_t i = 0; i < problem->row_count(); i++)
+    {
+        if (detail::write_cover_row(writer,
+                                    blocks,
+                                    problem->row_id(i),
+                                    problem->row_columns(i),
+                                    problem->row_size(i),
+                                    detail::is_native(header))
+            != 0)
+        {
+            return -1;
+        }
+    }
+
+    if (blocks != NULL && blocks->finish(writer) != 0)
+    {
+        return -1;
+    }
+
+    return writer.flush();
 }
 
 int dlx_write_solution(std::ostream& output, const struct DlxSolution* solution)
@@ -825,14 +2571,139 @@ int dlx_write_solution(std::ostream& output, const struct DlxSolution* solution)
         return -1;
     }
 
-    if (detail::write_solution_header(output, &solution->header) != 0)
+    // Compact sections only need explicit ids when they are not simply 1, 2, 3, ...
+    const bool compact = (solution->header.version >= DLX_SOLUTION_VERSION_COMPACT);
+    struct DlxSolutionHeader header = solution->header;
+    bool sequential = ((header.flags & DLX_SOLUTION_FLAG_EXPLICIT_IDS) == 0);
+    for (size_t i = 0; compact && sequential && i < solution->rows.size(); i++)
+    {
+        sequential = (solution->rows[i].solution_id == i + 1);
+    }
+    if (compact && !sequential)
+    {
+        header.flags |= DLX_SOLUTION_FLAG_EXPLICIT_IDS;
+    }
+    const bool has_status = (header.flags & DLX_SOLUTION_FLAG_STATUS) != 0;
+
+    DlxBlockWriter writer(output);
+    if (detail::write_solution_header(writer, &header) != 0)
+    {
+        return -1;
+    }
+
+    if ((header.flags & DLX_SOLUTION_FLAG_PROBLEM_INDEX) != 0
+        && detail::write_problem_index(writer, solution->problem_index) != 0)
     {
         return -1;
     }
 
+    if (compact)
+    {
+        DlxSolutionEncoder encoder;
+        encoder.reset((header.flags & DLX_SOLUTION_FLAG_SORTED_ROWS) != 0, !sequential);
+        for (const auto& row : solution->rows)
+        {
+            if (encoder.write(writer, row.solution_id, row.row_indices, row.entry_count) != 0)
+            {
+                return -1;
+            }
+        }
+        if (encoder.terminate(writer) != 0 || (has_status && detail::write_solve_status(writer, solution->status) != 0))
+        {
+            return -1;
+        }
+        return writer.flush();
+    }
+
     for (const auto& row : solution->rows)
     {
-        if (detail::write_solution_row(output, row.solution_id, row.row_indices, row.entry_count) != 0)
+        if (row.solution_id > UINT32_MAX
+            || detail::write_solution_row(
+                   writer, static_cast<uint32_t>(row.solution_id), row.row_indices, row.entry_count)
+                   != 0)
+        {
+            return -1;
+        }
+    }
+
+    // Version 1 sections end where the stream does, unless a status trailer needs the terminator row first.
+    if (has_status
+        && (detail::write_solution_row(writer, 0, nullptr, 0) != 0
+            || detail::write_solve_status(writer, solution->status) != 0))
+    {
+        return -1;
+    }
+
+    return writer.flush();
+}
+
+/**
+ * Copies every problem from @p input to @p output, switching the body encoding as each header is rewritten.
+ *
+ * @param std::istream& DLXB stream in either encoding.
+ * @param std::ostream& Destination stream.
+ * @param bool True to emit native-endian problems, false for portable big-endian ones.
+ * @param uint16_t Version to write, or 0 to keep each problem's own version.
+ * @return int 0 when every problem was copied, -1 otherwise.
+ */
+int dlx_convert_problems(std::istream& input, std::ostream& output, bool native, uint16_t version)
+{
+    DlxProblemStreamReader reader(input);
+    DlxProblemStreamWriter writer(output);
+    DlxCoverHeader header = {0};
+    DlxRowSpan span = {0};
+
+    while (!reader.at_end())
+    {
+        if (reader.read_header(&header) != 0)
+        {
+            return -1;
+        }
+
+        if (version != 0)
+        {
+            header.version = version;
+        }
+        if (native)
+        {
+            header.flags |= DLX_COVER_FLAG_NATIVE_ENDIAN;
+        }
+        else
+        {
+            header.flags &= ~DLX_COVER_FLAG_NATIVE_ENDIAN;
+        }
+
+        int started;
+        if ((header.flags & DLX_COVER_FLAG_OPTIONS) != 0)
+        {
+            started = writer.start(header, reader.assumptions(), reader.problem_id(), reader.options());
+        }
+        else if ((header.flags & DLX_COVER_FLAG_PROBLEM_ID) != 0)
+        {
+            started = writer.start(header, reader.assumptions(), reader.problem_id());
+        }
+        else if ((header.flags & DLX_COVER_FLAG_ASSUMPTIONS) != 0)
+        {
+            started = writer.start(header, reader.assumptions());
+        }
+        else
+        {
+            started = writer.start(header);
+        }
+        if (started != 0)
+        {
+            return -1;
+        }
+
+        int status;
+        while ((status = reader.read_row(&span)) == 1)
+        {
+            if (writer.write_row(span.row_id, span.columns, span.entry_count) != 0)
+            {
+                return -1;
+            }
+        }
+        if (status != 0 || writer.finish() != 0)
         {
             return -1;
         }
@@ -841,6 +2712,14 @@ int dlx_write_solution(std::ostream& output, const struct DlxSolution* solution)
     return 0;
 }
 
+bool dlx_is_native_problem_file(const char* path)
+{
+    std::ifstream input(path, std::ios::binary);
+    DlxCoverHeader header = {0};
+    DlxBlockReader reader(input, 0);
+    return input.is_open() && detail::read_cover_header(reader, &header) == 0 && header.magic == DLX_COVER_MAGIC
+           && detail::is_native(header);
+}
 
 struct node* dlx_read_binary(std::istream& input,
                              char*** solutions_out,
@@ -852,16 +2731,19 @@ struct node* dlx_read_binary(std::istream& input,
         return NULL;
     }
 
-    DlxProblem problem;
-    if (dlx_read_problem(input, &problem) != 0)
+    // Rows are linked as they are read, so the cover is never materialized as a DlxProblem.
+    DlxProblemStreamReader reader(input);
+    DlxCoverHeader header = {0};
+    if (reader.read_header(&header) != 0 || (header.flags & DLX_COVER_FLAG_REUSE_MATRIX) != 0)
     {
         return NULL;
     }
 
-    return dlx::Core::generateMatrixBinary(problem,
-                                           solutions_out,
-                                           item_count_out,
-                                           option_count_out);
+    return dlx::Core::generateMatrixFromStream(reader,
+                                               header,
+                                               solutions_out,
+                                               item_count_out,
+                                               option_count_out);
 }
 
 } // namespace dlx::binary
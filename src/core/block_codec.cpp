@@ -0,0 +1,751 @@
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include "core/block_codec.h"
+
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace dlx::binary {
+
+namespace {
+
+// Buffers are handed out as u32 arrays, so keep them aligned past what malloc guarantees for SIMD loads.
+constexpr size_t kBufferAlignment = 64;
+
+char* allocate_buffer(size_t bytes)
+{
+    size_t rounded = std::max<size_t>((bytes + kBufferAlignment - 1) / kBufferAlignment * kBufferAlignment,
+                                      kBufferAlignment);
+    return static_cast<char*>(aligned_alloc(kBufferAlignment, rounded));
+}
+
+/** Stores @p value big-endian at @p out. */
+void store_be32(char* out, uint32_t value)
+{
+    value = DLX_HOST_BIG_ENDIAN ? value : __builtin_bswap32(value);
+    memcpy(out, &value, sizeof(value));
+}
+
+uint32_t load_be32(const char* bytes)
+{
+    uint32_t value;
+    memcpy(&value, bytes, sizeof(value));
+    return DLX_HOST_BIG_ENDIAN ? value : __builtin_bswap32(value);
+}
+
+/** Writes @p value as a little-endian base-128 varint and returns the position after it. */
+template <typename Out>
+Out* put_varint(Out* out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        *out++ = static_cast<Out>(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = static_cast<Out>(value);
+    return out;
+}
+
+/** Reads a varint of at most five bytes; returns 0, or -1 when it is truncated or overflows 32 bits. */
+int get_varint(const uint8_t** cursor, const uint8_t* end, uint32_t* value)
+{
+    const uint8_t* in = *cursor;
+    uint32_t result = 0;
+    for (int shift = 0; shift < 35; shift += 7)
+    {
+        if (in == end)
+        {
+            return -1;
+        }
+        const uint8_t byte = *in++;
+        if (shift == 28 && byte > 0x0F)
+        {
+            return -1;
+        }
+        result |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            *cursor = in;
+            *value = result;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+// Row ids are delta-coded modulo 2^32 and zigzagged, so ids that step backwards stay short too.
+uint32_t zigzag(uint32_t delta)
+{
+    const int32_t signed_delta = static_cast<int32_t>(delta);
+    return (static_cast<uint32_t>(signed_delta) << 1) ^ static_cast<uint32_t>(signed_delta >> 31);
+}
+
+uint32_t unzigzag(uint32_t value)
+{
+    return (value >> 1) ^ (0u - (value & 1u));
+}
+
+uint64_t zigzag64(uint64_t delta)
+{
+    const int64_t signed_delta = static_cast<int64_t>(delta);
+    return (static_cast<uint64_t>(signed_delta) << 1) ^ static_cast<uint64_t>(signed_delta >> 63);
+}
+
+uint64_t unzigzag64(uint64_t value)
+{
+    return (value >> 1) ^ (0ull - (value & 1ull));
+}
+
+} // namespace
+
+/**
+ * Converts @p count u32 values between big-endian and host order in place.
+ */
+void dlx_byteswap_u32_array(uint32_t* values, size_t count)
+{
+    dlx_byteswap_u32_copy(values, values, count);
+}
+
+/**
+ * Copies @p count u32 values from @p src to @p dst, converting between big-endian and host order.
+ *
+ * Neither pointer needs to be aligned and they may be equal (but must not otherwise overlap). Sixteen bytes
+ * are swapped per step with SSSE3, SSE2, or NEON when the target has them; the scalar tail doubles as the
+ * portable fallback.
+ *
+ * @param void* Destination for the converted values.
+ * @param const void* Source values.
+ * @param size_t Number of u32 values.
+ */
+void dlx_byteswap_u32_copy(void* dst, const void* src, size_t count)
+{
+    if (DLX_HOST_BIG_ENDIAN)
+    {
+        if (dst != src && count > 0)
+        {
+            memcpy(dst, src, count * sizeof(uint32_t));
+        }
+        return;
+    }
+
+    char* out = static_cast<char*>(dst);
+    const char* in = static_cast<const char*>(src);
+    size_t i = 0;
+
+#if defined(__SSSE3__)
+    const __m128i mask = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * sizeof(uint32_t)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * sizeof(uint32_t)), _mm_shuffle_epi8(block, mask));
+    }
+#elif defined(__SSE2__)
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * sizeof(uint32_t)));
+        // Swap the bytes of every 16-bit half, then swap the halves of every 32-bit lane.
+        block = _mm_or_si128(_mm_slli_epi16(block, 8), _mm_srli_epi16(block, 8));
+        block = _mm_shufflelo_epi16(block, _MM_SHUFFLE(2, 3, 0, 1));
+        block = _mm_shufflehi_epi16(block, _MM_SHUFFLE(2, 3, 0, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * sizeof(uint32_t)), block);
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 4 <= count; i += 4)
+    {
+        uint8x16_t block = vld1q_u8(reinterpret_cast<const uint8_t*>(in + i * sizeof(uint32_t)));
+        vst1q_u8(reinterpret_cast<uint8_t*>(out + i * sizeof(uint32_t)), vrev32q_u8(block));
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        uint32_t value;
+        memcpy(&value, in + i * sizeof(uint32_t), sizeof(value));
+        value = __builtin_bswap32(value);
+        memcpy(out + i * sizeof(uint32_t), &value, sizeof(value));
+    }
+}
+
+void dlx_convert_u32_copy(void* dst, const void* src, size_t count, bool big_endian)
+{
+    if (big_endian != static_cast<bool>(DLX_HOST_BIG_ENDIAN))
+    {
+        dlx_byteswap_u32_copy(dst, src, count);
+    }
+    else if (dst != src && count > 0)
+    {
+        memcpy(dst, src, count * sizeof(uint32_t));
+    }
+}
+
+DlxBlockReader::DlxBlockReader(std::istream& input, size_t block_size)
+    : input_(&input)
+    , buffer_(nullptr)
+    , capacity_(0)
+    , block_size_(block_size)
+    , begin_(0)
+    , end_(0)
+    , expected_(0)
+    , seekable_(false)
+{
+    std::streambuf* buffer = input.rdbuf();
+    seekable_ = buffer != nullptr
+                && buffer->pubseekoff(0, std::ios::cur, std::ios::in) != std::streampos(std::streamoff(-1));
+}
+
+DlxBlockReader::~DlxBlockReader()
+{
+    // Hand read-ahead back to seekable streams so whoever reads next resumes where this reader stopped.
+    const size_t unread = end_ - begin_;
+    std::streambuf* buffer = input_->rdbuf();
+    if (unread > 0 && buffer != nullptr)
+    {
+        const std::streamoff offset = -static_cast<std::streamoff>(unread);
+        if (buffer->pubseekoff(offset, std::ios::cur, std::ios::in) != std::streampos(std::streamoff(-1)))
+        {
+            input_->clear(input_->rdstate() & ~std::ios::eofbit);
+        }
+    }
+    free(buffer_);
+}
+
+/**
+ * Makes at least @p bytes contiguous bytes available at the front of the buffer.
+ *
+ * Leftover bytes move to the (aligned) start of the buffer and the buffer grows when a single request exceeds
+ * it. One read() then fetches the missing bytes together with the read-ahead: up to a whole block from a
+ * seekable stream, and only the bytes declared with @ref expect from any other. Running into the end of the
+ * stream while reading ahead is not an error as long as the request itself was met.
+ *
+ * @return int 0 when the bytes are available, -1 when the stream ended or failed first.
+ */
+int DlxBlockReader::fill(size_t bytes)
+{
+    const size_t available = end_ - begin_;
+    const size_t wanted = std::max(bytes, block_size_);
+    if (wanted > capacity_)
+    {
+        char* grown = allocate_buffer(wanted);
+        if (grown == nullptr)
+        {
+            return -1;
+        }
+        if (available > 0)
+        {
+            memcpy(grown, buffer_ + begin_, available);
+        }
+        free(buffer_);
+        buffer_ = grown;
+        capacity_ = wanted;
+    }
+    else if (begin_ > 0)
+    {
+        memmove(buffer_, buffer_ + begin_, available);
+    }
+    begin_ = 0;
+    end_ = available;
+
+    size_t target = bytes;
+    if (block_size_ > 0)
+    {
+        target = std::max(target, seekable_ ? capacity_ : std::min(capacity_, end_ + expected_));
+    }
+    if (end_ < target)
+    {
+        input_->read(buffer_ + end_, static_cast<std::streamsize>(target - end_));
+        const size_t got = static_cast<size_t>(input_->gcount());
+        end_ += got;
+        expected_ -= std::min(expected_, got);
+        if (end_ >= bytes && input_->eof())
+        {
+            input_->clear(input_->rdstate() & ~std::ios::failbit);
+        }
+    }
+    return end_ >= bytes ? 0 : -1;
+}
+
+const char* DlxBlockReader::take(size_t bytes)
+{
+    if ((buffer_ == nullptr || end_ - begin_ < bytes) && fill(bytes) != 0)
+    {
+        return nullptr;
+    }
+
+    const char* data = buffer_ + begin_;
+    begin_ += bytes;
+    return data;
+}
+
+/**
+ * Consumes @p count u32 values and converts them to host order in place.
+ *
+ * Values that start off a 4-byte boundary are first slid back onto one, into bytes that were already
+ * consumed, so the returned array is always aligned without a second buffer.
+ *
+ * @return const uint32_t* Host-order values valid until the next call, or nullptr when the stream ended first.
+ */
+const uint32_t* DlxBlockReader::take_u32_array(size_t count, bool big_endian)
+{
+    if (count > SIZE_MAX / sizeof(uint32_t))
+    {
+        return nullptr;
+    }
+
+    const size_t bytes = count * sizeof(uint32_t);
+    const char* data = take(bytes);
+    if (data == nullptr)
+    {
+        return nullptr;
+    }
+
+    const size_t offset = static_cast<size_t>(data - buffer_);
+    char* aligned = buffer_ + (offset - offset % alignof(uint32_t));
+    if (aligned != data)
+    {
+        memmove(aligned, data, bytes);
+    }
+
+    uint32_t* values = reinterpret_cast<uint32_t*>(aligned);
+    dlx_convert_u32_copy(values, values, count, big_endian);
+    return values;
+}
+
+int DlxBlockReader::take_varint(uint64_t* value)
+{
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        if (end_ == begin_ && fill(1) != 0)
+        {
+            return (shift == 0 && input_->eof()) ? 0 : -1;
+        }
+        const uint8_t byte = static_cast<uint8_t>(buffer_[begin_++]);
+        if (shift == 63 && byte > 1)
+        {
+            return -1;
+        }
+        result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            *value = result;
+            return 1;
+        }
+    }
+    return -1;
+}
+
+void DlxBlockReader::expect(size_t bytes)
+{
+    const size_t available = end_ - begin_;
+    if (bytes > available)
+    {
+        expected_ = std::max(expected_, bytes - available);
+    }
+}
+
+bool DlxBlockReader::at_end()
+{
+    if (end_ > begin_)
+    {
+        return false;
+    }
+    return input_->peek() == std::char_traits<char>::eof();
+}
+
+DlxBlockWriter::DlxBlockWriter(std::ostream& output, size_t block_size)
+    : output_(&output)
+    , buffer_(nullptr)
+    , capacity_(std::max<size_t>(block_size, kBufferAlignment))
+    , end_(0)
+{}
+
+DlxBlockWriter::~DlxBlockWriter()
+{
+    flush();
+    free(buffer_);
+}
+
+char* DlxBlockWriter::reserve(size_t bytes)
+{
+    if (buffer_ != nullptr && end_ + bytes <= capacity_)
+    {
+        return buffer_ + end_;
+    }
+
+    if (flush() != 0)
+    {
+        return nullptr;
+    }
+
+    // The buffer is allocated lazily so idle writers (one per connected client) cost nothing.
+    if (buffer_ == nullptr || bytes > capacity_)
+    {
+        const size_t size = std::max(bytes, capacity_);
+        char* grown = allocate_buffer(size);
+        if (grown == nullptr)
+        {
+            return nullptr;
+        }
+        free(buffer_);
+        buffer_ = grown;
+        capacity_ = size;
+    }
+    return buffer_ + end_;
+}
+
+int DlxBlockWriter::write(const void* data, size_t bytes)
+{
+    char* slot = reserve(bytes);
+    if (slot == nullptr)
+    {
+        return -1;
+    }
+    if (bytes > 0)
+    {
+        memcpy(slot, data, bytes);
+    }
+    commit(bytes);
+    return 0;
+}
+
+int DlxBlockWriter::write_u32_array(const uint32_t* values, size_t count, bool big_endian)
+{
+    if (count > SIZE_MAX / sizeof(uint32_t))
+    {
+        return -1;
+    }
+
+    char* slot = reserve(count * sizeof(uint32_t));
+    if (slot == nullptr)
+    {
+        return -1;
+    }
+    dlx_convert_u32_copy(slot, values, count, big_endian);
+    commit(count * sizeof(uint32_t));
+    return 0;
+}
+
+int DlxBlockWriter::flush()
+{
+    if (end_ > 0)
+    {
+        output_->write(buffer_, static_cast<std::streamsize>(end_));
+        end_ = 0;
+    }
+    return output_->good() ? 0 : -1;
+}
+
+void dlx_encode_block_header(const struct DlxCoverBlockHeader& header, char* out)
+{
+    store_be32(out, header.row_count);
+    store_be32(out + 4, header.entry_count);
+    store_be32(out + 8, header.payload_bytes);
+}
+
+struct DlxCoverBlockHeader dlx_decode_block_header(const char* bytes)
+{
+    struct DlxCoverBlockHeader header;
+    header.row_count = load_be32(bytes);
+    header.entry_count = load_be32(bytes + 4);
+    header.payload_bytes = load_be32(bytes + 8);
+    return header;
+}
+
+DlxCoverBlockEncoder::DlxCoverBlockEncoder()
+    : body_bytes_(0)
+    , block_rows_(0)
+    , block_entries_(0)
+    , previous_row_id_(0)
+{}
+
+/**
+ * Appends one row to the open block, sorting its columns first when they arrive out of order.
+ *
+ * @return int 0 on success, -1 when @p columns is missing.
+ */
+int DlxCoverBlockEncoder::add_row(uint32_t row_id, const uint32_t* columns, uint16_t column_count)
+{
+    if (column_count > 0 && columns == nullptr)
+    {
+        return -1;
+    }
+
+    if (column_count > 1 && !std::is_sorted(columns, columns + column_count))
+    {
+        sorted_.assign(columns, columns + column_count);
+        std::sort(sorted_.begin(), sorted_.end());
+        columns = sorted_.data();
+    }
+
+    // Room for the worst case (five bytes per varint) is made up front and trimmed afterwards.
+    const size_t base = payload_.size();
+    payload_.resize(base + 5 * (2 + static_cast<size_t>(column_count)));
+    uint8_t* out = payload_.data() + base;
+    out = put_varint(out, zigzag(row_id - previous_row_id_));
+    out = put_varint(out, column_count);
+    uint32_t previous = 0;
+    for (uint16_t i = 0; i < column_count; i++)
+    {
+        out = put_varint(out, columns[i] - previous);
+        previous = columns[i];
+    }
+    payload_.resize(static_cast<size_t>(out - payload_.data()));
+
+    previous_row_id_ = row_id;
+    block_rows_ += 1;
+    block_entries_ += column_count;
+    return 0;
+}
+
+int DlxCoverBlockEncoder::flush(DlxBlockWriter& output)
+{
+    if (block_rows_ == 0)
+    {
+        return 0;
+    }
+
+    const struct DlxCoverBlockHeader header = {block_rows_, block_entries_, static_cast<uint32_t>(payload_.size())};
+    char* slot = output.reserve(DLX_COVER_BLOCK_HEADER_BYTES);
+    if (slot == nullptr)
+    {
+        return -1;
+    }
+    dlx_encode_block_header(header, slot);
+    output.commit(DLX_COVER_BLOCK_HEADER_BYTES);
+    if (output.write(payload_.data(), payload_.size()) != 0)
+    {
+        return -1;
+    }
+
+    offsets_.push_back(body_bytes_);
+    body_bytes_ += DLX_COVER_BLOCK_HEADER_BYTES + payload_.size();
+    payload_.clear();
+    block_rows_ = 0;
+    block_entries_ = 0;
+    previous_row_id_ = 0;
+    return 0;
+}
+
+int DlxCoverBlockEncoder::finish(DlxBlockWriter& output)
+{
+    if (flush(output) != 0)
+    {
+        return -1;
+    }
+
+    // Index: one u64 offset per block, then the block count and magic.
+    const size_t index_bytes = offsets_.size() * sizeof(uint64_t) + 2 * sizeof(uint32_t);
+    const struct DlxCoverBlockHeader terminator = {0, 0, static_cast<uint32_t>(index_bytes)};
+    char* slot = output.reserve(DLX_COVER_BLOCK_HEADER_BYTES + index_bytes);
+    if (slot == nullptr)
+    {
+        return -1;
+    }
+    dlx_encode_block_header(terminator, slot);
+    char* out = slot + DLX_COVER_BLOCK_HEADER_BYTES;
+    for (uint64_t offset : offsets_)
+    {
+        store_be32(out, static_cast<uint32_t>(offset >> 32));
+        store_be32(out + 4, static_cast<uint32_t>(offset));
+        out += sizeof(uint64_t);
+    }
+    store_be32(out, static_cast<uint32_t>(offsets_.size()));
+    store_be32(out + 4, DLX_COVER_INDEX_MAGIC);
+    output.commit(DLX_COVER_BLOCK_HEADER_BYTES + index_bytes);
+
+    offsets_.clear();
+    body_bytes_ = 0;
+    return 0;
+}
+
+DlxCoverBlockDecoder::DlxCoverBlockDecoder()
+    : cursor_(nullptr)
+    , end_(nullptr)
+    , rows_left_(0)
+    , entries_left_(0)
+    , previous_row_id_(0)
+{}
+
+void DlxCoverBlockDecoder::reset(const char* payload, const struct DlxCoverBlockHeader& header)
+{
+    cursor_ = reinterpret_cast<const uint8_t*>(payload);
+    end_ = cursor_ + header.payload_bytes;
+    rows_left_ = header.row_count;
+    entries_left_ = header.entry_count;
+    previous_row_id_ = 0;
+}
+
+int DlxCoverBlockDecoder::next_row(uint32_t* row_id, uint16_t* column_count)
+{
+    uint32_t delta = 0;
+    uint32_t count = 0;
+    if (rows_left_ == 0 || get_varint(&cursor_, end_, &delta) != 0 || get_varint(&cursor_, end_, &count) != 0
+        || count > UINT16_MAX || count > entries_left_)
+    {
+        return -1;
+    }
+
+    previous_row_id_ += unzigzag(delta);
+    *row_id = previous_row_id_;
+    *column_count = static_cast<uint16_t>(count);
+    return 0;
+}
+
+/**
+ * Decodes the columns of the row announced by @ref next_row into @p columns.
+ *
+ * @return int 0 on success, -1 when the payload is truncated or, after the last row, does not end exactly
+ *         where the block header said.
+ */
+int DlxCoverBlockDecoder::read_columns(uint32_t* columns, uint16_t column_count)
+{
+    uint32_t previous = 0;
+    for (uint16_t i = 0; i < column_count; i++)
+    {
+        uint32_t gap = 0;
+        if (get_varint(&cursor_, end_, &gap) != 0)
+        {
+            return -1;
+        }
+        previous += gap;
+        columns[i] = previous;
+    }
+
+    entries_left_ -= column_count;
+    rows_left_ -= 1;
+    if (rows_left_ == 0 && (cursor_ != end_ || entries_left_ != 0))
+    {
+        return -1;
+    }
+    return 0;
+}
+
+DlxSolutionEncoder::DlxSolutionEncoder()
+    : previous_id_(0)
+    , sorted_rows_(false)
+    , explicit_ids_(false)
+{}
+
+void DlxSolutionEncoder::reset(bool sorted, bool explicit_ids)
+{
+    previous_.clear();
+    previous_id_ = 0;
+    sorted_rows_ = sorted;
+    explicit_ids_ = explicit_ids;
+}
+
+/**
+ * Appends one solution record. Implicit ids must arrive as 1, 2, 3, ...; explicit ids may be anything.
+ *
+ * @return int 0 on success, -1 when @p rows is missing, an implicit id is out of sequence, or @p output fails.
+ */
+int DlxSolutionEncoder::write(DlxBlockWriter& output, uint64_t solution_id, const uint32_t* rows, uint16_t row_count)
+{
+    if ((row_count > 0 && rows == nullptr) || (!explicit_ids_ && solution_id != previous_id_ + 1))
+    {
+        return -1;
+    }
+
+    if (sorted_rows_ && row_count > 1 && !std::is_sorted(rows, rows + row_count))
+    {
+        sorted_.assign(rows, rows + row_count);
+        std::sort(sorted_.begin(), sorted_.end());
+        rows = sorted_.data();
+    }
+
+    size_t shared = 0;
+    const size_t limit = std::min<size_t>(previous_.size(), row_count);
+    while (shared < limit && previous_[shared] == rows[shared])
+    {
+        shared++;
+    }
+
+    // Tag, id and count take at most ten bytes each, every row at most five.
+    char* slot = output.reserve(30 + 5 * static_cast<size_t>(row_count - shared));
+    if (slot == nullptr)
+    {
+        return -1;
+    }
+    char* out = put_varint(slot, shared + 1);
+    if (explicit_ids_)
+    {
+        out = put_varint(out, zigzag64(solution_id - previous_id_));
+    }
+    out = put_varint(out, row_count - shared);
+    uint32_t previous = (shared == 0) ? 0 : rows[shared - 1];
+    for (size_t i = shared; i < row_count; i++)
+    {
+        const uint32_t delta = rows[i] - previous;
+        out = put_varint(out, sorted_rows_ ? delta : zigzag(delta));
+        previous = rows[i];
+    }
+    output.commit(static_cast<size_t>(out - slot));
+
+    previous_.assign(rows, rows + row_count);
+    previous_id_ = solution_id;
+    return 0;
+}
+
+int DlxSolutionEncoder::terminate(DlxBlockWriter& output)
+{
+    const char tag = 0;
+    return output.write(&tag, sizeof(tag));
+}
+
+DlxSolutionDecoder::DlxSolutionDecoder()
+    : previous_id_(0)
+    , sorted_rows_(false)
+    , explicit_ids_(false)
+{}
+
+void DlxSolutionDecoder::reset(bool sorted, bool explicit_ids)
+{
+    rows_.clear();
+    previous_id_ = 0;
+    sorted_rows_ = sorted;
+    explicit_ids_ = explicit_ids;
+}
+
+int DlxSolutionDecoder::read(DlxBlockReader& input, uint64_t* solution_id)
+{
+    uint64_t tag = 0;
+    int status = input.take_varint(&tag);
+    if (status != 1 || tag == 0)
+    {
+        return status == 1 ? 0 : status;
+    }
+
+    uint64_t id_delta = 1;
+    uint64_t suffix = 0;
+    const uint64_t shared = tag - 1;
+    if ((explicit_ids_ && input.take_varint(&id_delta) != 1) || input.take_varint(&suffix) != 1
+        || shared > rows_.size() || suffix > UINT16_MAX - shared)
+    {
+        return -1;
+    }
+
+    rows_.resize(static_cast<size_t>(shared + suffix));
+    uint32_t previous = (shared == 0) ? 0 : rows_[shared - 1];
+    for (size_t i = static_cast<size_t>(shared); i < rows_.size(); i++)
+    {
+        uint64_t delta = 0;
+        if (input.take_varint(&delta) != 1 || delta > UINT32_MAX)
+        {
+            return -1;
+        }
+        previous += sorted_rows_ ? static_cast<uint32_t>(delta) : unzigzag(static_cast<uint32_t>(delta));
+        rows_[i] = previous;
+    }
+
+    previous_id_ += explicit_ids_ ? unzigzag64(id_delta) : 1;
+    *solution_id = previous_id_;
+    return 1;
+}
+
+} // namespace dlx::binary
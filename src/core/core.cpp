@@ -1,8 +1,10 @@
 #include "core/dlx.h"
+#include "core/async_output.h"
 #include "core/binary.h"
 #include "core/solution_sink.h"
 #include "core/text.h"
 #include "core/matrix.h"
+#include "core/search.h"
 #include <stdio.h>
 #include <iostream>
 #include <wchar.h>
@@ -12,35 +14,11 @@
 #include <string.h>
 #include <vector>
 #include <algorithm>
+#include <charconv>
 #include <limits.h>
 #include <new>
 #include <sys/stat.h>
 
-namespace {
-
-void initialize_column_headers(struct node* matrix, uint32_t column_count)
-{
-    matrix[0].right = matrix;
-    matrix[0].left = matrix;
-
-    for (uint32_t i = 0; i < column_count; ++i)
-    {
-        struct node* column = &matrix[i + 1];
-        column->len = 0;
-        column->top = matrix;
-        column->left = &matrix[i];
-        column->right = matrix;
-        column->up = column;
-        column->down = column;
-        column->data = static_cast<int>(i + 1);
-
-        matrix[i].right = column;
-        matrix[0].left = column;
-    }
-}
-
-} // namespace
-
 namespace dlx {
 
 bool g_suppress_stdout_output = false;
@@ -90,17 +68,29 @@ int Core::dlx_enable_binary_solution_output(SolutionOutput& output_ctx, std::ost
 {
     binary::DlxSolutionHeader header = {
         .magic = DLX_SOLUTION_MAGIC,
-        .version = DLX_BINARY_VERSION,
+        .version = DLX_SOLUTION_VERSION,
         .flags = 0,
         .column_count = column_count,
     };
 
-    delete output_ctx.binary_writer;
-    output_ctx.binary_writer = new (std::nothrow) binary::DlxSolutionStreamWriter(output, header);
-    if (output_ctx.binary_writer == nullptr)
+    // Re-enabling on the same stream closes the current section and starts the next with the same writer.
+    if (output_ctx.binary_writer != nullptr && output_ctx.binary_stream == &output)
     {
-        fprintf(stderr, "Unable to allocate DLX solution writer\n");
-        return -1;
+        if (output_ctx.binary_writer->finish() != 0 || output_ctx.binary_writer->start(header) != 0)
+        {
+            fprintf(stderr, "Failed to write binary solution output\n");
+            return -1;
+        }
+    }
+    else
+    {
+        delete output_ctx.binary_writer;
+        output_ctx.binary_writer = new (std::nothrow) binary::DlxSolutionStreamWriter(output, header);
+        if (output_ctx.binary_writer == nullptr)
+        {
+            fprintf(stderr, "Unable to allocate DLX solution writer\n");
+            return -1;
+        }
     }
 
     output_ctx.binary_stream = &output;
@@ -138,117 +128,55 @@ void Core::dlx_disable_binary_solution_output(SolutionOutput& output_ctx)
  **************************************************************************************************************/
 
 /**
- * DLX is a powerful backtracking, depth-first algorithm that solves exact cover problems. Exact cover problems
- * can represent a wide range of applications such as a sudoku solver, to scheduling based applications.
- * 
- * @param struct node* A node pointer to the head of the matrix.
- * @param int An integer representing the current level of the recursive search.
- * @param char** A char pointer to pointers containing partials of a solutions.
- * @return void
- */ 
-void Core::search(struct node* head, int level, char** solutions, uint32_t* row_ids, SolutionOutput& output)
+ * Legacy output instantiation of the search: row ids are formatted into the caller's solution strings only when a
+ * solution is found and text is actually going somewhere, then routed through printSolutions.
+ */
+struct Core::OutputPolicy
 {
-    // If all items have been covered, output a found solution.
-    if (head->right == head)
-    {
-        printSolutions(solutions, row_ids, level, output);
-        return;
-    }
-    
-    // Pick an item i (column constraint), and cover the item.
-    struct node* constraint = pickConstraint(head);
-    cover(constraint);
-    
-    // Pick an option xl (row), and set potential partial solution
-    struct node* option = constraint->down;
-    struct node* optionNumber = option;
-    
-    // Traverse through matrix until the choosen options' associated spacer node is found
-    while (optionNumber->data > 0)
-    {
-        optionNumber += 1;
-    }
-
-    uint32_t optionRowId = static_cast<uint32_t>(abs(optionNumber->data));
-    // Create string for potential partial of solution
-    char* optionStr = static_cast<char*>(malloc(snprintf(NULL, 0, "%u", optionRowId) + 1));
-    sprintf(optionStr, "%u", optionRowId);
-    solutions[level] = optionStr;
-    row_ids[level] = optionRowId;
+    char** solutions;
+    SolutionOutput* output;
+    std::vector<char> digits;
 
-    // While node of a particular option row doesn't loop back to item node.
-    struct node* optionPart;
-    while (option != constraint)
+    void on_solution(const uint32_t* row_ids, int level)
     {
-        // Select next part of current option;
-        optionPart = option + 1;
-
-        // Cover each option parts' column until the options' space node is reached
-        while (optionPart != option)
+        const bool text = (output->async_writer == nullptr) && (output->sink != nullptr || !g_suppress_stdout_output);
+        if (text && level > 0)
         {
-            struct node* optionColumn = optionPart->top;
-
-            if (optionColumn == head) // spacer has been reached
+            // Ten digits and a terminator per row id.
+            if (digits.size() < static_cast<size_t>(level) * 11)
             {
-                optionPart = optionPart->up;
+                digits.resize(static_cast<size_t>(level) * 11);
             }
-            else
+            for (int i = 0; i < level; i++)
             {
-                cover(optionColumn);
-                optionPart += 1;
+                char* slot = digits.data() + static_cast<size_t>(i) * 11;
+                *std::to_chars(slot, slot + 10, row_ids[i]).ptr = '\0';
+                solutions[i] = slot;
             }
         }
-        
-        // Recursively search for potential solutions...
-        search(head, level + 1, solutions, row_ids, output);
 
-        // Iterate optionPart to options' spacer node
-        optionPart = option + 1;
-        while (optionPart->data > 0)
-        {
-            optionPart += 1;
-        }
-        optionPart -= 1; // Step back one to options' last actual node
+        printSolutions(solutions, row_ids, level, *output);
 
-        // Uncover each option parts' column until the previous options' space node is reached
-        while (optionPart != option)
+        for (int i = 0; text && i < level; i++)
         {
-            struct node* optionColumn = optionPart->top;
-
-            if (optionColumn == head) // Previous options' spacer has been reached.
-            {
-                optionPart = optionPart->down;
-            }
-            else
-            {
-                uncover(optionColumn);
-                optionPart -= 1;
-            }
+            solutions[i] = NULL;
         }
+    }
+};
 
-        // Update constraint to top of option, option to next option for constraint
-        constraint = option->top;
-        option = option->down;
-        optionNumber = option;
-
-        // Traverse through matrix until the choosen options' associated spacer node is found
-        while (optionNumber->data > 0)
-        {
-            optionNumber += 1;
-        }
-        
-        // Free malloc'd memory for old potential partial of solution and create new string for potential partial of solution
-        free(optionStr);
-        optionRowId = static_cast<uint32_t>(abs(optionNumber->data));
-        optionStr = static_cast<char*>(malloc(snprintf(NULL, 0, "%u", optionRowId) + 1));
-        sprintf(optionStr, "%u", optionRowId);
-        solutions[level] = optionStr;
-        row_ids[level] = optionRowId;
-    }
-
-    // Free malloc'd memory and uncover the constraint
-    free(optionStr);
-    uncover(constraint);
+/**
+ * DLX is a powerful backtracking, depth-first algorithm that solves exact cover problems. Exact cover problems
+ * can represent a wide range of applications such as a sudoku solver, to scheduling based applications.
+ * 
+ * @param struct node* A node pointer to the head of the matrix.
+ * @param int An integer representing the current level of the recursive search.
+ * @param char** A char pointer to pointers containing partials of a solutions.
+ * @return void
+ */ 
+void Core::search(struct node* head, int level, char** solutions, uint32_t* row_ids, SolutionOutput& output)
+{
+    OutputPolicy policy{solutions, &output, {}};
+    search(head, level, row_ids, policy);
 }
 
 /**
@@ -384,6 +312,226 @@ void Core::unhide(struct node* p)
     }
 }
 
+/**
+ * An auxilary function used to remove an entire option row from the matrix. Unlike hide, every node of the row
+ * (including p) is unlinked from its column so the row can no longer be reached from any item column.
+ *
+ * @param struct node* A node pointer to the first node of some option row.
+ * @return void
+ */
+void Core::hideRow(struct node* p)
+{
+    for (struct node* q = p; q->top->data > 0; q++)
+    {
+        q->up->down = q->down;
+        q->down->up = q->up;
+        q->top->len -= 1;
+    }
+}
+
+/**
+ * An auxilary function that reverses hideRow, relinking the nodes of an option row in the opposite order they
+ * were removed.
+ *
+ * @param struct node* A node pointer to the first node of some option row.
+ * @return void
+ */
+void Core::unhideRow(struct node* p)
+{
+    struct node* q = p;
+    while ((q + 1)->top->data > 0)
+    {
+        q++;
+    }
+
+    for (; q >= p; q--)
+    {
+        q->up->down = q;
+        q->down->up = q;
+        q->top->len += 1;
+    }
+}
+
+/**
+ * Runs the search on a matrix constrained by a set of assumptions. Forbidden rows are removed first, then every
+ * column of each forced row is covered exactly as search would when selecting that row. The forced rows are
+ * recorded as the leading entries of each solution. Once the search completes the matrix is restored to the
+ * state it was in before the call, so the same matrix can serve any number of constrained queries.
+ *
+ * Assumptions that contradict each other (a forced row that is also forbidden, or two forced rows sharing a
+ * column) produce no solutions.
+ *
+ * @param struct node* A node pointer to the head of the matrix.
+ * @param const RowIndex& Row lookup built from the same matrix.
+ * @param const SearchAssumptions& Forced and forbidden row identifiers.
+ * @param char** A char pointer to pointers containing partials of a solutions.
+ * @param uint32_t* Buffer receiving the row identifiers of each solution.
+ * @param SolutionOutput& Output routing for found solutions.
+ * @return int 0 on success, -1 when an assumption references an unknown row.
+ */
+int Core::searchWithAssumptions(struct node* head,
+                                const RowIndex& index,
+                                const SearchAssumptions& assumptions,
+                                char** solutions,
+                                uint32_t* row_ids,
+                                SolutionOutput& output)
+{
+    OutputPolicy policy{solutions, &output, {}};
+    return searchWithAssumptions(head, index, assumptions, row_ids, policy);
+}
+
+/**
+ * Removes the forbidden rows and selects the forced rows, recording them as the leading row ids. Every change is
+ * kept in @p state for @ref restoreAssumptions.
+ *
+ * @return int 0 on success, -1 when an assumption references an unknown row (the matrix is then untouched).
+ */
+int Core::applyAssumptions(const RowIndex& index,
+                           const SearchAssumptions& assumptions,
+                           uint32_t* row_ids,
+                           AssumptionState& state)
+{
+    std::vector<struct node*> forbidden;
+    forbidden.reserve(assumptions.forbidden_rows.size());
+    state.forced.reserve(assumptions.forced_rows.size());
+
+    // Resolve every row before touching any links so a bad id leaves the matrix untouched.
+    for (uint32_t row_id : assumptions.forbidden_rows)
+    {
+        struct node* row = index.find(row_id);
+        if (row == NULL)
+        {
+            return -1;
+        }
+        forbidden.push_back(row);
+    }
+
+    for (uint32_t row_id : assumptions.forced_rows)
+    {
+        struct node* row = index.find(row_id);
+        if (row == NULL)
+        {
+            return -1;
+        }
+        state.forced.push_back(row);
+    }
+
+    // Remove forbidden rows, skipping rows listed more than once.
+    state.hidden.reserve(forbidden.size());
+    for (struct node* row : forbidden)
+    {
+        if (row->up->down == row)
+        {
+            hideRow(row);
+            state.hidden.push_back(row);
+        }
+    }
+
+    // Select each forced row as search would, stopping at the first one that is no longer available.
+    for (size_t i = 0; i < state.forced.size(); i++)
+    {
+        struct node* row = state.forced[i];
+        bool available = (row->up->down == row);
+        for (struct node* q = row; available && q->top->data > 0; q++)
+        {
+            available = (q->top->left->right == q->top);
+        }
+
+        if (!available)
+        {
+            state.conflict = true;
+            break;
+        }
+
+        for (struct node* q = row; q->top->data > 0; q++)
+        {
+            cover(q->top);
+        }
+
+        row_ids[state.level] = assumptions.forced_rows[i];
+        state.level++;
+    }
+
+    return 0;
+}
+
+/**
+ * Undoes @ref applyAssumptions in the exact reverse order of its changes.
+ */
+void Core::restoreAssumptions(AssumptionState& state)
+{
+    for (int i = state.level - 1; i >= 0; i--)
+    {
+        struct node* q = state.forced[i];
+        while ((q + 1)->top->data > 0)
+        {
+            q++;
+        }
+
+        for (; q >= state.forced[i]; q--)
+        {
+            uncover(q->top);
+        }
+    }
+
+    for (auto it = state.hidden.rbegin(); it != state.hidden.rend(); ++it)
+    {
+        unhideRow(*it);
+    }
+}
+
+/**
+ * Records the first option node of every row reachable from the column headers. The matrix must not have any
+ * columns covered or rows hidden while the index is built.
+ *
+ * @param struct node* A node pointer to the head of the matrix.
+ * @return int 0 on success, -1 when the matrix is missing.
+ */
+int RowIndex::build(struct node* head)
+{
+    rows_.clear();
+    if (head == NULL)
+    {
+        return -1;
+    }
+
+    for (struct node* column = head->right; column != head; column = column->right)
+    {
+        for (struct node* p = column->down; p != column; p = p->down)
+        {
+            // Only the node directly after a spacer starts a row.
+            if ((p - 1)->top->data > 0)
+            {
+                continue;
+            }
+
+            struct node* spacer = p;
+            while (spacer->top->data > 0)
+            {
+                spacer++;
+            }
+            rows_.emplace_back(static_cast<uint32_t>(abs(spacer->data)), p);
+        }
+    }
+
+    std::sort(rows_.begin(), rows_.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.first < rhs.first;
+    });
+    return 0;
+}
+
+struct node* RowIndex::find(uint32_t row_id) const
+{
+    auto it = std::lower_bound(rows_.begin(), rows_.end(), row_id, [](const auto& entry, uint32_t value) {
+        return entry.first < value;
+    });
+    if (it == rows_.end() || it->first != row_id)
+    {
+        return NULL;
+    }
+    return it->second;
+}
+
 /**
  * This is a function for picking an item column using the MRV heuristic. Essentially, this function iterate through
  * the set of item columns and checks the number of options associated with that item. The item column with the
@@ -422,6 +570,10 @@ struct node* Core::pickConstraint(struct node* head)
     return i;
 }
 
+/**
+ * Links a fully materialized set of row chunks into a matrix. Each row is appended in O(row length) through
+ * matrix::MatrixBuilder, which sizes the node array from the known row and entry totals up front.
+ */
 struct node* Core::generateMatrixBinaryImpl(const struct binary::DlxCoverHeader& header,
                                             std::vector<binary::DlxRowChunk>& rows,
                                             char*** solutions_out,
@@ -433,172 +585,254 @@ struct node* Core::generateMatrixBinaryImpl(const struct binary::DlxCoverHeader&
         return nullptr;
     }
 
-    if (header.column_count == 0 || header.column_count > static_cast<uint32_t>(INT_MAX))
+    size_t total_entries = 0;
+    for (const auto& chunk : rows)
     {
-        return nullptr;
+        total_entries += chunk.entry_count;
     }
 
-    const uint32_t column_count = header.column_count;
-    const int itemCount = static_cast<int>(column_count);
+    matrix::MatrixBuilder builder;
+    if (builder.begin(header.column_count, rows.size(), total_entries) != 0)
+    {
+        return nullptr;
+    }
 
-    size_t total_entries = 0;
-    for (size_t row_index = 0; row_index < rows.size(); ++row_index)
+    for (auto& chunk : rows)
     {
-        auto& chunk = rows[row_index];
-        uint32_t row_id = (chunk.row_id == 0)
-                              ? static_cast<uint32_t>(row_index + 1)
-                              : chunk.row_id;
-        if (row_id > static_cast<uint32_t>(INT_MAX))
+        if (builder.append_row(chunk.row_id, chunk.columns, chunk.entry_count) != 0)
         {
             return nullptr;
         }
+    }
 
-        if (chunk.entry_count > 1)
-        {
-            std::sort(chunk.columns, chunk.columns + chunk.entry_count);
-        }
+    int nodeCount = builder.node_count();
+    struct node* matrix = builder.finish(solutions_out, item_count_out, option_count_out);
+    if (matrix != nullptr && g_matrix_dump_stream != nullptr)
+    {
+        matrix::dumpMatrixStructure(matrix, nodeCount, *item_count_out, *g_matrix_dump_stream);
+    }
 
-        bool invalid_column = false;
-        for (uint16_t i = 0; i < chunk.entry_count; ++i)
-        {
-            uint32_t column = chunk.columns[i];
-            if (column >= column_count)
-            {
-                invalid_column = true;
-                break;
-            }
-        }
-        if (invalid_column)
-        {
-            return nullptr;
-        }
+    return matrix;
+}
 
-        total_entries += chunk.entry_count;
-    }
+namespace {
 
-    if (rows.size() > static_cast<size_t>(INT_MAX))
+/**
+ * Appends every row of a CSR problem to @p builder after starting it from the problem header.
+ *
+ * @return int 0 on success, -1 when a row is out of range or allocation fails.
+ */
+int link_csr_rows(const binary::DlxCsrProblem& problem, matrix::MatrixBuilder& builder)
+{
+    if (builder.begin(problem.header.column_count, problem.row_count(), problem.entry_count()) != 0)
     {
-        return nullptr;
+        return -1;
     }
 
-    char** solutions = static_cast<char**>(calloc(rows.size(), sizeof(char*)));
-    if (solutions == nullptr)
+    for (size_t i = 0; i < problem.row_count(); i++)
     {
-        return nullptr;
+        if (builder.append_row(problem.row_id(i), problem.row_columns(i), problem.row_size(i)) != 0)
+        {
+            return -1;
+        }
     }
+    return 0;
+}
+
+} // namespace
 
-    size_t spacer_nodes = rows.size() + 1;
-    size_t total_nodes = static_cast<size_t>(column_count) + total_entries + spacer_nodes;
-    if (total_nodes > static_cast<size_t>(INT_MAX))
+/**
+ * Links a CSR problem. Every row's columns are already contiguous in the problem's arena, so the node array is sized
+ * exactly and the rows are appended in order without touching another allocation.
+ *
+ * @param const DlxCsrProblem& Problem to link; it is not modified, so several threads may link the same problem.
+ * @return struct node* Returns the address of the matrix head, or nullptr when the problem is invalid.
+ */
+struct node* Core::generateMatrixFromCsr(const binary::DlxCsrProblem& problem,
+                                         char*** solutions_out,
+                                         int* item_count_out,
+                                         int* option_count_out)
+{
+    if (solutions_out == nullptr || item_count_out == nullptr || option_count_out == nullptr)
     {
-        free(solutions);
         return nullptr;
     }
 
-    int nodeCount = static_cast<int>(total_nodes);
-    struct node* matrix = matrix::generateHeadNode(nodeCount);
-    if (matrix == nullptr)
+    matrix::MatrixBuilder builder;
+    if (link_csr_rows(problem, builder) != 0)
     {
-        free(solutions);
         return nullptr;
     }
 
-    initialize_column_headers(matrix, column_count);
+    int nodeCount = builder.node_count();
+    struct node* matrix = builder.finish(solutions_out, item_count_out, option_count_out);
+    if (matrix != nullptr && g_matrix_dump_stream != nullptr)
+    {
+        matrix::dumpMatrixStructure(matrix, nodeCount, *item_count_out, *g_matrix_dump_stream);
+    }
 
-    int currNodeCount = itemCount;
-    int prevRowCount = 0;
-    int spaceNodeCount = 0;
-    int pending_row_id = 0;
-    bool has_pending_row = false;
+    return matrix;
+}
 
-    for (size_t row_index = 0; row_index < rows.size(); ++row_index)
+/**
+ * Links a CSR problem into a caller-owned builder, reusing its node array. The returned matrix is borrowed from
+ * @p builder and stays valid until its next begin.
+ *
+ * @return struct node* Returns the address of the matrix head, or nullptr when the problem is invalid.
+ */
+struct node* Core::generateMatrixFromCsr(const binary::DlxCsrProblem& problem,
+                                         matrix::MatrixBuilder& builder,
+                                         int* item_count_out,
+                                         int* option_count_out)
+{
+    if (link_csr_rows(problem, builder) != 0)
     {
-        matrix::handleSpacerNodes(matrix, &spaceNodeCount, currNodeCount, prevRowCount);
-        if (has_pending_row)
-        {
-            matrix[currNodeCount + 1].data = -pending_row_id;
-        }
-        const auto& row = rows[row_index];
-        uint32_t row_id = (row.row_id == 0) ? static_cast<uint32_t>(row_index + 1) : row.row_id;
-        pending_row_id = static_cast<int>(row_id);
-        has_pending_row = true;
-
-        currNodeCount++;
-        prevRowCount = 0;
+        return nullptr;
+    }
 
-        const uint32_t* columns = row.columns;
-        size_t column_count_for_row = row.entry_count;
-        size_t column_cursor = 0;
+    struct node* matrix = builder.matrix(item_count_out, option_count_out);
+    if (matrix != nullptr && g_matrix_dump_stream != nullptr)
+    {
+        matrix::dumpMatrixStructure(matrix, builder.node_count(), *item_count_out, *g_matrix_dump_stream);
+    }
 
-        for (int assocItemCount = 1; assocItemCount <= itemCount; ++assocItemCount)
-        {
-            while (column_cursor < column_count_for_row
-                   && columns[column_cursor] + 1 < static_cast<uint32_t>(assocItemCount))
-            {
-                column_cursor++;
-            }
+    return matrix;
+}
 
-            if (column_cursor >= column_count_for_row)
-            {
-                break;
-            }
+namespace {
 
-            if (columns[column_cursor] + 1 != static_cast<uint32_t>(assocItemCount))
-            {
-                continue;
-            }
+/**
+ * Streams every remaining row of the current problem into @p builder, starting it from the header first.
+ * @p reader is a DlxProblemStreamReader or DlxMappedProblemReader; both hand out rows as DlxRowSpan views.
+ *
+ * @return int 0 when the advertised rows were all linked, -1 on a malformed or truncated stream.
+ */
+template <typename Reader>
+int link_stream_rows(Reader& reader, const struct binary::DlxCoverHeader& header, matrix::MatrixBuilder& builder)
+{
+    // Typical covers carry a handful of entries per row; the builder grows past this when needed.
+    constexpr size_t kEntriesPerRowHint = 4;
 
-            struct node* item = &matrix[assocItemCount];
-            struct node* last = item;
-            while (last->down != item)
-            {
-                last = last->down;
-            }
+    if (builder.begin(header.column_count, header.row_count, static_cast<size_t>(header.row_count) * kEntriesPerRowHint)
+        != 0)
+    {
+        return -1;
+    }
 
-            int new_index = currNodeCount + 1;
-            matrix[new_index].data = new_index;
-            item->len += 1;
-            item->up = &matrix[new_index];
-            last->down = &matrix[new_index];
-            matrix[new_index].up = last;
-            matrix[new_index].top = item;
-            matrix[new_index].down = item;
-
-            prevRowCount++;
-            currNodeCount++;
-            column_cursor++;
+    // Each row is linked straight out of the reader's block buffer (or the file mapping).
+    binary::DlxRowSpan span = {0};
+    uint32_t rows_read = 0;
+    int status = 0;
+    while ((status = reader.read_row(&span)) == 1)
+    {
+        if (builder.append_row(span.row_id, span.columns, span.entry_count) != 0)
+        {
+            status = -1;
+            break;
         }
+        rows_read++;
     }
 
-    matrix[currNodeCount + 1].top = matrix;
-    if (has_pending_row)
+    // A stream that ends before the advertised row count is truncated.
+    if (status != 0 || (header.row_count > 0 && rows_read != header.row_count))
     {
-        matrix[currNodeCount + 1].data = -pending_row_id;
+        return -1;
     }
-    else
+    return 0;
+}
+
+/**
+ * Links every remaining row of the current problem into a fresh matrix and hands its ownership to the caller.
+ */
+template <typename Reader>
+struct node* link_owned_matrix(Reader& reader,
+                               const struct binary::DlxCoverHeader& header,
+                               char*** solutions_out,
+                               int* item_count_out,
+                               int* option_count_out)
+{
+    if (solutions_out == nullptr || item_count_out == nullptr || option_count_out == nullptr)
+    {
+        return nullptr;
+    }
+
+    matrix::MatrixBuilder builder;
+    if (link_stream_rows(reader, header, builder) != 0)
     {
-        matrix[currNodeCount + 1].data = spaceNodeCount;
+        return nullptr;
     }
-    spaceNodeCount--;
-    matrix[currNodeCount + 1].down = matrix;
-    if (prevRowCount == 0)
+
+    int nodeCount = builder.node_count();
+    struct node* matrix = builder.finish(solutions_out, item_count_out, option_count_out);
+    if (matrix != nullptr && g_matrix_dump_stream != nullptr)
     {
-        matrix[currNodeCount + 1].up = matrix;
+        matrix::dumpMatrixStructure(matrix, nodeCount, *item_count_out, *g_matrix_dump_stream);
     }
-    else
+
+    return matrix;
+}
+
+} // namespace
+
+/**
+ * Links a cover straight from a problem stream whose header has already been read. Rows are consumed one at a
+ * time through DlxProblemStreamReader::read_row, so the full DlxProblem is never materialized; the node array
+ * starts from the header's row count and grows geometrically as entries arrive.
+ *
+ * @param DlxProblemStreamReader& Reader positioned just after the cover header (and assumption block).
+ * @param const DlxCoverHeader& Header returned by the reader.
+ * @return struct node* Returns the address of the matrix head, or nullptr when the stream is invalid.
+ */
+struct node* Core::generateMatrixFromStream(binary::DlxProblemStreamReader& reader,
+                                            const struct binary::DlxCoverHeader& header,
+                                            char*** solutions_out,
+                                            int* item_count_out,
+                                            int* option_count_out)
+{
+    return link_owned_matrix(reader, header, solutions_out, item_count_out, option_count_out);
+}
+
+/**
+ * Links a cover from a mapped native-endian DLXB file whose header has already been read. Row columns are read
+ * in place from the mapping, so linking is the only pass over the data.
+ *
+ * @param DlxMappedProblemReader& Reader positioned just after the cover header (and assumption block).
+ * @param const DlxCoverHeader& Header returned by the reader.
+ * @return struct node* Returns the address of the matrix head, or nullptr when the file is invalid.
+ */
+struct node* Core::generateMatrixFromStream(binary::DlxMappedProblemReader& reader,
+                                            const struct binary::DlxCoverHeader& header,
+                                            char*** solutions_out,
+                                            int* item_count_out,
+                                            int* option_count_out)
+{
+    return link_owned_matrix(reader, header, solutions_out, item_count_out, option_count_out);
+}
+
+/**
+ * Links a cover from a problem stream into a caller-owned builder, reusing whatever node array it already holds.
+ * Used by batch callers that solve many problems back to back; the returned matrix is borrowed from @p builder and
+ * stays valid until its next begin.
+ *
+ * @return struct node* Returns the address of the matrix head, or nullptr when the stream is invalid.
+ */
+struct node* Core::generateMatrixFromStream(binary::DlxProblemStreamReader& reader,
+                                            const struct binary::DlxCoverHeader& header,
+                                            matrix::MatrixBuilder& builder,
+                                            int* item_count_out,
+                                            int* option_count_out)
+{
+    if (link_stream_rows(reader, header, builder) != 0)
     {
-        matrix[currNodeCount - prevRowCount].down = &matrix[currNodeCount];
-        matrix[currNodeCount + 1].up = &matrix[(currNodeCount + 1) - prevRowCount];
+        return nullptr;
     }
 
-    if (g_matrix_dump_stream != nullptr)
+    struct node* matrix = builder.matrix(item_count_out, option_count_out);
+    if (matrix != nullptr && g_matrix_dump_stream != nullptr)
     {
-        matrix::dumpMatrixStructure(matrix, nodeCount, itemCount, *g_matrix_dump_stream);
+        matrix::dumpMatrixStructure(matrix, builder.node_count(), *item_count_out, *g_matrix_dump_stream);
     }
 
-    *solutions_out = solutions;
-    *item_count_out = itemCount;
-    *option_count_out = static_cast<int>(rows.size());
     return matrix;
 }
 
@@ -625,6 +859,14 @@ struct node* Core::generateMatrixBinaryFromRows(const struct binary::DlxCoverHea
  */
 void Core::printSolutions(char** solutions, const uint32_t* row_ids, int level, SolutionOutput& output)
 {
+    // Write-behind output formats and flushes on its own thread
+    if (output.async_writer != nullptr)
+    {
+        output.async_writer->push(row_ids, level);
+        output.emit_binary_row(row_ids, level);
+        return;
+    }
+
     auto emit = [&](std::ostream& stream) {
         for (int i = 0; i < level; i++)
         {
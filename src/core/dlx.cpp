@@ -1,12 +1,20 @@
 #include "core/dlx.h"
+#include "core/batch.h"
 #include "core/binary.h"
+#include "core/matrix.h"
+#include "core/snapshot.h"
 #include "core/tcp_server.h"
 #include "core/util.h"
 #include "core/solution_sink.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <limits.h>
 #include <locale.h>
 #include <stdio.h>
@@ -39,19 +47,34 @@ using dlx::util::SolutionBuffer;
  */
 static void print_usage(void)
 {
-    printf("./dlx [cover_file] [solution_output]\n");
-    printf("./dlx --server [problem_port] [solution_port]\n");
+    printf("./dlx [--async] [cover_file] [solution_output]\n");
+    printf("./dlx --server [problem_port] [solution_port] [--workers N] [--io-threads N] [--io-backend epoll|io_uring]\n");
+    printf("         [--slow-clients block|drop|spill] [--flush latency|default|bulk] [--stats SECONDS]\n");
+    printf("         [--local-socket PATH] [--result-cache MB] [--schedule fifo|shortest|fair]\n");
+    printf("./dlx --snapshot [snapshot_output] [cover_file]\n");
+    printf("./dlx --batch [--workers N] [--as-completed] [--async] [cover_file] [solution_output]\n");
+    printf("./dlx --convert [--native|--portable] [--version N] [cover_file] [cover_output]\n");
     printf("Hints:\n");
     printf("  Omit arguments or pass '-' to stream via stdin/stdout.\n");
+    printf("  A DLXM snapshot may be passed anywhere a cover file is accepted.\n");
+    printf("  Native-endian covers written by --convert are memory-mapped instead of parsed.\n");
+    printf("  --async formats and writes solutions on a separate thread (ignored with --workers).\n");
+    printf("  --slow-clients picks what the server does with subscribers that fall behind (default drop).\n");
+    printf("  --flush trades solution latency for throughput; clients may pick their own with a DlxFlushRequest.\n");
+    printf("  --stats prints the server's queue depths to stderr every SECONDS.\n");
+    printf("  --local-socket also serves clients on this host over a Unix socket and shared memory.\n");
+    printf("  --result-cache replays solutions of repeated problems from MB of memory (default 64, 0 disables).\n");
+    printf("  --schedule orders queued problems by arrival, estimated cost (default) or per-connection share.\n");
 }
 
 /**
  * Instantiates the TCP server ports and waits for input until server socket threads finish.
  * 
+ * @param int Number of command line arguments provided to program.
  * @param char** Set of command line arguments as strings.
  * @return int
  */
-int instantiate_server(char** argv)
+int instantiate_server(int argc, char** argv)
 {
     // String to long conversion
     long request_port = strtol(argv[2], nullptr, 10);
@@ -70,6 +93,129 @@ int instantiate_server(char** argv)
         static_cast<uint16_t>(solution_port)
     };
 
+    int stats_interval = 0;
+
+    // Optional settings, given as flag/value pairs after the ports
+    for (int index = 4; index < argc; index += 2)
+    {
+        // Socket backend: io_uring (the default, when built in and allowed by the kernel) or epoll
+        if (strcmp(argv[index], "--io-backend") == 0 && index + 1 < argc
+            && (strcmp(argv[index + 1], "epoll") == 0 || strcmp(argv[index + 1], "io_uring") == 0))
+        {
+            config.io_uring = strcmp(argv[index + 1], "io_uring") == 0;
+            continue;
+        }
+
+        // Slow subscribers: pause the search (block), disconnect them (drop) or queue to a temporary file (spill)
+        if (strcmp(argv[index], "--slow-clients") == 0 && index + 1 < argc)
+        {
+            if (strcmp(argv[index + 1], "block") == 0)
+            {
+                config.slow_clients = dlx::SlowClientPolicy::Block;
+            }
+            else if (strcmp(argv[index + 1], "drop") == 0)
+            {
+                config.slow_clients = dlx::SlowClientPolicy::Drop;
+            }
+            else if (strcmp(argv[index + 1], "spill") == 0)
+            {
+                config.slow_clients = dlx::SlowClientPolicy::Spill;
+            }
+            else
+            {
+                print_usage();
+                return EXIT_FAILURE;
+            }
+            continue;
+        }
+
+        // Solution batching: send every solution at once (latency), 256 KiB batches (default) or corked 1 MiB ones (bulk)
+        if (strcmp(argv[index], "--flush") == 0 && index + 1 < argc)
+        {
+            if (strcmp(argv[index + 1], "latency") == 0)
+            {
+                config.flush = dlx::kDlxLatencyFlush;
+            }
+            else if (strcmp(argv[index + 1], "default") == 0)
+            {
+                config.flush = dlx::kDlxDefaultFlush;
+            }
+            else if (strcmp(argv[index + 1], "bulk") == 0)
+            {
+                config.flush = dlx::kDlxBulkFlush;
+            }
+            else
+            {
+                print_usage();
+                return EXIT_FAILURE;
+            }
+            continue;
+        }
+
+        // Queue order: arrival (fifo), lowest estimated cost (shortest, the default) or least work per connection (fair)
+        if (strcmp(argv[index], "--schedule") == 0 && index + 1 < argc)
+        {
+            if (strcmp(argv[index + 1], "fifo") == 0)
+            {
+                config.schedule = dlx::ProblemSchedule::Fifo;
+            }
+            else if (strcmp(argv[index + 1], "shortest") == 0)
+            {
+                config.schedule = dlx::ProblemSchedule::ShortestFirst;
+            }
+            else if (strcmp(argv[index + 1], "fair") == 0)
+            {
+                config.schedule = dlx::ProblemSchedule::FairShare;
+            }
+            else
+            {
+                print_usage();
+                return EXIT_FAILURE;
+            }
+            continue;
+        }
+
+        // Unix domain socket for clients on the same host, which exchange problems and solutions in shared memory
+        if (strcmp(argv[index], "--local-socket") == 0 && index + 1 < argc)
+        {
+            config.local_socket_path = argv[index + 1];
+            continue;
+        }
+
+        long value = (index + 1 < argc) ? strtol(argv[index + 1], nullptr, 10) : -1;
+        if (value < 0 || value > 1024)
+        {
+            print_usage();
+            return EXIT_FAILURE;
+        }
+
+        // Solver threads; 0 (the default) starts one worker per hardware thread
+        if (strcmp(argv[index], "--workers") == 0)
+        {
+            config.workers = static_cast<unsigned int>(value);
+        }
+        // Event loop threads serving the sockets; 0 is treated as 1
+        else if (strcmp(argv[index], "--io-threads") == 0)
+        {
+            config.io_threads = static_cast<unsigned int>(value);
+        }
+        // Seconds between queue depth reports; 0 (the default) prints none
+        else if (strcmp(argv[index], "--stats") == 0)
+        {
+            stats_interval = static_cast<int>(value);
+        }
+        // Megabytes of solutions kept for problems submitted again; 0 solves every copy
+        else if (strcmp(argv[index], "--result-cache") == 0)
+        {
+            config.result_cache_bytes = static_cast<size_t>(value) << 20;
+        }
+        else
+        {
+            print_usage();
+            return EXIT_FAILURE;
+        }
+    }
+
     // Instantiate DlxTcpServer with TcpServerConfig structure
     dlx::DlxTcpServer server(config);
 
@@ -80,9 +226,52 @@ int instantiate_server(char** argv)
         return EXIT_FAILURE;
     }
 
+    // Reports the queue depths until the server stops
+    std::mutex stats_mutex;
+    std::condition_variable stats_cv;
+    bool stopped = false;
+    std::thread reporter;
+    if (stats_interval > 0)
+    {
+        reporter = std::thread([&]() {
+            std::unique_lock<std::mutex> lock(stats_mutex);
+            while (!stats_cv.wait_for(lock, std::chrono::seconds(stats_interval), [&]() { return stopped; }))
+            {
+                const dlx::TcpServerStats stats = server.stats();
+                fprintf(stderr,
+                        "problems=%zu slabs=%zu/%zu subscribers=%zu backlog=%llu spilled=%llu dropped=%llu"
+                        " cache_hits=%llu coalesced=%llu cached=%zu wait_p99_us=%llu/%llu/%llu/%llu\n",
+                        stats.queued_problems,
+                        stats.queued_slabs,
+                        stats.slab_capacity,
+                        stats.subscribers,
+                        static_cast<unsigned long long>(stats.backlog_bytes),
+                        static_cast<unsigned long long>(stats.spilled_bytes),
+                        static_cast<unsigned long long>(stats.dropped_clients),
+                        static_cast<unsigned long long>(stats.cache_hits),
+                        static_cast<unsigned long long>(stats.coalesced),
+                        stats.cached_bytes,
+                        static_cast<unsigned long long>(stats.waits[0].p99_micros),
+                        static_cast<unsigned long long>(stats.waits[1].p99_micros),
+                        static_cast<unsigned long long>(stats.waits[2].p99_micros),
+                        static_cast<unsigned long long>(stats.waits[3].p99_micros));
+            }
+        });
+    }
+
     // Blocks thread until request and solution threads are closed
     server.wait();
 
+    if (reporter.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(stats_mutex);
+            stopped = true;
+        }
+        stats_cv.notify_one();
+        reporter.join();
+    }
+
     return EXIT_SUCCESS;
 }
 
@@ -112,25 +301,38 @@ static bool open_cover_stream(const char* cover_path, CoverStream& cover_stream)
     return true;
 }
 
-static bool build_matrix_context(std::istream& cover_stream, const char* cover_path, MatrixContext& ctx)
+template <typename Reader>
+static bool build_matrix_context(Reader& reader,
+                                 const char* cover_path,
+                                 MatrixContext& ctx,
+                                 dlx::SearchAssumptions& assumptions)
 {
-    dlx::binary::DlxProblem problem;
+    dlx::binary::DlxCoverHeader header = {0};
     
     //
     ctx.reset();
 
     //
-    if (dlx::binary::dlx_read_problem(cover_stream, &problem) != 0)
+    if (reader.read_header(&header) != 0)
     {
         printf("Failed to read binary cover data from %s.\n", cover_path);
         return false;
     }
 
-    //
-    ctx.matrix = dlx::Core::generateMatrixBinary(problem,
-                                                 &ctx.solutions,
-                                                 &ctx.item_count,
-                                                 &ctx.option_count);
+    // A reuse frame only makes sense against a cover already held by a server
+    if ((header.flags & DLX_COVER_FLAG_REUSE_MATRIX) != 0)
+    {
+        printf("Cover file %s references a previous cover and cannot be solved standalone.\n", cover_path);
+        return false;
+    }
+    assumptions = reader.assumptions();
+
+    // Rows are linked as they stream in rather than being buffered first
+    ctx.matrix = dlx::Core::generateMatrixFromStream(reader,
+                                                     header,
+                                                     &ctx.solutions,
+                                                     &ctx.item_count,
+                                                     &ctx.option_count);
     
     //
     if (ctx.matrix == NULL)
@@ -142,6 +344,72 @@ static bool build_matrix_context(std::istream& cover_stream, const char* cover_p
     return true;
 }
 
+/**
+ * Reads and links the DLXB cover at @p cover_path (or stdin for "-").
+ *
+ * Native-endian cover files are mapped and linked straight from the page cache; everything else, including
+ * big-endian hosts where the mapping is refused, is decoded through the stream reader.
+ *
+ * @param const char* The path to a binary cover file in DLXB format or "-" for stdin
+ * @param CoverStream& Holds the opened stream for the streamed path
+ * @param MatrixContext& Context that takes ownership of the linked matrix
+ * @param SearchAssumptions& Receives the cover's assumption block
+ * @return bool
+ */
+static bool load_cover_context(const char* cover_path,
+                               CoverStream& cover_stream,
+                               MatrixContext& ctx,
+                               dlx::SearchAssumptions& assumptions)
+{
+    // Rows of a native cover are read in place from the mapping
+    if (strcmp(cover_path, "-") != 0 && dlx::binary::dlx_is_native_problem_file(cover_path))
+    {
+        dlx::binary::DlxMappedProblemReader mapped;
+        if (mapped.open(cover_path) == 0)
+        {
+            return build_matrix_context(mapped, cover_path, ctx, assumptions);
+        }
+    }
+
+    //
+    if (!open_cover_stream(cover_path, cover_stream))
+    {
+        return false;
+    }
+
+    dlx::binary::DlxProblemStreamReader reader(*cover_stream.stream);
+    return build_matrix_context(reader, cover_path, ctx, assumptions);
+}
+
+/**
+ * Maps a prebuilt DLXM snapshot in place of parsing and linking a DLXB cover.
+ *
+ * @param const char* Path to the snapshot file.
+ * @param MatrixContext& Context that takes ownership of the mapping.
+ * @return bool
+ */
+static bool load_snapshot_context(const char* snapshot_path, MatrixContext& ctx)
+{
+    auto snapshot = std::make_unique<dlx::snapshot::MatrixSnapshot>();
+
+    //
+    ctx.reset();
+
+    //
+    if (snapshot->load(snapshot_path) != 0)
+    {
+        printf("Failed to load matrix snapshot %s.\n", snapshot_path);
+        return false;
+    }
+
+    ctx.matrix = snapshot->matrix();
+    ctx.solutions = snapshot->solutions();
+    ctx.item_count = snapshot->item_count();
+    ctx.option_count = snapshot->option_count();
+    ctx.snapshot = std::move(snapshot);
+    return true;
+}
+
 static bool allocate_solution_buffer(int option_count, SolutionBuffer& buffer)
 {
     buffer.reset();
@@ -156,7 +424,7 @@ static bool allocate_solution_buffer(int option_count, SolutionBuffer& buffer)
     return true;
 }
 
-static bool setup_output_context(const char* solution_path, int item_count, OutputContext& ctx)
+static bool open_output_context(const char* solution_path, OutputContext& ctx, bool async_output = false)
 {
     ctx.reset();
     ctx.write_to_stdout = (strcmp(solution_path, "-") == 0);
@@ -182,12 +450,38 @@ static bool setup_output_context(const char* solution_path, int item_count, Outp
         dlx::Core::dlx_set_stdout_suppressed(true);
     }
 
+    // Write-behind output formats the console text and DLXS sections on its own thread
+    if (async_output)
+    {
+        ctx.async_writer = std::make_unique<dlx::sink::AsyncSolutionWriter>(ctx.stdout_suppressed ? nullptr : &std::cout,
+                                                                             ctx.stream);
+        ctx.output.async_writer = ctx.async_writer.get();
+        return true;
+    }
+
     if (!ctx.stdout_suppressed)
     {
-        ctx.console_sink = std::make_unique<dlx::sink::OstreamSolutionSink>(std::cout);
+        // Console rows bypass stdio and go to the descriptor in large writes, so drain stdio first to keep ordering
+        std::cout.flush();
+        fflush(stdout);
+        ctx.console_sink = std::make_unique<dlx::sink::FdTextSolutionSink>(STDOUT_FILENO);
         ctx.sink_router.add_sink(ctx.console_sink.get());
     }
     ctx.output.sink = ctx.sink_router.empty() ? nullptr : &ctx.sink_router;
+    return true;
+}
+
+/**
+ * Starts a DLXS section for a cover with @p item_count columns. Calling it again on the same context closes the
+ * previous section and reuses its writer.
+ */
+static bool begin_solution_section(int item_count, OutputContext& ctx)
+{
+    if (ctx.async_writer)
+    {
+        ctx.binary_output_enabled = (ctx.async_writer->begin_section(static_cast<uint32_t>(item_count)) == 0);
+        return ctx.binary_output_enabled;
+    }
 
     if (ctx.stream == nullptr
         || dlx::Core::dlx_enable_binary_solution_output(ctx.output,
@@ -204,17 +498,105 @@ static bool setup_output_context(const char* solution_path, int item_count, Outp
     return true;
 }
 
+static bool setup_output_context(const char* solution_path, int item_count, OutputContext& ctx, bool async_output)
+{
+    return open_output_context(solution_path, ctx, async_output) && begin_solution_section(item_count, ctx);
+}
+
 /**
  * @param const char* The path to a binary cover file to read in DLXB format or a piped input stream
  * @param const char* The path to write a binary solution file in DLXS format or a piped output stream
+ * @param bool True to queue solutions for a write-behind thread instead of writing them on the search thread
  */
-int handle_cli(const char* cover_path, const char* solution_path)
+int handle_cli(const char* cover_path, const char* solution_path, bool async_output)
 {
     CoverStream cover_stream;
     MatrixContext matrix_ctx;
     OutputContext output_ctx;
     SolutionBuffer solution_buffer;
+    dlx::SearchAssumptions assumptions;
     
+    // Snapshots are mapped directly and skip parsing and linking entirely
+    if (strcmp(cover_path, "-") != 0 && dlx::snapshot::is_snapshot_file(cover_path))
+    {
+        if (!load_snapshot_context(cover_path, matrix_ctx))
+        {
+            return EXIT_FAILURE;
+        }
+    }
+    else if (!load_cover_context(cover_path, cover_stream, matrix_ctx, assumptions))
+    {
+        return EXIT_FAILURE;
+    }
+
+    //
+    if (!allocate_solution_buffer(matrix_ctx.option_count, solution_buffer))
+    {
+        return EXIT_FAILURE;
+    }
+
+    //
+    if (!setup_output_context(solution_path, matrix_ctx.item_count, output_ctx, async_output))
+    {
+        return EXIT_FAILURE;
+    }
+
+    // Covers carrying an assumption block are solved with the forced/forbidden rows applied
+    if (!assumptions.empty())
+    {
+        dlx::RowIndex row_index;
+        row_index.build(matrix_ctx.matrix);
+        if (dlx::Core::searchWithAssumptions(matrix_ctx.matrix,
+                                             row_index,
+                                             assumptions,
+                                             matrix_ctx.solutions,
+                                             solution_buffer.rows,
+                                             output_ctx.output)
+            != 0)
+        {
+            printf("Assumptions in %s reference unknown rows.\n", cover_path);
+            return EXIT_FAILURE;
+        }
+    }
+    else
+    {
+        dlx::Core::search(matrix_ctx.matrix,
+                          0,
+                          matrix_ctx.solutions,
+                          solution_buffer.rows,
+                          output_ctx.output);
+    }
+
+    //
+    output_ctx.disable_binary_output();
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * Solves every problem in a DLXB stream back to back and writes one DLXS section per problem.
+ *
+ * The node array, row-id buffer, per-level solution buffer and solution writer are shared by every problem, so once
+ * the largest cover in the batch has been linked the loop stops allocating. Reuse frames are solved against the
+ * previous cover in the stream.
+ *
+ * @param const char* The path to a binary cover file holding one or more DLXB problems or a piped input stream
+ * @param const char* The path to write the DLXS sections to or a piped output stream
+ * @param bool True to queue solutions for a write-behind thread instead of writing them on the search thread
+ * @return int
+ */
+int handle_batch(const char* cover_path, const char* solution_path, bool async_output)
+{
+    CoverStream cover_stream;
+    OutputContext output_ctx;
+    dlx::matrix::MatrixBuilder builder;
+    std::vector<uint32_t> row_ids;
+    std::vector<char*> solutions;
+    struct node* matrix = NULL;
+    int item_count = 0;
+    int option_count = 0;
+    size_t problem_number = 0;
+
     //
     if (!open_cover_stream(cover_path, cover_stream))
     {
@@ -222,33 +604,216 @@ int handle_cli(const char* cover_path, const char* solution_path)
     }
 
     //
-    if (!build_matrix_context(*cover_stream.stream, cover_path, matrix_ctx))
+    if (!open_output_context(solution_path, output_ctx, async_output))
     {
         return EXIT_FAILURE;
     }
 
+    dlx::binary::DlxProblemStreamReader reader(*cover_stream.stream);
+    while (!reader.at_end())
+    {
+        dlx::binary::DlxCoverHeader header = {0};
+        problem_number++;
+
+        //
+        if (reader.read_header(&header) != 0)
+        {
+            printf("Failed to read problem %zu from %s.\n", problem_number, cover_path);
+            return EXIT_FAILURE;
+        }
+
+        // Relink into the builder's node array unless the frame reuses the previous cover
+        if ((header.flags & DLX_COVER_FLAG_REUSE_MATRIX) == 0)
+        {
+            matrix = dlx::Core::generateMatrixFromStream(reader, header, builder, &item_count, &option_count);
+            if (matrix == NULL)
+            {
+                printf("Failed to parse problem %zu in %s.\n", problem_number, cover_path);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (matrix == NULL)
+        {
+            printf("Problem %zu in %s references a previous cover, but none precedes it.\n", problem_number, cover_path);
+            return EXIT_FAILURE;
+        }
+
+        // Search buffers only ever grow, so later problems reuse them as-is
+        const size_t depth = static_cast<size_t>(std::max(option_count, 1));
+        if (row_ids.size() < depth)
+        {
+            row_ids.resize(depth);
+            solutions.resize(depth, NULL);
+        }
+
+        //
+        if (!begin_solution_section(item_count, output_ctx))
+        {
+            return EXIT_FAILURE;
+        }
+
+        //
+        if (!reader.assumptions().empty())
+        {
+            dlx::RowIndex row_index;
+            row_index.build(matrix);
+            if (dlx::Core::searchWithAssumptions(matrix,
+                                                 row_index,
+                                                 reader.assumptions(),
+                                                 solutions.data(),
+                                                 row_ids.data(),
+                                                 output_ctx.output)
+                != 0)
+            {
+                printf("Assumptions in problem %zu of %s reference unknown rows.\n", problem_number, cover_path);
+                return EXIT_FAILURE;
+            }
+        }
+        else
+        {
+            dlx::Core::search(matrix, 0, solutions.data(), row_ids.data(), output_ctx.output);
+        }
+    }
+
     //
-    if (!allocate_solution_buffer(matrix_ctx.option_count, solution_buffer))
+    output_ctx.disable_binary_output();
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * Solves the problems of a DLXB stream concurrently on a worker pool and writes one DLXS section per problem, in
+ * input order or, with --as-completed, in completion order tagged with each problem's index.
+ *
+ * @param const char* The path to a binary cover file holding one or more DLXB problems or a piped input stream
+ * @param const char* The path to write the DLXS sections to or a piped output stream
+ * @param const BatchConfig& Worker count and output ordering
+ * @return int
+ */
+int handle_parallel_batch(const char* cover_path, const char* solution_path, const dlx::batch::BatchConfig& config)
+{
+    CoverStream cover_stream;
+    std::unique_ptr<std::ofstream> solution_file;
+    std::ostream* solution_stream = &std::cout;
+
+    //
+    if (!open_cover_stream(cover_path, cover_stream))
     {
         return EXIT_FAILURE;
     }
 
     //
-    if (!setup_output_context(solution_path, matrix_ctx.item_count, output_ctx))
+    if (strcmp(solution_path, "-") != 0)
+    {
+        solution_file = std::make_unique<std::ofstream>(solution_path, std::ios::binary);
+        if (!solution_file->is_open())
+        {
+            printf("Unable to create output file %s.\n", solution_path);
+            return EXIT_FAILURE;
+        }
+        solution_stream = solution_file.get();
+    }
+
+    //
+    dlx::batch::BatchSolver solver(config);
+    if (solver.run(*cover_stream.stream, *solution_stream) != 0)
     {
+        printf("%s (%s)\n", solver.error().c_str(), cover_path);
         return EXIT_FAILURE;
     }
 
+    return EXIT_SUCCESS;
+}
+
+/**
+ * Links a DLXB cover once and writes it as a DLXM snapshot that later runs can map directly.
+ *
+ * @param const char* The path to a binary cover file in DLXB format or a piped input stream
+ * @param const char* The path to write the DLXM snapshot to
+ * @return int
+ */
+int handle_snapshot(const char* cover_path, const char* snapshot_path)
+{
+    CoverStream cover_stream;
+    MatrixContext matrix_ctx;
+    dlx::SearchAssumptions assumptions;
+
     //
-    dlx::Core::search(matrix_ctx.matrix,
-                      0,
-                      matrix_ctx.solutions,
-                      solution_buffer.rows,
-                      output_ctx.output);
-    
+    if (!load_cover_context(cover_path, cover_stream, matrix_ctx, assumptions))
+    {
+        return EXIT_FAILURE;
+    }
+
+    // Snapshots capture the linked matrix only, so refuse to silently drop an assumption block
+    if (!assumptions.empty())
+    {
+        printf("Cover file %s carries assumptions, which snapshots cannot store.\n", cover_path);
+        return EXIT_FAILURE;
+    }
+
     //
-    output_ctx.disable_binary_output();
+    std::ofstream snapshot_stream(snapshot_path, std::ios::binary | std::ios::trunc);
+    if (!snapshot_stream.is_open())
+    {
+        printf("Unable to open snapshot file %s.\n", snapshot_path);
+        return EXIT_FAILURE;
+    }
+
+    //
+    if (dlx::snapshot::write_snapshot(snapshot_stream,
+                                      matrix_ctx.matrix,
+                                      matrix_ctx.item_count,
+                                      matrix_ctx.option_count)
+        != 0)
+    {
+        printf("Failed to write matrix snapshot %s.\n", snapshot_path);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * Re-encodes every problem of a DLXB stream as native-endian (mappable) or portable big-endian DLXB.
+ *
+ * @param const char* The path to a binary cover file in DLXB format or a piped input stream
+ * @param const char* The path to write the converted problems to or a piped output stream
+ * @param bool True to write native-endian problems, false for portable ones
+ * @param uint16_t DLXB version to write, or 0 to keep each problem's version
+ * @return int
+ */
+int handle_convert(const char* cover_path, const char* output_path, bool native, uint16_t version)
+{
+    CoverStream cover_stream;
+    std::unique_ptr<std::ofstream> output_file;
+    std::ostream* output_stream = &std::cout;
+
+    //
+    if (!open_cover_stream(cover_path, cover_stream))
+    {
+        return EXIT_FAILURE;
+    }
+
+    //
+    if (strcmp(output_path, "-") != 0)
+    {
+        output_file = std::make_unique<std::ofstream>(output_path, std::ios::binary | std::ios::trunc);
+        if (!output_file->is_open())
+        {
+            printf("Unable to create output file %s.\n", output_path);
+            return EXIT_FAILURE;
+        }
+        output_stream = output_file.get();
+    }
+
+    //
+    if (dlx::binary::dlx_convert_problems(*cover_stream.stream, *output_stream, native, version) != 0)
+    {
+        printf("Failed to convert binary cover data from %s.\n", cover_path);
+        return EXIT_FAILURE;
+    }
 
+    output_stream->flush();
     return EXIT_SUCCESS;
 }
 
@@ -261,17 +826,144 @@ int handle_cli(const char* cover_path, const char* solution_path)
  */
 int main(int argc, char** argv)
 {
+    // If dlx application was asked to write a snapshot, link the cover and serialize it
+    if (argc >= 3 && argc <= 4 && strcmp(argv[1], "--snapshot") == 0)
+    {
+        const char* snapshot_cover_path = (argc == 4) ? argv[3] : "-";
+        if (strcmp(snapshot_cover_path, "-") != 0 && !std::filesystem::exists(snapshot_cover_path))
+        {
+            printf("Cover file %s does not exist.\n", snapshot_cover_path);
+            return EXIT_FAILURE;
+        }
+        return handle_snapshot(snapshot_cover_path, argv[2]);
+    }
+
+    // If dlx application was asked to re-encode a cover stream, convert it between native and portable DLXB
+    if (argc >= 2 && strcmp(argv[1], "--convert") == 0)
+    {
+        bool native = true;
+        uint16_t version = 0;
+        const char* convert_paths[2] = {"-", "-"};
+        int path_count = 0;
+
+        for (int i = 2; i < argc; i++)
+        {
+            if (strcmp(argv[i], "--native") == 0)
+            {
+                native = true;
+            }
+            else if (strcmp(argv[i], "--portable") == 0)
+            {
+                native = false;
+            }
+            else if (strcmp(argv[i], "--version") == 0 && i + 1 < argc)
+            {
+                long requested = strtol(argv[++i], nullptr, 10);
+                if (requested < 1 || requested > DLX_BINARY_VERSION)
+                {
+                    print_usage();
+                    return EXIT_FAILURE;
+                }
+                version = static_cast<uint16_t>(requested);
+            }
+            else if (path_count < 2)
+            {
+                convert_paths[path_count++] = argv[i];
+            }
+            else
+            {
+                print_usage();
+                return EXIT_FAILURE;
+            }
+        }
+
+        if (strcmp(convert_paths[0], "-") != 0 && !std::filesystem::exists(convert_paths[0]))
+        {
+            printf("Cover file %s does not exist.\n", convert_paths[0]);
+            return EXIT_FAILURE;
+        }
+        return handle_convert(convert_paths[0], convert_paths[1], native, version);
+    }
+
+    // If dlx application was asked to solve a multi-problem stream, solve it sequentially or on a worker pool
+    if (argc >= 2 && strcmp(argv[1], "--batch") == 0)
+    {
+        dlx::batch::BatchConfig batch_config;
+        bool parallel = false;
+        bool async_output = false;
+        const char* batch_paths[2] = {"-", "-"};
+        int path_count = 0;
+
+        for (int i = 2; i < argc; i++)
+        {
+            if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc)
+            {
+                long workers = strtol(argv[++i], nullptr, 10);
+                if (workers < 0 || workers > 1024)
+                {
+                    print_usage();
+                    return EXIT_FAILURE;
+                }
+                batch_config.workers = static_cast<unsigned int>(workers);
+                parallel = true;
+            }
+            else if (strcmp(argv[i], "--as-completed") == 0)
+            {
+                batch_config.order = dlx::batch::OutputOrder::AsCompleted;
+                parallel = true;
+            }
+            else if (strcmp(argv[i], "--async") == 0)
+            {
+                async_output = true;
+            }
+            else if (path_count < 2)
+            {
+                batch_paths[path_count++] = argv[i];
+            }
+            else
+            {
+                print_usage();
+                return EXIT_FAILURE;
+            }
+        }
+
+        if (strcmp(batch_paths[0], "-") != 0 && !std::filesystem::exists(batch_paths[0]))
+        {
+            printf("Cover file %s does not exist.\n", batch_paths[0]);
+            return EXIT_FAILURE;
+        }
+        if (parallel)
+        {
+            return handle_parallel_batch(batch_paths[0], batch_paths[1], batch_config);
+        }
+        return handle_batch(batch_paths[0], batch_paths[1], async_output);
+    }
+
+    // If dlx application was asked for write-behind output, drop the flag and solve as usual
+    bool async_output = false;
+    if (argc >= 2 && strcmp(argv[1], "--async") == 0)
+    {
+        async_output = true;
+        argv++;
+        argc--;
+        if (argc >= 2 && strncmp(argv[1], "--", 2) == 0)
+        {
+            print_usage();
+            return EXIT_FAILURE;
+        }
+    }
+
     // If an unknown set of arguments were provided, abort and print the cli usage.
-    if (argc > 3 && strcmp(argv[1], "--server") != 0)
+    if ((argc > 3 && strcmp(argv[1], "--server") != 0) || (argc >= 2 && strcmp(argv[1], "--snapshot") == 0))
     {
         print_usage();
         return EXIT_FAILURE;
     }
 
     // If dlx application was started as a TCP server, instantiate the server
-    if (argc == 4 && strcmp(argv[1], "--server") == 0)
+    if (argc >= 4 && strcmp(argv[1], "--server") == 0)
     {
-        return instantiate_server(argv);
+        return instantiate_server(argc, argv);
     }
 
     // Determine if paths are files or pipes
@@ -286,5 +978,5 @@ int main(int argc, char** argv)
     }
 
     // Handle cli execution with provided cover path and solution output path
-    return handle_cli(cover_path, solution_output_path);
+    return handle_cli(cover_path, solution_output_path, async_output);
 }
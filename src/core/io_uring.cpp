@@ -0,0 +1,499 @@
+#include "core/io_uring.h"
+
+#if defined(DLX_HAVE_IO_URING)
+
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+
+namespace dlx::io {
+
+namespace {
+
+int io_uring_setup(unsigned entries, struct io_uring_params* params)
+{
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int io_uring_enter(int fd, unsigned submit, unsigned wait_count, unsigned flags)
+{
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, submit, wait_count, flags, nullptr, 0));
+}
+
+int io_uring_register(int fd, unsigned opcode, const void* arg, unsigned count)
+{
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, count));
+}
+
+unsigned* ring_field(void* map, uint32_t offset)
+{
+    return reinterpret_cast<unsigned*>(static_cast<char*>(map) + offset);
+}
+
+} // namespace
+
+IoUring::IoUring()
+    : fd_(-1)
+    , sq_map_(MAP_FAILED)
+    , sq_map_bytes_(0)
+    , cq_map_(MAP_FAILED)
+    , cq_map_bytes_(0)
+    , sqes_(nullptr)
+    , sqes_bytes_(0)
+    , sq_head_(nullptr)
+    , sq_tail_(nullptr)
+    , sq_array_(nullptr)
+    , sq_mask_(0)
+    , sq_entries_(0)
+    , sqe_tail_(0)
+    , cq_head_(nullptr)
+    , cq_tail_(nullptr)
+    , cq_mask_(0)
+    , cqes_(nullptr)
+{}
+
+IoUring::~IoUring()
+{
+    release();
+}
+
+/**
+ * Sets up the ring and maps its queues. The server needs multishot accept, cancel-any and zero-copy sends,
+ * which all arrived by Linux 6.0, so the IORING_OP_SEND_ZC probe doubles as the kernel version check.
+ *
+ * @param unsigned Submission queue size; the kernel rounds it up to a power of two.
+ * @return int 0 on success, -1 otherwise.
+ */
+int IoUring::init(unsigned entries)
+{
+    release();
+
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_SUBMIT_ALL | IORING_SETUP_COOP_TASKRUN;
+    fd_ = io_uring_setup(entries, &params);
+    if (fd_ < 0)
+    {
+        return -1;
+    }
+    if ((params.features & IORING_FEAT_NODROP) == 0)
+    {
+        release();
+        return -1;
+    }
+
+    sq_map_bytes_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_map_bytes_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    const bool single_map = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_map)
+    {
+        sq_map_bytes_ = std::max(sq_map_bytes_, cq_map_bytes_);
+    }
+
+    sq_map_ = mmap(nullptr, sq_map_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+    if (sq_map_ == MAP_FAILED)
+    {
+        release();
+        return -1;
+    }
+    if (!single_map)
+    {
+        cq_map_ = mmap(nullptr, cq_map_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+        if (cq_map_ == MAP_FAILED)
+        {
+            release();
+            return -1;
+        }
+    }
+    void* cq_map = single_map ? sq_map_ : cq_map_;
+
+    sqes_bytes_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    void* sqes = mmap(nullptr, sqes_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED)
+    {
+        release();
+        return -1;
+    }
+    sqes_ = static_cast<struct io_uring_sqe*>(sqes);
+
+    sq_head_ = ring_field(sq_map_, params.sq_off.head);
+    sq_tail_ = ring_field(sq_map_, params.sq_off.tail);
+    sq_mask_ = *ring_field(sq_map_, params.sq_off.ring_mask);
+    sq_entries_ = params.sq_entries;
+    sq_array_ = ring_field(sq_map_, params.sq_off.array);
+    sqe_tail_ = *sq_tail_;
+    cq_head_ = ring_field(cq_map, params.cq_off.head);
+    cq_tail_ = ring_field(cq_map, params.cq_off.tail);
+    cq_mask_ = *ring_field(cq_map, params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<struct io_uring_cqe*>(static_cast<char*>(cq_map) + params.cq_off.cqes);
+
+    // Entries are always used in ring order, so the indirection array is the identity.
+    for (unsigned i = 0; i < sq_entries_; i++)
+    {
+        sq_array_[i] = i;
+    }
+
+    const size_t probe_bytes = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+    std::vector<char> probe_storage(probe_bytes, 0);
+    auto* probe = reinterpret_cast<struct io_uring_probe*>(probe_storage.data());
+    supported_.assign(256, false);
+    if (io_uring_register(fd_, IORING_REGISTER_PROBE, probe, 256) == 0)
+    {
+        for (unsigned i = 0; i < probe->ops_len; i++)
+        {
+            if ((probe->ops[i].flags & IO_URING_OP_SUPPORTED) != 0)
+            {
+                supported_[probe->ops[i].op] = true;
+            }
+        }
+    }
+    if (!supports(IORING_OP_SEND_ZC))
+    {
+        release();
+        return -1;
+    }
+    return 0;
+}
+
+void IoUring::release()
+{
+    if (sqes_ != nullptr)
+    {
+        munmap(sqes_, sqes_bytes_);
+        sqes_ = nullptr;
+    }
+    if (cq_map_ != MAP_FAILED)
+    {
+        munmap(cq_map_, cq_map_bytes_);
+        cq_map_ = MAP_FAILED;
+    }
+    if (sq_map_ != MAP_FAILED)
+    {
+        munmap(sq_map_, sq_map_bytes_);
+        sq_map_ = MAP_FAILED;
+    }
+    if (fd_ >= 0)
+    {
+        close(fd_);
+        fd_ = -1;
+    }
+}
+
+struct io_uring_sqe* IoUring::next_sqe()
+{
+    if (sqe_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_)
+    {
+        submit(0);
+        if (sqe_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_)
+        {
+            return nullptr;
+        }
+    }
+
+    struct io_uring_sqe* sqe = &sqes_[sqe_tail_ & sq_mask_];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe_tail_++;
+    return sqe;
+}
+
+/**
+ * @return int Entries the kernel accepted, or -1 with errno set (EINTR included, so callers can recheck state).
+ */
+int IoUring::submit(unsigned wait_count)
+{
+    __atomic_store_n(sq_tail_, sqe_tail_, __ATOMIC_RELEASE);
+    const unsigned pending = sqe_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    if (pending == 0 && wait_count == 0)
+    {
+        return 0;
+    }
+    return io_uring_enter(fd_, pending, wait_count, wait_count > 0 ? IORING_ENTER_GETEVENTS : 0);
+}
+
+bool IoUring::pop(struct io_uring_cqe* cqe)
+{
+    const unsigned head = *cq_head_;
+    if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE))
+    {
+        return false;
+    }
+    *cqe = cqes_[head & cq_mask_];
+    __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+int IoUring::register_buffers(const struct iovec* buffers, unsigned count)
+{
+    return io_uring_register(fd_, IORING_REGISTER_BUFFERS, buffers, count) == 0 ? 0 : -1;
+}
+
+UringSendQueue::UringSendQueue()
+    : slot_bytes_(0)
+    , in_flight_(0)
+    , zero_copy_(false)
+{}
+
+/**
+ * Outstanding sends are cancelled and waited for, so the kernel never touches the region after it is freed.
+ */
+UringSendQueue::~UringSendQueue()
+{
+    if (!busy())
+    {
+        return;
+    }
+
+    struct io_uring_sqe* sqe = ring_.next_sqe();
+    if (sqe != nullptr)
+    {
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->fd = -1;
+        sqe->cancel_flags = IORING_ASYNC_CANCEL_ANY;
+        sqe->user_data = UINT64_MAX;
+    }
+    for (auto& slot : slots_)
+    {
+        if (slot.channel != nullptr)
+        {
+            slot.channel->closed = true;
+        }
+    }
+    drain();
+}
+
+/**
+ * @param unsigned Number of slots, which bounds the bytes queued across every channel.
+ * @param size_t Size of each slot.
+ * @return int 0 on success, -1 when io_uring cannot be used.
+ */
+int UringSendQueue::init(unsigned slots, size_t slot_bytes)
+{
+    if (slots == 0 || slot_bytes == 0 || ring_.init(slots * 2) != 0)
+    {
+        return -1;
+    }
+
+    slot_bytes_ = slot_bytes;
+    region_.reset(new char[slots * slot_bytes]);
+    slots_.assign(slots, Slot());
+    free_.clear();
+    for (uint32_t slot = slots; slot > 0; slot--)
+    {
+        free_.push_back(slot - 1);
+    }
+
+    // Zero-copy sends need the slots registered; without that (e.g. RLIMIT_MEMLOCK) plain sends still batch.
+    std::vector<struct iovec> buffers(slots);
+    for (unsigned i = 0; i < slots; i++)
+    {
+        buffers[i].iov_base = region_.get() + i * slot_bytes;
+        buffers[i].iov_len = slot_bytes;
+    }
+    zero_copy_ = ring_.register_buffers(buffers.data(), slots) == 0;
+    return 0;
+}
+
+char* UringSendQueue::acquire(uint32_t* slot)
+{
+    poll();
+    while (free_.empty() && busy())
+    {
+        if (ring_.submit(1) < 0 && errno != EINTR)
+        {
+            break;
+        }
+        struct io_uring_cqe cqe;
+        while (ring_.pop(&cqe))
+        {
+            complete(cqe);
+        }
+    }
+    if (free_.empty())
+    {
+        return nullptr;
+    }
+
+    *slot = free_.back();
+    free_.pop_back();
+    return region_.get() + static_cast<size_t>(*slot) * slot_bytes_;
+}
+
+void UringSendQueue::release(uint32_t slot)
+{
+    slots_[slot] = Slot();
+    free_.push_back(slot);
+}
+
+void UringSendQueue::send(const std::shared_ptr<SendChannel>& channel, uint32_t slot, size_t size)
+{
+    if (channel->failed || channel->closed || size == 0)
+    {
+        release(slot);
+        return;
+    }
+
+    slots_[slot].channel = channel;
+    channel->queue.push_back({slot, size});
+    if (!channel->busy)
+    {
+        start_next(*channel);
+    }
+}
+
+void UringSendQueue::poll()
+{
+    if (!busy())
+    {
+        return;
+    }
+    ring_.submit(0);
+    struct io_uring_cqe cqe;
+    while (ring_.pop(&cqe))
+    {
+        complete(cqe);
+    }
+}
+
+void UringSendQueue::drain()
+{
+    while (busy())
+    {
+        if (ring_.submit(1) < 0 && errno != EINTR)
+        {
+            break;
+        }
+        struct io_uring_cqe cqe;
+        while (ring_.pop(&cqe))
+        {
+            complete(cqe);
+        }
+    }
+}
+
+void UringSendQueue::start_next(SendChannel& channel)
+{
+    while (!channel.queue.empty())
+    {
+        const SendChannel::Pending pending = channel.queue.front();
+        channel.queue.pop_front();
+        if (channel.failed || channel.closed)
+        {
+            release(pending.slot);
+            continue;
+        }
+
+        Slot& slot = slots_[pending.slot];
+        slot.offset = 0;
+        slot.size = pending.size;
+        start(pending.slot);
+        return;
+    }
+}
+
+/**
+ * Queues the unsent part of @p index. The channel itself is found again through the slot, which keeps it
+ * alive for as long as the kernel might still report on it.
+ */
+void UringSendQueue::start(uint32_t index)
+{
+    Slot& slot = slots_[index];
+    struct io_uring_sqe* sqe = ring_.next_sqe();
+    if (sqe == nullptr)
+    {
+        std::shared_ptr<SendChannel> owner = slot.channel;
+        owner->failed = true;
+        owner->busy = false;
+        release(index);
+        start_next(*owner);
+        return;
+    }
+
+    // Zero copy only pays for itself on large sends: it costs an extra completion and, over loopback, still
+    // copies. Full slots go out from the registered buffers, the short tail of a stream as a plain send.
+    const bool zero_copy = zero_copy_ && slot.size == slot_bytes_;
+    sqe->opcode = zero_copy ? IORING_OP_SEND_ZC : IORING_OP_SEND;
+    sqe->fd = slot.channel->fd;
+    sqe->addr = reinterpret_cast<uintptr_t>(region_.get() + static_cast<size_t>(index) * slot_bytes_ + slot.offset);
+    sqe->len = static_cast<uint32_t>(slot.size - slot.offset);
+    sqe->msg_flags = MSG_NOSIGNAL;
+    if (zero_copy)
+    {
+        sqe->ioprio = IORING_RECVSEND_FIXED_BUF;
+        sqe->buf_index = static_cast<uint16_t>(index);
+    }
+    sqe->user_data = index;
+
+    slot.channel->busy = true;
+    slot.sending = true;
+    slot.outstanding++;
+    in_flight_++;
+}
+
+void UringSendQueue::complete(const struct io_uring_cqe& cqe)
+{
+    if (cqe.user_data >= slots_.size())
+    {
+        return; // The cancellation request itself.
+    }
+
+    const uint32_t index = static_cast<uint32_t>(cqe.user_data);
+    Slot& slot = slots_[index];
+    in_flight_--;
+    slot.outstanding--;
+
+    // A zero-copy send reports its result first and, flagged IORING_CQE_F_MORE, a notification once the
+    // kernel no longer reads the buffer.
+    if ((cqe.flags & IORING_CQE_F_NOTIF) != 0)
+    {
+        if (slot.outstanding == 0 && !slot.sending)
+        {
+            release(index);
+        }
+        return;
+    }
+    if ((cqe.flags & IORING_CQE_F_MORE) != 0)
+    {
+        slot.outstanding++;
+        in_flight_++;
+    }
+
+    SendChannel& channel = *slot.channel;
+    if ((cqe.res == -EAGAIN || cqe.res == -EINTR) && !channel.closed)
+    {
+        start(index);
+        return;
+    }
+    if (cqe.res <= 0)
+    {
+        channel.failed = true;
+    }
+    else
+    {
+        slot.offset += static_cast<size_t>(cqe.res);
+    }
+
+    if (!channel.failed && !channel.closed && slot.offset < slot.size)
+    {
+        // Short send: the rest goes out before anything else queued on the channel. Zero-copy slots are only
+        // reused once their notification arrived, but the next send may be queued now.
+        start(index);
+        return;
+    }
+
+    slot.sending = false;
+    channel.busy = false;
+    std::shared_ptr<SendChannel> owner = slot.channel;
+    if (slot.outstanding == 0)
+    {
+        release(index);
+    }
+    start_next(*owner);
+}
+
+} // namespace dlx::io
+
+#endif
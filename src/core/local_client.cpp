@@ -0,0 +1,261 @@
+#include "core/local_client.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <chrono>
+#include <streambuf>
+
+namespace dlx {
+
+namespace {
+
+// How long either wait sleeps on its futex before checking that the server is still connected.
+constexpr std::chrono::milliseconds kLivenessPoll(50);
+
+/** True once the peer of @p fd has hung up; futex waits cannot tell a dead process from a slow one. */
+bool peer_hung_up(int fd)
+{
+    pollfd hangup = {fd, 0, 0};
+    return fd < 0 || (poll(&hangup, 1, 0) > 0 && (hangup.revents & (POLLHUP | POLLERR)) != 0);
+}
+
+} // namespace
+
+/** Put area over the segment's problem area; a frame that does not fit fails the stream. */
+class DlxLocalClient::ProblemBuffer : public std::streambuf
+{
+public:
+    void reset(char* area, size_t size) { setp(area, area + size); }
+    size_t written() const { return static_cast<size_t>(pptr() - pbase()); }
+
+protected:
+    int overflow(int ch) override { return ch == traits_type::eof() ? traits_type::not_eof(ch) : traits_type::eof(); }
+};
+
+/** Get area over the readable span of the ring, handed back to the server once read. */
+class DlxLocalClient::RingBuffer : public std::streambuf
+{
+public:
+    RingBuffer(shm::ShmRing& ring, int fd)
+        : ring_(&ring)
+        , fd_(fd)
+    {}
+
+protected:
+    int underflow() override
+    {
+        ring_->consume(static_cast<size_t>(egptr() - eback()));
+        setg(nullptr, nullptr, nullptr);
+
+        while (true)
+        {
+            const char* data = nullptr;
+            const size_t available = ring_->peek(&data);
+            if (available > 0)
+            {
+                char* begin = const_cast<char*>(data);
+                setg(begin, begin, begin + available);
+                return traits_type::to_int_type(*gptr());
+            }
+            // The writer publishes its last bytes before closing, so one more look finds them.
+            if (ring_->writer_closed())
+            {
+                if (ring_->peek(&data) > 0)
+                {
+                    continue;
+                }
+                return traits_type::eof();
+            }
+            if (!ring_->wait_readable(kLivenessPoll) && peer_hung_up(fd_))
+            {
+                return traits_type::eof();
+            }
+        }
+    }
+
+private:
+    shm::ShmRing* ring_;
+    int fd_;
+};
+
+DlxLocalClient::DlxLocalClient()
+    : fd_(-1)
+    , submitted_(0)
+    , problem_stream_(nullptr)
+    , solution_stream_(nullptr)
+{}
+
+DlxLocalClient::~DlxLocalClient()
+{
+    close();
+}
+
+/**
+ * Creates the segment, connects and sends the attach request with the segment's descriptor.
+ *
+ * @return int 0 on success, -1 otherwise.
+ */
+int DlxLocalClient::connect(const std::string& path, size_t problem_bytes, size_t ring_bytes)
+{
+    close();
+
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    segment_ = std::make_unique<shm::ShmSegment>();
+    if (path.empty() || path.size() >= sizeof(addr.sun_path) || segment_->create(ring_bytes, problem_bytes) != 0)
+    {
+        close();
+        return -1;
+    }
+    memcpy(addr.sun_path, path.c_str(), path.size());
+
+    fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0 || ::connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0
+        || send_request(shm::kLocalAttach, 0, 0, segment_->fd()) != 0)
+    {
+        close();
+        return -1;
+    }
+
+    ring_ = std::make_unique<shm::ShmRing>(*segment_);
+    problem_buffer_ = std::make_unique<ProblemBuffer>();
+    ring_buffer_ = std::make_unique<RingBuffer>(*ring_, fd_);
+    problem_stream_.rdbuf(problem_buffer_.get());
+    solution_stream_.rdbuf(ring_buffer_.get());
+    problem_stream_.clear();
+    solution_stream_.clear();
+    return 0;
+}
+
+std::ostream& DlxLocalClient::problem()
+{
+    if (fd_ < 0)
+    {
+        problem_stream_.setstate(std::ios::badbit);
+        return problem_stream_;
+    }
+
+    // The area still holds the last submitted frame until the server counts it as decoded.
+    std::atomic<uint32_t>& decoded = segment_->header()->decoded;
+    uint32_t seen = decoded.load(std::memory_order_acquire);
+    while (seen != submitted_)
+    {
+        shm::futex_wait(&decoded, seen, kLivenessPoll);
+        const uint32_t now = decoded.load(std::memory_order_acquire);
+        if (now == seen && server_gone())
+        {
+            problem_stream_.setstate(std::ios::badbit);
+            return problem_stream_;
+        }
+        seen = now;
+    }
+
+    problem_buffer_->reset(segment_->problem_area(), segment_->problem_bytes());
+    problem_stream_.clear();
+    return problem_stream_;
+}
+
+int DlxLocalClient::submit()
+{
+    if (fd_ < 0)
+    {
+        return -1;
+    }
+
+    const size_t length = problem_buffer_->written();
+    const bool complete = problem_stream_.flush().good() && length > 0;
+    problem_buffer_->reset(nullptr, 0);
+    if (!complete || send_request(shm::kLocalSubmit, 0, static_cast<uint32_t>(length), -1) != 0)
+    {
+        return -1;
+    }
+    submitted_++;
+    return 0;
+}
+
+std::istream& DlxLocalClient::solutions()
+{
+    if (fd_ < 0)
+    {
+        solution_stream_.setstate(std::ios::badbit);
+    }
+    return solution_stream_;
+}
+
+void DlxLocalClient::finish()
+{
+    if (fd_ >= 0)
+    {
+        shutdown(fd_, SHUT_WR);
+    }
+}
+
+void DlxLocalClient::close()
+{
+    problem_stream_.rdbuf(nullptr);
+    solution_stream_.rdbuf(nullptr);
+    problem_buffer_.reset();
+    ring_buffer_.reset();
+    if (ring_ != nullptr)
+    {
+        ring_->close_reader();
+        ring_.reset();
+    }
+    if (fd_ >= 0)
+    {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    segment_.reset();
+    submitted_ = 0;
+}
+
+/**
+ * Writes one LocalRequest, passing @p passed_fd along with it when it is not negative.
+ *
+ * @return int 0 on success, -1 otherwise.
+ */
+int DlxLocalClient::send_request(uint32_t op, uint32_t offset, uint32_t length, int passed_fd)
+{
+    const uint32_t words[4] = {htonl(DLX_LOCAL_MAGIC), htonl(op), htonl(offset), htonl(length)};
+    iovec payload = {const_cast<uint32_t*>(words), sizeof(words)};
+    union
+    {
+        cmsghdr header;
+        char space[CMSG_SPACE(sizeof(int))];
+    } control;
+
+    msghdr message = {};
+    message.msg_iov = &payload;
+    message.msg_iovlen = 1;
+    if (passed_fd >= 0)
+    {
+        memset(&control, 0, sizeof(control));
+        message.msg_control = control.space;
+        message.msg_controllen = sizeof(control.space);
+        cmsghdr* header = CMSG_FIRSTHDR(&message);
+        header->cmsg_level = SOL_SOCKET;
+        header->cmsg_type = SCM_RIGHTS;
+        header->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(header), &passed_fd, sizeof(int));
+    }
+
+    ssize_t written;
+    do
+    {
+        written = sendmsg(fd_, &message, MSG_NOSIGNAL);
+    } while (written < 0 && errno == EINTR);
+    return written == static_cast<ssize_t>(sizeof(words)) ? 0 : -1;
+}
+
+bool DlxLocalClient::server_gone() const
+{
+    return peer_hung_up(fd_);
+}
+
+} // namespace dlx
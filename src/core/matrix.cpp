@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <climits>
 #include <cstdlib>
 #include <ostream>
 #include "core/dlx.h"
@@ -141,4 +143,343 @@ void dumpMatrixStructure(const struct node* matrix,
     output.flush();
 }
 
+/**
+ * Moves every link in the used prefix of a reallocated node array onto its new base address.
+ *
+ * The builder stores absolute pointers while it links rows, so when realloc moves the block each
+ * non-null link is translated by its index relative to the old base.
+ *
+ * @param matrix New address of the node array.
+ * @param last_index Highest node index in use.
+ * @param old_base Address of the node array before it moved.
+ */
+void rebaseMatrixLinks(struct node* matrix, size_t last_index, uintptr_t old_base)
+{
+    auto rebase = [&](struct node*& link) {
+        if (link != nullptr)
+        {
+            link = matrix + (reinterpret_cast<uintptr_t>(link) - old_base) / sizeof(struct node);
+        }
+    };
+
+    for (size_t i = 0; i <= last_index; ++i)
+    {
+        rebase(matrix[i].top);
+        rebase(matrix[i].up);
+        rebase(matrix[i].down);
+        rebase(matrix[i].left);
+        rebase(matrix[i].right);
+    }
+}
+
+/**
+ * Counts the nodes of a freshly linked matrix by walking its contiguous array until the spacer that
+ * closes the final option row.
+ *
+ * @param matrix Matrix head returned by one of the generators.
+ * @param itemCount Number of item columns.
+ * @param optionCount Number of option rows.
+ * @return Highest node index in use (the nodeCount reported by the builders).
+ */
+size_t countMatrixNodes(const struct node* matrix, int itemCount, int optionCount)
+{
+    // Spacers are the only nodes past the column headers whose top link is the head.
+    size_t index = static_cast<size_t>(itemCount) + 1;
+    int spacers = 0;
+    while (spacers < optionCount)
+    {
+        index++;
+        if (matrix[index].top == matrix)
+        {
+            spacers++;
+        }
+    }
+    return index;
+}
+
+MatrixBuilder::MatrixBuilder()
+    : matrix_(nullptr)
+    , capacity_(0)
+    , last_index_(0)
+    , spacer_index_(0)
+    , column_count_(0)
+    , row_count_(0)
+{}
+
+MatrixBuilder::~MatrixBuilder()
+{
+    reset();
+}
+
+void MatrixBuilder::reset()
+{
+    free(matrix_);
+    matrix_ = nullptr;
+    capacity_ = 0;
+    last_index_ = 0;
+    spacer_index_ = 0;
+    column_count_ = 0;
+    row_count_ = 0;
+}
+
+/**
+ * Ensures the node array can hold at least @p nodes entries.
+ *
+ * Capacity at least doubles on every growth so the total relinking cost stays linear. When realloc
+ * moves the block every pointer in the used prefix is rebased onto the new address.
+ *
+ * @param nodes Required number of node slots (including the head).
+ * @return 0 on success, -1 on allocation failure.
+ */
+int MatrixBuilder::reserve(size_t nodes)
+{
+    if (nodes <= capacity_)
+    {
+        return 0;
+    }
+
+    size_t new_capacity = std::max(nodes, capacity_ * 2);
+    uintptr_t old_base = reinterpret_cast<uintptr_t>(matrix_);
+    struct node* grown = static_cast<struct node*>(realloc(matrix_, sizeof(struct node) * new_capacity));
+    if (grown == nullptr)
+    {
+        return -1;
+    }
+
+    if (old_base != 0 && reinterpret_cast<uintptr_t>(grown) != old_base)
+    {
+        rebaseMatrixLinks(grown, last_index_, old_base);
+    }
+
+    matrix_ = grown;
+    capacity_ = new_capacity;
+    return 0;
+}
+
+/**
+ * Starts a new matrix with @p column_count column headers and the leading spacer node.
+ *
+ * The hints only size the allocation; rows beyond them are still accepted. A node array left over
+ * from an earlier matrix is reused, so repeated builds stop allocating once it is large enough.
+ *
+ * @param column_count Number of item columns.
+ * @param row_hint Expected number of option rows.
+ * @param entry_hint Expected number of option nodes across all rows.
+ * @return 0 on success, -1 on invalid input or allocation failure.
+ */
+int MatrixBuilder::begin(uint32_t column_count, size_t row_hint, size_t entry_hint)
+{
+    // Keep the node array so batches of problems relink into the same memory.
+    last_index_ = 0;
+    spacer_index_ = 0;
+    column_count_ = 0;
+    row_count_ = 0;
+
+    if (column_count == 0 || column_count > static_cast<uint32_t>(INT_MAX))
+    {
+        return -1;
+    }
+
+    size_t hinted = static_cast<size_t>(column_count) + 2 + row_hint + entry_hint;
+    size_t minimum = static_cast<size_t>(column_count) + 2;
+    if (reserve(std::max(std::min(hinted, static_cast<size_t>(INT_MAX)), minimum)) != 0)
+    {
+        return -1;
+    }
+
+    struct node* matrix = matrix_;
+    matrix[0].len = 0;
+    matrix[0].data = 0;
+    matrix[0].top = matrix;
+    matrix[0].up = nullptr;
+    matrix[0].down = nullptr;
+    matrix[0].left = matrix;
+    matrix[0].right = matrix;
+
+    for (uint32_t i = 0; i < column_count; ++i)
+    {
+        struct node* column = &matrix[i + 1];
+        column->len = 0;
+        column->top = matrix;
+        column->left = &matrix[i];
+        column->right = matrix;
+        column->up = column;
+        column->down = column;
+        column->data = static_cast<int>(i + 1);
+
+        matrix[i].right = column;
+        matrix[0].left = column;
+    }
+
+    // Leading spacer: its down pointer is completed once the first row is linked.
+    spacer_index_ = static_cast<size_t>(column_count) + 1;
+    struct node* spacer = &matrix[spacer_index_];
+    spacer->len = 0;
+    spacer->data = 0;
+    spacer->top = matrix;
+    spacer->up = matrix;
+    spacer->down = matrix;
+    spacer->left = nullptr;
+    spacer->right = nullptr;
+
+    last_index_ = spacer_index_;
+    column_count_ = column_count;
+    return 0;
+}
+
+/**
+ * Links one option row beneath the current column tails and closes it with a spacer node.
+ *
+ * A row id of zero is replaced by the row's one-based position, matching the DLXB loaders.
+ *
+ * @param row_id Identifier recorded in the trailing spacer.
+ * @param columns Zero-based column indices in any order; the caller's buffer is never modified.
+ * @param column_count Number of entries in @p columns.
+ * @return 0 on success, -1 on invalid input or allocation failure.
+ */
+int MatrixBuilder::append_row(uint32_t row_id, const uint32_t* columns, uint16_t column_count)
+{
+    if (matrix_ == nullptr || (column_count > 0 && columns == nullptr))
+    {
+        return -1;
+    }
+
+    if (row_id == 0)
+    {
+        row_id = static_cast<uint32_t>(row_count_ + 1);
+    }
+    if (row_id > static_cast<uint32_t>(INT_MAX) || row_count_ >= static_cast<size_t>(INT_MAX))
+    {
+        return -1;
+    }
+
+    // Rows from well-formed covers arrive sorted; only unsorted rows pay for a scratch copy.
+    if (column_count > 1 && !std::is_sorted(columns, columns + column_count))
+    {
+        scratch_.assign(columns, columns + column_count);
+        std::sort(scratch_.begin(), scratch_.end());
+        columns = scratch_.data();
+    }
+    if (column_count > 0 && columns[column_count - 1] >= column_count_)
+    {
+        return -1;
+    }
+
+    // Room for every entry plus the trailing spacer.
+    size_t required = last_index_ + column_count + 2;
+    if (required - 1 > static_cast<size_t>(INT_MAX) || reserve(required) != 0)
+    {
+        return -1;
+    }
+
+    struct node* matrix = matrix_;
+    size_t first_index = last_index_ + 1;
+    for (uint16_t i = 0; i < column_count; ++i)
+    {
+        if (i > 0 && columns[i] == columns[i - 1])
+        {
+            continue;
+        }
+
+        size_t index = ++last_index_;
+        struct node* item = &matrix[columns[i] + 1];
+        struct node* tail = item->up;
+        struct node* option = &matrix[index];
+
+        option->len = 0;
+        option->data = static_cast<int>(index);
+        option->top = item;
+        option->up = tail;
+        option->down = item;
+        option->left = nullptr;
+        option->right = nullptr;
+
+        tail->down = option;
+        item->up = option;
+        item->len += 1;
+    }
+
+    const bool has_nodes = (last_index_ >= first_index);
+    matrix[spacer_index_].down = has_nodes ? &matrix[last_index_] : matrix;
+
+    spacer_index_ = ++last_index_;
+    struct node* spacer = &matrix[spacer_index_];
+    spacer->len = 0;
+    spacer->data = -static_cast<int>(row_id);
+    spacer->top = matrix;
+    spacer->up = has_nodes ? &matrix[first_index] : matrix;
+    spacer->down = matrix;
+    spacer->left = nullptr;
+    spacer->right = nullptr;
+
+    row_count_ += 1;
+    return 0;
+}
+
+/**
+ * Exposes the matrix linked so far without transferring ownership.
+ *
+ * The returned head is valid until the next @ref begin, @ref finish, or @ref reset, and must not be
+ * passed to Core::freeMemory. Callers supply their own per-level solution buffer.
+ *
+ * @return Pointer to the matrix head, or nullptr when nothing has been started.
+ */
+struct node* MatrixBuilder::matrix(int* item_count_out, int* option_count_out) const
+{
+    if (matrix_ == nullptr || column_count_ == 0 || item_count_out == nullptr || option_count_out == nullptr)
+    {
+        return nullptr;
+    }
+
+    *item_count_out = static_cast<int>(column_count_);
+    *option_count_out = static_cast<int>(row_count_);
+    return matrix_;
+}
+
+/**
+ * Finalizes the matrix, trims unused capacity, and allocates the per-level solution buffer.
+ *
+ * Ownership of the node array and solution buffer moves to the caller, who releases them with
+ * Core::freeMemory. The builder is left empty.
+ *
+ * @return Pointer to the matrix head, or nullptr when nothing was built or allocation failed.
+ */
+struct node* MatrixBuilder::finish(char*** solutions_out, int* item_count_out, int* option_count_out)
+{
+    if (matrix_ == nullptr || solutions_out == nullptr || item_count_out == nullptr || option_count_out == nullptr)
+    {
+        return nullptr;
+    }
+
+    char** solutions = static_cast<char**>(calloc(std::max<size_t>(row_count_, 1), sizeof(char*)));
+    if (solutions == nullptr)
+    {
+        return nullptr;
+    }
+
+    if (capacity_ > last_index_ + 1)
+    {
+        uintptr_t old_base = reinterpret_cast<uintptr_t>(matrix_);
+        struct node* trimmed = static_cast<struct node*>(realloc(matrix_, sizeof(struct node) * (last_index_ + 1)));
+        if (trimmed != nullptr)
+        {
+            if (reinterpret_cast<uintptr_t>(trimmed) != old_base)
+            {
+                rebaseMatrixLinks(trimmed, last_index_, old_base);
+            }
+            matrix_ = trimmed;
+            capacity_ = last_index_ + 1;
+        }
+    }
+
+    struct node* matrix = matrix_;
+    *solutions_out = solutions;
+    *item_count_out = static_cast<int>(column_count_);
+    *option_count_out = static_cast<int>(row_count_);
+
+    matrix_ = nullptr;
+    reset();
+    return matrix;
+}
+
 } // namespace dlx::matrix
@@ -0,0 +1,233 @@
+#include "core/result_cache.h"
+#include <algorithm>
+#include <numeric>
+
+namespace dlx {
+
+namespace {
+
+// FNV-1a over 32-bit words, finished with a 64-bit mixer so neighbouring keys spread over the table.
+uint64_t hash_words(uint64_t hash, const uint32_t* words, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        hash = (hash ^ words[i]) * 0x100000001B3ull;
+    }
+    return hash;
+}
+
+uint64_t mix(uint64_t hash)
+{
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+constexpr uint64_t kHashSeed = 0xCBF29CE484222325ull;
+
+// Recordings reserve budget 64 KiB at a time, so the cache lock is not taken for every solution.
+constexpr size_t kReserveWords = 16384;
+
+} // namespace
+
+bool ResultKey::operator==(const ResultKey& other) const
+{
+    return hash == other.hash && assumptions == other.assumptions
+           && (cover == other.cover || (cover != nullptr && other.cover != nullptr && *cover == *other.cover));
+}
+
+/**
+ * Sorts every row's columns into a scratch copy, then orders the rows by id and columns and lays them out as
+ * {row id, size, columns}.
+ */
+std::shared_ptr<const std::vector<uint32_t>> canonical_cover(const binary::DlxCsrProblem& problem)
+{
+    const size_t rows = problem.row_count();
+    std::vector<uint32_t> columns(problem.entry_count());
+    std::vector<size_t> starts(rows + 1, 0);
+    for (size_t row = 0; row < rows; row++)
+    {
+        const uint32_t* source = problem.row_columns(row);
+        starts[row + 1] = starts[row] + problem.row_size(row);
+        std::copy(source, source + problem.row_size(row), columns.begin() + static_cast<std::ptrdiff_t>(starts[row]));
+        std::sort(columns.begin() + static_cast<std::ptrdiff_t>(starts[row]),
+                  columns.begin() + static_cast<std::ptrdiff_t>(starts[row + 1]));
+    }
+
+    std::vector<size_t> order(rows);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t left, size_t right) {
+        if (problem.row_id(left) != problem.row_id(right))
+        {
+            return problem.row_id(left) < problem.row_id(right);
+        }
+        return std::lexicographical_compare(columns.begin() + static_cast<std::ptrdiff_t>(starts[left]),
+                                            columns.begin() + static_cast<std::ptrdiff_t>(starts[left + 1]),
+                                            columns.begin() + static_cast<std::ptrdiff_t>(starts[right]),
+                                            columns.begin() + static_cast<std::ptrdiff_t>(starts[right + 1]));
+    });
+
+    auto cover = std::make_shared<std::vector<uint32_t>>();
+    cover->reserve(1 + rows * 2 + columns.size());
+    cover->push_back(problem.header.column_count);
+    for (size_t row : order)
+    {
+        cover->push_back(problem.row_id(row));
+        cover->push_back(static_cast<uint32_t>(starts[row + 1] - starts[row]));
+        cover->insert(cover->end(),
+                      columns.begin() + static_cast<std::ptrdiff_t>(starts[row]),
+                      columns.begin() + static_cast<std::ptrdiff_t>(starts[row + 1]));
+    }
+    return cover;
+}
+
+ResultKey make_result_key(std::shared_ptr<const std::vector<uint32_t>> cover, const SearchAssumptions& assumptions)
+{
+    ResultKey key;
+    key.assumptions = assumptions.forced_rows;
+    std::sort(key.assumptions.begin(), key.assumptions.end());
+    key.assumptions.push_back(static_cast<uint32_t>(assumptions.forced_rows.size()));
+    const size_t forbidden = key.assumptions.size();
+    key.assumptions.insert(key.assumptions.end(), assumptions.forbidden_rows.begin(), assumptions.forbidden_rows.end());
+    std::sort(key.assumptions.begin() + static_cast<std::ptrdiff_t>(forbidden), key.assumptions.end());
+
+    uint64_t hash = hash_words(kHashSeed, cover->data(), cover->size());
+    hash = hash_words(hash, key.assumptions.data(), key.assumptions.size());
+    key.hash = mix(hash);
+    key.cover = std::move(cover);
+    return key;
+}
+
+ResultCache::ResultCache(size_t budget_bytes)
+    : budget_bytes_(budget_bytes)
+{}
+
+std::shared_ptr<SolvedProblem> ResultCache::acquire(ResultKey key, bool* leader)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    *leader = false;
+    auto found = entries_.find(key.hash);
+    if (found != entries_.end())
+    {
+        Slot& slot = found->second;
+        if (!(slot.entry->key == key))
+        {
+            return nullptr;
+        }
+        if (slot.entry->state.load() == SolvedProblem::State::Complete)
+        {
+            recent_.splice(recent_.begin(), recent_, slot.recent);
+            hits_.fetch_add(1);
+        }
+        else
+        {
+            coalesced_.fetch_add(1);
+        }
+        return slot.entry;
+    }
+
+    const uint64_t hash = key.hash;
+    auto entry = std::make_shared<SolvedProblem>(std::move(key));
+    entries_.emplace(hash, Slot{entry, recent_.end()});
+    *leader = true;
+    return entry;
+}
+
+std::shared_ptr<SolvedProblem> ResultCache::lookup(const ResultKey& key)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = entries_.find(key.hash);
+    if (found == entries_.end() || found->second.entry->state.load() != SolvedProblem::State::Complete
+        || !(found->second.entry->key == key))
+    {
+        return nullptr;
+    }
+    recent_.splice(recent_.begin(), recent_, found->second.recent);
+    hits_.fetch_add(1);
+    return found->second.entry;
+}
+
+/**
+ * Evicts least recently used complete entries until @p bytes more fit the budget; the caller holds mutex_.
+ * Nothing is evicted when the reservations in flight alone leave too little room.
+ */
+bool ResultCache::make_room(size_t bytes)
+{
+    if (reserved_bytes_ + bytes > budget_bytes_)
+    {
+        return false;
+    }
+    while (bytes_ + reserved_bytes_ + bytes > budget_bytes_)
+    {
+        auto oldest = entries_.find(recent_.back());
+        bytes_ -= oldest->second.entry->bytes();
+        entries_.erase(oldest);
+        recent_.pop_back();
+    }
+    return true;
+}
+
+/**
+ * Grows the reservation a chunk at a time, or by exactly what is missing when a whole chunk does not fit.
+ */
+bool ResultCache::reserve(SolvedProblem& entry, size_t words)
+{
+    if (words <= entry.reserved)
+    {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t target : {std::max(words, entry.reserved + kReserveWords), words})
+    {
+        const size_t bytes = (target - entry.reserved) * sizeof(uint32_t);
+        if (make_room(bytes))
+        {
+            reserved_bytes_ += bytes;
+            entry.reserved = target;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Completes or abandons a leader's entry. The records are trimmed before the state is published, since waiting
+ * problems replay them without taking the lock. A complete entry that does not fit the budget still serves the
+ * problems that waited for it but is not kept; otherwise the least recently used entries make room for it.
+ */
+void ResultCache::finish(const std::shared_ptr<SolvedProblem>& entry, bool complete)
+{
+    if (complete)
+    {
+        entry->records.shrink_to_fit();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    reserved_bytes_ -= entry->reserved * sizeof(uint32_t);
+    entry->reserved = 0;
+    entry->state.store(complete ? SolvedProblem::State::Complete : SolvedProblem::State::Abandoned);
+    auto found = entries_.find(entry->key.hash);
+    if (found == entries_.end() || found->second.entry != entry)
+    {
+        return;
+    }
+    if (!complete || !make_room(entry->bytes()))
+    {
+        entries_.erase(found);
+        return;
+    }
+
+    bytes_ += entry->bytes();
+    recent_.push_front(entry->key.hash);
+    found->second.recent = recent_.begin();
+}
+
+size_t ResultCache::cached_bytes()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bytes_;
+}
+
+} // namespace dlx
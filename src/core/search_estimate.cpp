@@ -0,0 +1,185 @@
+#include "core/search_estimate.h"
+#include <algorithm>
+#include <vector>
+
+namespace dlx {
+
+namespace {
+
+constexpr double kCostLimit = 1e18;
+
+// Steps a probe may take per entry and column of the cover, and at least; small covers are always walked whole.
+constexpr size_t kProbeStepsPerEntry = 16;
+constexpr size_t kMinProbeSteps = 65536;
+
+uint64_t next_random(uint64_t* state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+/**
+ * Nodes below a probe cut off @p levels above its leaf, assuming every remaining level keeps branching
+ * @p factor ways: branches * (factor + factor^2 + ... + factor^levels), capped at kCostLimit.
+ */
+double extrapolate(double branches, double factor, size_t levels)
+{
+    double nodes = 0;
+    for (size_t level = 0; level < levels && nodes < kCostLimit; level++)
+    {
+        branches *= std::max(factor, 1.0);
+        nodes += branches;
+    }
+    return nodes;
+}
+
+} // namespace
+
+/**
+ * Indexes the rows of every column once, then runs each probe on fresh copies of the row liveness and column
+ * sizes. Choosing a row removes every row that shares a column with it, as covering would. A probe's steps are
+ * bounded by a multiple of the cover's entries and columns; one that runs out extrapolates the rest of its path
+ * from the columns each level covered so far and its last branching factor, so the estimate stays linear in the
+ * cover however deep the search would go.
+ */
+uint64_t estimate_search_cost(const binary::DlxCsrProblem& problem, unsigned int probes)
+{
+    const size_t columns = problem.header.column_count;
+    const size_t rows = problem.row_count();
+    const size_t entries = problem.entry_count();
+    if (columns == 0 || rows == 0 || probes == 0)
+    {
+        return entries;
+    }
+
+    std::vector<uint32_t> column_starts(columns + 1, 0);
+    for (size_t row = 0; row < rows; row++)
+    {
+        const uint32_t* row_columns = problem.row_columns(row);
+        for (uint16_t entry = 0; entry < problem.row_size(row); entry++)
+        {
+            if (row_columns[entry] < columns)
+            {
+                column_starts[row_columns[entry] + 1]++;
+            }
+        }
+    }
+    for (size_t column = 0; column < columns; column++)
+    {
+        column_starts[column + 1] += column_starts[column];
+    }
+    std::vector<uint32_t> sizes(columns);
+    for (size_t column = 0; column < columns; column++)
+    {
+        sizes[column] = column_starts[column + 1] - column_starts[column];
+    }
+    std::vector<uint32_t> column_rows(column_starts[columns]);
+    std::vector<uint32_t> fill(column_starts.begin(), column_starts.end() - 1);
+    for (size_t row = 0; row < rows; row++)
+    {
+        const uint32_t* row_columns = problem.row_columns(row);
+        for (uint16_t entry = 0; entry < problem.row_size(row); entry++)
+        {
+            if (row_columns[entry] < columns)
+            {
+                column_rows[fill[row_columns[entry]]++] = static_cast<uint32_t>(row);
+            }
+        }
+    }
+
+    uint64_t random = 0x9E3779B97F4A7C15ull ^ (rows << 20) ^ entries;
+    std::vector<uint32_t> counts;
+    std::vector<uint8_t> alive;
+    std::vector<uint8_t> covered;
+    const size_t work_limit = std::max(kProbeStepsPerEntry * (entries + columns), kMinProbeSteps);
+    double total = 0;
+    for (unsigned int probe = 0; probe < probes; probe++)
+    {
+        counts = sizes;
+        alive.assign(rows, 1);
+        covered.assign(columns, 0);
+        double branches = 1;
+        double nodes = 1;
+        double factor = 1;
+        size_t work = 0;
+        size_t levels = 0;
+        size_t covered_count = 0;
+        while (nodes < kCostLimit)
+        {
+            if (work > work_limit && levels > 0)
+            {
+                const size_t remaining = (columns - covered_count) * levels;
+                nodes += extrapolate(branches, factor, (remaining + covered_count - 1) / covered_count);
+                break;
+            }
+
+            work += columns;
+            size_t chosen = columns;
+            for (size_t column = 0; column < columns; column++)
+            {
+                if (covered[column] == 0 && (chosen == columns || counts[column] < counts[chosen]))
+                {
+                    chosen = column;
+                }
+            }
+            if (chosen == columns || counts[chosen] == 0)
+            {
+                break;
+            }
+
+            factor = counts[chosen];
+            branches *= factor;
+            nodes += branches;
+            levels++;
+
+            uint32_t pick = static_cast<uint32_t>(next_random(&random) % counts[chosen]);
+            uint32_t selected = 0;
+            for (uint32_t at = column_starts[chosen]; at < column_starts[chosen + 1]; at++)
+            {
+                if (alive[column_rows[at]] != 0 && pick-- == 0)
+                {
+                    selected = column_rows[at];
+                    break;
+                }
+            }
+
+            const uint32_t* selected_columns = problem.row_columns(selected);
+            for (uint16_t entry = 0; entry < problem.row_size(selected); entry++)
+            {
+                const uint32_t column = selected_columns[entry];
+                if (column >= columns || covered[column] != 0)
+                {
+                    continue;
+                }
+                covered[column] = 1;
+                covered_count++;
+                work += column_starts[column + 1] - column_starts[column];
+                for (uint32_t at = column_starts[column]; at < column_starts[column + 1]; at++)
+                {
+                    const uint32_t row = column_rows[at];
+                    if (alive[row] == 0)
+                    {
+                        continue;
+                    }
+                    alive[row] = 0;
+                    work += problem.row_size(row);
+                    const uint32_t* removed = problem.row_columns(row);
+                    for (uint16_t other = 0; other < problem.row_size(row); other++)
+                    {
+                        if (removed[other] < columns)
+                        {
+                            counts[removed[other]]--;
+                        }
+                    }
+                }
+            }
+        }
+        total += std::min(nodes, kCostLimit);
+    }
+
+    return entries + static_cast<uint64_t>(total / probes);
+}
+
+} // namespace dlx
@@ -0,0 +1,303 @@
+#include "core/shm_ring.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <new>
+
+namespace dlx::shm {
+
+namespace {
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "shared counters must be lock-free to work across processes");
+
+constexpr size_t kPageBytes = 4096;
+
+size_t round_up(size_t value, size_t multiple)
+{
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+size_t round_up_pow2(size_t value)
+{
+    size_t result = kPageBytes;
+    while (result < value)
+    {
+        result <<= 1;
+    }
+    return result;
+}
+
+// Offset and size describe a range inside [begin, end) of the segment, without overflowing.
+bool fits(uint64_t offset, uint64_t bytes, uint64_t begin, uint64_t end)
+{
+    return offset >= begin && offset <= end && bytes <= end - offset;
+}
+
+} // namespace
+
+void futex_wait(std::atomic<uint32_t>* word, uint32_t expected, std::chrono::milliseconds timeout)
+{
+    struct timespec relative;
+    relative.tv_sec = static_cast<time_t>(timeout.count() / 1000);
+    relative.tv_nsec = static_cast<long>((timeout.count() % 1000) * 1000000);
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT, expected, &relative, nullptr, 0);
+}
+
+void futex_wake(std::atomic<uint32_t>* word)
+{
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+}
+
+ShmSegment::ShmSegment()
+    : fd_(-1)
+    , map_(MAP_FAILED)
+    , map_bytes_(0)
+    , ring_offset_(0)
+    , ring_bytes_(0)
+    , problem_offset_(0)
+    , problem_bytes_(0)
+{}
+
+ShmSegment::~ShmSegment()
+{
+    release();
+}
+
+/**
+ * Lays the segment out as header, ring and problem area, each starting on a page, and seals the file so the
+ * server can map it without fearing that it shrinks under the mapping.
+ *
+ * @param size_t Minimum ring capacity.
+ * @param size_t Size of the problem area.
+ * @return int 0 on success, -1 otherwise.
+ */
+int ShmSegment::create(size_t ring_bytes, size_t problem_bytes)
+{
+    release();
+
+    ring_offset_ = round_up(sizeof(ShmSegmentHeader), kPageBytes);
+    ring_bytes_ = round_up_pow2(ring_bytes);
+    problem_offset_ = ring_offset_ + ring_bytes_;
+    problem_bytes_ = round_up(std::max<size_t>(problem_bytes, 1), kPageBytes);
+    map_bytes_ = problem_offset_ + problem_bytes_;
+
+    fd_ = memfd_create("dlx-local", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd_ < 0 || ftruncate(fd_, static_cast<off_t>(map_bytes_)) != 0
+        || fcntl(fd_, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) != 0)
+    {
+        release();
+        return -1;
+    }
+
+    map_ = mmap(nullptr, map_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (map_ == MAP_FAILED)
+    {
+        release();
+        return -1;
+    }
+
+    ShmSegmentHeader* layout = new (map_) ShmSegmentHeader();
+    layout->magic = DLX_SHM_MAGIC;
+    layout->version = DLX_SHM_VERSION;
+    layout->ring_offset = ring_offset_;
+    layout->ring_bytes = ring_bytes_;
+    layout->problem_offset = problem_offset_;
+    layout->problem_bytes = problem_bytes_;
+    return 0;
+}
+
+/**
+ * Maps a segment received from a client. Its layout is read once and checked against the sealed file size; from
+ * then on only the copies kept here are used, so a client rewriting its header cannot point the server outside the
+ * mapping.
+ *
+ * @param int Descriptor of the segment; closed on failure.
+ * @return int 0 on success, -1 otherwise.
+ */
+int ShmSegment::attach(int fd)
+{
+    release();
+    fd_ = fd;
+
+    struct stat info;
+    const int seals = fcntl(fd_, F_GET_SEALS);
+    if (seals < 0 || (seals & F_SEAL_SHRINK) == 0 || fstat(fd_, &info) != 0
+        || static_cast<uint64_t>(info.st_size) < sizeof(ShmSegmentHeader))
+    {
+        release();
+        return -1;
+    }
+
+    map_bytes_ = static_cast<size_t>(info.st_size);
+    map_ = mmap(nullptr, map_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (map_ == MAP_FAILED)
+    {
+        release();
+        return -1;
+    }
+
+    const ShmSegmentHeader* layout = header();
+    const uint64_t ring_offset = layout->ring_offset;
+    const uint64_t ring_bytes = layout->ring_bytes;
+    const uint64_t problem_offset = layout->problem_offset;
+    const uint64_t problem_bytes = layout->problem_bytes;
+    const bool ring_first = ring_offset <= problem_offset;
+    if (layout->magic != DLX_SHM_MAGIC || layout->version != DLX_SHM_VERSION || ring_bytes < kPageBytes
+        || (ring_bytes & (ring_bytes - 1)) != 0 || ring_offset % alignof(uint64_t) != 0
+        || !fits(ring_offset, ring_bytes, sizeof(ShmSegmentHeader), map_bytes_)
+        || !fits(problem_offset, problem_bytes, sizeof(ShmSegmentHeader), map_bytes_)
+        || (ring_first ? ring_offset + ring_bytes > problem_offset : problem_offset + problem_bytes > ring_offset))
+    {
+        release();
+        return -1;
+    }
+
+    ring_offset_ = static_cast<size_t>(ring_offset);
+    ring_bytes_ = static_cast<size_t>(ring_bytes);
+    problem_offset_ = static_cast<size_t>(problem_offset);
+    problem_bytes_ = static_cast<size_t>(problem_bytes);
+    return 0;
+}
+
+void ShmSegment::release()
+{
+    if (map_ != MAP_FAILED)
+    {
+        munmap(map_, map_bytes_);
+        map_ = MAP_FAILED;
+    }
+    if (fd_ >= 0)
+    {
+        close(fd_);
+        fd_ = -1;
+    }
+    map_bytes_ = 0;
+}
+
+ShmRing::ShmRing(const ShmSegment& segment)
+    : header_(segment.header())
+    , data_(segment.ring_data())
+    , mask_(segment.ring_bytes() - 1)
+    , position_(0)
+{}
+
+ssize_t ShmRing::write(const struct iovec* iov, size_t count)
+{
+    const uint64_t tail = header_->tail.load(std::memory_order_acquire);
+    if (tail > position_ || position_ - tail > mask_ + 1)
+    {
+        return -1;
+    }
+
+    size_t room = static_cast<size_t>(mask_ + 1 - (position_ - tail));
+    size_t copied = 0;
+    for (size_t i = 0; i < count && room > 0; i++)
+    {
+        const char* source = static_cast<const char*>(iov[i].iov_base);
+        size_t left = std::min(iov[i].iov_len, room);
+        room -= left;
+        while (left > 0)
+        {
+            const size_t offset = static_cast<size_t>(position_) & mask_;
+            const size_t chunk = std::min(left, mask_ + 1 - offset);
+            memcpy(data_ + offset, source, chunk);
+            source += chunk;
+            left -= chunk;
+            position_ += chunk;
+            copied += chunk;
+        }
+    }
+    if (copied == 0)
+    {
+        return 0;
+    }
+
+    header_->head.store(position_, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (header_->reader_waiting.load(std::memory_order_relaxed) != 0)
+    {
+        header_->data_seq.fetch_add(1);
+        futex_wake(&header_->data_seq);
+    }
+    return static_cast<ssize_t>(copied);
+}
+
+bool ShmRing::wait_writable(std::chrono::milliseconds timeout)
+{
+    const uint32_t seq = header_->space_seq.load();
+    header_->writer_waiting.store(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (position_ - header_->tail.load() > mask_ && !reader_closed())
+    {
+        futex_wait(&header_->space_seq, seq, timeout);
+    }
+    header_->writer_waiting.store(0);
+    return position_ - header_->tail.load() <= mask_;
+}
+
+void ShmRing::close_writer()
+{
+    header_->writer_closed.store(1, std::memory_order_release);
+    header_->data_seq.fetch_add(1);
+    futex_wake(&header_->data_seq);
+}
+
+size_t ShmRing::peek(const char** data)
+{
+    const uint64_t head = header_->head.load(std::memory_order_acquire);
+    if (head < position_ || head - position_ > mask_ + 1)
+    {
+        return 0;
+    }
+
+    const size_t offset = static_cast<size_t>(position_) & mask_;
+    *data = data_ + offset;
+    return std::min(static_cast<size_t>(head - position_), mask_ + 1 - offset);
+}
+
+void ShmRing::consume(size_t bytes)
+{
+    if (bytes == 0)
+    {
+        return;
+    }
+
+    position_ += bytes;
+    header_->tail.store(position_, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (header_->writer_waiting.load(std::memory_order_relaxed) != 0)
+    {
+        header_->space_seq.fetch_add(1);
+        futex_wake(&header_->space_seq);
+    }
+}
+
+bool ShmRing::wait_readable(std::chrono::milliseconds timeout)
+{
+    const uint32_t seq = header_->data_seq.load();
+    header_->reader_waiting.store(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (header_->head.load() == position_ && !writer_closed())
+    {
+        futex_wait(&header_->data_seq, seq, timeout);
+    }
+    header_->reader_waiting.store(0);
+    return header_->head.load() != position_;
+}
+
+void ShmRing::close_reader()
+{
+    header_->reader_closed.store(1, std::memory_order_release);
+    header_->space_seq.fetch_add(1);
+    futex_wake(&header_->space_seq);
+}
+
+} // namespace dlx::shm
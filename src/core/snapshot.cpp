@@ -0,0 +1,298 @@
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <climits>
+#include <fstream>
+#include <vector>
+#include "core/dlx.h"
+#include "core/matrix.h"
+#include "core/snapshot.h"
+
+namespace dlx::snapshot {
+
+namespace {
+
+// Preferred load address for snapshot images. It sits well clear of the usual heap, stack, and
+// shared-library ranges so an unhinted process normally has it free.
+#if UINTPTR_MAX > 0xFFFFFFFFu
+constexpr uintptr_t kSnapshotBase = 0x3D1C00000000u;
+#else
+constexpr uintptr_t kSnapshotBase = 0x40000000u;
+#endif
+
+// Nodes are re-encoded and written in batches to keep the writer's scratch memory bounded.
+constexpr size_t kWriteBatchNodes = 4096;
+
+struct node* encode_link(const struct node* matrix, const struct node* link)
+{
+    if (link == nullptr)
+    {
+        return nullptr;
+    }
+    return reinterpret_cast<struct node*>(kSnapshotBase + static_cast<uintptr_t>(link - matrix) * sizeof(struct node));
+}
+
+/**
+ * Checks that every non-null link of the mapped image names one of its @p last_index + 1 nodes
+ * relative to the recorded @p base, and moves the links onto @p nodes when the image was mapped
+ * elsewhere. A corrupt or hostile file is rejected here instead of steering a search outside the
+ * mapping.
+ */
+bool link_nodes(struct node* nodes, size_t last_index, uintptr_t base)
+{
+    const bool rebase = reinterpret_cast<uintptr_t>(nodes) != base;
+    auto link = [&](struct node*& target) {
+        if (target == nullptr)
+        {
+            return true;
+        }
+        const uintptr_t offset = reinterpret_cast<uintptr_t>(target) - base;
+        if (reinterpret_cast<uintptr_t>(target) < base || offset % sizeof(struct node) != 0
+            || offset / sizeof(struct node) > last_index)
+        {
+            return false;
+        }
+        if (rebase)
+        {
+            target = nodes + offset / sizeof(struct node);
+        }
+        return true;
+    };
+
+    for (size_t i = 0; i <= last_index; ++i)
+    {
+        struct node& current = nodes[i];
+        if (!link(current.top) || !link(current.up) || !link(current.down) || !link(current.left)
+            || !link(current.right))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool read_exact_at(int fd, void* buffer, size_t size, off_t offset)
+{
+    char* cursor = static_cast<char*>(buffer);
+    while (size > 0)
+    {
+        ssize_t count = pread(fd, cursor, size, offset);
+        if (count <= 0)
+        {
+            return false;
+        }
+        cursor += count;
+        size -= static_cast<size_t>(count);
+        offset += count;
+    }
+    return true;
+}
+
+} // namespace
+
+MatrixSnapshot::MatrixSnapshot()
+    : mapping_(nullptr)
+    , mapping_size_(0)
+    , matrix_(nullptr)
+    , solutions_(nullptr)
+    , item_count_(0)
+    , option_count_(0)
+    , node_count_(0)
+    , relocated_(false)
+{}
+
+MatrixSnapshot::~MatrixSnapshot()
+{
+    reset();
+}
+
+void MatrixSnapshot::reset()
+{
+    if (mapping_ != nullptr)
+    {
+        munmap(mapping_, mapping_size_);
+    }
+    free(solutions_);
+
+    mapping_ = nullptr;
+    mapping_size_ = 0;
+    matrix_ = nullptr;
+    solutions_ = nullptr;
+    item_count_ = 0;
+    option_count_ = 0;
+    node_count_ = 0;
+    relocated_ = false;
+}
+
+/**
+ * Maps a DLXM snapshot copy-on-write and exposes its matrix for searching.
+ *
+ * The whole file is mapped with the recorded base address as a hint. When the kernel honours it the
+ * image is used as is, without touching a single node, unless @p verify asks for a check. Otherwise
+ * one sequential pass rebases the links onto the actual mapping and checks on the way that every
+ * link names a node of the image.
+ *
+ * @param const char* Path to a snapshot written by @ref write_snapshot.
+ * @param bool Check every link even when no rebase is needed; pass true for files from an untrusted
+ *        writer.
+ * @return int 0 on success, -1 when the file is missing, truncated, corrupt, or was written by an
+ *         incompatible host.
+ */
+int MatrixSnapshot::load(const char* path, bool verify)
+{
+    reset();
+
+    if (path == nullptr)
+    {
+        return -1;
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    struct stat info;
+    DlxSnapshotHeader header = {0};
+    if (fstat(fd, &info) != 0 || !read_exact_at(fd, &header, sizeof(header), 0))
+    {
+        close(fd);
+        return -1;
+    }
+
+    const size_t file_size = static_cast<size_t>(info.st_size);
+    const bool valid = header.magic == DLX_SNAPSHOT_MAGIC
+        && header.version == DLX_SNAPSHOT_VERSION
+        && header.node_size == sizeof(struct node)
+        && header.node_offset == DLX_SNAPSHOT_NODE_OFFSET
+        && header.column_count > 0
+        && header.column_count <= static_cast<uint32_t>(INT_MAX)
+        && header.option_count <= static_cast<uint32_t>(INT_MAX)
+        && header.node_count > header.column_count
+        && header.node_count < static_cast<uint64_t>(INT_MAX)
+        && header.base_address <= UINTPTR_MAX
+        && header.node_offset + (header.node_count + 1) * sizeof(struct node) <= file_size;
+    if (!valid)
+    {
+        close(fd);
+        return -1;
+    }
+
+    const uintptr_t base = static_cast<uintptr_t>(header.base_address);
+    void* hint = reinterpret_cast<void*>(base - header.node_offset);
+    void* mapping = mmap(hint, file_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        return -1;
+    }
+
+    mapping_ = mapping;
+    mapping_size_ = file_size;
+    matrix_ = reinterpret_cast<struct node*>(static_cast<char*>(mapping) + header.node_offset);
+    item_count_ = static_cast<int>(header.column_count);
+    option_count_ = static_cast<int>(header.option_count);
+    node_count_ = static_cast<size_t>(header.node_count);
+
+    relocated_ = reinterpret_cast<uintptr_t>(matrix_) != base;
+    if ((relocated_ || verify) && !link_nodes(matrix_, node_count_, base))
+    {
+        reset();
+        return -1;
+    }
+
+    solutions_ = static_cast<char**>(calloc(std::max(option_count_, 1), sizeof(char*)));
+    if (solutions_ == nullptr)
+    {
+        reset();
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * Writes a freshly linked matrix as a DLXM snapshot.
+ *
+ * The matrix must be in the state a generator returned it (no columns covered). Links are encoded
+ * relative to the preferred load address, so the snapshot is tied to the writing host's pointer
+ * size, byte order, and node layout, all of which the loader verifies.
+ *
+ * @param std::ostream& Binary output stream.
+ * @param const struct node* Matrix head.
+ * @param int Number of item columns.
+ * @param int Number of option rows.
+ * @return int 0 on success, -1 on invalid input or write failure.
+ */
+int write_snapshot(std::ostream& output, const struct node* matrix, int item_count, int option_count)
+{
+    if (matrix == nullptr || item_count <= 0 || option_count < 0)
+    {
+        return -1;
+    }
+
+    const size_t node_count = matrix::countMatrixNodes(matrix, item_count, option_count);
+
+    DlxSnapshotHeader header = {0};
+    header.magic = DLX_SNAPSHOT_MAGIC;
+    header.version = DLX_SNAPSHOT_VERSION;
+    header.node_size = static_cast<uint16_t>(sizeof(struct node));
+    header.column_count = static_cast<uint32_t>(item_count);
+    header.option_count = static_cast<uint32_t>(option_count);
+    header.node_count = node_count;
+    header.base_address = kSnapshotBase;
+    header.node_offset = DLX_SNAPSHOT_NODE_OFFSET;
+
+    // Header padded out to the page-aligned node array.
+    std::vector<char> preamble(DLX_SNAPSHOT_NODE_OFFSET, 0);
+    memcpy(preamble.data(), &header, sizeof(header));
+    output.write(preamble.data(), static_cast<std::streamsize>(preamble.size()));
+
+    std::vector<struct node> batch;
+    batch.reserve(kWriteBatchNodes);
+    for (size_t i = 0; i <= node_count && output.good(); ++i)
+    {
+        const struct node& source = matrix[i];
+        struct node encoded;
+        encoded.len = source.len;
+        encoded.data = source.data;
+        encoded.top = encode_link(matrix, source.top);
+        encoded.up = encode_link(matrix, source.up);
+        encoded.down = encode_link(matrix, source.down);
+        encoded.left = encode_link(matrix, source.left);
+        encoded.right = encode_link(matrix, source.right);
+        batch.push_back(encoded);
+
+        if (batch.size() == kWriteBatchNodes || i == node_count)
+        {
+            output.write(reinterpret_cast<const char*>(batch.data()),
+                         static_cast<std::streamsize>(batch.size() * sizeof(struct node)));
+            batch.clear();
+        }
+    }
+
+    output.flush();
+    return output.good() ? 0 : -1;
+}
+
+/**
+ * Reports whether @p path starts with the DLXM magic, letting callers choose between the snapshot
+ * loader and the DLXB parser.
+ */
+bool is_snapshot_file(const char* path)
+{
+    std::ifstream file(path, std::ios::binary);
+    uint32_t magic = 0;
+    if (!file.read(reinterpret_cast<char*>(&magic), sizeof(magic)))
+    {
+        return false;
+    }
+    return magic == DLX_SNAPSHOT_MAGIC;
+}
+
+} // namespace dlx::snapshot
@@ -1,4 +1,8 @@
 #include "core/solution_sink.h"
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <charconv>
 #include <iostream>
 
 namespace dlx::sink {
@@ -19,6 +23,125 @@ void OstreamSolutionSink::flush()
     stream_.flush();
 }
 
+FdTextSolutionSink::FdTextSolutionSink(int fd, const TextSinkConfig& config)
+    : fd_(fd)
+    , config_(config)
+    , used_(0)
+    , failed_(false)
+{
+    buffer_.resize(config_.flush_bytes + 4096);
+}
+
+FdTextSolutionSink::~FdTextSolutionSink()
+{
+    sync();
+}
+
+void FdTextSolutionSink::on_solution(const SolutionView& view)
+{
+    for (int i = 0; i < view.count; i++)
+    {
+        const size_t length = strlen(view.values[i]);
+        char* out = reserve(length + config_.value_separator.size());
+        memcpy(out, view.values[i], length);
+        used_ += length;
+        if (i + 1 < view.count)
+        {
+            memcpy(out + length, config_.value_separator.data(), config_.value_separator.size());
+            used_ += config_.value_separator.size();
+        }
+    }
+    finish_solution();
+}
+
+void FdTextSolutionSink::on_solution(const uint32_t* row_ids, int count)
+{
+    // Ten digits per id plus its separator.
+    const size_t separator = config_.value_separator.size();
+    char* const start = reserve(static_cast<size_t>(count > 0 ? count : 0) * (10 + separator));
+    char* out = start;
+    for (int i = 0; i < count; i++)
+    {
+        out = std::to_chars(out, out + 10, row_ids[i]).ptr;
+        if (i + 1 < count)
+        {
+            memcpy(out, config_.value_separator.data(), separator);
+            out += separator;
+        }
+    }
+    used_ += static_cast<size_t>(out - start);
+    finish_solution();
+}
+
+void FdTextSolutionSink::flush()
+{
+    if (used_ >= config_.flush_bytes
+        || (used_ > 0 && std::chrono::steady_clock::now() - oldest_ >= config_.flush_interval))
+    {
+        sync();
+    }
+}
+
+/**
+ * Writes the whole buffer, retrying interrupted and partial writes.
+ *
+ * @return int 0 when everything reached the descriptor, -1 if this or any earlier write failed.
+ */
+int FdTextSolutionSink::sync()
+{
+    size_t written = 0;
+    while (!failed_ && written < used_)
+    {
+        const ssize_t result = ::write(fd_, buffer_.data() + written, used_ - written);
+        if (result < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (result <= 0)
+        {
+            failed_ = true;
+            break;
+        }
+        written += static_cast<size_t>(result);
+    }
+    used_ = 0;
+    return failed_ ? -1 : 0;
+}
+
+/**
+ * Returns room for @p bytes at the end of the buffer, writing out what is buffered (or growing the buffer for an
+ * oversized solution) first. Callers advance used_ by what they actually wrote.
+ */
+char* FdTextSolutionSink::reserve(size_t bytes)
+{
+    if (used_ == 0)
+    {
+        oldest_ = std::chrono::steady_clock::now();
+    }
+    if (used_ + bytes > buffer_.size())
+    {
+        const bool was_empty = (used_ == 0);
+        sync();
+        if (!was_empty)
+        {
+            oldest_ = std::chrono::steady_clock::now();
+        }
+        if (bytes > buffer_.size())
+        {
+            buffer_.resize(bytes);
+        }
+    }
+    return buffer_.data() + used_;
+}
+
+void FdTextSolutionSink::finish_solution()
+{
+    const std::string& separator = config_.solution_separator;
+    char* out = reserve(separator.size());
+    memcpy(out, separator.data(), separator.size());
+    used_ += separator.size();
+}
+
 void CompositeSolutionSink::add_sink(SolutionSink* sink)
 {
     if (sink != nullptr)
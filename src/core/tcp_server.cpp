@@ -1,17 +1,36 @@
 #include "core/tcp_server.h"
 #include "core/binary.h"
 #include "core/dlx.h"
+#include "core/io_uring.h"
+#include "core/matrix.h"
+#include "core/result_cache.h"
+#include "core/search_estimate.h"
+#include "core/search.h"
+#include "core/shm_ring.h"
 #include <arpa/inet.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
 #include <unistd.h>
 #include <algorithm>
+#include <chrono>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <istream>
 #include <memory>
+#include <optional>
 #include <ostream>
 #include <streambuf>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -19,13 +38,129 @@ namespace dlx {
 
 namespace {
 
+#if defined(DLX_HAVE_IO_URING)
+using SendQueue = io::UringSendQueue;
+#else
+struct SendQueue
+{
+};
+#endif
+
+/** Drops @p bytes sent from the front of @p batch, starting at entry @p first; returns the first entry left. */
+size_t consume_iov(std::vector<iovec>& batch, size_t first, size_t bytes)
+{
+    while (first < batch.size() && bytes >= batch[first].iov_len)
+    {
+        bytes -= batch[first].iov_len;
+        first++;
+    }
+    if (first < batch.size())
+    {
+        batch[first].iov_base = static_cast<char*>(batch[first].iov_base) + bytes;
+        batch[first].iov_len -= bytes;
+    }
+    return first;
+}
+
+/**
+ * Bounds on what one client may leave unsent under the Drop and Spill policies, and the server-wide gauges its
+ * backlog is counted in.
+ */
+struct BacklogLimits
+{
+    SlowClientPolicy policy;
+    size_t memory_bytes;
+    uint64_t spill_bytes;
+    std::chrono::milliseconds lag; /**< Longest a backlog may go without a byte sent; zero means no limit. */
+    std::atomic<uint64_t>* memory_gauge;
+    std::atomic<uint64_t>* spill_gauge;
+};
+
+/**
+ * Output buffer of one subscriber socket. By default it fills a private buffer and sends it with blocking send
+ * calls (waiting for room on non-blocking sockets, such as request connections answered inline). Given a
+ * @ref io::UringSendQueue it instead fills the queue's registered slots and queues them without waiting, falling
+ * back to the private buffer only when every slot is taken. Given @ref BacklogLimits it never waits: whatever the
+ * socket does not take is queued in memory, then in a temporary file, and flushing fails once the limits are hit
+ * or the socket has taken nothing for longer than the lag limit. Given a @ref shm::ShmRing, every send goes into
+ * the ring instead of the socket, which is then only watched for the client hanging up.
+ */
 class BufferedSocketStreambuf : public std::streambuf
 {
 public:
-    explicit BufferedSocketStreambuf(int fd)
+    BufferedSocketStreambuf(int fd, SendQueue* queue, const BacklogLimits* limits, shm::ShmRing* ring)
         : fd_(fd)
+        , queue_(queue)
+        , limits_(limits != nullptr ? std::optional<BacklogLimits>(*limits) : std::nullopt)
+        , ring_(ring)
+    {
+#if defined(DLX_HAVE_IO_URING)
+        if (queue_ != nullptr)
+        {
+            channel_ = std::make_shared<io::SendChannel>(fd);
+            setp(nullptr, nullptr);
+            return;
+        }
+#endif
+        reset_batch();
+    }
+
+    ~BufferedSocketStreambuf() override
+    {
+        if (limits_)
+        {
+            limits_->memory_gauge->fetch_sub(pending_.size() - pending_begin_);
+            limits_->spill_gauge->fetch_sub(spill_end_ - spill_begin_);
+        }
+        if (spill_ != nullptr)
+        {
+            fclose(spill_);
+        }
+#if defined(DLX_HAVE_IO_URING)
+        if (channel_ != nullptr)
+        {
+            channel_->closed = true;
+            if (slot_held_)
+            {
+                queue_->release(slot_);
+            }
+        }
+#endif
+    }
+
+    /** Unsent bytes queued behind the socket, in memory or spilled. */
+    uint64_t backlog_bytes() const { return (pending_.size() - pending_begin_) + (spill_end_ - spill_begin_); }
+    /** Bytes written since the last send: the private batch, or the io_uring slot being filled. */
+    size_t batched_bytes() const
+    {
+        return (chunk_count_ > 0 ? (chunk_count_ - 1) * kChunkBytes : 0) + static_cast<size_t>(pptr() - pbase());
+    }
+    /** Lets the private batch grow to @p bytes (in whole chunks) before it is sent on its own. */
+    void set_batch_limit(size_t bytes) { batch_limit_ = std::min(std::max(bytes, kChunkBytes), kMaxBatchBytes); }
+    /** Marks the following sends with MSG_MORE, so the kernel holds back partial segments until a send without it. */
+    void set_more(bool more) { more_ = more; }
+
+    /** True once the client was cut off for falling behind: a backlog limit was hit or it stopped reading. */
+    bool fell_behind() const { return fell_behind_; }
+
+    /**
+     * Sends as much of the backlog as the socket takes without blocking, refilling memory from the spill file.
+     *
+     * @return int 0 when the rest can wait, -1 when the socket failed or the backlog stalled past the lag limit.
+     */
+    int drain_backlog()
     {
-        setp(buffer_, buffer_ + sizeof(buffer_));
+        if (send_backlog() != 0)
+        {
+            return -1;
+        }
+        if (backlog_bytes() > 0 && limits_->lag.count() > 0
+            && std::chrono::steady_clock::now() - last_progress_ >= limits_->lag)
+        {
+            fell_behind_ = true;
+            return -1;
+        }
+        return 0;
     }
 
 protected:
@@ -37,7 +172,7 @@ protected:
             std::streamsize available = epptr() - pptr();
             if (available == 0)
             {
-                if (flush_buffer() != 0)
+                if (make_room() != 0)
                 {
                     break;
                 }
@@ -59,7 +194,7 @@ protected:
             return sync() == 0 ? traits_type::not_eof(ch) : traits_type::eof();
         }
 
-        if (pptr() == epptr() && flush_buffer() != 0)
+        if (pptr() == epptr() && make_room() != 0)
         {
             return traits_type::eof();
         }
@@ -75,151 +210,1001 @@ protected:
     }
 
 private:
+    /** Makes the full put area writable again: another chunk while the batch is under its limit, else a send. */
+    int make_room()
+    {
+        if (chunk_count_ > 0 && chunk_count_ * kChunkBytes < batch_limit_)
+        {
+            next_chunk();
+            return 0;
+        }
+        return (flush_buffer() == 0 && refill() == 0) ? 0 : -1;
+    }
+
+    /** Hands the buffered bytes on; queued slots are given up, so idle subscribers hold none. */
     int flush_buffer()
     {
-        std::streamsize size = pptr() - pbase();
-        std::streamsize sent = 0;
-        while (sent < size)
+#if defined(DLX_HAVE_IO_URING)
+        if (slot_held_)
+        {
+            const size_t size = static_cast<size_t>(pptr() - pbase());
+            slot_held_ = false;
+            setp(nullptr, nullptr);
+            if (size == 0)
+            {
+                queue_->release(slot_);
+            }
+            else
+            {
+                queue_->send(channel_, slot_, size);
+            }
+            return channel_->failed ? -1 : 0;
+        }
+        if (channel_ != nullptr && channel_->failed)
+        {
+            return -1;
+        }
+#endif
+        // The batch goes out as one gather list: every full chunk, then the filled part of the put area.
+        iov_.clear();
+        for (size_t chunk = 0; chunk + 1 < chunk_count_; chunk++)
+        {
+            iov_.push_back(iovec{chunks_[chunk].get(), kChunkBytes});
+        }
+        if (pptr() > pbase())
+        {
+            iov_.push_back(iovec{pbase(), static_cast<size_t>(pptr() - pbase())});
+        }
+        const int status = limits_ ? send_or_queue() : send_all();
+        reset_batch();
+        return status;
+    }
+
+    /** Sends up to kMaxIov entries of @p iov with one sendmsg, or copies them into the ring; errno as for sendmsg. */
+    ssize_t transmit(const iovec* iov, size_t count, int flags)
+    {
+        if (ring_ != nullptr)
+        {
+            const ssize_t written = ring_->reader_closed() ? -1 : ring_->write(iov, count);
+            errno = (written == 0) ? EAGAIN : EPIPE;
+            return written == 0 ? -1 : written;
+        }
+
+        msghdr message = {};
+        message.msg_iov = const_cast<iovec*>(iov);
+        message.msg_iovlen = std::min(count, kMaxIov);
+        return sendmsg(fd_, &message, flags);
+    }
+
+    /** Waits until the socket, or the ring, has room; -1 when the client is gone. */
+    int wait_writable()
+    {
+        if (ring_ == nullptr)
+        {
+            pollfd writable = {fd_, POLLOUT, 0};
+            return (poll(&writable, 1, -1) < 0 && errno != EINTR) ? -1 : 0;
+        }
+
+        // The ring's futex cannot report a client that died, so its socket is checked between waits.
+        while (!ring_->wait_writable(kRingLivenessPoll))
+        {
+            pollfd hangup = {fd_, 0, 0};
+            if (ring_->reader_closed() || (poll(&hangup, 1, 0) > 0 && (hangup.revents & (POLLHUP | POLLERR)) != 0))
+            {
+                return -1;
+            }
+        }
+        return 0;
+    }
+
+    /** Sends the gather list, waiting for room in the socket (non-blocking request connections included). */
+    int send_all()
+    {
+        size_t first = 0;
+        while (first < iov_.size())
         {
-            ssize_t written = send(fd_, pbase() + sent, static_cast<size_t>(size - sent), 0);
+            const ssize_t written = transmit(iov_.data() + first, iov_.size() - first, MSG_NOSIGNAL | (more_ ? MSG_MORE : 0));
+            if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+            {
+                if (wait_writable() != 0)
+                {
+                    return -1;
+                }
+                continue;
+            }
             if (written <= 0)
             {
                 return -1;
             }
-            sent += written;
+            first = consume_iov(iov_, first, static_cast<size_t>(written));
         }
-        setp(buffer_, buffer_ + sizeof(buffer_));
         return 0;
     }
 
-    int fd_;
-    char buffer_[65536];
-};
+    /** Provides an empty put area after @ref flush_buffer: a fresh slot when one is free, else the private buffer. */
+    int refill()
+    {
+#if defined(DLX_HAVE_IO_URING)
+        if (queue_ != nullptr)
+        {
+            char* slot = queue_->acquire(&slot_);
+            if (slot != nullptr)
+            {
+                slot_held_ = true;
+                setp(slot, slot + queue_->slot_bytes());
+                return 0;
+            }
+            // acquire only gives up once nothing is in flight, so the direct sends cannot overtake queued ones.
+            if (channel_->failed)
+            {
+                return -1;
+            }
+        }
+#endif
+        reset_batch();
+        return 0;
+    }
 
-class SocketInputStreambuf : public std::streambuf
-{
-public:
-    explicit SocketInputStreambuf(int fd)
-        : fd_(fd)
+    /** Empties the private batch, leaving its first chunk as the put area. */
+    void reset_batch()
     {
-        setg(buffer_, buffer_, buffer_);
+        chunk_count_ = 0;
+        next_chunk();
     }
 
-protected:
-    int_type underflow() override
+    void next_chunk()
+    {
+        if (chunk_count_ == chunks_.size())
+        {
+            chunks_.emplace_back(new char[kChunkBytes]);
+        }
+        char* chunk = chunks_[chunk_count_++].get();
+        setp(chunk, chunk + kChunkBytes);
+    }
+
+    /** Sends the backlog, oldest bytes first, until the socket is full or the backlog is gone. */
+    int send_backlog()
+    {
+        while (true)
+        {
+            if (pending_begin_ == pending_.size())
+            {
+                pending_.clear();
+                pending_begin_ = 0;
+                if (spill_begin_ == spill_end_)
+                {
+                    return 0;
+                }
+
+                const size_t chunk = static_cast<size_t>(std::min<uint64_t>(spill_end_ - spill_begin_, kSpillChunkBytes));
+                pending_.resize(chunk);
+                if (pread(fileno(spill_), pending_.data(), chunk, static_cast<off_t>(spill_begin_)) != static_cast<ssize_t>(chunk))
+                {
+                    return -1;
+                }
+                spill_begin_ += chunk;
+                limits_->spill_gauge->fetch_sub(chunk);
+                limits_->memory_gauge->fetch_add(chunk);
+                if (spill_begin_ == spill_end_ && ftruncate(fileno(spill_), 0) == 0)
+                {
+                    spill_begin_ = 0;
+                    spill_end_ = 0;
+                }
+            }
+
+            const iovec backlog = {pending_.data() + pending_begin_, pending_.size() - pending_begin_};
+            const ssize_t written = transmit(&backlog, 1, MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (written > 0)
+            {
+                pending_begin_ += static_cast<size_t>(written);
+                limits_->memory_gauge->fetch_sub(static_cast<uint64_t>(written));
+                last_progress_ = std::chrono::steady_clock::now();
+                continue;
+            }
+            if (written < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            return (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) ? 0 : -1;
+        }
+    }
+
+
+    /** Sends what the socket takes of the gather list right away when nothing is queued before it; queues the rest. */
+    int send_or_queue()
     {
-        if (gptr() < egptr())
+        if (drain_backlog() != 0)
         {
-            return traits_type::to_int_type(*gptr());
+            return -1;
         }
 
-        ssize_t bytes = recv(fd_, buffer_, sizeof(buffer_), 0);
-        if (bytes <= 0)
+        size_t first = 0;
+        while (backlog_bytes() == 0 && first < iov_.size())
         {
-            return traits_type::eof();
+            const ssize_t written =
+                transmit(iov_.data() + first, iov_.size() - first, MSG_NOSIGNAL | MSG_DONTWAIT | (more_ ? MSG_MORE : 0));
+            if (written > 0)
+            {
+                first = consume_iov(iov_, first, static_cast<size_t>(written));
+            }
+            else if (written < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            else if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            {
+                break;
+            }
+            else
+            {
+                return -1;
+            }
         }
 
-        setg(buffer_, buffer_, buffer_ + bytes);
-        return traits_type::to_int_type(*gptr());
+        for (size_t queued = first; queued < iov_.size(); queued++)
+        {
+            if (queue_bytes(static_cast<const char*>(iov_[queued].iov_base), iov_[queued].iov_len) != 0)
+            {
+                return -1;
+            }
+        }
+        return 0;
     }
 
-private:
+    /** Appends to the memory backlog, or to the spill file once memory is full or the file holds older bytes. */
+    int queue_bytes(const char* data, size_t size)
+    {
+        if (size == 0)
+        {
+            return 0;
+        }
+        if (backlog_bytes() == 0)
+        {
+            // The lag limit counts from the moment the socket first refused bytes.
+            last_progress_ = std::chrono::steady_clock::now();
+        }
+
+        if (spill_begin_ == spill_end_ && pending_.size() - pending_begin_ + size <= limits_->memory_bytes)
+        {
+            if (pending_begin_ > pending_.size() / 2)
+            {
+                pending_.erase(pending_.begin(), pending_.begin() + static_cast<std::ptrdiff_t>(pending_begin_));
+                pending_begin_ = 0;
+            }
+            pending_.insert(pending_.end(), data, data + size);
+            limits_->memory_gauge->fetch_add(size);
+            return 0;
+        }
+
+        if (limits_->policy != SlowClientPolicy::Spill || spill_end_ - spill_begin_ + size > limits_->spill_bytes
+            || (spill_ == nullptr && (spill_ = tmpfile()) == nullptr)
+            || pwrite(fileno(spill_), data, size, static_cast<off_t>(spill_end_)) != static_cast<ssize_t>(size))
+        {
+            fell_behind_ = true;
+            return -1;
+        }
+        spill_end_ += size;
+        limits_->spill_gauge->fetch_add(size);
+        return 0;
+    }
+
+    // Bytes read back from the spill file into memory at a time.
+    static constexpr size_t kSpillChunkBytes = 1 << 20;
+    // The private batch grows in chunks of this size, up to kMaxBatchBytes, and each sendmsg takes up to kMaxIov.
+    static constexpr size_t kChunkBytes = 64 * 1024;
+    static constexpr size_t kMaxBatchBytes = 16u << 20;
+    static constexpr size_t kMaxIov = 256;
+    // How often a writer waiting for room in a shared ring checks that the client is still there.
+    static constexpr std::chrono::milliseconds kRingLivenessPoll{50};
+
     int fd_;
-    char buffer_[65536];
+    SendQueue* queue_;
+    std::optional<BacklogLimits> limits_;
+    shm::ShmRing* ring_;
+    std::vector<char> pending_;  /**< Memory backlog; bytes before pending_begin_ are already sent. */
+    size_t pending_begin_ = 0;
+    FILE* spill_ = nullptr;      /**< Unlinked temporary file holding the bytes queued after pending_. */
+    uint64_t spill_begin_ = 0;
+    uint64_t spill_end_ = 0;
+    std::chrono::steady_clock::time_point last_progress_; /**< Last byte of the backlog sent, or its start. */
+    bool fell_behind_ = false;
+#if defined(DLX_HAVE_IO_URING)
+    std::shared_ptr<io::SendChannel> channel_;
+    uint32_t slot_ = 0;
+    bool slot_held_ = false;
+#endif
+    std::vector<std::unique_ptr<char[]>> chunks_; /**< Private batch; kept allocated between sends. */
+    size_t chunk_count_ = 0;                      /**< Chunks holding the batch; the last one is the put area. */
+    size_t batch_limit_ = kChunkBytes;
+    std::vector<iovec> iov_;
+    bool more_ = false;
 };
 
 class SocketOutputStream : public std::ostream
 {
 public:
-    explicit SocketOutputStream(int fd)
+    SocketOutputStream(int fd, SendQueue* queue, const BacklogLimits* limits, shm::ShmRing* ring = nullptr)
         : std::ostream(nullptr)
-        , buffer_(fd)
+        , buffer_(fd, queue, limits, ring)
     {
         rdbuf(&buffer_);
     }
 
+    BufferedSocketStreambuf& buffer() { return buffer_; }
+
 private:
     BufferedSocketStreambuf buffer_;
 };
 
-class SocketInputStream : public std::istream
+/** Read-only view of one complete DLXB frame held in a problem connection's buffer. */
+class FrameStreambuf : public std::streambuf
 {
 public:
-    explicit SocketInputStream(int fd)
+    FrameStreambuf(const char* data, size_t size)
+    {
+        char* begin = const_cast<char*>(data);
+        setg(begin, begin, begin + size);
+    }
+};
+
+class FrameInputStream : public std::istream
+{
+public:
+    FrameInputStream(const char* data, size_t size)
         : std::istream(&buffer_)
-        , buffer_(fd)
+        , buffer_(data, size)
     {}
 
 private:
-    SocketInputStreambuf buffer_;
+    FrameStreambuf buffer_;
+};
+
+// Reactor event tags: the kind of descriptor lives in the upper half of epoll_event::data.u64, the fd below it.
+enum class EventKind : uint32_t
+{
+    Wake = 1,
+    ProblemListener,
+    SolutionListener,
+    Problem,
+    Solution,
+    LocalListener,
+    Local /**< A problem connection on the Unix domain socket. */
 };
 
+uint64_t event_tag(EventKind kind, int fd)
+{
+    return (static_cast<uint64_t>(kind) << 32) | static_cast<uint32_t>(fd);
+}
+
+uint64_t event_tag(EventKind kind, uint32_t serial)
+{
+    return (static_cast<uint64_t>(kind) << 32) | serial;
+}
+
+constexpr int kReactorEvents = 64;
+
+// Serial of the writers that answer request connections inline; they are never watched by a reactor.
+constexpr uint32_t kInlineReplySerial = UINT32_MAX;
+
+// Bytes a problem connection reads per readiness event; level-triggered epoll reports the rest next round.
+constexpr size_t kProblemReadBytes = 256 * 1024;
+
+#if defined(DLX_HAVE_IO_URING)
+constexpr unsigned kReactorRingEntries = 256;
+// Subscriber send slots: 4 MiB registered in total, within the default RLIMIT_MEMLOCK.
+constexpr unsigned kSendSlots = 64;
+constexpr size_t kSendSlotBytes = 64 * 1024;
+#endif
+
 } // namespace
 
 struct DlxTcpServer::SolutionClient
 {
     int fd;
+    uint32_t serial; /**< Identifies the client in reactor events, which may outlive a reused descriptor. */
+    std::shared_ptr<shm::ShmSegment> segment; /**< Segment of a local client, whose ring the stream writes to. */
+    std::unique_ptr<shm::ShmRing> ring;
     std::unique_ptr<SocketOutputStream> stream;
     std::unique_ptr<binary::DlxSolutionStreamWriter> writer;
-
-    SolutionClient(int socket_fd, std::unique_ptr<SocketOutputStream> output_stream)
+    bool streaming = false;                  /**< The client takes part in the problem stream being sent. */
+    DlxFlushPolicy flush = kDlxDefaultFlush;
+    bool unflushed = false;                  /**< Rows were written since the last send. */
+    std::chrono::steady_clock::time_point unflushed_since;
+    std::vector<DlxSubscription> subscriptions;
+    char request[sizeof(DlxSubscription)];   /**< Partially received subscription or flush policy frame. */
+    size_t request_bytes = 0;
+
+    SolutionClient(int socket_fd, uint32_t client_serial, std::unique_ptr<SocketOutputStream> output_stream)
         : fd(socket_fd)
+        , serial(client_serial)
         , stream(std::move(output_stream))
         , writer(nullptr)
     {}
 
+    /** Whether the client receives the stream of a problem published on @p route. */
+    bool wants(const SolutionRoute& route) const
+    {
+        if (subscriptions.empty())
+        {
+            return true;
+        }
+        return route.tagged
+               && std::any_of(subscriptions.begin(), subscriptions.end(), [&](const DlxSubscription& subscription) {
+                      return ((route.problem_id ^ subscription.problem_id) & subscription.mask) == 0;
+                  });
+    }
+
+    /** Adopts @p policy for the rows written from now on. */
+    void set_flush_policy(const DlxFlushPolicy& policy)
+    {
+        flush = policy;
+        stream->buffer().set_batch_limit(policy.max_bytes);
+        stream->buffer().set_more(streaming && policy.cork);
+    }
+
+    /**
+     * Collects subscription and flush policy frames from bytes the client sent, however they were split.
+     * Repeated subscriptions are ignored, so only distinct ones count against DLX_SUBSCRIPTION_LIMIT.
+     *
+     * @return bool False when the bytes are neither, or would take the client past its subscription limit.
+     */
+    bool receive(const char* data, size_t size)
+    {
+        while (size > 0)
+        {
+            const size_t taken = std::min(size, sizeof(request) - request_bytes);
+            memcpy(request + request_bytes, data, taken);
+            request_bytes += taken;
+            data += taken;
+            size -= taken;
+            if (request_bytes < sizeof(request))
+            {
+                break;
+            }
+
+            uint32_t words[3];
+            memcpy(words, request, sizeof(words));
+            request_bytes = 0;
+            if (ntohl(words[0]) == DLX_FLUSH_MAGIC)
+            {
+                const uint32_t micros = ntohl(words[2]);
+                set_flush_policy(
+                    DlxFlushPolicy{ntohl(words[1]), micros & ~DLX_FLUSH_CORK, (micros & DLX_FLUSH_CORK) != 0});
+                continue;
+            }
+            if (ntohl(words[0]) != DLX_SUBSCRIBE_MAGIC)
+            {
+                return false;
+            }
+            const uint32_t mask = ntohl(words[2]);
+            const uint32_t problem_id = ntohl(words[1]) & mask;
+            const bool known =
+                std::any_of(subscriptions.begin(), subscriptions.end(), [&](const DlxSubscription& subscription) {
+                    return subscription.mask == mask && subscription.problem_id == problem_id;
+                });
+            if (known)
+            {
+                continue;
+            }
+            if (subscriptions.size() >= DLX_SUBSCRIPTION_LIMIT)
+            {
+                return false;
+            }
+            subscriptions.push_back(DlxSubscription{DLX_SUBSCRIBE_MAGIC, problem_id, mask});
+        }
+        return true;
+    }
+
     ~SolutionClient()
     {
+        // The writer flushes its buffered rows into the stream, so it has to go first.
+        writer.reset();
         stream.reset();
+        if (ring != nullptr)
+        {
+            ring->close_writer();
+        }
         if (fd >= 0)
         {
+            // Shut down first: a pending io_uring poll or send keeps the socket open past close().
+            shutdown(fd, SHUT_RDWR);
             close(fd);
             fd = -1;
         }
     }
 };
 
-
-DlxTcpServer::DlxTcpServer(const TcpServerConfig& config)
-    : config_(config)
-    , request_port_(config.request_port)
-    , solution_port_(config.solution_port)
-    , request_listen_fd_(-1)
-    , solution_listen_fd_(-1)
-    , shutting_down_(false)
+/** Subscriber send queue shared by every solution socket when the io_uring backend is active. */
+struct DlxTcpServer::SubscriberSends
 {
-}
+    SendQueue queue;
+};
 
-DlxTcpServer::~DlxTcpServer()
+/**
+ * Non-blocking problem connection owned by one reactor: received bytes accumulate in @ref buffer until the
+ * scanner reports a complete frame, which is then decoded and queued for the solvers.
+ */
+struct DlxTcpServer::ProblemStream
 {
-    stop();
-    wait();
-}
+    ProblemStream(int socket_fd, bool unix_socket)
+        : fd(socket_fd)
+        , local(unix_socket)
+        , begin(0)
+        , end(0)
+        , connection(std::make_shared<ProblemConnection>())
+    {}
 
-int DlxTcpServer::create_listening_socket(uint16_t requested_port, uint16_t* bound_port)
-{
-    int fd = socket(AF_INET, SOCK_STREAM, 0);
-    if (fd < 0)
+    ~ProblemStream()
     {
-        return -1;
+        if (passed_fd >= 0)
+        {
+            close(passed_fd);
+        }
+        if (fd >= 0)
+        {
+            close(fd);
+        }
     }
 
-    int opt = 1;
-    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    ProblemStream(const ProblemStream&) = delete;
+    ProblemStream& operator=(const ProblemStream&) = delete;
 
-    sockaddr_in addr;
-    memset(&addr, 0, sizeof(addr));
-    addr.sin_family = AF_INET;
-    addr.sin_addr.s_addr = htonl(INADDR_ANY);
-    addr.sin_port = htons(requested_port);
+    int fd;
+    bool local;         /**< Accepted on the Unix domain socket: LocalRequest frames and descriptors may arrive. */
+    int passed_fd = -1; /**< Descriptor received with the bytes read last, until an attach request takes it. */
+    std::shared_ptr<shm::ShmSegment> segment; /**< Attached segment; every answer then goes to its ring. */
+    std::vector<char> buffer;
+    size_t begin; /**< Start of the frame being received. */
+    size_t end;   /**< End of the bytes received so far. */
+    binary::DlxFrameScanner scanner;
+    std::shared_ptr<ProblemConnection> connection;
+    std::shared_ptr<const binary::DlxCsrProblem> current; /**< Cover that reuse frames refer to. */
+    std::shared_ptr<const std::vector<uint32_t>> current_key; /**< Canonical form of @ref current, when cached. */
+    uint64_t current_cost = 0; /**< Estimated work of solving @ref current. */
+};
 
-    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0)
+/**
+ * One I/O thread's epoll instance, or io_uring instance when that backend is active. Every reactor watches every
+ * listening socket (EPOLLEXCLUSIVE, or one multishot accept each, so a new connection wakes one of them) and
+ * keeps the connections it accepted for their whole life.
+ */
+struct DlxTcpServer::Reactor
+{
+    Reactor()
+        : epoll_fd(epoll_create1(EPOLL_CLOEXEC))
+        , wake_fd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+    {}
+
+    ~Reactor()
     {
-        close(fd);
-        return -1;
+        problems.clear();
+        if (wake_fd >= 0)
+        {
+            close(wake_fd);
+        }
+        if (epoll_fd >= 0)
+        {
+            close(epoll_fd);
+        }
     }
 
-    if (listen(fd, SOMAXCONN) < 0)
+    Reactor(const Reactor&) = delete;
+    Reactor& operator=(const Reactor&) = delete;
+
+    int watch(int fd, uint32_t events, uint64_t tag)
+    {
+        epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = events;
+        event.data.u64 = tag;
+        return epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event);
+    }
+
+#if defined(DLX_HAVE_IO_URING)
+    /** Submission entry for @p opcode on @p fd; its completions carry @p tag. */
+    struct io_uring_sqe* prepare(uint8_t opcode, int fd, uint64_t tag)
+    {
+        struct io_uring_sqe* sqe = ring->next_sqe();
+        if (sqe != nullptr)
+        {
+            sqe->opcode = opcode;
+            sqe->fd = fd;
+            sqe->user_data = tag;
+            pending++;
+        }
+        return sqe;
+    }
+
+    std::unique_ptr<io::IoUring> ring;
+    unsigned pending = 0;     /**< Requests that will still post a completion. */
+    uint64_t wake_value = 0;  /**< Target of the eventfd read that wakes the ring. */
+#endif
+
+    void wake()
+    {
+        const uint64_t one = 1;
+        ssize_t written = write(wake_fd, &one, sizeof(one));
+        (void)written;
+    }
+
+    int epoll_fd;
+    int wake_fd;
+    std::unordered_map<int, std::unique_ptr<ProblemStream>> problems;
+};
+
+/**
+ * Queue waits of every priority, as histograms with eight buckets per power of two of microseconds, so percentiles
+ * come out within an eighth of their value. Guarded by problem_queue_mutex_.
+ */
+struct DlxTcpServer::QueueWaits
+{
+    static constexpr size_t kBuckets = 8 * 62;
+
+    struct Priority
+    {
+        uint64_t problems = 0;
+        uint64_t total_micros = 0;
+        uint64_t max_micros = 0;
+        uint64_t buckets[kBuckets] = {};
+    };
+
+    static size_t bucket(uint64_t micros)
+    {
+        if (micros < 8)
+        {
+            return static_cast<size_t>(micros);
+        }
+        const int octave = 63 - __builtin_clzll(micros);
+        return static_cast<size_t>(octave - 2) * 8 + static_cast<size_t>((micros >> (octave - 3)) & 7);
+    }
+
+    /** Largest wait that falls into @p index. */
+    static uint64_t bucket_limit(size_t index)
+    {
+        if (index < 8)
+        {
+            return index;
+        }
+        const int octave = static_cast<int>(index / 8) + 2;
+        return ((9 + static_cast<uint64_t>(index % 8)) << (octave - 3)) - 1;
+    }
+
+    void record(unsigned int priority, uint64_t micros)
+    {
+        Priority& waits = priorities[priority];
+        waits.problems++;
+        waits.total_micros += micros;
+        waits.max_micros = std::max(waits.max_micros, micros);
+        waits.buckets[std::min(bucket(micros), kBuckets - 1)]++;
+    }
+
+    TcpServerWaitStats summary(unsigned int priority) const
+    {
+        const Priority& waits = priorities[priority];
+        TcpServerWaitStats stats = {waits.problems, 0, 0, waits.max_micros};
+        if (waits.problems == 0)
+        {
+            return stats;
+        }
+        stats.mean_micros = waits.total_micros / waits.problems;
+        const uint64_t rank = waits.problems - waits.problems / 100;
+        uint64_t seen = 0;
+        for (size_t index = 0; index < kBuckets; index++)
+        {
+            seen += waits.buckets[index];
+            if (seen >= rank)
+            {
+                stats.p99_micros = std::min(bucket_limit(index), waits.max_micros);
+                break;
+            }
+        }
+        return stats;
+    }
+
+    Priority priorities[DLX_COVER_PRIORITY_LEVELS];
+};
+
+/**
+ * Wakeup shared by every solver's ring and the single output thread that drains them.
+ */
+struct DlxTcpServer::OutputSignal
+{
+    std::mutex mutex;
+    std::condition_variable data_cv;
+    std::atomic<bool> consumer_waiting{false};
+};
+
+/**
+ * Bounded single-producer/single-consumer ring between one solver thread and the output thread.
+ *
+ * The ring owns a fixed set of slabs of u32 words. The solver appends records ({count, row ids...}, or a
+ * Begin/End marker) to the slab at the head and publishes the slab as a whole once it is full, at the end of a
+ * problem, or when the output thread has gone hungry; the output thread then broadcasts a slab at a time. A Begin
+ * marker is never published on its own: it waits in the open slab for the problem's first record or its End
+ * marker, so a search that finds nothing yet does not claim the output thread. Records
+ * are copied straight from the search buffer, so the search never allocates or locks per solution: the mutexes and
+ * condition variables are only touched when a side has to sleep because the ring is full or empty. A problem's
+ * stream always starts a fresh slab and is published as soon as it ends, so no slab spans two problems. The route of
+ * each problem travels beside its Begin marker in a small locked queue, touched once per problem.
+ */
+struct DlxTcpServer::SolutionRing
+{
+    static constexpr uint32_t kBeginMarker = UINT32_MAX;   /**< Followed by the problem's column count. */
+    static constexpr uint32_t kEndMarker = UINT32_MAX - 1; /**< Closes the problem's stream; followed by its status. */
+    /** Room for the largest encodable solution (UINT16_MAX rows) and its count word. */
+    static constexpr size_t kSlabWords = 65536;
+    static constexpr size_t kSlabCount = 16;
+    static constexpr int kFullSpins = 64;
+
+    struct Slab
+    {
+        size_t used;
+        uint32_t words[kSlabWords];
+    };
+
+    SolutionRing(const std::atomic<bool>& stopping, OutputSignal& signal, bool eager_publish)
+        : slabs(new Slab[kSlabCount])
+        , stopping(&stopping)
+        , signal(&signal)
+        , eager(eager_publish)
+        , head(0)
+        , cached_tail(0)
+        , fill(0)
+        , hungry(false)
+        , tail(0)
+        , producer_waiting(false)
+    {}
+
+    /**
+     * Solver side: copy one record into the open slab, publishing the slab first when the record does not fit.
+     *
+     * @return bool False when the record is too large or the server shut down while waiting for a free slab.
+     */
+    bool append(uint32_t first, const uint32_t* words, size_t count)
+    {
+        const size_t needed = count + 1;
+        if (needed > kSlabWords)
+        {
+            return false;
+        }
+        if (fill + needed > kSlabWords)
+        {
+            publish();
+        }
+        if (fill == 0 && !acquire())
+        {
+            return false;
+        }
+
+        uint32_t* out = slabs[head.load(std::memory_order_relaxed) % kSlabCount].words + fill;
+        out[0] = first;
+        memcpy(out + 1, words, count * sizeof(uint32_t));
+        fill += needed;
+
+        // The output thread is streaming this ring and ran dry, so a slow trickle of solutions is not held back.
+        // Eager rings never wait for that, so a problem's first solution leaves as soon as it is found.
+        if (first != kBeginMarker && (eager || hungry.load(std::memory_order_relaxed)))
+        {
+            hungry.store(false, std::memory_order_relaxed);
+            publish();
+        }
+        return true;
+    }
+
+    /** Solver side: hand the open slab, if it holds anything, to the output thread. */
+    void publish()
+    {
+        if (fill == 0)
+        {
+            return;
+        }
+
+        const uint64_t position = head.load(std::memory_order_relaxed);
+        slabs[position % kSlabCount].used = fill;
+        fill = 0;
+        head.store(position + 1, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (signal->consumer_waiting.load(std::memory_order_relaxed))
+        {
+            std::lock_guard<std::mutex> lock(signal->mutex);
+            signal->data_cv.notify_one();
+        }
+    }
+
+    /** Solver side: close the problem's stream with @p status and hand it to the output thread. */
+    void end_problem(const binary::DlxSolveStatus& status)
+    {
+        const uint32_t words[DLX_SOLVE_STATUS_WORDS] = {
+            status.code,
+            static_cast<uint32_t>(status.solutions >> 32),
+            static_cast<uint32_t>(status.solutions),
+            static_cast<uint32_t>(status.nodes >> 32),
+            static_cast<uint32_t>(status.nodes),
+        };
+        append(kEndMarker, words, DLX_SOLVE_STATUS_WORDS);
+        publish();
+    }
+
+    /** Output side: the status that follows the End marker at @p words. */
+    static binary::DlxSolveStatus end_status(const uint32_t* words)
+    {
+        return binary::DlxSolveStatus{words[0],
+                                      (static_cast<uint64_t>(words[1]) << 32) | words[2],
+                                      (static_cast<uint64_t>(words[3]) << 32) | words[4]};
+    }
+
+    /** Output side: the oldest published slab, or nullptr when nothing is waiting. */
+    const Slab* front() const
+    {
+        const uint64_t position = tail.load(std::memory_order_relaxed);
+        return head.load(std::memory_order_acquire) != position ? &slabs[position % kSlabCount] : nullptr;
+    }
+
+    /** Output side: return the slab from @ref front to the solver. */
+    void release_slab()
+    {
+        tail.store(tail.load(std::memory_order_relaxed) + 1);
+        if (producer_waiting.load())
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            space_cv.notify_one();
+        }
+    }
+
+    /** Published slabs the output thread has not released yet; a sample, for the stats gauges. */
+    size_t queued() const
+    {
+        return static_cast<size_t>(head.load(std::memory_order_relaxed) - tail.load(std::memory_order_relaxed));
+    }
+
+    /** Solver side: queue the route of the problem whose Begin marker comes next. */
+    void push_route(SolutionRoute route)
+    {
+        std::lock_guard<std::mutex> lock(route_mutex);
+        routes.push_back(std::move(route));
+    }
+
+    /** Output side: the route of the Begin marker just read. */
+    SolutionRoute pop_route()
+    {
+        std::lock_guard<std::mutex> lock(route_mutex);
+        SolutionRoute route;
+        if (!routes.empty())
+        {
+            route = std::move(routes.front());
+            routes.pop_front();
+        }
+        return route;
+    }
+
+    /** Wake a solver parked on a full ring so it notices a shutdown. */
+    void wake()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        space_cv.notify_all();
+    }
+
+    /** Wait until the slab at the head is free; spins briefly before parking. */
+    bool acquire()
+    {
+        const uint64_t position = head.load(std::memory_order_relaxed);
+        if (position - cached_tail < kSlabCount)
+        {
+            return true;
+        }
+        for (int spin = 0; spin < kFullSpins; spin++)
+        {
+            cached_tail = tail.load(std::memory_order_acquire);
+            if (position - cached_tail < kSlabCount)
+            {
+                return true;
+            }
+            std::this_thread::yield();
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        producer_waiting.store(true);
+        space_cv.wait(lock, [&]() {
+            cached_tail = tail.load();
+            return position - cached_tail < kSlabCount || stopping->load();
+        });
+        producer_waiting.store(false);
+        return position - cached_tail < kSlabCount;
+    }
+
+    std::unique_ptr<Slab[]> slabs;
+    const std::atomic<bool>* stopping;
+    OutputSignal* signal;
+    bool eager; /**< Publish after every record instead of once the slab is full. */
+
+    alignas(64) std::atomic<uint64_t> head; /**< Slabs published by the solver. */
+    uint64_t cached_tail;
+    size_t fill; /**< Words written to the open slab. */
+    std::atomic<bool> hungry;
+
+    alignas(64) std::atomic<uint64_t> tail; /**< Slabs released by the output thread. */
+
+    alignas(64) std::atomic<bool> producer_waiting;
+    std::mutex mutex;
+    std::condition_variable space_cv;
+
+    std::mutex route_mutex;
+    std::deque<SolutionRoute> routes;
+
+    // Output side: the section being streamed from this ring, written under the server's solution_mutex_.
+    SolutionRoute section;
+    uint32_t section_columns = 0;
+    bool section_open = false;
+};
+
+namespace {
+
+// An idle output thread polls the rings this often, asking the ring it is streaming for partial slabs.
+constexpr std::chrono::milliseconds kOutputIdlePoll(2);
+
+// True when @p options may stop a search before every solution is found, or withhold the rows it finds.
+bool restricts_search(const binary::DlxSolveOptions& options)
+{
+    return options.solution_limit != 0 || options.node_budget != 0 || options.deadline_ms != 0
+           || (options.flags & DLX_SOLVE_FLAG_COUNT_ONLY) != 0 || options.engine > DLX_SOLVE_ENGINE_DANCING_LINKS;
+}
+
+} // namespace
+
+DlxTcpServer::DlxTcpServer(const TcpServerConfig& config)
+    : config_(config)
+    , request_port_(config.request_port)
+    , solution_port_(config.solution_port)
+    , request_listen_fd_(-1)
+    , solution_listen_fd_(-1)
+    , local_listen_fd_(-1)
+    , queue_waits_(std::make_unique<QueueWaits>())
+    , output_signal_(std::make_unique<OutputSignal>())
+    , output_poll_(kOutputIdlePoll)
+    , shutting_down_(false)
+{
+    if (config_.result_cache_bytes > 0)
+    {
+        result_cache_ = std::make_unique<ResultCache>(config_.result_cache_bytes);
+    }
+    // Flush deadlines shorter than the idle poll are only met if the output thread wakes up that often.
+    if (config_.flush.max_micros > 0)
+    {
+        output_poll_ = std::min(output_poll_, std::chrono::microseconds(config_.flush.max_micros));
+    }
+}
+
+DlxTcpServer::~DlxTcpServer()
+{
+    stop();
+    wait();
+}
+
+int DlxTcpServer::create_listening_socket(uint16_t requested_port, uint16_t* bound_port)
+{
+    // Listening sockets are non-blocking: every reactor is woken for them, and the losers see EAGAIN.
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    int opt = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(requested_port);
+
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    if (listen(fd, SOMAXCONN) < 0)
     {
         close(fd);
         return -1;
@@ -231,411 +1216,1831 @@ int DlxTcpServer::create_listening_socket(uint16_t requested_port, uint16_t* bou
     {
         *bound_port = ntohs(actual_addr.sin_port);
     }
-
-    return fd;
+
+    return fd;
+}
+
+/**
+ * Listens on a Unix domain socket at @p path, replacing a socket a previous server left behind. Other files at the
+ * path are left alone and make the bind fail.
+ *
+ * @return int The non-blocking listening socket, or -1.
+ */
+int DlxTcpServer::create_local_socket(const std::string& path)
+{
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path))
+    {
+        return -1;
+    }
+    memcpy(addr.sun_path, path.c_str(), path.size());
+
+    struct stat existing;
+    if (lstat(path.c_str(), &existing) == 0 && S_ISSOCK(existing.st_mode))
+    {
+        unlink(path.c_str());
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(fd, SOMAXCONN) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool DlxTcpServer::start()
+{
+    if (request_listen_fd_ != -1 || solution_listen_fd_ != -1)
+    {
+        return false;
+    }
+
+    shutting_down_ = false;
+
+    request_listen_fd_ = create_listening_socket(config_.request_port, &request_port_);
+    if (request_listen_fd_ < 0)
+    {
+        return false;
+    }
+
+    solution_listen_fd_ = create_listening_socket(config_.solution_port, &solution_port_);
+    if (solution_listen_fd_ < 0)
+    {
+        close(request_listen_fd_);
+        request_listen_fd_ = -1;
+        return false;
+    }
+
+    if (!config_.local_socket_path.empty())
+    {
+        local_listen_fd_ = create_local_socket(config_.local_socket_path);
+        if (local_listen_fd_ < 0)
+        {
+            close(request_listen_fd_);
+            close(solution_listen_fd_);
+            request_listen_fd_ = -1;
+            solution_listen_fd_ = -1;
+            return false;
+        }
+    }
+
+    // Every reactor watches the listeners and its own wake-up eventfd.
+    const unsigned int io_threads = std::max(1u, config_.io_threads);
+    reactors_.clear();
+    using_io_uring_ = false;
+    for (unsigned int index = 0; index < io_threads; index++)
+    {
+        auto reactor = std::make_unique<Reactor>();
+        if (reactor->epoll_fd < 0 || reactor->wake_fd < 0
+            || reactor->watch(reactor->wake_fd, EPOLLIN, event_tag(EventKind::Wake, reactor->wake_fd)) != 0
+            || reactor->watch(request_listen_fd_,
+                              EPOLLIN | EPOLLEXCLUSIVE,
+                              event_tag(EventKind::ProblemListener, request_listen_fd_)) != 0
+            || reactor->watch(solution_listen_fd_,
+                              EPOLLIN | EPOLLEXCLUSIVE,
+                              event_tag(EventKind::SolutionListener, solution_listen_fd_)) != 0
+            || (local_listen_fd_ >= 0
+                && reactor->watch(local_listen_fd_,
+                                  EPOLLIN | EPOLLEXCLUSIVE,
+                                  event_tag(EventKind::LocalListener, local_listen_fd_)) != 0))
+        {
+            reactors_.clear();
+            close(request_listen_fd_);
+            close(solution_listen_fd_);
+            request_listen_fd_ = -1;
+            solution_listen_fd_ = -1;
+            if (local_listen_fd_ >= 0)
+            {
+                close(local_listen_fd_);
+                unlink(config_.local_socket_path.c_str());
+                local_listen_fd_ = -1;
+            }
+            return false;
+        }
+        reactors_.push_back(std::move(reactor));
+    }
+#if defined(DLX_HAVE_IO_URING)
+    // io_uring is all or nothing: if any ring cannot be set up, every reactor stays on epoll.
+    if (config_.io_uring)
+    {
+        using_io_uring_ = true;
+        for (auto& reactor : reactors_)
+        {
+            reactor->ring = std::make_unique<io::IoUring>();
+            if (reactor->ring->init(kReactorRingEntries) != 0)
+            {
+                using_io_uring_ = false;
+                break;
+            }
+        }
+        for (auto& reactor : reactors_)
+        {
+            if (!using_io_uring_)
+            {
+                reactor->ring.reset();
+            }
+        }
+        if (using_io_uring_)
+        {
+            subscriber_sends_ = std::make_unique<SubscriberSends>();
+            if (subscriber_sends_->queue.init(kSendSlots, kSendSlotBytes) != 0)
+            {
+                subscriber_sends_.reset();
+            }
+        }
+    }
+#endif
+
+    dlx::Core::dlx_set_stdout_suppressed(true);
+
+    for (size_t index = 0; index < reactors_.size(); index++)
+    {
+        io_threads_.emplace_back(&DlxTcpServer::run_reactor, this, index);
+    }
+    // Every solver gets its own solution ring, so the rings stay single-producer.
+    const unsigned int workers = config_.workers != 0 ? config_.workers : std::max(1u, std::thread::hardware_concurrency());
+    solution_rings_.clear();
+    for (unsigned int worker = 0; worker < workers; worker++)
+    {
+        solution_rings_.push_back(
+            std::make_unique<SolutionRing>(shutting_down_, *output_signal_, config_.flush.max_bytes == 0));
+    }
+    for (unsigned int worker = 0; worker < workers; worker++)
+    {
+        worker_threads_.emplace_back(&DlxTcpServer::process_problem_queue, this, static_cast<size_t>(worker));
+    }
+    output_thread_ = std::thread(&DlxTcpServer::process_solution_queue, this);
+    return true;
+}
+
+void DlxTcpServer::stop()
+{
+    if (shutting_down_.exchange(true))
+    {
+        return;
+    }
+
+    problem_queue_cv_.notify_all();
+    for (auto& ring : solution_rings_)
+    {
+        ring->wake();
+    }
+    for (auto& reactor : reactors_)
+    {
+        reactor->wake();
+    }
+    {
+        std::lock_guard<std::mutex> lock(output_signal_->mutex);
+        output_signal_->data_cv.notify_all();
+    }
+
+    // Listening sockets stop accepting now but are only closed by wait(), once no reactor can still use them.
+    if (request_listen_fd_ >= 0)
+    {
+        shutdown(request_listen_fd_, SHUT_RDWR);
+    }
+    if (solution_listen_fd_ >= 0)
+    {
+        shutdown(solution_listen_fd_, SHUT_RDWR);
+    }
+    if (local_listen_fd_ >= 0)
+    {
+        shutdown(local_listen_fd_, SHUT_RDWR);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(solution_mutex_);
+        for (auto& client : solution_clients_)
+        {
+            client.reset();
+        }
+        solution_clients_.clear();
+        lagging_replies_.clear();
+        subscriber_count_.store(0);
+    }
+
+    dlx::Core::dlx_set_stdout_suppressed(false);
+}
+
+void DlxTcpServer::wait()
+{
+    for (auto& io_thread : io_threads_)
+    {
+        if (io_thread.joinable())
+        {
+            io_thread.join();
+        }
+    }
+    io_threads_.clear();
+    reactors_.clear();
+    if (request_listen_fd_ >= 0)
+    {
+        close(request_listen_fd_);
+        request_listen_fd_ = -1;
+    }
+    if (solution_listen_fd_ >= 0)
+    {
+        close(solution_listen_fd_);
+        solution_listen_fd_ = -1;
+    }
+    if (local_listen_fd_ >= 0)
+    {
+        close(local_listen_fd_);
+        unlink(config_.local_socket_path.c_str());
+        local_listen_fd_ = -1;
+    }
+    for (auto& worker : worker_threads_)
+    {
+        if (worker.joinable())
+        {
+            worker.join();
+        }
+    }
+    if (output_thread_.joinable())
+    {
+        output_thread_.join();
+    }
+
+    // Subscribers accepted while the reactors wound down still point at the send queue.
+    {
+        std::lock_guard<std::mutex> lock(solution_mutex_);
+        solution_clients_.clear();
+        lagging_replies_.clear();
+        subscriber_count_.store(0);
+        broadcasting_ = nullptr;
+        for (auto& ring : solution_rings_)
+        {
+            ring->section = SolutionRoute();
+            ring->section_open = false;
+        }
+    }
+    subscriber_sends_.reset();
+}
+
+/**
+ * I/O thread: runs its reactor on io_uring when the server selected that backend, otherwise on epoll, until the
+ * server stops. Problem connections are read without blocking and framed incrementally; solution sockets are
+ * only watched for hang-ups, since the output thread writes them.
+ *
+ * @param size_t Index of the reactor in reactors_.
+ * @return void
+ */
+void DlxTcpServer::run_reactor(size_t index)
+{
+    Reactor& reactor = *reactors_[index];
+#if defined(DLX_HAVE_IO_URING)
+    if (reactor.ring != nullptr)
+    {
+        run_uring_reactor(reactor);
+        reactor.problems.clear();
+        return;
+    }
+#endif
+    run_epoll_reactor(reactor);
+    reactor.problems.clear();
+}
+
+void DlxTcpServer::run_epoll_reactor(Reactor& reactor)
+{
+    epoll_event events[kReactorEvents];
+
+    while (!shutting_down_.load())
+    {
+        const int ready = epoll_wait(reactor.epoll_fd, events, kReactorEvents, -1);
+        if (ready < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+
+        for (int i = 0; i < ready && !shutting_down_.load(); i++)
+        {
+            const uint32_t target = static_cast<uint32_t>(events[i].data.u64 & UINT32_MAX);
+            switch (static_cast<EventKind>(events[i].data.u64 >> 32))
+            {
+            case EventKind::Wake:
+                break;
+            case EventKind::ProblemListener:
+                accept_problem_connections(reactor, static_cast<int>(target));
+                break;
+            case EventKind::SolutionListener:
+                accept_solution_clients(reactor, static_cast<int>(target));
+                break;
+            case EventKind::LocalListener:
+                accept_local_connections(reactor, static_cast<int>(target));
+                break;
+            case EventKind::Problem:
+            case EventKind::Local:
+                read_problem_stream(reactor, static_cast<int>(target));
+                break;
+            case EventKind::Solution:
+                watch_solution_client(reactor, target);
+                break;
+            }
+        }
+    }
+}
+
+void DlxTcpServer::accept_problem_connections(Reactor& reactor, int listen_fd)
+{
+    while (true)
+    {
+        int client_fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (client_fd < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return; // Backlog drained, or another reactor took the connection.
+        }
+
+        auto stream = std::make_unique<ProblemStream>(client_fd, false);
+        if (reactor.watch(client_fd, EPOLLIN | EPOLLRDHUP, event_tag(EventKind::Problem, client_fd)) != 0)
+        {
+            continue;
+        }
+        reactor.problems[client_fd] = std::move(stream);
+    }
+}
+
+/**
+ * Local connections are problem connections that may also carry LocalRequest frames and a segment descriptor.
+ */
+void DlxTcpServer::accept_local_connections(Reactor& reactor, int listen_fd)
+{
+    while (true)
+    {
+        int client_fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (client_fd < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return;
+        }
+
+        auto stream = std::make_unique<ProblemStream>(client_fd, true);
+        if (reactor.watch(client_fd, EPOLLIN | EPOLLRDHUP, event_tag(EventKind::Local, client_fd)) != 0)
+        {
+            continue;
+        }
+        reactor.problems[client_fd] = std::move(stream);
+    }
+}
+
+void DlxTcpServer::accept_solution_clients(Reactor& reactor, int listen_fd)
+{
+    while (true)
+    {
+        // Subscriber sockets stay blocking: the output thread writes them, the reactor only notices hang-ups.
+        int client_fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client_fd < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(solution_mutex_);
+        const uint32_t serial = add_solution_client_locked(client_fd);
+        if (reactor.watch(client_fd, EPOLLIN | EPOLLRDHUP, event_tag(EventKind::Solution, serial)) != 0)
+        {
+            solution_clients_.back().reset();
+        }
+        remove_disconnected_clients_locked();
+    }
+}
+
+/**
+ * Registers a new subscriber, starting its DLXS stream straight away when a problem is being published. It has no
+ * subscriptions yet, so it takes every published problem.
+ *
+ * @return uint32_t The client's serial, used to tag its reactor events.
+ */
+uint32_t DlxTcpServer::add_solution_client_locked(int client_fd)
+{
+    const uint32_t serial = next_client_serial_++;
+    auto client = make_solution_client(client_fd, serial, true);
+    solution_clients_.push_back(client);
+    subscriber_count_.store(solution_clients_.size());
+    if (broadcasting_ != nullptr)
+    {
+        start_solution_section_locked(*client, broadcasting_->section, broadcasting_->section_columns);
+    }
+    return serial;
+}
+
+/**
+ * Wraps a solution socket in its output stream. Under the Block policy subscribers send through the io_uring
+ * queue when it is active and inline replies wait for their socket; under Drop and Spill every client queues
+ * what its socket does not take right away, within the configured limits. Replies to a local client with a
+ * segment go into the segment's ring instead, under the same policies.
+ *
+ * @param int The connected socket, owned by the returned client.
+ * @param uint32_t The client's serial.
+ * @param bool True for a solution port subscriber, false for an inline reply.
+ * @param std::shared_ptr<shm::ShmSegment> Segment whose ring receives the answers, or nullptr.
+ * @return std::shared_ptr<SolutionClient> The new client.
+ */
+std::shared_ptr<DlxTcpServer::SolutionClient> DlxTcpServer::make_solution_client(int client_fd,
+                                                                                 uint32_t serial,
+                                                                                 bool subscriber,
+                                                                                 std::shared_ptr<shm::ShmSegment> segment)
+{
+    std::unique_ptr<shm::ShmRing> ring = (segment != nullptr) ? std::make_unique<shm::ShmRing>(*segment) : nullptr;
+    std::unique_ptr<SocketOutputStream> stream;
+    if (config_.slow_clients == SlowClientPolicy::Block)
+    {
+        SendQueue* queue = (subscriber && subscriber_sends_ != nullptr) ? &subscriber_sends_->queue : nullptr;
+        stream = std::make_unique<SocketOutputStream>(client_fd, queue, nullptr, ring.get());
+    }
+    else
+    {
+        const BacklogLimits limits = {
+            .policy = config_.slow_clients,
+            .memory_bytes = config_.client_buffer_bytes,
+            .spill_bytes = config_.client_spill_bytes,
+            .lag = std::chrono::milliseconds(config_.client_lag_ms),
+            .memory_gauge = &backlog_bytes_,
+            .spill_gauge = &spilled_bytes_,
+        };
+        stream = std::make_unique<SocketOutputStream>(client_fd, nullptr, &limits, ring.get());
+    }
+
+    // Rows are batched here, so Nagle's algorithm would only delay the tail of each batch.
+    if (ring == nullptr)
+    {
+        const int nodelay = 1;
+        setsockopt(client_fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+        if (config_.socket_send_buffer > 0)
+        {
+            setsockopt(client_fd, SOL_SOCKET, SO_SNDBUF, &config_.socket_send_buffer, sizeof(config_.socket_send_buffer));
+        }
+    }
+
+    auto client = std::make_shared<SolutionClient>(client_fd, serial, std::move(stream));
+    client->segment = std::move(segment);
+    client->ring = std::move(ring);
+    client->set_flush_policy(config_.flush);
+    return client;
+}
+
+/**
+ * Called after rows were written to @p client: sends its batch once the client's flush policy says so.
+ *
+ * @return bool False when the send failed.
+ */
+bool DlxTcpServer::apply_flush_policy_locked(SolutionClient& client, std::chrono::steady_clock::time_point now)
+{
+    if (!client.unflushed)
+    {
+        client.unflushed = true;
+        client.unflushed_since = now;
+    }
+
+    const size_t buffered = client.writer->buffered_bytes() + client.stream->buffer().batched_bytes();
+    if (buffered >= client.flush.max_bytes)
+    {
+        return flush_solution_client_locked(client, true);
+    }
+    if (client.flush.max_micros > 0 && now - client.unflushed_since >= std::chrono::microseconds(client.flush.max_micros))
+    {
+        return flush_solution_client_locked(client, false);
+    }
+    return true;
+}
+
+/**
+ * Sends every row written to @p client so far in one gather write. @p more keeps a corked client's partial
+ * segment back, for batches that more of the section follows.
+ *
+ * @return bool False when the send failed.
+ */
+bool DlxTcpServer::flush_solution_client_locked(SolutionClient& client, bool more)
+{
+    client.unflushed = false;
+    client.stream->buffer().set_more(more && client.flush.cork);
+    const bool sent = client.writer->flush() == 0 && client.stream->flush().good();
+    client.stream->buffer().set_more(client.flush.cork);
+    return sent;
+}
+
+/**
+ * Output thread, while no slab is waiting: sends the batches that have waited past their client's deadline.
+ */
+void DlxTcpServer::flush_due_clients()
+{
+    const auto now = std::chrono::steady_clock::now();
+    auto due = [&](const SolutionClient& client) {
+        return client.streaming && client.unflushed && client.flush.max_micros > 0
+               && now - client.unflushed_since >= std::chrono::microseconds(client.flush.max_micros);
+    };
+
+    std::lock_guard<std::mutex> lock(solution_mutex_);
+    // Inline answers open on rings the output thread is not following still owe their trickle a flush.
+    for (const auto& ring : solution_rings_)
+    {
+        if (ring->section_open && ring->section.reply != nullptr)
+        {
+            SolutionClient& reply = *ring->section.reply;
+            if (due(reply) && !flush_solution_client_locked(reply, false))
+            {
+                reply.streaming = false;
+            }
+        }
+    }
+    if (broadcasting_ == nullptr)
+    {
+        return;
+    }
+
+    bool failed = false;
+    for (auto& client : solution_clients_)
+    {
+        if (client != nullptr && due(*client) && !flush_solution_client_locked(*client, false))
+        {
+            release_failed_client_locked(client);
+            failed = true;
+        }
+    }
+    if (failed)
+    {
+        remove_disconnected_clients_locked();
+    }
+#if defined(DLX_HAVE_IO_URING)
+    if (subscriber_sends_ != nullptr)
+    {
+        subscriber_sends_->queue.poll();
+    }
+#endif
+}
+
+/**
+ * Disconnects a client whose stream failed, counting it as dropped when it was cut off for falling behind.
+ */
+void DlxTcpServer::release_failed_client_locked(std::shared_ptr<SolutionClient>& client)
+{
+    if (client != nullptr && client->stream->buffer().fell_behind())
+    {
+        dropped_clients_.fetch_add(1);
+    }
+    client.reset();
+}
+
+/**
+ * Output thread, while no slab is waiting: hands slow clients whatever their sockets now take from the backlog
+ * they built up, and retires finished inline replies once they have nothing left to send.
+ */
+void DlxTcpServer::drain_client_backlogs()
+{
+    std::lock_guard<std::mutex> lock(solution_mutex_);
+    bool failed = false;
+    for (auto& client : solution_clients_)
+    {
+        if (client != nullptr && client->stream->buffer().drain_backlog() != 0)
+        {
+            release_failed_client_locked(client);
+            failed = true;
+        }
+    }
+    if (failed)
+    {
+        remove_disconnected_clients_locked();
+    }
+
+    lagging_replies_.erase(std::remove_if(lagging_replies_.begin(),
+                                          lagging_replies_.end(),
+                                          [](const std::shared_ptr<SolutionClient>& reply) {
+                                              return reply->stream->buffer().drain_backlog() != 0
+                                                     || reply->stream->buffer().backlog_bytes() == 0;
+                                          }),
+                           lagging_replies_.end());
+}
+
+/**
+ * Samples the queue depths. Slab counts are read without stopping the solvers, so they may be a slab off.
+ *
+ * @return TcpServerStats The current depths and counters.
+ */
+TcpServerStats DlxTcpServer::stats()
+{
+    TcpServerStats stats = {};
+    {
+        std::lock_guard<std::mutex> lock(problem_queue_mutex_);
+        stats.queued_problems = problem_queue_.size();
+        for (unsigned int priority = 0; priority < DLX_COVER_PRIORITY_LEVELS; priority++)
+        {
+            stats.waits[priority] = queue_waits_->summary(priority);
+        }
+    }
+    for (const auto& ring : solution_rings_)
+    {
+        stats.queued_slabs += ring->queued();
+        stats.slab_capacity += SolutionRing::kSlabCount;
+    }
+    stats.subscribers = subscriber_count_.load();
+    stats.backlog_bytes = backlog_bytes_.load();
+    stats.spilled_bytes = spilled_bytes_.load();
+    stats.dropped_clients = dropped_clients_.load();
+    if (result_cache_ != nullptr)
+    {
+        stats.cache_hits = result_cache_->hits();
+        stats.coalesced = result_cache_->coalesced();
+        stats.cached_bytes = result_cache_->cached_bytes();
+    }
+    return stats;
+}
+
+/**
+ * Receives what a problem connection has sent and queues every frame it completes.
+ */
+void DlxTcpServer::read_problem_stream(Reactor& reactor, int fd)
+{
+    auto found = reactor.problems.find(fd);
+    if (found == reactor.problems.end())
+    {
+        return;
+    }
+    ProblemStream& stream = *found->second;
+
+    reserve_receive_space(stream);
+    const ssize_t received = receive_problem_bytes(stream);
+    if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+    {
+        return;
+    }
+    if (!consume_problem_bytes(stream, received))
+    {
+        reactor.problems.erase(found);
+    }
+}
+
+/**
+ * Receives into the free end of the stream's buffer. Local connections are read with recvmsg, so a segment
+ * descriptor sent along with an attach request is kept in @ref ProblemStream::passed_fd.
+ *
+ * @return ssize_t As for recv; a second descriptor arriving before the first was used fails the receive.
+ */
+ssize_t DlxTcpServer::receive_problem_bytes(ProblemStream& stream)
+{
+    char* free_space = stream.buffer.data() + stream.end;
+    const size_t free_bytes = stream.buffer.size() - stream.end;
+    if (!stream.local)
+    {
+        return recv(stream.fd, free_space, free_bytes, 0);
+    }
+
+    union
+    {
+        cmsghdr header;
+        char space[CMSG_SPACE(sizeof(int))];
+    } control;
+    iovec target = {free_space, free_bytes};
+    msghdr message = {};
+    message.msg_iov = &target;
+    message.msg_iovlen = 1;
+    message.msg_control = control.space;
+    message.msg_controllen = sizeof(control.space);
+    const ssize_t received = recvmsg(stream.fd, &message, MSG_CMSG_CLOEXEC);
+    if (received < 0)
+    {
+        return received;
+    }
+
+    for (cmsghdr* header = CMSG_FIRSTHDR(&message); header != nullptr; header = CMSG_NXTHDR(&message, header))
+    {
+        if (header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS)
+        {
+            continue;
+        }
+        int passed = -1;
+        memcpy(&passed, CMSG_DATA(header), sizeof(passed));
+        if (stream.passed_fd >= 0)
+        {
+            close(passed);
+            return -1;
+        }
+        stream.passed_fd = passed;
+    }
+    return (message.msg_flags & MSG_CTRUNC) != 0 ? -1 : received;
+}
+
+/**
+ * Makes room for the next receive. The unread frame is kept at the front so the buffer only grows to the
+ * largest frame.
+ */
+void DlxTcpServer::reserve_receive_space(ProblemStream& stream)
+{
+    if (stream.begin > 0 && stream.buffer.size() - stream.end < kProblemReadBytes)
+    {
+        memmove(stream.buffer.data(), stream.buffer.data() + stream.begin, stream.end - stream.begin);
+        stream.end -= stream.begin;
+        stream.begin = 0;
+    }
+    if (stream.buffer.size() - stream.end < kProblemReadBytes)
+    {
+        stream.buffer.resize(stream.end + kProblemReadBytes);
+    }
+}
+
+/**
+ * Accounts for @p received new bytes (0 at end of stream, negative on a receive error) and queues every frame
+ * they complete.
+ *
+ * @return bool False once the connection should be closed: end of stream, an error, or malformed input.
+ */
+bool DlxTcpServer::consume_problem_bytes(ProblemStream& stream, ssize_t received)
+{
+    bool open = received > 0;
+    if (open)
+    {
+        stream.end += static_cast<size_t>(received);
+    }
+
+    while (true)
+    {
+        // Between frames, a local connection may send a LocalRequest instead.
+        const size_t available = stream.end - stream.begin;
+        if (stream.local && stream.scanner.idle())
+        {
+            uint32_t magic = 0;
+            if (available < sizeof(magic))
+            {
+                break;
+            }
+            memcpy(&magic, stream.buffer.data() + stream.begin, sizeof(magic));
+            if (ntohl(magic) == DLX_LOCAL_MAGIC)
+            {
+                if (available < sizeof(shm::LocalRequest))
+                {
+                    break;
+                }
+                if (handle_local_request(stream, stream.buffer.data() + stream.begin) != 0)
+                {
+                    return false;
+                }
+                stream.begin += sizeof(shm::LocalRequest);
+                continue;
+            }
+        }
+
+        size_t frame_bytes = 0;
+        const int status = stream.scanner.scan(stream.buffer.data() + stream.begin, available, &frame_bytes);
+        if (status == 0)
+        {
+            break;
+        }
+        if (status < 0 || submit_problem_frame(stream, stream.buffer.data() + stream.begin, frame_bytes) != 0)
+        {
+            return false;
+        }
+        stream.begin += frame_bytes;
+    }
+    if (stream.begin == stream.end)
+    {
+        stream.begin = 0;
+        stream.end = 0;
+    }
+
+    // Rows framed only by the end of the stream are complete now; anything else left over is truncated.
+    if (received == 0 && stream.scanner.needs_eof())
+    {
+        submit_problem_frame(stream, stream.buffer.data() + stream.begin, stream.end - stream.begin);
+    }
+    return open;
+}
+
+/**
+ * Carries out one LocalRequest. Attaching maps the client's segment and makes its ring the connection's reply
+ * writer; submitting decodes a frame straight from the segment's problem area and then counts it in the header's
+ * decoded word, which tells the client the area may be overwritten.
+ *
+ * @param const char* The request's sixteen bytes.
+ * @return int 0 on success, -1 when the request is malformed and the connection should be closed.
+ */
+int DlxTcpServer::handle_local_request(ProblemStream& stream, const char* data)
+{
+    uint32_t words[4];
+    memcpy(words, data, sizeof(words));
+    const uint32_t op = ntohl(words[1]);
+    if (op == shm::kLocalAttach)
+    {
+        const int segment_fd = stream.passed_fd;
+        stream.passed_fd = -1;
+        if (segment_fd < 0 || stream.segment != nullptr || stream.connection->reply != nullptr)
+        {
+            if (segment_fd >= 0)
+            {
+                close(segment_fd);
+            }
+            return -1;
+        }
+
+        auto segment = std::make_shared<shm::ShmSegment>();
+        const int reply_fd = (segment->attach(segment_fd) == 0) ? fcntl(stream.fd, F_DUPFD_CLOEXEC, 0) : -1;
+        if (reply_fd < 0)
+        {
+            return -1;
+        }
+        stream.segment = segment;
+        stream.connection->reply = make_solution_client(reply_fd, kInlineReplySerial, false, std::move(segment));
+        return 0;
+    }
+
+    const uint32_t offset = ntohl(words[2]);
+    const uint32_t length = ntohl(words[3]);
+    if (op != shm::kLocalSubmit || stream.segment == nullptr || offset > stream.segment->problem_bytes()
+        || length > stream.segment->problem_bytes() - offset)
+    {
+        return -1;
+    }
+
+    const int status = submit_problem_frame(stream, stream.segment->problem_area() + offset, length);
+    shm::ShmSegmentHeader* header = stream.segment->header();
+    header->decoded.fetch_add(1);
+    shm::futex_wake(&header->decoded);
+    return status;
+}
+
+void DlxTcpServer::watch_solution_client(Reactor& reactor, uint32_t serial)
+{
+    std::lock_guard<std::mutex> lock(solution_mutex_);
+    const int fd = check_solution_client_locked(serial);
+    if (fd >= 0)
+    {
+        epoll_ctl(reactor.epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+        drop_solution_client_locked(serial);
+    }
+}
+
+/**
+ * Subscribers only ever send subscription frames, so readiness on their socket means subscriptions or a hang-up.
+ * Clients are looked up by serial, so a stale event for a client that is already gone is ignored.
+ *
+ * @return int The descriptor of a client that hung up or sent something other than subscriptions and should be
+ *         dropped, or -1 to keep watching.
+ */
+int DlxTcpServer::check_solution_client_locked(uint32_t serial)
+{
+    auto found = std::find_if(solution_clients_.begin(),
+                              solution_clients_.end(),
+                              [&](const std::shared_ptr<SolutionClient>& client) { return client != nullptr && client->serial == serial; });
+    if (found == solution_clients_.end())
+    {
+        return -1;
+    }
+
+    char scratch[256];
+    const ssize_t received = recv((*found)->fd, scratch, sizeof(scratch), MSG_DONTWAIT);
+    if (received > 0)
+    {
+        return (*found)->receive(scratch, static_cast<size_t>(received)) ? -1 : (*found)->fd;
+    }
+    if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+    {
+        return -1;
+    }
+    return (*found)->fd;
+}
+
+void DlxTcpServer::drop_solution_client_locked(uint32_t serial)
+{
+    for (auto& client : solution_clients_)
+    {
+        if (client != nullptr && client->serial == serial)
+        {
+            client.reset();
+        }
+    }
+    remove_disconnected_clients_locked();
+}
+
+#if defined(DLX_HAVE_IO_URING)
+/**
+ * io_uring form of the reactor loop. Accepts are multishot, every problem connection keeps one receive
+ * posted into its buffer, and subscribers keep one poll posted. Everything queued while handling a batch of
+ * completions is submitted by the same io_uring_enter that waits for the next batch, so a busy reactor makes
+ * one system call per round instead of one per ready socket. On shutdown every request is cancelled and waited
+ * for, so no receive can land in a buffer after it is freed.
+ */
+void DlxTcpServer::run_uring_reactor(Reactor& reactor)
+{
+    io::IoUring& ring = *reactor.ring;
+    arm_uring_wake(reactor);
+    arm_uring_accept(reactor, request_listen_fd_);
+    arm_uring_accept(reactor, solution_listen_fd_);
+    if (local_listen_fd_ >= 0)
+    {
+        arm_uring_accept(reactor, local_listen_fd_);
+    }
+
+    struct io_uring_cqe cqe;
+    while (!shutting_down_.load())
+    {
+        if (ring.submit(1) < 0 && errno != EINTR && errno != EBUSY)
+        {
+            break;
+        }
+        while (!shutting_down_.load() && ring.pop(&cqe))
+        {
+            if ((cqe.flags & IORING_CQE_F_MORE) == 0)
+            {
+                reactor.pending--;
+            }
+            handle_uring_completion(reactor, cqe);
+        }
+    }
+
+    struct io_uring_sqe* sqe = reactor.prepare(IORING_OP_ASYNC_CANCEL, -1, 0);
+    if (sqe != nullptr)
+    {
+        sqe->cancel_flags = IORING_ASYNC_CANCEL_ANY;
+    }
+    while (reactor.pending > 0)
+    {
+        if (ring.submit(1) < 0 && errno != EINTR && errno != EBUSY)
+        {
+            break;
+        }
+        while (ring.pop(&cqe))
+        {
+            if ((cqe.flags & IORING_CQE_F_MORE) == 0)
+            {
+                reactor.pending--;
+            }
+            const EventKind kind = static_cast<EventKind>(cqe.user_data >> 32);
+            if ((kind == EventKind::ProblemListener || kind == EventKind::SolutionListener
+                 || kind == EventKind::LocalListener)
+                && cqe.res >= 0)
+            {
+                close(cqe.res); // Accepted while shutting down.
+            }
+        }
+    }
+}
+
+void DlxTcpServer::handle_uring_completion(Reactor& reactor, const ::io_uring_cqe& cqe)
+{
+    const uint32_t target = static_cast<uint32_t>(cqe.user_data & UINT32_MAX);
+    const bool rearm = (cqe.flags & IORING_CQE_F_MORE) == 0;
+    switch (static_cast<EventKind>(cqe.user_data >> 32))
+    {
+    case EventKind::Wake:
+        arm_uring_wake(reactor);
+        break;
+    case EventKind::ProblemListener:
+        if (cqe.res >= 0)
+        {
+            auto stream = std::make_unique<ProblemStream>(cqe.res, false);
+            ProblemStream& added = *stream;
+            reactor.problems[cqe.res] = std::move(stream);
+            arm_uring_receive(reactor, added);
+        }
+        if (rearm)
+        {
+            arm_uring_accept(reactor, static_cast<int>(target));
+        }
+        break;
+    case EventKind::LocalListener:
+        if (cqe.res >= 0)
+        {
+            reactor.problems[cqe.res] = std::make_unique<ProblemStream>(cqe.res, true);
+            arm_uring_local_poll(reactor, cqe.res);
+        }
+        if (rearm)
+        {
+            arm_uring_accept(reactor, static_cast<int>(target));
+        }
+        break;
+    case EventKind::Local:
+        // Local connections are polled and then read with recvmsg, which keeps any descriptor sent along.
+        read_problem_stream(reactor, static_cast<int>(target));
+        if (reactor.problems.count(static_cast<int>(target)) != 0)
+        {
+            arm_uring_local_poll(reactor, static_cast<int>(target));
+        }
+        break;
+    case EventKind::SolutionListener:
+        if (cqe.res >= 0)
+        {
+            std::lock_guard<std::mutex> lock(solution_mutex_);
+            const uint32_t serial = add_solution_client_locked(cqe.res);
+            arm_uring_poll(reactor, cqe.res, serial);
+        }
+        if (rearm)
+        {
+            arm_uring_accept(reactor, static_cast<int>(target));
+        }
+        break;
+    case EventKind::Problem:
+    {
+        auto found = reactor.problems.find(static_cast<int>(target));
+        if (found == reactor.problems.end())
+        {
+            break;
+        }
+        if (cqe.res == -EAGAIN || cqe.res == -EINTR || cqe.res == -ENOBUFS)
+        {
+            arm_uring_receive(reactor, *found->second);
+        }
+        else if (consume_problem_bytes(*found->second, cqe.res))
+        {
+            arm_uring_receive(reactor, *found->second);
+        }
+        else
+        {
+            reactor.problems.erase(found);
+        }
+        break;
+    }
+    case EventKind::Solution:
+    {
+        std::lock_guard<std::mutex> lock(solution_mutex_);
+        auto found = std::find_if(solution_clients_.begin(),
+                                  solution_clients_.end(),
+                                  [&](const std::shared_ptr<SolutionClient>& client) { return client != nullptr && client->serial == target; });
+        if (found == solution_clients_.end())
+        {
+            break; // Already dropped by the output thread; the shutdown in its destructor ended the poll.
+        }
+        if (check_solution_client_locked(target) >= 0)
+        {
+            drop_solution_client_locked(target);
+        }
+        else
+        {
+            arm_uring_poll(reactor, (*found)->fd, target);
+        }
+        break;
+    }
+    }
 }
 
-bool DlxTcpServer::start()
+void DlxTcpServer::arm_uring_wake(Reactor& reactor)
 {
-    if (request_listen_fd_ != -1 || solution_listen_fd_ != -1)
+    struct io_uring_sqe* sqe = reactor.prepare(IORING_OP_READ, reactor.wake_fd, event_tag(EventKind::Wake, reactor.wake_fd));
+    if (sqe != nullptr)
     {
-        return false;
+        sqe->addr = reinterpret_cast<uintptr_t>(&reactor.wake_value);
+        sqe->len = sizeof(reactor.wake_value);
     }
+}
 
-    shutting_down_ = false;
-
-    request_listen_fd_ = create_listening_socket(config_.request_port, &request_port_);
-    if (request_listen_fd_ < 0)
+void DlxTcpServer::arm_uring_accept(Reactor& reactor, int listen_fd)
+{
+    const EventKind kind = (listen_fd == request_listen_fd_) ? EventKind::ProblemListener
+                           : (listen_fd == local_listen_fd_) ? EventKind::LocalListener
+                                                              : EventKind::SolutionListener;
+    struct io_uring_sqe* sqe = reactor.prepare(IORING_OP_ACCEPT, listen_fd, event_tag(kind, listen_fd));
+    if (sqe != nullptr)
     {
-        return false;
+        sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+        // Subscriber sockets stay blocking for the output thread's direct sends.
+        sqe->accept_flags = (kind == EventKind::SolutionListener) ? SOCK_CLOEXEC : (SOCK_NONBLOCK | SOCK_CLOEXEC);
     }
+}
 
-    solution_listen_fd_ = create_listening_socket(config_.solution_port, &solution_port_);
-    if (solution_listen_fd_ < 0)
+void DlxTcpServer::arm_uring_receive(Reactor& reactor, ProblemStream& stream)
+{
+    reserve_receive_space(stream);
+    struct io_uring_sqe* sqe = reactor.prepare(IORING_OP_RECV, stream.fd, event_tag(EventKind::Problem, stream.fd));
+    if (sqe != nullptr)
     {
-        close(request_listen_fd_);
-        request_listen_fd_ = -1;
-        return false;
+        sqe->addr = reinterpret_cast<uintptr_t>(stream.buffer.data() + stream.end);
+        sqe->len = static_cast<uint32_t>(stream.buffer.size() - stream.end);
     }
-
-    dlx::Core::dlx_set_stdout_suppressed(true);
-
-    request_thread_ = std::thread(&DlxTcpServer::accept_request_loop, this);
-    solution_thread_ = std::thread(&DlxTcpServer::accept_solution_loop, this);
-    worker_thread_ = std::thread(&DlxTcpServer::process_problem_queue, this);
-    output_thread_ = std::thread(&DlxTcpServer::process_solution_queue, this);
-    return true;
 }
 
-void DlxTcpServer::stop()
+void DlxTcpServer::arm_uring_poll(Reactor& reactor, int fd, uint32_t serial)
 {
-    if (shutting_down_.exchange(true))
+    struct io_uring_sqe* sqe = reactor.prepare(IORING_OP_POLL_ADD, fd, event_tag(EventKind::Solution, serial));
+    if (sqe != nullptr)
     {
-        return;
+        sqe->poll32_events = POLLIN | POLLRDHUP;
     }
+}
 
-    problem_queue_cv_.notify_all();
-    solution_queue_cv_.notify_all();
-
-    if (request_listen_fd_ >= 0)
+void DlxTcpServer::arm_uring_local_poll(Reactor& reactor, int fd)
+{
+    struct io_uring_sqe* sqe = reactor.prepare(IORING_OP_POLL_ADD, fd, event_tag(EventKind::Local, fd));
+    if (sqe != nullptr)
     {
-        close(request_listen_fd_);
-        request_listen_fd_ = -1;
+        sqe->poll32_events = POLLIN | POLLRDHUP;
     }
-    if (solution_listen_fd_ >= 0)
+}
+#endif
+
+/**
+ * Decodes one complete frame into a solver task. Rows are decoded straight into the problem's CSR arena, one
+ * allocation per problem; reuse frames point at the connection's previous cover.
+ *
+ * @return int 0 when the frame was queued, -1 when it could not be decoded or reuses a cover the connection never
+ *         sent; the connection is then closed.
+ */
+int DlxTcpServer::submit_problem_frame(ProblemStream& stream, const char* data, size_t bytes)
+{
+    FrameInputStream input(data, bytes);
+    binary::DlxProblemStreamReader reader(input);
+
+    binary::DlxCoverHeader header = {0};
+    if (reader.read_header(&header) != 0)
     {
-        close(solution_listen_fd_);
-        solution_listen_fd_ = -1;
+        return -1;
     }
 
+    ProblemTask task;
+    task.assumptions = reader.assumptions();
+    task.options = reader.options();
+    task.connection = stream.connection;
+    task.route.connection = stream.connection;
+    task.route.tagged = (header.flags & DLX_COVER_FLAG_PROBLEM_ID) != 0;
+    task.route.report_status = (header.flags & DLX_COVER_FLAG_OPTIONS) != 0;
+    task.route.problem_id = reader.problem_id();
+    if ((header.flags & DLX_COVER_FLAG_REPLY_INLINE) != 0 || stream.segment != nullptr)
     {
-        std::lock_guard<std::mutex> lock(solution_mutex_);
-        for (auto& client : solution_clients_)
+        if (stream.connection->reply == nullptr)
         {
-            client.reset();
+            // The answers get their own descriptor, so they still go out after the client half-closes the
+            // connection and the reactor closes its end.
+            const int reply_fd = fcntl(stream.fd, F_DUPFD_CLOEXEC, 0);
+            if (reply_fd < 0)
+            {
+                return -1;
+            }
+            stream.connection->reply = make_solution_client(reply_fd, kInlineReplySerial, false);
         }
-        solution_clients_.clear();
-    }
-
-    dlx::Core::dlx_set_stdout_suppressed(false);
-}
-
-void DlxTcpServer::wait()
-{
-    if (request_thread_.joinable())
-    {
-        request_thread_.join();
-    }
-    if (solution_thread_.joinable())
-    {
-        solution_thread_.join();
+        task.route.reply = stream.connection->reply;
     }
-    if (worker_thread_.joinable())
+    if ((header.flags & DLX_COVER_FLAG_REUSE_MATRIX) != 0)
     {
-        worker_thread_.join();
-    }
-    if (output_thread_.joinable())
-    {
-        output_thread_.join();
+        // A reuse frame ahead of any cover could never be answered, so it is a protocol error.
+        if (stream.current == nullptr)
+        {
+            return -1;
+        }
     }
-}
-
-void DlxTcpServer::accept_request_loop()
-{
-    while (!shutting_down_)
+    else
     {
-        int client_fd = accept(request_listen_fd_, nullptr, nullptr);
-        if (client_fd < 0)
+        // The header's row count is only trusted as far as the frame could hold it: every row costs at least a
+        // word, and covers that pack tighter grow the arena as their rows arrive.
+        auto problem = std::make_shared<binary::DlxCsrProblem>();
+        int status = problem->reserve(std::min<size_t>(header.row_count, bytes / sizeof(uint32_t)), 0);
+        while (status == 0 && (status = reader.read_row(problem.get())) == 1)
         {
-            if (shutting_down_)
-            {
-                break;
-            }
-            continue;
+            status = 0;
+        }
+        if (status != 0)
+        {
+            return -1;
         }
 
-        std::thread(&DlxTcpServer::process_problem_connection, this, client_fd).detach();
+        problem->header = header;
+        problem->header.row_count = static_cast<uint32_t>(problem->row_count());
+        stream.current = std::move(problem);
+        if (result_cache_ != nullptr)
+        {
+            stream.current_key = canonical_cover(*stream.current);
+        }
+        if (config_.schedule != ProblemSchedule::Fifo)
+        {
+            stream.current_cost = estimate_search_cost(*stream.current);
+        }
     }
-}
-
-void DlxTcpServer::accept_solution_loop()
-{
-    while (!shutting_down_)
+    task.cover = stream.current;
+    task.cost = stream.current_cost;
+    task.priority = (header.flags & DLX_COVER_PRIORITY_MASK) >> DLX_COVER_PRIORITY_SHIFT;
+    if (result_cache_ != nullptr && task.options.engine <= DLX_SOLVE_ENGINE_DANCING_LINKS)
     {
-        int client_fd = accept(solution_listen_fd_, nullptr, nullptr);
-        if (client_fd < 0)
+        ResultKey key = make_result_key(stream.current_key, task.assumptions);
+        // A search that may stop early cannot fill an entry, but a complete entry answers it just as well.
+        task.result = restricts_search(task.options) ? result_cache_->lookup(key)
+                                                     : result_cache_->acquire(std::move(key), &task.leader);
+        // A copy of a problem in the cache, or about to be, only replays the solutions.
+        if (task.result != nullptr && !task.leader)
         {
-            if (shutting_down_)
-            {
-                break;
-            }
-            continue;
+            task.cost = task.result->state.load() == SolvedProblem::State::Complete ? task.result->records.size() : 0;
         }
+    }
 
-        auto stream = std::make_unique<SocketOutputStream>(client_fd);
-        auto client = std::make_shared<SolutionClient>(client_fd, std::move(stream));
+    {
+        std::lock_guard<std::mutex> lock(problem_queue_mutex_);
+        ProblemConnection& connection = *task.connection;
+        // A connection coming back to an idle queue starts level with the work given out so far.
+        if (connection.queued++ == 0)
         {
-            std::lock_guard<std::mutex> lock(solution_mutex_);
-            solution_clients_.push_back(client);
-            if (active_column_count_.has_value())
-            {
-                binary::DlxSolutionHeader header = {
-                    .magic = DLX_SOLUTION_MAGIC,
-                    .version = DLX_BINARY_VERSION,
-                    .flags = 0,
-                    .column_count = active_column_count_.value(),
-                };
-                client->writer = std::make_unique<binary::DlxSolutionStreamWriter>(*client->stream, header);
-            }
-            remove_disconnected_clients_locked();
+            connection.served = std::max(connection.served, fair_clock_);
         }
+        task.queued_at = std::chrono::steady_clock::now();
+        problem_queue_.push_back(std::move(task));
     }
+    // Only workers free to take this connection's frames can run it, so let every idle worker look.
+    problem_queue_cv_.notify_all();
+    return 0;
 }
 
-void DlxTcpServer::emit_solution_row(void* ctx, const uint32_t* row_ids, int level)
+/**
+ * Solver thread: links each task's cover into a private builder (skipped when the worker already holds that cover)
+ * and streams the solutions into the worker's own ring. A worker only takes frames of connections that have nothing
+ * in flight or whose frames in flight it runs, so the frames of one connection are solved and streamed in the
+ * order they arrived; a connection whose answers are all out may go to any idle worker.
+ *
+ * Problems found in the result cache are replayed from it instead. One that waits for an identical problem still
+ * being solved holds back the later frames of its connection too; the problem it waits for was queued before it,
+ * so every wait ends. Which runnable frame goes next is up to the configured @ref ProblemSchedule.
+ *
+ * Frames with solve options search under a @ref search::BoundedPolicy, and a replay honours their limit and
+ * count-only flag too. Every stream's End marker carries how the search ended; only sections of frames that sent
+ * options report it to the client.
+ *
+ * @param size_t Index of the worker and of its solution ring.
+ * @return void
+ */
+void DlxTcpServer::process_problem_queue(size_t worker)
 {
-    DlxTcpServer* server = static_cast<DlxTcpServer*>(ctx);
-    server->enqueue_solution_row(row_ids, level);
-}
+    SolutionRing& ring = *solution_rings_[worker];
+    matrix::MatrixBuilder builder;
+    std::shared_ptr<const binary::DlxCsrProblem> linked;
+    struct node* matrix = nullptr;
+    int itemCount = 0;
+    int optionCount = 0;
+    std::vector<uint32_t> row_ids;
+    RowIndex row_index;
+    bool indexed = false;
+
+    // Answers a problem that is not searched with an empty section ending in @p code.
+    auto answer_unsearched = [&](ProblemTask& task, uint32_t code) {
+        const uint32_t columnCount = task.cover->header.column_count;
+        ring.push_route(std::move(task.route));
+        ring.append(SolutionRing::kBeginMarker, &columnCount, 1);
+        ring.end_problem(binary::DlxSolveStatus{code, 0, 0});
+    };
 
-void DlxTcpServer::process_problem_queue()
-{
     while (true)
     {
         ProblemTask task;
         {
             std::unique_lock<std::mutex> lock(problem_queue_mutex_);
+            auto runnable = problem_queue_.end();
             problem_queue_cv_.wait(lock, [&]() {
-                return shutting_down_.load() || !problem_queue_.empty();
+                runnable = pick_problem_locked(worker);
+                return shutting_down_.load() || runnable != problem_queue_.end();
             });
 
-            if (problem_queue_.empty())
+            if (runnable == problem_queue_.end())
             {
-                if (shutting_down_.load())
-                {
-                    break;
-                }
-                continue;
+                break;
             }
 
-            task = std::move(problem_queue_.front());
-            problem_queue_.pop_front();
+            ProblemConnection& connection = *runnable->connection;
+            connection.worker = static_cast<int>(worker);
+            connection.in_flight++;
+            connection.queued--;
+            fair_clock_ = connection.served;
+            connection.served += std::max<uint64_t>(runnable->cost, 1);
+            const auto waited = std::chrono::steady_clock::now() - runnable->queued_at;
+            queue_waits_->record(runnable->priority,
+                                 static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(waited).count()));
+            task = std::move(*runnable);
+            problem_queue_.erase(runnable);
         }
 
-        char** solutions = NULL;
-        int itemCount = 0;
-        int optionCount = 0;
-        struct node* matrix =
-            dlx::Core::generateMatrixBinaryFromRows(task.header, task.rows, &solutions, &itemCount, &optionCount);
-        for (auto& row : task.rows)
+        // Dancing links is the only engine; asking for another still gets an (empty) answer saying so.
+        if (task.options.engine > DLX_SOLVE_ENGINE_DANCING_LINKS)
         {
-            free(row.columns);
-            row.columns = nullptr;
+            answer_unsearched(task, DLX_SOLVE_UNSUPPORTED);
+            continue;
         }
-        task.rows.clear();
 
-        if (matrix == NULL)
+        const uint64_t solution_limit = task.options.solution_limit;
+        const bool count_only = (task.options.flags & DLX_SOLVE_FLAG_COUNT_ONLY) != 0;
+        if (task.result != nullptr && !task.leader)
         {
-            continue;
+            const SolvedProblem& solved = *task.result;
+            if (solved.state.load() == SolvedProblem::State::Complete)
+            {
+                // The options cut the replay short where they would have stopped the search.
+                binary::DlxSolveStatus status = {DLX_SOLVE_COMPLETE, 0, 0};
+                ring.push_route(std::move(task.route));
+                ring.append(SolutionRing::kBeginMarker, &solved.column_count, 1);
+                for (size_t at = 0; at < solved.records.size() && status.code == DLX_SOLVE_COMPLETE;
+                     at += 1 + solved.records[at])
+                {
+                    if (!count_only)
+                    {
+                        ring.append(solved.records[at], &solved.records[at + 1], solved.records[at]);
+                    }
+                    if (++status.solutions == solution_limit)
+                    {
+                        status.code = DLX_SOLVE_LIMIT_REACHED;
+                    }
+                }
+                ring.end_problem(status);
+                continue;
+            }
+            // The solutions did not fit the cache, so this copy is searched like any other problem.
+            task.result.reset();
+        }
+
+        // Reuse frames share the cover of an earlier frame, which this worker has usually linked already.
+        if (task.cover != linked)
+        {
+            matrix = dlx::Core::generateMatrixFromCsr(*task.cover, builder, &itemCount, &optionCount);
+            linked = task.cover;
+            indexed = false;
         }
 
-        if (optionCount <= 0)
+        // A cover without rows has no solutions, and one that cannot be linked is answered as invalid; either way
+        // the client gets its section.
+        if (matrix == NULL || optionCount <= 0)
         {
-            dlx::Core::freeMemory(matrix, solutions);
+            const uint32_t code = matrix == NULL ? DLX_SOLVE_INVALID : DLX_SOLVE_COMPLETE;
+            answer_unsearched(task, code);
+            finish_cached_result(task, task.cover->header.column_count, code == DLX_SOLVE_COMPLETE);
             continue;
         }
 
+        const uint32_t columnCount = static_cast<uint32_t>(itemCount);
+        const bool report_status = task.route.report_status;
+        ring.push_route(std::move(task.route));
+        ring.append(SolutionRing::kBeginMarker, &columnCount, 1);
+
+        if (row_ids.size() < static_cast<size_t>(optionCount))
         {
-            SolutionEvent event;
-            event.type = SolutionEvent::Type::Begin;
-            event.column_count = static_cast<uint32_t>(itemCount);
-            std::lock_guard<std::mutex> lock(solution_queue_mutex_);
-            solution_queue_.push_back(std::move(event));
+            row_ids.resize(static_cast<size_t>(optionCount));
         }
-        solution_queue_cv_.notify_one();
 
-        std::vector<uint32_t> row_ids(static_cast<size_t>(optionCount));
+        // Solutions go straight from the search buffer into the ring; wider ones than DLXS can encode are dropped.
+        // A leader also records them for the cache until they outgrow what the budget can reserve.
+        std::vector<uint32_t>* recording = task.leader ? &task.result->records : nullptr;
+        bool overflowed = false;
+        auto output = search::make_callback_policy([&](const uint32_t* ids, int level) {
+            if (level > 0 && level <= UINT16_MAX)
+            {
+                ring.append(static_cast<uint32_t>(level), ids, static_cast<size_t>(level));
+                if (recording != nullptr)
+                {
+                    if (!result_cache_->reserve(*task.result, recording->size() + 1 + static_cast<size_t>(level)))
+                    {
+                        std::vector<uint32_t>().swap(*recording);
+                        recording = nullptr;
+                        overflowed = true;
+                        return;
+                    }
+                    recording->push_back(static_cast<uint32_t>(level));
+                    recording->insert(recording->end(), ids, ids + level);
+                }
+            }
+        });
 
-        SolutionOutput output;
-        output.binary_stream = nullptr;
-        output.binary_callback = &DlxTcpServer::emit_solution_row;
-        output.binary_context = this;
+        auto run = [&](auto& policy) {
+            if (task.assumptions.empty())
+            {
+                dlx::Core::search(matrix, 0, row_ids.data(), policy);
+                return;
+            }
+            if (!indexed)
+            {
+                row_index.build(matrix);
+                indexed = true;
+            }
 
-        dlx::Core::search(matrix, 0, solutions, row_ids.data(), output);
+            // Unknown row ids leave the stream empty; the terminator still closes it below.
+            dlx::Core::searchWithAssumptions(matrix, row_index, task.assumptions, row_ids.data(), policy);
+        };
 
+        // Only frames with solve options pay for the checks, and only their sections carry the status.
+        binary::DlxSolveStatus status = {DLX_SOLVE_COMPLETE, 0, 0};
+        if (report_status)
+        {
+            search::BoundedPolicy<decltype(output)> bounded{output};
+            bounded.solution_limit = solution_limit;
+            bounded.node_budget = task.options.node_budget;
+            bounded.count_only = count_only;
+            if (task.options.deadline_ms != 0)
+            {
+                bounded.deadline = task.queued_at + std::chrono::milliseconds(task.options.deadline_ms);
+            }
+            run(bounded);
+            status = binary::DlxSolveStatus{bounded.status, bounded.solutions, bounded.nodes};
+        }
+        else
         {
-            SolutionEvent event;
-            event.type = SolutionEvent::Type::End;
-            event.column_count = 0;
-            std::lock_guard<std::mutex> lock(solution_queue_mutex_);
-            solution_queue_.push_back(std::move(event));
+            run(output);
         }
-        solution_queue_cv_.notify_one();
 
-        dlx::Core::freeMemory(matrix, solutions);
+        ring.end_problem(status);
+        finish_cached_result(task, columnCount, !overflowed && status.code == DLX_SOLVE_COMPLETE);
     }
 }
 
-void DlxTcpServer::process_solution_queue()
+/**
+ * Picks the frame worker @p worker runs next: among the oldest frame of every connection that has nothing in flight
+ * or runs on it, and not waiting for an identical problem, the one @ref runs_before puts first. Frames behind a connection's
+ * oldest one are never candidates, so each connection's frames stay in order.
+ *
+ * @return The frame, or the end of the queue when the worker has nothing to run.
+ */
+std::deque<DlxTcpServer::ProblemTask>::iterator DlxTcpServer::pick_problem_locked(size_t worker)
 {
-    while (true)
+    const uint64_t scan = ++queue_scan_;
+    const auto now = std::chrono::steady_clock::now();
+    auto best = problem_queue_.end();
+    for (auto queued = problem_queue_.begin(); queued != problem_queue_.end(); ++queued)
     {
-        SolutionEvent event;
+        ProblemConnection& connection = *queued->connection;
+        if (connection.scan == scan)
         {
-            std::unique_lock<std::mutex> lock(solution_queue_mutex_);
-            solution_queue_cv_.wait(lock, [&]() {
-                return shutting_down_.load() || !solution_queue_.empty();
-            });
-
-            if (solution_queue_.empty())
-            {
-                if (shutting_down_.load())
-                {
-                    break;
-                }
-                continue;
-            }
-
-            event = std::move(solution_queue_.front());
-            solution_queue_.pop_front();
+            continue;
+        }
+        connection.scan = scan;
+        if ((connection.worker >= 0 && connection.worker != static_cast<int>(worker))
+            || (queued->result != nullptr && !queued->leader
+                && queued->result->state.load() == SolvedProblem::State::Solving))
+        {
+            continue;
+        }
+        if (best == problem_queue_.end() || runs_before(*queued, *best, now))
+        {
+            best = queued;
         }
+    }
+    return best;
+}
 
-        switch (event.type)
+/**
+ * True when @p task should run before @p other, which was queued earlier: an overdue frame first, then the higher
+ * priority, then what the schedule prefers. Ties keep arrival order.
+ */
+bool DlxTcpServer::runs_before(const ProblemTask& task,
+                               const ProblemTask& other,
+                               std::chrono::steady_clock::time_point now) const
+{
+    if (config_.schedule_max_wait_ms > 0)
+    {
+        const auto limit = std::chrono::milliseconds(config_.schedule_max_wait_ms);
+        const bool overdue = now - task.queued_at >= limit;
+        const bool other_overdue = now - other.queued_at >= limit;
+        if (overdue || other_overdue)
         {
-        case SolutionEvent::Type::Begin:
-            begin_solution_stream(event.column_count);
-            break;
-        case SolutionEvent::Type::Row:
-            broadcast_solution_row(event.row_ids.data(), static_cast<int>(event.row_ids.size()));
-            break;
-        case SolutionEvent::Type::End:
-            broadcast_problem_complete();
-            finish_solution_stream();
-            break;
+            return overdue && !other_overdue;
         }
     }
+    if (task.priority != other.priority)
+    {
+        return task.priority > other.priority;
+    }
+    switch (config_.schedule)
+    {
+    case ProblemSchedule::ShortestFirst:
+        return task.cost < other.cost;
+    case ProblemSchedule::FairShare:
+        return task.connection->served < other.connection->served;
+    default:
+        return false;
+    }
 }
 
-void DlxTcpServer::enqueue_solution_row(const uint32_t* row_ids, int level)
+/**
+ * Leader side of the result cache: completes or abandons the task's entry and wakes the workers, whose queued
+ * copies of the problem can run now. The entry changes state under problem_queue_mutex_ so no worker misses it.
+ */
+void DlxTcpServer::finish_cached_result(ProblemTask& task, uint32_t column_count, bool complete)
 {
-    if (row_ids == nullptr || level <= 0)
+    if (!task.leader)
     {
         return;
     }
 
-    SolutionEvent event;
-    event.type = SolutionEvent::Type::Row;
-    event.column_count = 0;
-    event.row_ids.assign(row_ids, row_ids + level);
+    task.result->column_count = column_count;
     {
-        std::lock_guard<std::mutex> lock(solution_queue_mutex_);
-        solution_queue_.push_back(std::move(event));
+        std::lock_guard<std::mutex> lock(problem_queue_mutex_);
+        result_cache_->finish(task.result, complete);
     }
-    solution_queue_cv_.notify_one();
+    problem_queue_cv_.notify_all();
 }
 
-void DlxTcpServer::process_problem_connection(int client_fd)
+/**
+ * Output thread: serves the solver rings round-robin. A ring is only picked up once it has published a slab (a
+ * full one, a finished problem, or a first record), so a long search that rarely finds solutions does not hold
+ * back problems finishing on other workers. Sections answered inline go to their own request connection, so the
+ * thread moves between rings at any slab boundary of those; only a broadcast section, which every subscriber
+ * reads as one contiguous stream, keeps the thread on its ring until the End marker.
+ */
+void DlxTcpServer::process_solution_queue()
 {
-    SocketInputStream cover_stream(client_fd);
-    binary::DlxProblemStreamReader reader(cover_stream);
+    OutputSignal& signal = *output_signal_;
+    const size_t rings = solution_rings_.size();
+    SolutionRing* streaming = nullptr;
+    size_t next = 0;
+
+    auto ready = [&](SolutionRing** source) -> const SolutionRing::Slab* {
+        if (streaming != nullptr)
+        {
+            *source = streaming;
+            return streaming->front();
+        }
+        for (size_t i = 0; i < rings; i++)
+        {
+            SolutionRing* ring = solution_rings_[(next + i) % rings].get();
+            if (const SolutionRing::Slab* slab = ring->front())
+            {
+                next = (next + i + 1) % rings;
+                *source = ring;
+                return slab;
+            }
+        }
+        return nullptr;
+    };
 
     while (true)
     {
-        binary::DlxCoverHeader header = {0};
-        if (reader.read_header(&header) != 0)
+        SolutionRing* source = nullptr;
+        if (const SolutionRing::Slab* slab = ready(&source))
+        {
+            drain_solution_slab(*source, slab->words, slab->used);
+            source->release_slab();
+            streaming = broadcasting_ == source ? source : nullptr;
+            continue;
+        }
+        if (shutting_down_.load())
         {
             break;
         }
+        flush_due_clients();
+        if (config_.slow_clients != SlowClientPolicy::Block)
+        {
+            drain_client_backlogs();
+        }
 
-        ProblemTask task;
-        task.header = header;
-        task.rows.reserve(header.row_count);
-
-        while (true)
+        std::unique_lock<std::mutex> lock(signal.mutex);
+        signal.consumer_waiting.store(true);
+        const bool woken = signal.data_cv.wait_for(lock, output_poll_, [&]() {
+            SolutionRing* unused = nullptr;
+            return shutting_down_.load() || ready(&unused) != nullptr;
+        });
+        signal.consumer_waiting.store(false);
+        if (!woken)
         {
-            binary::DlxRowChunk chunk = {0};
-            int status = reader.read_chunk(&chunk);
-            if (status == 0)
-            {
-                break;
-            }
-            if (status == -1)
+            // Every ring with a section out ran dry, so its next record is published on its own.
+            for (auto& ring : solution_rings_)
             {
-                close(client_fd);
-                return;
+                if (ring->section_open)
+                {
+                    ring->hungry.store(true, std::memory_order_relaxed);
+                }
             }
-
-            task.rows.push_back(chunk);
         }
+    }
+}
 
-        task.header.row_count = static_cast<uint32_t>(task.rows.size());
-
+/**
+ * Broadcasts one slab: runs of solution records go out under a single lock, markers open and close streams.
+ *
+ * @param SolutionRing& Ring the slab belongs to, which holds the routes of its problems.
+ * @param const uint32_t* Records of the slab.
+ * @param size_t Number of words used in the slab; an End marker is always the last record of its slab.
+ * @return void
+ */
+void DlxTcpServer::drain_solution_slab(SolutionRing& ring, const uint32_t* words, size_t used)
+{
+    size_t run = 0;
+    size_t position = 0;
+    while (position < used)
+    {
+        const uint32_t count = words[position];
+        if (count == SolutionRing::kBeginMarker)
+        {
+            broadcast_solution_rows(ring, words + run, position - run);
+            begin_solution_stream(ring, words[position + 1], ring.pop_route());
+            position += 2;
+            run = position;
+        }
+        else if (count == SolutionRing::kEndMarker)
         {
-            std::lock_guard<std::mutex> lock(problem_queue_mutex_);
-            problem_queue_.push_back(std::move(task));
+            broadcast_solution_rows(ring, words + run, position - run);
+            broadcast_problem_complete(ring, SolutionRing::end_status(words + position + 1));
+            finish_solution_stream(ring);
+            return;
+        }
+        else
+        {
+            position += static_cast<size_t>(count) + 1;
         }
-        problem_queue_cv_.notify_one();
     }
-
-    close(client_fd);
+    broadcast_solution_rows(ring, words + run, used - run);
 }
 
-void DlxTcpServer::begin_solution_stream(uint32_t column_count)
+/**
+ * Opens the DLXS section of a problem on the request connection that asked for an inline answer, or else on
+ * every subscriber whose subscriptions match the route. Tagged problems carry their id in the section header.
+ */
+void DlxTcpServer::begin_solution_stream(SolutionRing& ring, uint32_t column_count, SolutionRoute route)
 {
     std::lock_guard<std::mutex> lock(solution_mutex_);
-    active_column_count_ = column_count;
-    binary::DlxSolutionHeader header = {
-        .magic = DLX_SOLUTION_MAGIC,
-        .version = DLX_BINARY_VERSION,
-        .flags = 0,
-        .column_count = column_count,
-    };
+    ring.section_columns = column_count;
+    ring.section = std::move(route);
+    ring.section_open = true;
+    if (ring.section.reply != nullptr)
+    {
+        start_solution_section_locked(*ring.section.reply, ring.section, column_count);
+        return;
+    }
+
+    broadcasting_ = &ring;
     for (auto& client : solution_clients_)
     {
         if (client == nullptr)
         {
             continue;
         }
-        if (client->writer)
+        client->streaming = false;
+        if (client->wants(ring.section) && !start_solution_section_locked(*client, ring.section, column_count))
         {
-            client->writer->start(header);
-        }
-        else
-        {
-            client->writer = std::make_unique<binary::DlxSolutionStreamWriter>(*client->stream, header);
+            release_failed_client_locked(client);
         }
     }
     remove_disconnected_clients_locked();
 }
 
-void DlxTcpServer::finish_solution_stream()
+/**
+ * Writes the header of the section of @p route to @p client.
+ *
+ * @return bool False when the header could not be written; the client then sits the problem out.
+ */
+bool DlxTcpServer::start_solution_section_locked(SolutionClient& client, const SolutionRoute& route, uint32_t column_count)
 {
-    std::lock_guard<std::mutex> lock(solution_mutex_);
-    active_column_count_.reset();
+    binary::DlxSolutionHeader header = {
+        .magic = DLX_SOLUTION_MAGIC,
+        .version = DLX_SOLUTION_VERSION,
+        .flags = static_cast<uint16_t>(route.report_status ? DLX_SOLUTION_FLAG_STATUS : 0),
+        .column_count = column_count,
+    };
+    if (client.writer == nullptr)
+    {
+        client.writer = std::make_unique<binary::DlxSolutionStreamWriter>(*client.stream);
+    }
+    const int status = route.tagged ? client.writer->start(header, route.problem_id) : client.writer->start(header);
+    client.streaming = (status == 0);
+    client.unflushed = client.streaming;
+    client.unflushed_since = std::chrono::steady_clock::now();
+    client.stream->buffer().set_more(client.flush.cork);
+    return client.streaming;
+}
+
+/**
+ * Closes the section open on @p ring and, once the last section of its connection is out, frees the
+ * connection's later frames to run on any worker.
+ */
+void DlxTcpServer::finish_solution_stream(SolutionRing& ring)
+{
+    std::shared_ptr<ProblemConnection> connection;
+    {
+        std::lock_guard<std::mutex> lock(solution_mutex_);
+        connection = std::move(ring.section.connection);
+        ring.section = SolutionRoute();
+        ring.section_open = false;
+        if (broadcasting_ == &ring)
+        {
+            broadcasting_ = nullptr;
+        }
+    }
+    if (connection == nullptr)
+    {
+        return;
+    }
+
+    bool released = false;
+    {
+        std::lock_guard<std::mutex> lock(problem_queue_mutex_);
+        if (connection->in_flight > 0 && --connection->in_flight == 0)
+        {
+            connection->worker = -1;
+            released = connection->queued > 0;
+        }
+    }
+    if (released)
+    {
+        problem_queue_cv_.notify_all();
+    }
 }
 
-void DlxTcpServer::broadcast_solution_row(const uint32_t* row_ids, int level)
+void DlxTcpServer::broadcast_solution_rows(SolutionRing& ring, const uint32_t* records, size_t words)
 {
-    if (row_ids == nullptr || level <= 0)
+    if (words == 0)
     {
         return;
     }
 
+    const auto now = std::chrono::steady_clock::now();
+    auto write_rows = [&](SolutionClient& client) {
+        for (size_t position = 0; position < words; position += records[position] + 1)
+        {
+            if (client.writer->write_row(records + position + 1, static_cast<uint16_t>(records[position])) != 0)
+            {
+                return false;
+            }
+        }
+        return apply_flush_policy_locked(client, now);
+    };
+
     std::lock_guard<std::mutex> lock(solution_mutex_);
+    if (ring.section.reply != nullptr)
+    {
+        // A request connection that stopped reading only loses the rest of its own answers.
+        SolutionClient& reply = *ring.section.reply;
+        if (reply.streaming && !write_rows(reply))
+        {
+            reply.streaming = false;
+        }
+        return;
+    }
+
     for (auto& client : solution_clients_)
     {
-        if (client == nullptr || client->writer == nullptr)
+        if (client == nullptr || !client->streaming)
         {
             continue;
         }
-
-        if (client->writer->write_row(row_ids, static_cast<uint16_t>(level)) != 0)
+        if (!write_rows(*client))
         {
-            client.reset();
+            release_failed_client_locked(client);
         }
     }
     remove_disconnected_clients_locked();
+#if defined(DLX_HAVE_IO_URING)
+    // Everything the clients queued goes to the kernel together; the output thread does not wait for it.
+    if (subscriber_sends_ != nullptr)
+    {
+        subscriber_sends_->queue.poll();
+    }
+#endif
 }
 
-void DlxTcpServer::broadcast_problem_complete()
+void DlxTcpServer::broadcast_problem_complete(SolutionRing& ring, const binary::DlxSolveStatus& status)
 {
     std::lock_guard<std::mutex> lock(solution_mutex_);
+    if (ring.section.reply != nullptr)
+    {
+        SolutionClient& reply = *ring.section.reply;
+        reply.stream->buffer().set_more(false);
+        if (reply.streaming && reply.writer->finish(status) == 0)
+        {
+            reply.stream->flush();
+        }
+        reply.streaming = false;
+        reply.unflushed = false;
+
+        // Whatever a slow request connection has not taken yet is sent from the output thread's idle loop.
+        if (reply.stream->buffer().backlog_bytes() > 0
+            && std::find(lagging_replies_.begin(), lagging_replies_.end(), ring.section.reply) == lagging_replies_.end())
+        {
+            lagging_replies_.push_back(ring.section.reply);
+        }
+        return;
+    }
+
     for (auto& client : solution_clients_)
     {
-        if (client == nullptr || client->writer == nullptr)
+        if (client == nullptr || !client->streaming)
         {
             continue;
         }
 
-        if (client->writer->finish() != 0)
+        // The terminator goes out uncorked, together with whatever the section still held back.
+        client->streaming = false;
+        client->unflushed = false;
+        client->stream->buffer().set_more(false);
+        if (client->writer->finish(status) != 0)
         {
-            client.reset();
+            release_failed_client_locked(client);
         }
         else
         {
             client->stream->flush();
         }
     }
+#if defined(DLX_HAVE_IO_URING)
+    // A problem's stream is only complete once its terminator left, as with blocking sends.
+    if (subscriber_sends_ != nullptr)
+    {
+        subscriber_sends_->queue.drain();
+    }
+#endif
     remove_disconnected_clients_locked();
 }
 
@@ -646,6 +3051,7 @@ void DlxTcpServer::remove_disconnected_clients_locked()
                        solution_clients_.end(),
                        [](const std::shared_ptr<SolutionClient>& client) { return client == nullptr; }),
         solution_clients_.end());
+    subscriber_count_.store(solution_clients_.size());
 }
 
 } // namespace dlx
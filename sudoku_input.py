@@ -36,6 +36,11 @@ DLXS_ENTRY_COUNT_BYTES = 2
 DLXS_ROW_HEADER_SIZE = DLXS_SOLUTION_ID_BYTES + DLXS_ENTRY_COUNT_BYTES
 DLXS_ROW_VALUE_BYTES = 4
 
+DLXS_VERSION_COMPACT = 2
+DLXS_FLAG_PROBLEM_INDEX = 0x0100
+DLXS_FLAG_EXPLICIT_IDS = 0x0400
+DLXS_PROBLEM_INDEX_BYTES = 4
+
 
 def start_server():
     platform_args = ["--platform", DLX_PLATFORM] if DLX_PLATFORM else []
@@ -119,11 +124,34 @@ def read_dlxs_frame(solution_sock: socket.socket) -> bytes:
             raise RuntimeError(f"Incomplete DLXS stream (got {len(chunks)} of {size} bytes)")
         return bytes(chunks)
 
+    def read_varint() -> int:
+        value = 0
+        shift = 0
+        while True:
+            byte = read_exact(1)
+            frame.extend(byte)
+            value |= (byte[0] & 0x7F) << shift
+            if byte[0] & 0x80 == 0:
+                return value
+            shift += 7
+
     frame = bytearray()
     header = read_exact(DLXS_HEADER_SIZE)
     if header[:DLXS_MAGIC_BYTES] != b"DLXS":
         raise RuntimeError("Invalid DLXS magic")
     frame.extend(header)
+    version, flags = struct.unpack("!HH", header[DLXS_MAGIC_BYTES:DLXS_MAGIC_BYTES + 4])
+    if flags & DLXS_FLAG_PROBLEM_INDEX:
+        frame.extend(read_exact(DLXS_PROBLEM_INDEX_BYTES))
+
+    # Version 2 records: tag (0 ends the section), optional id delta, suffix count, suffix rows.
+    while version >= DLXS_VERSION_COMPACT:
+        if read_varint() == 0:
+            return bytes(frame)
+        if flags & DLXS_FLAG_EXPLICIT_IDS:
+            read_varint()
+        for _ in range(read_varint()):
+            read_varint()
 
     while True:
         row_header = read_exact(DLXS_ROW_HEADER_SIZE)
@@ -23,6 +23,9 @@ struct PerformanceTestConfig
     uint32_t network_target_solution_rate = 1000;
     std::string network_problem_file = "tests/sudoku_example/sudoku_cover.txt";
     std::string network_report_path = "tests/performance/dlx_network_throughput.csv";
+    uint32_t network_backend_problems = 500;
+    std::string network_backend_report_path = "tests/performance/dlx_network_backends.csv";
+    std::string network_local_report_path = "tests/performance/dlx_network_local.csv";
     std::string source_path = "tests/config/performance_config.yaml";
     bool config_loaded = false;
     std::vector<SearchPerformanceCase> search_cases = {
@@ -44,13 +44,18 @@ inline std::vector<uint8_t> AsciiCoverToBytes(const std::string& ascii)
     return std::vector<uint8_t>(payload.begin(), payload.end());
 }
 
-inline int ConnectToPort(uint16_t port)
+// Connects to a loopback port; a positive @p receive_buffer caps SO_RCVBUF before the window is negotiated.
+inline int ConnectToPort(uint16_t port, int receive_buffer = 0)
 {
     int fd = socket(AF_INET, SOCK_STREAM, 0);
     if (fd < 0)
     {
         return fd;
     }
+    if (receive_buffer > 0)
+    {
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &receive_buffer, sizeof(receive_buffer));
+    }
 
     sockaddr_in addr;
     std::memset(&addr, 0, sizeof(addr));
@@ -139,6 +139,9 @@ PerformanceTestConfig load_config()
     assign_positive_uint(network_node, "target_solution_rate", config.network_target_solution_rate);
     assign_string(network_node, "problem_file", config.network_problem_file);
     assign_string(network_node, "report_path", config.network_report_path);
+    assign_positive_uint(network_node, "backend_problems", config.network_backend_problems);
+    assign_string(network_node, "backend_report_path", config.network_backend_report_path);
+    assign_string(network_node, "local_report_path", config.network_local_report_path);
 
     return config;
 }
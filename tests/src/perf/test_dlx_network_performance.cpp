@@ -1,5 +1,6 @@
 #include "core/tcp_server.h"
 #include "core/binary.h"
+#include "core/local_client.h"
 #include "performance_test_config.h"
 #include "tcp_test_utils.h"
 #include <algorithm>
@@ -8,6 +9,7 @@
 #include <condition_variable>
 #include <cmath>
 #include <fstream>
+#include <iostream>
 #include <filesystem>
 #include <gtest/gtest.h>
 #include <iomanip>
@@ -18,6 +20,7 @@
 #include <system_error>
 #include <string>
 #include <thread>
+#include <unistd.h>
 #include <vector>
 
 namespace binary = dlx::binary;
@@ -32,6 +35,8 @@ protected:
     void SetUp() override
     {
         dlx::TcpServerConfig config{0, 0};
+        // Every problem is the same cover; the cache would replay it instead of measuring the solvers.
+        config.result_cache_bytes = 0;
         server_ = std::make_unique<dlx::DlxTcpServer>(config);
         if (!server_->start())
         {
@@ -507,4 +512,287 @@ TEST_F(DlxTcpNetworkPerformanceTest, MeasuresEndToEndThroughput)
     report.close();
 }
 
+// Streams the same batch of problems through each socket backend and reports how long every subscriber took to
+// receive every solution stream. Producers send their problems back to back over one connection each, so the
+// run stresses framing, broadcast and send batching rather than connection setup.
+TEST(DlxTcpNetworkBackendTest, ComparesEpollAndIoUring)
+{
+    const PerformanceTestConfig& config = GetPerformanceTestConfig();
+    if (!config.network_performance_enabled)
+    {
+        GTEST_SKIP() << "Network performance tests disabled. Provide "
+                     << config.source_path
+                     << " with tests.network_performance.enabled: true and related parameters to run.";
+    }
+
+    std::vector<uint8_t> payload = AsciiCoverToBytes(ReadFileToString(config.network_problem_file));
+    ASSERT_FALSE(payload.empty()) << "Unable to read ASCII cover from " << config.network_problem_file;
+
+    const uint32_t producers = std::max<uint32_t>(1, config.network_request_clients);
+    const uint32_t subscribers = std::max<uint32_t>(1, config.network_solution_clients);
+    const uint32_t per_producer = std::max<uint32_t>(1, config.network_backend_problems);
+    const uint64_t total_problems = static_cast<uint64_t>(producers) * per_producer;
+
+    std::vector<uint8_t> batch;
+    batch.reserve(payload.size() * per_producer);
+    for (uint32_t i = 0; i < per_producer; i++)
+    {
+        batch.insert(batch.end(), payload.begin(), payload.end());
+    }
+
+    struct BackendResult
+    {
+        std::string name;
+        double seconds;
+    };
+    std::vector<BackendResult> results;
+
+    for (bool io_uring : {false, true})
+    {
+        dlx::TcpServerConfig server_config{0, 0};
+        server_config.io_uring = io_uring;
+        server_config.result_cache_bytes = 0;
+        // Only blocking subscribers send through the io_uring slot queue, which is what is being compared.
+        server_config.slow_clients = dlx::SlowClientPolicy::Block;
+        dlx::DlxTcpServer server(server_config);
+        if (!server.start())
+        {
+            GTEST_SKIP() << "Unable to bind TCP server sockets in this environment";
+        }
+        if (io_uring && !server.uses_io_uring())
+        {
+            server.stop();
+            server.wait();
+            break; // Not built in, or refused by this kernel: only epoll is measured.
+        }
+
+        std::vector<int> subscriber_fds;
+        for (uint32_t i = 0; i < subscribers; i++)
+        {
+            int fd = ConnectToPort(server.solution_port());
+            ASSERT_GE(fd, 0);
+            subscriber_fds.push_back(fd);
+        }
+        // Give the reactors a moment to register every subscriber before the first problem is solved.
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        std::atomic<uint64_t> incomplete{0};
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> readers;
+        for (int fd : subscriber_fds)
+        {
+            readers.emplace_back([&, fd]() {
+                DescriptorInputStream stream(fd);
+                for (uint64_t i = 0; i < total_problems; i++)
+                {
+                    if (ReadProblemSolution(stream).empty())
+                    {
+                        incomplete.fetch_add(1);
+                        return;
+                    }
+                }
+            });
+        }
+        std::vector<std::thread> writers;
+        for (uint32_t i = 0; i < producers; i++)
+        {
+            writers.emplace_back([&]() { SendProblem(server.request_port(), batch); });
+        }
+        for (auto& writer : writers)
+        {
+            writer.join();
+        }
+        for (auto& reader : readers)
+        {
+            reader.join();
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        for (int fd : subscriber_fds)
+        {
+            close(fd);
+        }
+        server.stop();
+        server.wait();
+
+        EXPECT_EQ(incomplete.load(), 0u) << (io_uring ? "io_uring" : "epoll") << " lost solution streams";
+        results.push_back({io_uring ? "io_uring" : "epoll", seconds});
+    }
+
+    std::filesystem::path report_path(config.network_backend_report_path);
+    if (!report_path.parent_path().empty())
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(report_path.parent_path(), ec);
+    }
+    std::ofstream report(config.network_backend_report_path, std::ios::out | std::ios::trunc);
+    ASSERT_TRUE(report.is_open()) << "Unable to open report path " << config.network_backend_report_path;
+    report << "Backend,Problems,Subscribers,Seconds,Problems Per Second\n";
+    for (const BackendResult& result : results)
+    {
+        report << result.name << ',' << total_problems << ',' << subscribers << ',' << std::fixed
+               << std::setprecision(3) << result.seconds << ',' << std::setprecision(1)
+               << (result.seconds > 0 ? static_cast<double>(total_problems) / result.seconds : 0.0) << '\n';
+        std::cout << result.name << ": " << total_problems << " problems to " << subscribers << " subscribers in "
+                  << result.seconds << " s" << std::endl;
+    }
+}
+
+// Asks for an inline answer: sets DLX_COVER_FLAG_REPLY_INLINE in the big-endian flags at bytes 6-7 of the header.
+std::vector<uint8_t> InlineFrame(std::vector<uint8_t> frame)
+{
+    frame[6] = static_cast<uint8_t>(frame[6] | (DLX_COVER_FLAG_REPLY_INLINE >> 8));
+    return frame;
+}
+
+// Cover with 2^columns solutions: every column has two interchangeable single-column rows.
+std::vector<uint8_t> DoublingCover(uint32_t columns)
+{
+    binary::DlxCoverHeader header = {
+        .magic = DLX_COVER_MAGIC,
+        .version = DLX_BINARY_VERSION,
+        .flags = 0,
+        .column_count = columns,
+        .row_count = columns * 2,
+    };
+    std::ostringstream cover;
+    {
+        binary::DlxProblemStreamWriter writer(cover, header);
+        for (uint32_t column = 0; column < columns; column++)
+        {
+            writer.write_row(column * 2 + 1, &column, 1);
+            writer.write_row(column * 2 + 2, &column, 1);
+        }
+        writer.finish();
+    }
+    const std::string bytes = cover.str();
+    return std::vector<uint8_t>(bytes.begin(), bytes.end());
+}
+
+// Compares a client on the same host answered inline over loopback TCP with one using the Unix domain socket and
+// a shared segment: the mean round trip of small problems sent one at a time, and the rate at which one large
+// answer streams back.
+TEST(DlxTcpNetworkLocalTest, ComparesLoopbackTcpAndSharedMemory)
+{
+    const PerformanceTestConfig& config = GetPerformanceTestConfig();
+    if (!config.network_performance_enabled)
+    {
+        GTEST_SKIP() << "Network performance tests disabled. Provide "
+                     << config.source_path
+                     << " with tests.network_performance.enabled: true and related parameters to run.";
+    }
+
+    std::vector<uint8_t> payload = AsciiCoverToBytes(ReadFileToString(config.network_problem_file));
+    ASSERT_FALSE(payload.empty()) << "Unable to read ASCII cover from " << config.network_problem_file;
+    const std::vector<uint8_t> small = InlineFrame(payload);
+    constexpr uint32_t kLargeColumns = 20;
+    const std::vector<uint8_t> large = InlineFrame(DoublingCover(kLargeColumns));
+    const uint32_t round_trips = std::max<uint32_t>(1, config.network_backend_problems);
+
+    dlx::TcpServerConfig server_config{0, 0};
+    server_config.local_socket_path = "/tmp/dlx_perf_" + std::to_string(getpid()) + ".sock";
+    server_config.result_cache_bytes = 0;
+    dlx::DlxTcpServer server(server_config);
+    if (!server.start())
+    {
+        GTEST_SKIP() << "Unable to bind server sockets in this environment";
+    }
+
+    struct TransportResult
+    {
+        std::string name;
+        double round_trip_micros;
+        double stream_seconds;
+        uint64_t stream_rows;
+    };
+    std::vector<TransportResult> results;
+    using Clock = std::chrono::steady_clock;
+
+    {
+        int fd = ConnectToPort(server.request_port());
+        ASSERT_GE(fd, 0);
+        DescriptorInputStream answers(fd);
+        auto exchange = [&](const std::vector<uint8_t>& frame) -> uint64_t {
+            size_t offset = 0;
+            while (offset < frame.size())
+            {
+                const ssize_t written = send(fd, frame.data() + offset, frame.size() - offset, 0);
+                if (written <= 0)
+                {
+                    return 0;
+                }
+                offset += static_cast<size_t>(written);
+            }
+            binary::DlxSolution section;
+            return binary::dlx_read_solution(answers, &section) == 0 ? section.rows.size() : 0;
+        };
+
+        const auto start = Clock::now();
+        for (uint32_t i = 0; i < round_trips; i++)
+        {
+            ASSERT_EQ(exchange(small), 1u);
+        }
+        const auto middle = Clock::now();
+        const uint64_t rows = exchange(large);
+        const auto end = Clock::now();
+        close(fd);
+        results.push_back({"tcp loopback",
+                           std::chrono::duration<double, std::micro>(middle - start).count() / round_trips,
+                           std::chrono::duration<double>(end - middle).count(),
+                           rows});
+    }
+
+    {
+        dlx::DlxLocalClient client;
+        ASSERT_EQ(client.connect(server.local_socket_path()), 0);
+        auto exchange = [&](const std::vector<uint8_t>& frame) -> uint64_t {
+            client.problem().write(reinterpret_cast<const char*>(frame.data()), static_cast<std::streamsize>(frame.size()));
+            binary::DlxSolution section;
+            return client.submit() == 0 && binary::dlx_read_solution(client.solutions(), &section) == 0
+                       ? section.rows.size()
+                       : 0;
+        };
+
+        const auto start = Clock::now();
+        for (uint32_t i = 0; i < round_trips; i++)
+        {
+            ASSERT_EQ(exchange(small), 1u);
+        }
+        const auto middle = Clock::now();
+        const uint64_t rows = exchange(large);
+        const auto end = Clock::now();
+        client.close();
+        results.push_back({"shared memory",
+                           std::chrono::duration<double, std::micro>(middle - start).count() / round_trips,
+                           std::chrono::duration<double>(end - middle).count(),
+                           rows});
+    }
+    server.stop();
+    server.wait();
+
+    for (const TransportResult& result : results)
+    {
+        EXPECT_EQ(result.stream_rows, 1ull << kLargeColumns) << result.name << " lost solutions";
+    }
+
+    std::filesystem::path report_path(config.network_local_report_path);
+    if (!report_path.parent_path().empty())
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(report_path.parent_path(), ec);
+    }
+    std::ofstream report(config.network_local_report_path, std::ios::out | std::ios::trunc);
+    ASSERT_TRUE(report.is_open()) << "Unable to open report path " << config.network_local_report_path;
+    report << "Transport,Round Trips,Mean Round Trip (us),Streamed Solutions,Stream Seconds,Solutions Per Second\n";
+    for (const TransportResult& result : results)
+    {
+        const double rate = result.stream_seconds > 0 ? static_cast<double>(result.stream_rows) / result.stream_seconds : 0.0;
+        report << result.name << ',' << round_trips << ',' << std::fixed << std::setprecision(1)
+               << result.round_trip_micros << ',' << result.stream_rows << ',' << std::setprecision(3)
+               << result.stream_seconds << ',' << std::setprecision(0) << rate << '\n';
+        std::cout << result.name << ": " << result.round_trip_micros << " us per round trip, " << result.stream_rows
+                  << " solutions in " << result.stream_seconds << " s" << std::endl;
+    }
+}
+
 } // namespace
@@ -1,11 +1,20 @@
 #include "core/dlx.h"
+#include "core/batch.h"
 #include "core/binary.h"
+#include "core/block_codec.h"
+#include "core/matrix.h"
+#include "core/search.h"
+#include "core/snapshot.h"
 #include "sudoku/encoder/encoder.h"
 #include "ascii_binary_utils.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <fstream>
+#include <map>
 #include <gtest/gtest.h>
 #include <sstream>
 #include <string>
@@ -153,10 +162,11 @@ TEST(DlxBinaryTest, SolutionRoundTrip)
     std::ofstream file(file_template, std::ios::binary);
     ASSERT_TRUE(file.is_open());
 
+    // Version 1 sections store ids verbatim; compact sections are covered by CompactSolutionsShareRowPrefixes.
     binary::DlxSolution solution;
     solution.header = {
         .magic = DLX_SOLUTION_MAGIC,
-        .version = DLX_BINARY_VERSION,
+        .version = 1,
         .flags = 0,
         .column_count = 10,
     };
@@ -180,7 +190,7 @@ TEST(DlxBinaryTest, SolutionRoundTrip)
     binary::DlxSolution read_solution;
     ASSERT_EQ(binary::dlx_read_solution(solution_stream, &read_solution), 0);
     EXPECT_EQ(read_solution.header.magic, DLX_SOLUTION_MAGIC);
-    EXPECT_EQ(read_solution.header.version, DLX_BINARY_VERSION);
+    EXPECT_EQ(read_solution.header.version, 1);
     EXPECT_EQ(read_solution.header.flags, 0);
     EXPECT_EQ(read_solution.header.column_count, 10u);
     ASSERT_EQ(read_solution.rows.size(), 1u);
@@ -194,6 +204,92 @@ TEST(DlxBinaryTest, SolutionRoundTrip)
     remove(file_template);
 }
 
+TEST(DlxBinaryTest, CompactSolutionsShareRowPrefixes)
+{
+    // Consecutive DFS solutions: a long shared prefix, then a short tail in search (unsorted) order.
+    std::vector<std::vector<uint32_t>> solutions;
+    for (uint32_t i = 0; i < 200; i++)
+    {
+        std::vector<uint32_t> rows = {900, 40, 1200, 7 + i / 10};
+        rows.push_back(5000 - i);
+        rows.push_back(3 * i);
+        solutions.push_back(rows);
+    }
+
+    auto encode = [&](uint16_t version, uint16_t flags) {
+        std::ostringstream output;
+        binary::DlxSolutionStreamWriter writer(output, {DLX_SOLUTION_MAGIC, version, flags, 6000});
+        for (const auto& rows : solutions)
+        {
+            EXPECT_EQ(writer.write_row(rows.data(), static_cast<uint16_t>(rows.size())), 0);
+        }
+        EXPECT_EQ(writer.finish(), 0);
+        return output.str();
+    };
+
+    const std::string v1 = encode(1, 0);
+    const std::string compact = encode(DLX_SOLUTION_VERSION_COMPACT, 0);
+    const std::string sorted = encode(DLX_SOLUTION_VERSION_COMPACT, DLX_SOLUTION_FLAG_SORTED_ROWS);
+    EXPECT_LT(compact.size() * 4, v1.size());
+    EXPECT_LT(sorted.size() * 2, v1.size());
+
+    // Every encoding decodes to the same ids; only the sorted one reorders rows.
+    for (const std::string* encoded : {&v1, &compact, &sorted})
+    {
+        std::istringstream input(*encoded);
+        binary::DlxSolutionStreamReader reader(input);
+        binary::DlxSolutionHeader header = {0};
+        ASSERT_EQ(reader.read_header(&header), 0);
+        uint64_t solution_id = 0;
+        std::vector<uint32_t> rows;
+        for (size_t i = 0; i < solutions.size(); i++)
+        {
+            ASSERT_EQ(reader.read_row(&solution_id, &rows), 1);
+            EXPECT_EQ(solution_id, i + 1);
+            std::vector<uint32_t> expected = solutions[i];
+            if ((header.flags & DLX_SOLUTION_FLAG_SORTED_ROWS) != 0)
+            {
+                std::sort(expected.begin(), expected.end());
+            }
+            EXPECT_EQ(rows, expected);
+        }
+        EXPECT_EQ(reader.read_row(&solution_id, &rows), 0);
+    }
+
+    // Ids beyond 32 bits survive version 2 as explicit ids and are refused by version 1.
+    binary::DlxSolution wide;
+    wide.header = {DLX_SOLUTION_MAGIC, DLX_SOLUTION_VERSION_COMPACT, 0, 6000};
+    for (uint64_t id : {uint64_t{1} << 40, (uint64_t{1} << 40) + 3, uint64_t{2}})
+    {
+        binary::DlxSolutionRow row = {0};
+        row.solution_id = id;
+        row.entry_count = 2;
+        row.capacity = 2;
+        row.row_indices = static_cast<uint32_t*>(malloc(sizeof(uint32_t) * 2));
+        ASSERT_NE(row.row_indices, nullptr);
+        row.row_indices[0] = 11;
+        row.row_indices[1] = static_cast<uint32_t>(id % 1000);
+        wide.rows.push_back(row);
+    }
+    std::stringstream wide_stream;
+    ASSERT_EQ(binary::dlx_write_solution(wide_stream, &wide), 0);
+
+    binary::DlxSolution read_wide;
+    ASSERT_EQ(binary::dlx_read_solution(wide_stream, &read_wide), 0);
+    EXPECT_NE(read_wide.header.flags & DLX_SOLUTION_FLAG_EXPLICIT_IDS, 0);
+    ASSERT_EQ(read_wide.rows.size(), wide.rows.size());
+    for (size_t i = 0; i < wide.rows.size(); i++)
+    {
+        EXPECT_EQ(read_wide.rows[i].solution_id, wide.rows[i].solution_id);
+        ASSERT_EQ(read_wide.rows[i].entry_count, 2);
+        EXPECT_EQ(read_wide.rows[i].row_indices[1], wide.rows[i].row_indices[1]);
+    }
+
+    wide.header.version = 1;
+    std::ostringstream refused;
+    EXPECT_EQ(binary::dlx_write_solution(refused, &wide), -1);
+}
+
 TEST(DlxBinaryTest, DlxSolvesFromBinaryCoverAndEmitsBinarySolutions)
 {
     char cover_template[] = "tests/tmp_binary_coverXXXXXX";
@@ -234,7 +330,7 @@ TEST(DlxBinaryTest, DlxSolvesFromBinaryCoverAndEmitsBinarySolutions)
     binary::DlxSolution solution;
     ASSERT_EQ(binary::dlx_read_solution(binary_stream, &solution), 0);
     EXPECT_EQ(solution.header.magic, DLX_SOLUTION_MAGIC);
-    EXPECT_EQ(solution.header.version, DLX_BINARY_VERSION);
+    EXPECT_EQ(solution.header.version, DLX_SOLUTION_VERSION);
     EXPECT_EQ(solution.header.column_count, static_cast<uint32_t>(itemCount));
     ASSERT_EQ(solution.rows.size(), 1u);
 
@@ -290,4 +386,1170 @@ TEST(DlxBinaryTest, AsciiCoverProducesBinarySolutionMatchingExpectedRows)
     dlx::Core::freeMemory(matrix, solutions);
 }
 
+void collect_solution_rows(void* ctx, const uint32_t* row_ids, int level)
+{
+    auto* rows = static_cast<std::vector<std::vector<uint32_t>>*>(ctx);
+    rows->emplace_back(row_ids, row_ids + level);
+}
+
+void push_row(binary::DlxProblem& problem, uint32_t row_id, std::vector<uint32_t> columns)
+{
+    binary::DlxRowChunk chunk = {0};
+    chunk.row_id = row_id;
+    chunk.entry_count = static_cast<uint16_t>(columns.size());
+    chunk.capacity = chunk.entry_count;
+    chunk.columns = static_cast<uint32_t*>(malloc(sizeof(uint32_t) * columns.size()));
+    memcpy(chunk.columns, columns.data(), sizeof(uint32_t) * columns.size());
+    problem.rows.push_back(chunk);
+}
+
+// Four columns with three solutions: {1,2}, {3,4} and {2,5,6}.
+void build_assumption_problem(binary::DlxProblem& problem)
+{
+    problem.header = {
+        .magic = DLX_COVER_MAGIC,
+        .version = DLX_BINARY_VERSION,
+        .flags = 0,
+        .column_count = 4,
+        .row_count = 6,
+    };
+    push_row(problem, 1, {0, 1});
+    push_row(problem, 2, {2, 3});
+    push_row(problem, 3, {0, 2});
+    push_row(problem, 4, {1, 3});
+    push_row(problem, 5, {0});
+    push_row(problem, 6, {1});
+}
+
+TEST(DlxBinaryTest, AssumptionBlockRoundTrip)
+{
+    binary::DlxProblem problem;
+    build_assumption_problem(problem);
+    problem.assumptions.forced_rows = {2};
+    problem.assumptions.forbidden_rows = {1, 4};
+
+    std::ostringstream output;
+    ASSERT_EQ(binary::dlx_write_problem(output, &problem), 0);
+
+    std::istringstream input(output.str());
+    binary::DlxProblem read_problem;
+    ASSERT_EQ(binary::dlx_read_problem(input, &read_problem), 0);
+    EXPECT_NE(read_problem.header.flags & DLX_COVER_FLAG_ASSUMPTIONS, 0);
+    EXPECT_EQ(read_problem.rows.size(), 6u);
+    EXPECT_EQ(read_problem.assumptions.forced_rows, (std::vector<uint32_t>{2}));
+    EXPECT_EQ(read_problem.assumptions.forbidden_rows, (std::vector<uint32_t>{1, 4}));
+}
+
+TEST(DlxBinaryTest, SearchWithAssumptionsRestoresMatrix)
+{
+    binary::DlxProblem problem;
+    build_assumption_problem(problem);
+
+    char** solutions = NULL;
+    int itemCount = 0;
+    int optionCount = 0;
+    struct node* matrix = dlx::Core::generateMatrixBinary(problem, &solutions, &itemCount, &optionCount);
+    ASSERT_NE(matrix, nullptr);
+
+    dlx::RowIndex index;
+    ASSERT_EQ(index.build(matrix), 0);
+    EXPECT_EQ(index.size(), 6u);
+
+    std::vector<uint32_t> row_ids(static_cast<size_t>(optionCount));
+    auto solve = [&](const dlx::SearchAssumptions& assumptions, int* status) {
+        std::vector<std::vector<uint32_t>> found;
+        dlx::SolutionOutput output;
+        output.binary_callback = &collect_solution_rows;
+        output.binary_context = &found;
+        dlx::Core::dlx_set_stdout_suppressed(true);
+        *status = dlx::Core::searchWithAssumptions(matrix, index, assumptions, solutions, row_ids.data(), output);
+        dlx::Core::dlx_set_stdout_suppressed(false);
+        return found;
+    };
+
+    int status = 0;
+    EXPECT_EQ(solve({}, &status).size(), 3u);
+    EXPECT_EQ(status, 0);
+
+    dlx::SearchAssumptions forced_and_forbidden;
+    forced_and_forbidden.forced_rows = {2};
+    forced_and_forbidden.forbidden_rows = {1};
+    auto constrained = solve(forced_and_forbidden, &status);
+    EXPECT_EQ(status, 0);
+    ASSERT_EQ(constrained.size(), 1u);
+    EXPECT_EQ(constrained[0], (std::vector<uint32_t>{2, 5, 6}));
+
+    dlx::SearchAssumptions conflicting;
+    conflicting.forced_rows = {1, 3};
+    EXPECT_TRUE(solve(conflicting, &status).empty());
+    EXPECT_EQ(status, 0);
+
+    dlx::SearchAssumptions unknown;
+    unknown.forbidden_rows = {42};
+    EXPECT_TRUE(solve(unknown, &status).empty());
+    EXPECT_EQ(status, -1);
+
+    // Every query above must leave the matrix exactly as it was built.
+    EXPECT_EQ(solve({}, &status).size(), 3u);
+
+    dlx::Core::freeMemory(matrix, solutions);
+}
+
+TEST(DlxBinaryTest, SearchPoliciesMatchSolutionOutput)
+{
+    binary::DlxProblem problem;
+    build_assumption_problem(problem);
+
+    char** solutions = NULL;
+    int itemCount = 0;
+    int optionCount = 0;
+    struct node* matrix = dlx::Core::generateMatrixBinary(problem, &solutions, &itemCount, &optionCount);
+    ASSERT_NE(matrix, nullptr);
+    std::vector<uint32_t> row_ids(static_cast<size_t>(optionCount));
+
+    // Reference: the SolutionOutput path, writing DLXS and collecting row ids through the callback.
+    std::vector<std::vector<uint32_t>> expected;
+    std::ostringstream expected_dlxs;
+    {
+        dlx::SolutionOutput output;
+        output.binary_callback = &collect_solution_rows;
+        output.binary_context = &expected;
+        ASSERT_EQ(dlx::Core::dlx_enable_binary_solution_output(output, expected_dlxs, 4), 0);
+        dlx::Core::dlx_set_stdout_suppressed(true);
+        dlx::Core::search(matrix, 0, solutions, row_ids.data(), output);
+        dlx::Core::dlx_set_stdout_suppressed(false);
+        dlx::Core::dlx_disable_binary_solution_output(output);
+    }
+    ASSERT_EQ(expected.size(), 3u);
+
+    dlx::search::CountPolicy counter;
+    dlx::Core::search(matrix, 0, row_ids.data(), counter);
+    EXPECT_EQ(counter.solutions, 3u);
+
+    dlx::search::CollectPolicy collector;
+    dlx::Core::search(matrix, 0, row_ids.data(), collector);
+    ASSERT_EQ(collector.lengths.size(), expected.size());
+    size_t offset = 0;
+    for (size_t i = 0; i < expected.size(); i++)
+    {
+        std::vector<uint32_t> rows(collector.row_ids.begin() + offset,
+                                   collector.row_ids.begin() + offset + collector.lengths[i]);
+        EXPECT_EQ(rows, expected[i]);
+        offset += collector.lengths[i];
+    }
+
+    std::ostringstream policy_dlxs;
+    {
+        binary::DlxSolutionStreamWriter writer(policy_dlxs, {DLX_SOLUTION_MAGIC, DLX_SOLUTION_VERSION, 0, 4});
+        dlx::search::DlxsWriterPolicy dlxs(writer);
+        dlx::Core::search(matrix, 0, row_ids.data(), dlxs);
+        EXPECT_EQ(dlxs.status, 0);
+        ASSERT_EQ(writer.finish(), 0);
+    }
+    EXPECT_EQ(policy_dlxs.str(), expected_dlxs.str());
+
+    // Lambdas see forced rows first, exactly like the SolutionOutput overload.
+    dlx::RowIndex index;
+    ASSERT_EQ(index.build(matrix), 0);
+    dlx::SearchAssumptions forced;
+    forced.forced_rows = {2};
+    std::vector<std::vector<uint32_t>> constrained;
+    auto lambda = dlx::search::make_callback_policy([&](const uint32_t* ids, int level) {
+        constrained.emplace_back(ids, ids + level);
+    });
+    ASSERT_EQ(dlx::Core::searchWithAssumptions(matrix, index, forced, row_ids.data(), lambda), 0);
+    ASSERT_EQ(constrained.size(), 2u);
+    EXPECT_EQ(constrained[0].front(), 2u);
+    EXPECT_EQ(constrained[1].front(), 2u);
+
+    counter.solutions = 0;
+    dlx::Core::search(matrix, 0, row_ids.data(), counter);
+    EXPECT_EQ(counter.solutions, 3u);
+
+    dlx::Core::freeMemory(matrix, solutions);
+}
+
+TEST(DlxBinaryTest, MatrixBuilderGrowsAndMatchesStreamedCover)
+{
+    binary::DlxProblem problem;
+    build_assumption_problem(problem);
+
+    // Zero hints force every row through the geometric growth and pointer rebasing path.
+    dlx::matrix::MatrixBuilder builder;
+    ASSERT_EQ(builder.begin(problem.header.column_count, 0, 0), 0);
+    for (auto& row : problem.rows)
+    {
+        ASSERT_EQ(builder.append_row(row.row_id, row.columns, row.entry_count), 0);
+    }
+    int builtNodes = builder.node_count();
+
+    char** solutions = NULL;
+    int itemCount = 0;
+    int optionCount = 0;
+    struct node* matrix = builder.finish(&solutions, &itemCount, &optionCount);
+    ASSERT_NE(matrix, nullptr);
+    EXPECT_EQ(itemCount, 4);
+    EXPECT_EQ(optionCount, 6);
+
+    std::ostringstream cover;
+    ASSERT_EQ(binary::dlx_write_problem(cover, &problem), 0);
+    std::istringstream cover_input(cover.str());
+    char** streamed_solutions = NULL;
+    int streamedItems = 0;
+    int streamedOptions = 0;
+    struct node* streamed = binary::dlx_read_binary(cover_input, &streamed_solutions, &streamedItems, &streamedOptions);
+    ASSERT_NE(streamed, nullptr);
+    EXPECT_EQ(streamedOptions, optionCount);
+
+    std::ostringstream built_dump;
+    std::ostringstream streamed_dump;
+    dlx::matrix::dumpMatrixStructure(matrix, builtNodes, itemCount, built_dump);
+    dlx::matrix::dumpMatrixStructure(streamed, builtNodes, streamedItems, streamed_dump);
+    EXPECT_EQ(built_dump.str(), streamed_dump.str());
+
+    std::vector<std::vector<uint32_t>> found;
+    std::vector<uint32_t> row_ids(static_cast<size_t>(optionCount));
+    dlx::SolutionOutput output;
+    output.binary_callback = &collect_solution_rows;
+    output.binary_context = &found;
+    dlx::Core::dlx_set_stdout_suppressed(true);
+    dlx::Core::search(matrix, 0, solutions, row_ids.data(), output);
+    dlx::Core::dlx_set_stdout_suppressed(false);
+    EXPECT_EQ(found.size(), 3u);
+
+    dlx::Core::freeMemory(streamed, streamed_solutions);
+    dlx::Core::freeMemory(matrix, solutions);
+}
+
+TEST(DlxBinaryTest, MatrixBuilderRejectsOutOfRangeColumns)
+{
+    dlx::matrix::MatrixBuilder builder;
+    EXPECT_EQ(builder.begin(0, 0, 0), -1);
+    ASSERT_EQ(builder.begin(3, 1, 2), 0);
+
+    uint32_t duplicate[] = {2, 0, 2};
+    EXPECT_EQ(builder.append_row(1, duplicate, 3), 0);
+    EXPECT_EQ(builder.node_count(), 4 + 2 + 1);
+
+    uint32_t out_of_range[] = {3};
+    EXPECT_EQ(builder.append_row(2, out_of_range, 1), -1);
+}
+
+TEST(DlxBinaryTest, SnapshotRoundTripMapsLinkedMatrix)
+{
+    binary::DlxProblem problem;
+    build_assumption_problem(problem);
+
+    char** solutions = NULL;
+    int itemCount = 0;
+    int optionCount = 0;
+    struct node* matrix = dlx::Core::generateMatrixBinary(problem, &solutions, &itemCount, &optionCount);
+    ASSERT_NE(matrix, nullptr);
+    size_t nodeCount = dlx::matrix::countMatrixNodes(matrix, itemCount, optionCount);
+
+    char snapshot_template[] = "tests/tmp_snapshotXXXXXX";
+    int snapshot_fd = mkstemp(snapshot_template);
+    ASSERT_NE(snapshot_fd, -1);
+    close(snapshot_fd);
+    {
+        std::ofstream snapshot_file(snapshot_template, std::ios::binary | std::ios::trunc);
+        ASSERT_EQ(dlx::snapshot::write_snapshot(snapshot_file, matrix, itemCount, optionCount), 0);
+    }
+    EXPECT_TRUE(dlx::snapshot::is_snapshot_file(snapshot_template));
+
+    std::ostringstream expected_dump;
+    dlx::matrix::dumpMatrixStructure(matrix, static_cast<int>(nodeCount), itemCount, expected_dump);
+
+    // The second mapping cannot share the first one's address, so at least one load exercises the rebase path.
+    dlx::snapshot::MatrixSnapshot first;
+    dlx::snapshot::MatrixSnapshot second;
+    ASSERT_EQ(first.load(snapshot_template), 0);
+    ASSERT_EQ(second.load(snapshot_template), 0);
+    EXPECT_TRUE(first.relocated() || second.relocated());
+
+    for (dlx::snapshot::MatrixSnapshot* snapshot : {&first, &second})
+    {
+        EXPECT_EQ(snapshot->item_count(), itemCount);
+        EXPECT_EQ(snapshot->option_count(), optionCount);
+        EXPECT_EQ(snapshot->node_count(), nodeCount);
+
+        std::ostringstream dump;
+        dlx::matrix::dumpMatrixStructure(snapshot->matrix(), static_cast<int>(nodeCount), itemCount, dump);
+        EXPECT_EQ(dump.str(), expected_dump.str());
+
+        std::vector<std::vector<uint32_t>> found;
+        std::vector<uint32_t> row_ids(static_cast<size_t>(optionCount));
+        dlx::SolutionOutput output;
+        output.binary_callback = &collect_solution_rows;
+        output.binary_context = &found;
+        dlx::Core::dlx_set_stdout_suppressed(true);
+        dlx::Core::search(snapshot->matrix(), 0, snapshot->solutions(), row_ids.data(), output);
+        dlx::Core::dlx_set_stdout_suppressed(false);
+        EXPECT_EQ(found.size(), 3u);
+    }
+    first.reset();
+    second.reset();
+
+    // A link past the last node, or between two nodes, must be refused before any search follows it.
+    // Verification catches it wherever the image lands; an unverified load only checks while rebasing.
+    dlx::snapshot::DlxSnapshotHeader header = {0};
+    {
+        std::ifstream snapshot_file(snapshot_template, std::ios::binary);
+        ASSERT_TRUE(snapshot_file.read(reinterpret_cast<char*>(&header), sizeof(header)));
+    }
+    const std::streamoff down_link = DLX_SNAPSHOT_NODE_OFFSET + sizeof(struct node) + offsetof(struct node, down);
+    for (uint64_t corrupt : {header.base_address + (nodeCount + 1) * sizeof(struct node),
+                             header.base_address + sizeof(struct node) / 2,
+                             header.base_address - sizeof(struct node)})
+    {
+        {
+            std::fstream snapshot_file(snapshot_template, std::ios::binary | std::ios::in | std::ios::out);
+            snapshot_file.seekp(down_link);
+            const uintptr_t link = static_cast<uintptr_t>(corrupt);
+            ASSERT_TRUE(snapshot_file.write(reinterpret_cast<const char*>(&link), sizeof(link)));
+        }
+        dlx::snapshot::MatrixSnapshot corrupted;
+        EXPECT_EQ(corrupted.load(snapshot_template, true), -1);
+        EXPECT_EQ(corrupted.matrix(), nullptr);
+
+        // Only an unverified mapping at the base is trusted; one that holds the base forces the next to be
+        // rebased, which checks the links regardless.
+        dlx::snapshot::MatrixSnapshot at_base;
+        if (at_base.load(snapshot_template) == 0)
+        {
+            EXPECT_FALSE(at_base.relocated());
+            dlx::snapshot::MatrixSnapshot rebased;
+            EXPECT_EQ(rebased.load(snapshot_template), -1);
+            EXPECT_EQ(rebased.matrix(), nullptr);
+        }
+    }
+
+    unlink(snapshot_template);
+    dlx::Core::freeMemory(matrix, solutions);
+}
+
+TEST(DlxBinaryTest, CsrProblemRoundTripsAndLinks)
+{
+    binary::DlxProblem problem;
+    build_assumption_problem(problem);
+    problem.assumptions.forbidden_rows = {1};
+
+    std::ostringstream cover;
+    ASSERT_EQ(binary::dlx_write_problem(cover, &problem), 0);
+
+    std::istringstream cover_input(cover.str());
+    binary::DlxCsrProblem csr;
+    ASSERT_EQ(binary::dlx_read_problem(cover_input, &csr), 0);
+    ASSERT_EQ(csr.row_count(), 6u);
+    EXPECT_EQ(csr.entry_count(), 10u);
+    EXPECT_EQ(csr.assumptions.forbidden_rows, (std::vector<uint32_t>{1}));
+    EXPECT_EQ(csr.row_id(2), 3u);
+    ASSERT_EQ(csr.row_size(2), 2u);
+    EXPECT_EQ(csr.row_columns(2)[0], 0u);
+    EXPECT_EQ(csr.row_columns(2)[1], 2u);
+
+    // Writing the CSR form back must reproduce the chunk-based encoding byte for byte.
+    std::ostringstream rewritten;
+    ASSERT_EQ(binary::dlx_write_problem(rewritten, &csr), 0);
+    EXPECT_EQ(rewritten.str(), cover.str());
+
+    binary::DlxRowChunk view = csr.row_chunk(3);
+    EXPECT_EQ(view.row_id, 4u);
+    EXPECT_EQ(view.entry_count, 2u);
+    EXPECT_EQ(view.capacity, 0u);
+
+    binary::DlxProblem adapted;
+    ASSERT_EQ(csr.to_problem(&adapted), 0);
+    ASSERT_EQ(adapted.rows.size(), problem.rows.size());
+    for (size_t i = 0; i < adapted.rows.size(); i++)
+    {
+        EXPECT_EQ(adapted.rows[i].row_id, problem.rows[i].row_id);
+        ASSERT_EQ(adapted.rows[i].entry_count, problem.rows[i].entry_count);
+        EXPECT_EQ(0, memcmp(adapted.rows[i].columns, problem.rows[i].columns, sizeof(uint32_t) * problem.rows[i].entry_count));
+    }
+
+    // Converting back from chunks and moving the result must keep every row intact.
+    binary::DlxCsrProblem grown;
+    ASSERT_EQ(grown.assign(adapted), 0);
+    binary::DlxCsrProblem moved(std::move(grown));
+    EXPECT_EQ(grown.row_count(), 0u);
+    ASSERT_EQ(moved.row_count(), 6u);
+
+    char** solutions = NULL;
+    int itemCount = 0;
+    int optionCount = 0;
+    struct node* matrix = dlx::Core::generateMatrixFromCsr(moved, &solutions, &itemCount, &optionCount);
+    ASSERT_NE(matrix, nullptr);
+    EXPECT_EQ(itemCount, 4);
+    EXPECT_EQ(optionCount, 6);
+
+    std::vector<std::vector<uint32_t>> found;
+    std::vector<uint32_t> row_ids(static_cast<size_t>(optionCount));
+    dlx::SolutionOutput output;
+    output.binary_callback = &collect_solution_rows;
+    output.binary_context = &found;
+    dlx::Core::dlx_set_stdout_suppressed(true);
+    dlx::Core::search(matrix, 0, solutions, row_ids.data(), output);
+    dlx::Core::dlx_set_stdout_suppressed(false);
+    EXPECT_EQ(found.size(), 3u);
+
+    dlx::Core::freeMemory(matrix, solutions);
+}
+
+TEST(DlxBinaryTest, BlockReaderSpansMatchEncodedRows)
+{
+    // Rows of every length from 0 to 40 exercise both the SIMD body and the scalar tail of the byteswap,
+    // at odd block sizes that split rows and columns across refills. The rows are parsed by hand below, so the
+    // cover uses the fixed-width version 1 layout.
+    binary::DlxProblem problem;
+    problem.header = {
+        .magic = DLX_COVER_MAGIC,
+        .version = 1,
+        .flags = 0,
+        .column_count = 64,
+        .row_count = 41,
+    };
+    for (uint32_t length = 0; length <= 40; length++)
+    {
+        std::vector<uint32_t> columns;
+        for (uint32_t i = 0; i < length; i++)
+        {
+            columns.push_back((i * 7 + length) % 64 | (i << 24));
+        }
+        push_row(problem, length + 1, columns);
+    }
+    problem.assumptions.forced_rows = {3};
+
+    std::ostringstream cover;
+    ASSERT_EQ(binary::dlx_write_problem(cover, &problem), 0);
+    const std::string bytes = cover.str() + cover.str();
+
+    for (size_t block_size : {size_t(0), size_t(5), size_t(64), size_t(DLX_BLOCK_SIZE)})
+    {
+        std::istringstream input(bytes);
+        binary::DlxBlockReader reader(input, block_size);
+        for (int copy = 0; copy < 2; copy++)
+        {
+            const char* header = reader.take(sizeof(binary::DlxCoverHeader));
+            ASSERT_NE(header, nullptr);
+            const uint32_t* counts = reader.take_u32_array(2);
+            ASSERT_NE(counts, nullptr);
+            EXPECT_EQ(counts[0], 1u);
+            EXPECT_EQ(counts[1], 0u);
+            ASSERT_NE(reader.take_u32_array(1), nullptr);
+
+            for (const auto& row : problem.rows)
+            {
+                const uint32_t* row_id = reader.take_u32_array(1);
+                ASSERT_NE(row_id, nullptr);
+                EXPECT_EQ(*row_id, row.row_id);
+                ASSERT_NE(reader.take(sizeof(uint16_t)), nullptr);
+                const uint32_t* columns = reader.take_u32_array(row.entry_count);
+                ASSERT_NE(columns, nullptr);
+                EXPECT_EQ(reinterpret_cast<uintptr_t>(columns) % alignof(uint32_t), 0u);
+                EXPECT_EQ(0, memcmp(columns, row.columns, sizeof(uint32_t) * row.entry_count)) << "block " << block_size;
+            }
+        }
+        EXPECT_TRUE(reader.at_end());
+    }
+
+    // Stream reader spans and the aggregate reader agree, and the aggregate reader leaves the stream at the
+    // start of the next problem despite reading ahead.
+    std::istringstream spans_input(bytes);
+    binary::DlxProblemStreamReader stream_reader(spans_input);
+    binary::DlxCoverHeader header = {0};
+    ASSERT_EQ(stream_reader.read_header(&header), 0);
+    binary::DlxRowSpan span = {0};
+    for (const auto& row : problem.rows)
+    {
+        ASSERT_EQ(stream_reader.read_row(&span), 1);
+        EXPECT_EQ(span.row_id, row.row_id);
+        ASSERT_EQ(span.entry_count, row.entry_count);
+        EXPECT_EQ(0, memcmp(span.columns, row.columns, sizeof(uint32_t) * row.entry_count));
+    }
+    EXPECT_EQ(stream_reader.read_row(&span), 0);
+    EXPECT_FALSE(stream_reader.at_end());
+
+    std::istringstream aggregate_input(bytes);
+    for (int copy = 0; copy < 2; copy++)
+    {
+        binary::DlxCsrProblem csr;
+        ASSERT_EQ(binary::dlx_read_problem(aggregate_input, &csr), 0);
+        ASSERT_EQ(csr.row_count(), problem.rows.size());
+        EXPECT_EQ(csr.assumptions.forced_rows, (std::vector<uint32_t>{3}));
+        EXPECT_EQ(0, memcmp(csr.row_columns(40), problem.rows[40].columns, sizeof(uint32_t) * 40));
+    }
+    EXPECT_EQ(aggregate_input.peek(), std::char_traits<char>::eof());
+}
+
+TEST(DlxBinaryTest, CompressedCoverSpansBlocksAndDecodesInParallel)
+{
+    // Enough sudoku-shaped rows to fill several blocks; ids step backwards now and then and columns arrive
+    // unsorted, which version 2 stores sorted.
+    binary::DlxProblem problem;
+    problem.header = {
+        .magic = DLX_COVER_MAGIC,
+        .version = DLX_BINARY_VERSION,
+        .flags = 0,
+        .column_count = 324,
+        .row_count = 0,
+    };
+    for (uint32_t row = 0; row < 30000; row++)
+    {
+        const uint32_t cell = row % 81;
+        const uint32_t digit = (row / 81) % 9;
+        push_row(problem, (row % 1000 == 999) ? row / 2 : row + 1,
+                 {243 + (cell % 9) * 9 + digit, cell, 81 + (cell / 9) * 9 + digit, 162 + (cell % 9) * 9 + digit});
+    }
+    push_row(problem, UINT32_MAX, {});
+    problem.assumptions.forbidden_rows = {7};
+
+    std::ostringstream compressed;
+    ASSERT_EQ(binary::dlx_write_problem(compressed, &problem), 0);
+    ASSERT_EQ(binary::dlx_write_problem(compressed, &problem), 0);
+
+    auto expect_rows = [&](const binary::DlxCsrProblem& csr) {
+        ASSERT_EQ(csr.row_count(), problem.rows.size());
+        EXPECT_EQ(csr.assumptions.forbidden_rows, (std::vector<uint32_t>{7}));
+        for (size_t i = 0; i < problem.rows.size(); i++)
+        {
+            std::vector<uint32_t> sorted(problem.rows[i].columns, problem.rows[i].columns + problem.rows[i].entry_count);
+            std::sort(sorted.begin(), sorted.end());
+            ASSERT_EQ(csr.row_id(i), problem.rows[i].row_id) << "row " << i;
+            ASSERT_EQ(std::vector<uint32_t>(csr.row_columns(i), csr.row_columns(i) + csr.row_size(i)), sorted) << "row " << i;
+        }
+    };
+
+    // Sequential readers find the end of each problem from its terminator, even with two back to back.
+    std::istringstream input(compressed.str());
+    for (int copy = 0; copy < 2; copy++)
+    {
+        binary::DlxCsrProblem csr;
+        ASSERT_EQ(binary::dlx_read_problem(input, &csr), 0);
+        expect_rows(csr);
+    }
+    EXPECT_EQ(input.peek(), std::char_traits<char>::eof());
+
+    std::istringstream stream_input(compressed.str());
+    binary::DlxProblemStreamReader reader(stream_input);
+    binary::DlxCoverHeader header = {0};
+    ASSERT_EQ(reader.read_header(&header), 0);
+    binary::DlxRowSpan span = {0};
+    size_t rows = 0;
+    while (reader.read_row(&span) == 1)
+    {
+        rows++;
+    }
+    EXPECT_EQ(rows, problem.rows.size());
+    EXPECT_FALSE(reader.at_end());
+
+    // The block index lets one buffered problem be decoded on several threads.
+    const std::string single = compressed.str().substr(0, compressed.str().size() / 2);
+    for (unsigned int workers : {1u, 4u})
+    {
+        binary::DlxCsrProblem csr;
+        ASSERT_EQ(binary::dlx_decode_problem(single.data(), single.size(), &csr, workers), 0);
+        expect_rows(csr);
+    }
+    binary::DlxCsrProblem rejected;
+    EXPECT_EQ(binary::dlx_decode_problem(single.data(), single.size() - 1, &rejected, 2), -1);
+    std::istringstream truncated(single.substr(0, single.size() / 2));
+    EXPECT_EQ(binary::dlx_read_problem(truncated, &rejected), -1);
+
+    // Version 1 remains readable and is at least three times larger for covers like this.
+    problem.header.version = 1;
+    std::ostringstream version_one;
+    ASSERT_EQ(binary::dlx_write_problem(version_one, &problem), 0);
+    EXPECT_GE(version_one.str().size(), 3 * single.size());
+
+    std::istringstream convert_input(version_one.str());
+    std::ostringstream converted;
+    ASSERT_EQ(binary::dlx_convert_problems(convert_input, converted, false, DLX_BINARY_VERSION), 0);
+    EXPECT_EQ(converted.str(), single);
+}
+
+/**
+ * Stream buffer over a string that behaves like a pipe or std::cin: it cannot seek and reports nothing
+ * available ahead of time, so readsome() would return nothing. Counts the reads that reach it.
+ */
+class OneWayStreamBuf : public std::streambuf
+{
+public:
+    explicit OneWayStreamBuf(const std::string& data) : data_(data) {}
+
+    size_t reads = 0;
+
+protected:
+    int_type underflow() override
+    {
+        if (position_ == data_.size())
+        {
+            return traits_type::eof();
+        }
+        current_ = data_[position_++];
+        setg(&current_, &current_, &current_ + 1);
+        return traits_type::to_int_type(current_);
+    }
+
+    std::streamsize xsgetn(char* destination, std::streamsize count) override
+    {
+        reads++;
+        std::streamsize copied = 0;
+        if (gptr() < egptr() && count > 0)
+        {
+            *destination++ = *gptr();
+            gbump(1);
+            copied++;
+        }
+        const size_t taken = std::min(data_.size() - position_, static_cast<size_t>(count - copied));
+        memcpy(destination, data_.data() + position_, taken);
+        position_ += taken;
+        return copied + static_cast<std::streamsize>(taken);
+    }
+
+private:
+    const std::string& data_;
+    size_t position_ = 0;
+    char current_ = 0;
+};
+
+TEST(DlxBinaryTest, BlockReaderBatchesNonSeekableStreams)
+{
+    binary::DlxProblem problem;
+    problem.header = {
+        .magic = DLX_COVER_MAGIC,
+        .version = DLX_BINARY_VERSION,
+        .flags = 0,
+        .column_count = 324,
+        .row_count = 0,
+    };
+    for (uint32_t row = 0; row < 100000; row++)
+    {
+        const uint32_t cell = row % 81;
+        const uint32_t digit = (row / 81) % 9;
+        push_row(problem, row + 1, {cell, 81 + (cell / 9) * 9 + digit, 162 + (cell % 9) * 9 + digit});
+    }
+    std::ostringstream cover;
+    ASSERT_EQ(binary::dlx_write_problem(cover, &problem), 0);
+    const std::string tail = "next frame";
+    const std::string encoded = cover.str() + tail;
+
+    OneWayStreamBuf pipe(encoded);
+    std::istream input(&pipe);
+    ASSERT_EQ(input.rdbuf()->pubseekoff(0, std::ios::cur, std::ios::in), std::streampos(std::streamoff(-1)));
+    binary::DlxProblemStreamReader reader(input);
+    binary::DlxCoverHeader header = {0};
+    ASSERT_EQ(reader.read_header(&header), 0);
+    binary::DlxRowSpan span = {0};
+    size_t rows = 0;
+    while (reader.read_row(&span) == 1)
+    {
+        ASSERT_EQ(span.row_id, problem.rows[rows].row_id);
+        ASSERT_EQ(span.entry_count, problem.rows[rows].entry_count);
+        rows++;
+    }
+    EXPECT_EQ(rows, problem.rows.size());
+
+    // Each block arrives in one read together with the next block's header, and nothing past the frame is read.
+    const size_t blocks = encoded.size() / DLX_COVER_BLOCK_BYTES + 1;
+    EXPECT_GE(blocks, 4u);
+    EXPECT_LE(pipe.reads, blocks + 3) << blocks << " blocks";
+    std::string rest(tail.size(), '\0');
+    ASSERT_TRUE(input.read(&rest[0], static_cast<std::streamsize>(rest.size())));
+    EXPECT_EQ(rest, tail);
+}
+
+TEST(DlxBinaryTest, NativeCoverConvertsAndMapsInPlace)
+{
+    binary::DlxProblem problem;
+    build_assumption_problem(problem);
+
+    // Two problems, the second with an assumption block, so the converter has to frame each one.
+    std::ostringstream portable;
+    ASSERT_EQ(binary::dlx_write_problem(portable, &problem), 0);
+    problem.assumptions.forbidden_rows = {1};
+    ASSERT_EQ(binary::dlx_write_problem(portable, &problem), 0);
+
+    std::istringstream portable_input(portable.str());
+    std::ostringstream native;
+    ASSERT_EQ(binary::dlx_convert_problems(portable_input, native, true), 0);
+
+    // The stream reader decodes native problems like portable ones, and converting back is lossless.
+    std::istringstream native_input(native.str());
+    binary::DlxCsrProblem csr;
+    ASSERT_EQ(binary::dlx_read_problem(native_input, &csr), 0);
+    EXPECT_NE(csr.header.flags & DLX_COVER_FLAG_NATIVE_ENDIAN, 0);
+    EXPECT_EQ(csr.row_count(), 6u);
+    EXPECT_EQ(csr.entry_count(), 10u);
+
+    std::istringstream reconvert_input(native.str());
+    std::ostringstream reconverted;
+    ASSERT_EQ(binary::dlx_convert_problems(reconvert_input, reconverted, false), 0);
+    EXPECT_EQ(reconverted.str(), portable.str());
+
+    char native_template[] = "tests/tmp_nativeXXXXXX";
+    int native_fd = mkstemp(native_template);
+    ASSERT_NE(native_fd, -1);
+    close(native_fd);
+    {
+        std::ofstream native_file(native_template, std::ios::binary | std::ios::trunc);
+        native_file << native.str();
+    }
+    EXPECT_TRUE(binary::dlx_is_native_problem_file(native_template));
+
+    binary::DlxMappedProblemReader mapped;
+    ASSERT_EQ(mapped.open(native_template), 0);
+
+    binary::DlxCoverHeader header = {0};
+    ASSERT_EQ(mapped.read_header(&header), 0);
+    EXPECT_TRUE(mapped.assumptions().empty());
+
+    char** solutions = NULL;
+    int itemCount = 0;
+    int optionCount = 0;
+    struct node* matrix = dlx::Core::generateMatrixFromStream(mapped, header, &solutions, &itemCount, &optionCount);
+    ASSERT_NE(matrix, nullptr);
+    EXPECT_EQ(itemCount, 4);
+    EXPECT_EQ(optionCount, 6);
+
+    std::vector<std::vector<uint32_t>> found;
+    std::vector<uint32_t> row_ids(static_cast<size_t>(optionCount));
+    dlx::SolutionOutput output;
+    output.binary_callback = &collect_solution_rows;
+    output.binary_context = &found;
+    dlx::Core::dlx_set_stdout_suppressed(true);
+    dlx::Core::search(matrix, 0, solutions, row_ids.data(), output);
+    dlx::Core::dlx_set_stdout_suppressed(false);
+    EXPECT_EQ(found.size(), 3u);
+    dlx::Core::freeMemory(matrix, solutions);
+
+    // Spans of the second problem are views into the mapping itself, not copies.
+    ASSERT_FALSE(mapped.at_end());
+    ASSERT_EQ(mapped.read_header(&header), 0);
+    EXPECT_EQ(mapped.assumptions().forbidden_rows, (std::vector<uint32_t>{1}));
+    binary::DlxRowSpan span = {0};
+    size_t rows = 0;
+    int status;
+    while ((status = mapped.read_row(&span)) == 1)
+    {
+        EXPECT_EQ(span.row_id, problem.rows[rows].row_id);
+        ASSERT_EQ(span.entry_count, problem.rows[rows].entry_count);
+        EXPECT_EQ(0, memcmp(span.columns, problem.rows[rows].columns, sizeof(uint32_t) * span.entry_count));
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(span.columns) % alignof(uint32_t), 0u);
+        rows++;
+    }
+    EXPECT_EQ(status, 0);
+    EXPECT_EQ(rows, 6u);
+    EXPECT_TRUE(mapped.at_end());
+
+    // Portable files are refused so callers fall back to the stream reader.
+    std::ofstream(native_template, std::ios::binary | std::ios::trunc) << portable.str();
+    EXPECT_FALSE(binary::dlx_is_native_problem_file(native_template));
+    ASSERT_EQ(mapped.open(native_template), 0);
+    EXPECT_EQ(mapped.read_header(&header), -1);
+
+    mapped.close();
+    unlink(native_template);
+}
+
+TEST(DlxBinaryTest, FrameScannerFindsFrameBoundariesOneByteAtATime)
+{
+    binary::DlxProblem problem;
+    build_assumption_problem(problem);
+
+    // A compressed problem with an assumption block, its native form, and an unframed version 1 problem
+    // whose rows run to the end of the stream.
+    std::vector<std::string> frames;
+    std::ostringstream compressed;
+    problem.assumptions.forced_rows = {2};
+    ASSERT_EQ(binary::dlx_write_problem(compressed, &problem), 0);
+    frames.push_back(compressed.str());
+
+    std::istringstream compressed_input(frames[0]);
+    std::ostringstream native;
+    ASSERT_EQ(binary::dlx_convert_problems(compressed_input, native, true), 0);
+    frames.push_back(native.str());
+
+    std::ostringstream unframed;
+    problem.assumptions = dlx::SearchAssumptions();
+    problem.header.version = 1;
+    ASSERT_EQ(binary::dlx_write_problem(unframed, &problem), 0);
+    frames.push_back(unframed.str());
+    frames.back().replace(12, 4, 4, '\0'); // The writer fills in the row count; clear it.
+
+    std::string stream;
+    for (const std::string& frame : frames)
+    {
+        stream += frame;
+    }
+
+    binary::DlxFrameScanner scanner;
+    EXPECT_TRUE(scanner.idle());
+    size_t begin = 0;
+    std::vector<size_t> found;
+    for (size_t end = 1; end <= stream.size(); end++)
+    {
+        size_t frame_bytes = 0;
+        const int status = scanner.scan(stream.data() + begin, end - begin, &frame_bytes);
+        ASSERT_GE(status, 0) << "at byte " << end;
+        if (status == 1)
+        {
+            found.push_back(frame_bytes);
+            begin += frame_bytes;
+            EXPECT_TRUE(scanner.idle());
+        }
+    }
+
+    ASSERT_EQ(found.size(), 2u);
+    EXPECT_EQ(found[0], frames[0].size());
+    EXPECT_EQ(found[1], frames[1].size());
+    EXPECT_TRUE(scanner.needs_eof());
+    EXPECT_EQ(stream.size() - begin, frames[2].size());
+
+    // Anything that does not start with the cover magic is rejected as soon as the header is in.
+    scanner.reset();
+    const std::string garbage(16, 'x');
+    size_t frame_bytes = 0;
+    EXPECT_EQ(scanner.scan(garbage.data(), garbage.size(), &frame_bytes), -1);
+}
+
+TEST(DlxBinaryTest, VersionsNewerThanTheLibraryAreRejected)
+{
+    binary::DlxProblem problem;
+    build_assumption_problem(problem);
+    std::ostringstream cover;
+    ASSERT_EQ(binary::dlx_write_problem(cover, &problem), 0);
+
+    // Both headers carry their big-endian version right after the magic.
+    auto with_version = [](std::string bytes, uint16_t version) {
+        bytes[4] = static_cast<char>(version >> 8);
+        bytes[5] = static_cast<char>(version & 0xFF);
+        return bytes;
+    };
+
+    const std::string newer_cover = with_version(cover.str(), DLX_BINARY_VERSION + 1);
+    std::istringstream newer_input(newer_cover);
+    binary::DlxCsrProblem csr;
+    EXPECT_EQ(binary::dlx_read_problem(newer_input, &csr), -1);
+    EXPECT_EQ(binary::dlx_decode_problem(newer_cover.data(), newer_cover.size(), &csr, 1), -1);
+    binary::DlxFrameScanner scanner;
+    size_t frame_bytes = 0;
+    EXPECT_EQ(scanner.scan(newer_cover.data(), newer_cover.size(), &frame_bytes), -1);
+
+    problem.header.version = DLX_BINARY_VERSION + 1;
+    std::ostringstream refused_cover;
+    EXPECT_EQ(binary::dlx_write_problem(refused_cover, &problem), -1);
+
+    std::ostringstream section;
+    {
+        binary::DlxSolutionStreamWriter writer(section, {DLX_SOLUTION_MAGIC, DLX_SOLUTION_VERSION, 0, 4});
+        const uint32_t rows[] = {1, 3};
+        ASSERT_EQ(writer.write_row(rows, 2), 0);
+        ASSERT_EQ(writer.finish(), 0);
+    }
+    std::istringstream current_input(section.str());
+    binary::DlxSolution current;
+    ASSERT_EQ(binary::dlx_read_solution(current_input, &current), 0);
+    EXPECT_EQ(current.header.version, DLX_SOLUTION_VERSION);
+
+    std::istringstream newer_section(with_version(section.str(), DLX_SOLUTION_VERSION + 1));
+    binary::DlxSolution newer;
+    EXPECT_EQ(binary::dlx_read_solution(newer_section, &newer), -1);
+
+    current.header.version = DLX_SOLUTION_VERSION + 1;
+    std::ostringstream refused_section;
+    EXPECT_EQ(binary::dlx_write_solution(refused_section, &current), -1);
+}
+
+TEST(DlxBinaryTest, ProblemIdTravelsWithEveryEncoding)
+{
+    binary::DlxProblem problem;
+    build_assumption_problem(problem);
+    problem.header.flags |= DLX_COVER_FLAG_PROBLEM_ID;
+    problem.problem_id = 0xC0FFEE01u;
+    problem.assumptions.forced_rows = {2};
+
+    std::ostringstream compressed;
+    ASSERT_EQ(binary::dlx_write_problem(compressed, &problem), 0);
+    const std::string compressed_bytes = compressed.str();
+
+    std::istringstream chunk_input(compressed_bytes);
+    binary::DlxProblem read_problem;
+    ASSERT_EQ(binary::dlx_read_problem(chunk_input, &read_problem), 0);
+    EXPECT_EQ(read_problem.problem_id, problem.problem_id);
+    EXPECT_EQ(read_problem.assumptions.forced_rows, (std::vector<uint32_t>{2}));
+    EXPECT_EQ(read_problem.rows.size(), 6u);
+
+    binary::DlxCsrProblem decoded;
+    ASSERT_EQ(binary::dlx_decode_problem(compressed_bytes.data(), compressed_bytes.size(), &decoded, 2), 0);
+    EXPECT_EQ(decoded.problem_id, problem.problem_id);
+    EXPECT_EQ(decoded.row_count(), 6u);
+
+    // Native conversion keeps the id, and the stream writer tags a frame without adding an assumption block.
+    std::istringstream convert_input(compressed_bytes);
+    std::ostringstream stream;
+    ASSERT_EQ(binary::dlx_convert_problems(convert_input, stream, true), 0);
+    const size_t native_bytes = stream.str().size();
+    {
+        binary::DlxCoverHeader header = problem.header;
+        header.flags = 0;
+        binary::DlxProblemStreamWriter writer(stream);
+        ASSERT_EQ(writer.start(header, dlx::SearchAssumptions(), 7), 0);
+        for (const auto& row : problem.rows)
+        {
+            ASSERT_EQ(writer.write_row(row.row_id, row.columns, row.entry_count), 0);
+        }
+        ASSERT_EQ(writer.finish(), 0);
+    }
+    const std::string frames = stream.str();
+
+    std::istringstream frame_input(frames);
+    binary::DlxProblemStreamReader reader(frame_input);
+    binary::DlxCoverHeader header = {0};
+    std::vector<uint32_t> expected_ids = {problem.problem_id, 7};
+    for (uint32_t expected_id : expected_ids)
+    {
+        ASSERT_EQ(reader.read_header(&header), 0);
+        EXPECT_NE(header.flags & DLX_COVER_FLAG_PROBLEM_ID, 0);
+        EXPECT_EQ(reader.problem_id(), expected_id);
+        size_t rows = 0;
+        binary::DlxRowSpan span = {0};
+        while (reader.read_row(&span) == 1)
+        {
+            rows++;
+        }
+        EXPECT_EQ(rows, 6u);
+    }
+    EXPECT_EQ(header.flags & DLX_COVER_FLAG_ASSUMPTIONS, 0);
+    EXPECT_TRUE(reader.assumptions().empty());
+
+    // The scanner steps over the id whether or not an assumption block follows it.
+    binary::DlxFrameScanner scanner;
+    size_t frame_bytes = 0;
+    ASSERT_EQ(scanner.scan(frames.data(), frames.size(), &frame_bytes), 1);
+    EXPECT_EQ(frame_bytes, native_bytes);
+    ASSERT_EQ(scanner.scan(frames.data() + native_bytes, frames.size() - native_bytes, &frame_bytes), 1);
+    EXPECT_EQ(frame_bytes, frames.size() - native_bytes);
+}
+
+TEST(DlxBinaryTest, SolveOptionsAndStatusTravelWithTheirSections)
+{
+    binary::DlxProblem problem;
+    build_assumption_problem(problem);
+    problem.header.flags |= DLX_COVER_FLAG_PROBLEM_ID | DLX_COVER_FLAG_OPTIONS;
+    problem.problem_id = 9;
+    problem.options = {0x100000002ull, 12345, 250, DLX_SOLVE_FLAG_COUNT_ONLY, DLX_SOLVE_ENGINE_DANCING_LINKS};
+    problem.assumptions.forbidden_rows = {4};
+
+    auto expect_options = [&](const binary::DlxSolveOptions& options) {
+        EXPECT_EQ(options.solution_limit, problem.options.solution_limit);
+        EXPECT_EQ(options.node_budget, problem.options.node_budget);
+        EXPECT_EQ(options.deadline_ms, problem.options.deadline_ms);
+        EXPECT_EQ(options.flags, problem.options.flags);
+        EXPECT_EQ(options.engine, problem.options.engine);
+    };
+
+    std::ostringstream compressed;
+    ASSERT_EQ(binary::dlx_write_problem(compressed, &problem), 0);
+    const std::string compressed_bytes = compressed.str();
+
+    std::istringstream chunk_input(compressed_bytes);
+    binary::DlxProblem read_problem;
+    ASSERT_EQ(binary::dlx_read_problem(chunk_input, &read_problem), 0);
+    expect_options(read_problem.options);
+    EXPECT_EQ(read_problem.problem_id, 9u);
+    EXPECT_EQ(read_problem.assumptions.forbidden_rows, (std::vector<uint32_t>{4}));
+
+    binary::DlxCsrProblem decoded;
+    ASSERT_EQ(binary::dlx_decode_problem(compressed_bytes.data(), compressed_bytes.size(), &decoded, 1), 0);
+    expect_options(decoded.options);
+    EXPECT_EQ(decoded.row_count(), 6u);
+
+    // Native conversion keeps the block, and the scanner steps over it.
+    std::istringstream convert_input(compressed_bytes);
+    std::ostringstream native;
+    ASSERT_EQ(binary::dlx_convert_problems(convert_input, native, true), 0);
+    const std::string native_bytes = native.str();
+    binary::DlxFrameScanner scanner;
+    size_t frame_bytes = 0;
+    ASSERT_EQ(scanner.scan(native_bytes.data(), native_bytes.size(), &frame_bytes), 1);
+    EXPECT_EQ(frame_bytes, native_bytes.size());
+
+    std::istringstream native_input(native_bytes);
+    binary::DlxProblemStreamReader reader(native_input);
+    binary::DlxCoverHeader header = {0};
+    ASSERT_EQ(reader.read_header(&header), 0);
+    expect_options(reader.options());
+    EXPECT_EQ(reader.problem_id(), 9u);
+    EXPECT_EQ(reader.assumptions().forbidden_rows, (std::vector<uint32_t>{4}));
+
+    // The status trailer follows the terminator of either solution version.
+    for (uint16_t version : {static_cast<uint16_t>(1), static_cast<uint16_t>(DLX_SOLUTION_VERSION_COMPACT)})
+    {
+        std::ostringstream section;
+        {
+            binary::DlxSolutionStreamWriter writer(
+                section, {DLX_SOLUTION_MAGIC, version, DLX_SOLUTION_FLAG_STATUS, 4});
+            const uint32_t rows[] = {5, 2};
+            ASSERT_EQ(writer.write_row(rows, 2), 0);
+            ASSERT_EQ(writer.finish({DLX_SOLVE_LIMIT_REACHED, 1, 0x500000007ull}), 0);
+            ASSERT_EQ(writer.start({DLX_SOLUTION_MAGIC, version, DLX_SOLUTION_FLAG_STATUS, 4}), 0);
+            ASSERT_EQ(writer.finish(), 0);
+        }
+
+        std::istringstream section_input(section.str());
+        {
+            binary::DlxSolutionStreamReader solutions(section_input);
+            binary::DlxSolutionHeader solution_header = {0};
+            uint64_t solution_id = 0;
+            std::vector<uint32_t> rows;
+            ASSERT_EQ(solutions.read_header(&solution_header), 0);
+            ASSERT_EQ(solutions.read_row(&solution_id, &rows), 1);
+            ASSERT_EQ(solutions.read_row(&solution_id, &rows), 0);
+            EXPECT_EQ(solutions.status().code, static_cast<uint32_t>(DLX_SOLVE_LIMIT_REACHED));
+            EXPECT_EQ(solutions.status().solutions, 1u);
+            EXPECT_EQ(solutions.status().nodes, 0x500000007ull);
+        }
+
+        binary::DlxSolution empty;
+        ASSERT_EQ(binary::dlx_read_solution(section_input, &empty), 0);
+        EXPECT_TRUE(empty.rows.empty());
+        EXPECT_EQ(empty.status.code, static_cast<uint32_t>(DLX_SOLVE_COMPLETE));
+
+        binary::DlxSolution written;
+        written.header = {DLX_SOLUTION_MAGIC, version, DLX_SOLUTION_FLAG_STATUS, 4};
+        written.status = {DLX_SOLVE_DEADLINE, 0, 77};
+        std::ostringstream rewritten;
+        ASSERT_EQ(binary::dlx_write_solution(rewritten, &written), 0);
+        std::istringstream rewritten_input(rewritten.str());
+        binary::DlxSolution reread;
+        ASSERT_EQ(binary::dlx_read_solution(rewritten_input, &reread), 0);
+        EXPECT_EQ(reread.status.code, static_cast<uint32_t>(DLX_SOLVE_DEADLINE));
+        EXPECT_EQ(reread.status.nodes, 77u);
+        EXPECT_EQ(rewritten_input.peek(), std::char_traits<char>::eof());
+    }
+}
+
+TEST(DlxBinaryTest, BoundedPolicyStopsTheSearchAndRestoresTheMatrix)
+{
+    binary::DlxProblem problem;
+    build_assumption_problem(problem);
+
+    char** solutions = NULL;
+    int itemCount = 0;
+    int optionCount = 0;
+    struct node* matrix = dlx::Core::generateMatrixBinary(problem, &solutions, &itemCount, &optionCount);
+    ASSERT_NE(matrix, nullptr);
+    std::vector<uint32_t> row_ids(static_cast<size_t>(optionCount));
+
+    dlx::search::BoundedPolicy<dlx::search::CollectPolicy> limited;
+    limited.solution_limit = 1;
+    dlx::Core::search(matrix, 0, row_ids.data(), limited);
+    EXPECT_EQ(limited.status, static_cast<uint32_t>(DLX_SOLVE_LIMIT_REACHED));
+    EXPECT_EQ(limited.solutions, 1u);
+    EXPECT_EQ(limited.inner.lengths.size(), 1u);
+
+    dlx::search::BoundedPolicy<dlx::search::CollectPolicy> budgeted;
+    budgeted.node_budget = 2;
+    dlx::Core::search(matrix, 0, row_ids.data(), budgeted);
+    EXPECT_EQ(budgeted.status, static_cast<uint32_t>(DLX_SOLVE_NODE_BUDGET));
+    EXPECT_EQ(budgeted.nodes, 2u);
+
+    dlx::search::BoundedPolicy<dlx::search::CollectPolicy> counted;
+    counted.count_only = true;
+    dlx::Core::search(matrix, 0, row_ids.data(), counted);
+    EXPECT_EQ(counted.status, static_cast<uint32_t>(DLX_SOLVE_COMPLETE));
+    EXPECT_EQ(counted.solutions, 3u);
+    EXPECT_TRUE(counted.inner.lengths.empty());
+
+    dlx::search::BoundedPolicy<dlx::search::CountPolicy> expired;
+    expired.deadline = std::chrono::steady_clock::now();
+    dlx::Core::search(matrix, 0, row_ids.data(), expired);
+    EXPECT_EQ(expired.status, static_cast<uint32_t>(DLX_SOLVE_DEADLINE));
+    EXPECT_EQ(expired.nodes, 0u);
+
+    // Stopped searches leave the matrix as they found it.
+    dlx::search::CountPolicy counter;
+    dlx::Core::search(matrix, 0, row_ids.data(), counter);
+    EXPECT_EQ(counter.solutions, 3u);
+
+    dlx::Core::freeMemory(matrix, solutions);
+}
+
+TEST(DlxBinaryTest, BatchSolverOrdersOrTagsSections)
+{
+    binary::DlxProblem problem;
+    build_assumption_problem(problem);
+
+    // Forty problems alternating full covers and reuse frames that force row 2 and forbid row 1.
+    constexpr uint32_t kProblems = 40;
+    std::ostringstream cover;
+    {
+        binary::DlxProblemStreamWriter writer(cover, problem.header);
+        for (uint32_t i = 0; i < kProblems; i++)
+        {
+            if (i > 0)
+            {
+                binary::DlxCoverHeader header = problem.header;
+                if (i % 2 == 1)
+                {
+                    header.flags = DLX_COVER_FLAG_REUSE_MATRIX;
+                    header.row_count = 0;
+                    dlx::SearchAssumptions assumptions;
+                    assumptions.forced_rows = {2};
+                    assumptions.forbidden_rows = {1};
+                    ASSERT_EQ(writer.start(header, assumptions), 0);
+                    ASSERT_EQ(writer.finish(), 0);
+                    continue;
+                }
+                ASSERT_EQ(writer.start(header), 0);
+            }
+            for (const auto& row : problem.rows)
+            {
+                ASSERT_EQ(writer.write_row(row.row_id, row.columns, row.entry_count), 0);
+            }
+            ASSERT_EQ(writer.finish(), 0);
+        }
+    }
+
+    auto solve = [&](const dlx::batch::BatchConfig& config, dlx::batch::BatchStats* stats) {
+        std::istringstream input(cover.str());
+        std::ostringstream output;
+        dlx::batch::BatchSolver solver(config);
+        EXPECT_EQ(solver.run(input, output, stats), 0) << solver.error();
+        return output.str();
+    };
+
+    dlx::batch::BatchConfig sequential;
+    sequential.workers = 1;
+    dlx::batch::BatchStats stats;
+    const std::string expected = solve(sequential, &stats);
+    EXPECT_EQ(stats.problems, kProblems);
+    EXPECT_EQ(stats.solutions, (kProblems / 2) * 3 + (kProblems / 2) * 1);
+
+    dlx::batch::BatchConfig in_order;
+    in_order.workers = 4;
+    in_order.max_in_flight = 3;
+    EXPECT_EQ(solve(in_order, nullptr), expected);
+
+    dlx::batch::BatchConfig as_completed;
+    as_completed.workers = 4;
+    as_completed.order = dlx::batch::OutputOrder::AsCompleted;
+    std::istringstream tagged(solve(as_completed, nullptr));
+
+    std::map<uint32_t, size_t> solutions_by_problem;
+    binary::DlxSolution section;
+    while (tagged.peek() != std::char_traits<char>::eof())
+    {
+        ASSERT_EQ(binary::dlx_read_solution(tagged, &section), 0);
+        ASSERT_NE(section.header.flags & DLX_SOLUTION_FLAG_PROBLEM_INDEX, 0);
+        EXPECT_TRUE(solutions_by_problem.emplace(section.problem_index, section.rows.size()).second);
+    }
+    ASSERT_EQ(solutions_by_problem.size(), kProblems);
+    for (const auto& [index, count] : solutions_by_problem)
+    {
+        EXPECT_EQ(count, (index % 2 == 1) ? 1u : 3u) << "problem " << index;
+    }
+}
+
 } // namespace
@@ -1,5 +1,9 @@
 #include "core/tcp_server.h"
 #include "core/binary.h"
+#include "core/io_uring.h"
+#include "core/local_client.h"
+#include "core/result_cache.h"
+#include "core/search_estimate.h"
 #include "ascii_binary_utils.h"
 #include "tcp_test_utils.h"
 #include <arpa/inet.h>
@@ -9,10 +13,15 @@
 #include <netinet/in.h>
 #include <string.h>
 #include <sys/socket.h>
+#include <sys/un.h>
 #include <unistd.h>
 #include <errno.h>
+#include <algorithm>
 #include <memory>
+#include <set>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 namespace {
@@ -25,6 +34,104 @@ constexpr char kExpectedSudokuRows[] =
     "34 40 17 16 21 5 27 28 44 122 127 136 140 129 141 142 143 148 151 152 153 "
     "154 156 157 144 158 161 164 170 171 175 177 178 182 183";
 
+// Cover in which every column has two interchangeable single-column rows (2c + 1 and 2c + 2), so it has
+// 2^columns solutions.
+std::vector<uint8_t> DoublingCover(uint32_t columns)
+{
+    binary::DlxCoverHeader header = {
+        .magic = DLX_COVER_MAGIC,
+        .version = DLX_BINARY_VERSION,
+        .flags = 0,
+        .column_count = columns,
+        .row_count = columns * 2,
+    };
+    std::ostringstream cover;
+    {
+        binary::DlxProblemStreamWriter writer(cover, header);
+        for (uint32_t column = 0; column < columns; column++)
+        {
+            writer.write_row(column * 2 + 1, &column, 1);
+            writer.write_row(column * 2 + 2, &column, 1);
+        }
+        writer.finish();
+    }
+    const std::string bytes = cover.str();
+    return std::vector<uint8_t>(bytes.begin(), bytes.end());
+}
+
+// Tags an encoded cover frame with a problem id: the id goes right after the 16-byte header and the flags, which
+// sit big-endian in bytes 6-7, gain DLX_COVER_FLAG_PROBLEM_ID along with @p extra_flags.
+std::vector<uint8_t> TagFrame(std::vector<uint8_t> frame, uint32_t problem_id, uint16_t extra_flags = 0)
+{
+    const uint16_t flags = static_cast<uint16_t>(((frame[6] << 8) | frame[7]) | DLX_COVER_FLAG_PROBLEM_ID | extra_flags);
+    frame[6] = static_cast<uint8_t>(flags >> 8);
+    frame[7] = static_cast<uint8_t>(flags & 0xFF);
+    const uint32_t id = htonl(problem_id);
+    const uint8_t* id_bytes = reinterpret_cast<const uint8_t*>(&id);
+    frame.insert(frame.begin() + sizeof(binary::DlxCoverHeader), id_bytes, id_bytes + sizeof(id));
+    return frame;
+}
+
+// DoublingCover(@p columns) answered inline under solve options, tagged with @p problem_id.
+std::vector<uint8_t> BoundedCover(uint32_t columns, uint32_t problem_id, const binary::DlxSolveOptions& options)
+{
+    binary::DlxCoverHeader header = {
+        .magic = DLX_COVER_MAGIC,
+        .version = DLX_BINARY_VERSION,
+        .flags = DLX_COVER_FLAG_PROBLEM_ID | DLX_COVER_FLAG_REPLY_INLINE,
+        .column_count = columns,
+        .row_count = columns * 2,
+    };
+    std::ostringstream cover;
+    {
+        binary::DlxProblemStreamWriter writer(cover);
+        writer.start(header, dlx::SearchAssumptions(), problem_id, options);
+        for (uint32_t column = 0; column < columns; column++)
+        {
+            writer.write_row(column * 2 + 1, &column, 1);
+            writer.write_row(column * 2 + 2, &column, 1);
+        }
+        writer.finish();
+    }
+    const std::string bytes = cover.str();
+    return std::vector<uint8_t>(bytes.begin(), bytes.end());
+}
+
+bool SendSubscription(int fd, uint32_t problem_id, uint32_t mask)
+{
+    const uint32_t words[3] = {htonl(DLX_SUBSCRIBE_MAGIC), htonl(problem_id), htonl(mask)};
+    return send(fd, words, sizeof(words), 0) == static_cast<ssize_t>(sizeof(words));
+}
+
+bool SendFlushPolicy(int fd, const dlx::DlxFlushPolicy& policy)
+{
+    const uint32_t micros = policy.max_micros | (policy.cork ? DLX_FLUSH_CORK : 0);
+    const uint32_t words[3] = {htonl(DLX_FLUSH_MAGIC), htonl(policy.max_bytes), htonl(micros)};
+    return send(fd, words, sizeof(words), 0) == static_cast<ssize_t>(sizeof(words));
+}
+
+// A Unix domain socket path private to this process and call.
+std::string LocalSocketPath()
+{
+    static int next = 0;
+    return "/tmp/dlx_test_" + std::to_string(getpid()) + "_" + std::to_string(next++) + ".sock";
+}
+
+int ConnectToLocalSocket(const std::string& path)
+{
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, path.c_str(), path.size());
+    if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
 class DlxTcpServerTest : public ::testing::Test
 {
 protected:
@@ -121,6 +228,53 @@ TEST_F(DlxTcpServerTest, BroadcastsToMultipleClients)
     client_b.join();
 }
 
+TEST_F(DlxTcpServerTest, StreamsMoreSolutionsThanTheRingHolds)
+{
+    // Every column has two interchangeable rows, so the cover has 2^16 solutions of 16 rows each: more than a
+    // megaword of records, which forces the solver to wrap the solution ring and wait for the output thread.
+    constexpr uint32_t kColumns = 16;
+    const std::vector<uint8_t> cover = DoublingCover(kColumns);
+
+    std::promise<binary::DlxSolution> promise;
+    auto future = promise.get_future();
+    std::thread solution_thread([&]() {
+        int fd = ConnectToPort(server().solution_port());
+        ASSERT_GE(fd, 0);
+        DescriptorInputStream stream(fd);
+        binary::DlxSolution solution;
+        binary::dlx_read_solution(stream, &solution);
+        close(fd);
+        promise.set_value(std::move(solution));
+    });
+
+    // Give the subscriber time to register before the problem starts streaming.
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_TRUE(SendProblem(server().request_port(), cover));
+
+    ASSERT_EQ(future.wait_for(std::chrono::seconds(30)), std::future_status::ready);
+    binary::DlxSolution solution = future.get();
+    ASSERT_EQ(solution.rows.size(), 1u << kColumns);
+
+    // Each solution picks one row per column; the picks, read as bits, must cover every combination once.
+    std::vector<bool> seen(1u << kColumns, false);
+    for (const auto& row : solution.rows)
+    {
+        ASSERT_EQ(row.entry_count, kColumns);
+        uint32_t mask = 0;
+        for (uint16_t i = 0; i < row.entry_count; i++)
+        {
+            const uint32_t id = row.row_indices[i];
+            ASSERT_GE(id, 1u);
+            ASSERT_LE(id, kColumns * 2);
+            mask |= ((id - 1) % 2) << ((id - 1) / 2);
+        }
+        EXPECT_FALSE(seen[mask]);
+        seen[mask] = true;
+    }
+
+    solution_thread.join();
+}
+
 TEST_F(DlxTcpServerTest, ReusesSolutionSocketAcrossProblems)
 {
     auto expected = ParseRowList(kExpectedSudokuRows);
@@ -200,4 +354,1213 @@ TEST_F(DlxTcpServerTest, MultipleProblemClientsBroadcastToSolutionSubscribers)
     client_b.join();
 }
 
+TEST_F(DlxTcpServerTest, ReuseFramesSolveUnderAssumptions)
+{
+    auto expected = ParseRowList(kExpectedSudokuRows);
+    std::promise<std::vector<std::vector<uint32_t>>> promise;
+    auto future = promise.get_future();
+
+    std::thread solution_thread([&]() {
+        int fd = ConnectToPort(server().solution_port());
+        ASSERT_GE(fd, 0);
+        DescriptorInputStream stream(fd);
+
+        std::vector<std::vector<uint32_t>> results;
+        for (int i = 0; i < 3; i++)
+        {
+            results.push_back(ReadProblemSolution(stream));
+        }
+        close(fd);
+        promise.set_value(results);
+    });
+
+    std::vector<uint8_t> payload = AsciiCoverToBytes(ReadFileToString("tests/sudoku_example/sudoku_cover.txt"));
+    ASSERT_FALSE(payload.empty());
+
+    // Two query frames against the cover above: one forcing a solution row, one forbidding it.
+    std::ostringstream queries;
+    binary::DlxCoverHeader reuse_header = {
+        .magic = DLX_COVER_MAGIC,
+        .version = DLX_BINARY_VERSION,
+        .flags = DLX_COVER_FLAG_REUSE_MATRIX,
+        .column_count = 0,
+        .row_count = 0,
+    };
+    dlx::SearchAssumptions forced;
+    forced.forced_rows = {expected[0]};
+    dlx::SearchAssumptions forbidden;
+    forbidden.forbidden_rows = {expected[0]};
+
+    binary::DlxProblemStreamWriter writer(queries, reuse_header, forced);
+    writer.finish();
+    ASSERT_EQ(writer.start(reuse_header, forbidden), 0);
+    writer.finish();
+
+    const std::string query_bytes = queries.str();
+    payload.insert(payload.end(), query_bytes.begin(), query_bytes.end());
+    ASSERT_TRUE(SendProblem(server().request_port(), payload));
+
+    ASSERT_EQ(future.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    auto results = future.get();
+    ASSERT_EQ(results.size(), 3u);
+    EXPECT_EQ(results[0], expected);
+
+    auto sorted_expected = expected;
+    std::sort(sorted_expected.begin(), sorted_expected.end());
+    auto forced_rows = results[1];
+    ASSERT_FALSE(forced_rows.empty());
+    EXPECT_EQ(forced_rows[0], expected[0]);
+    std::sort(forced_rows.begin(), forced_rows.end());
+    EXPECT_EQ(forced_rows, sorted_expected);
+
+    EXPECT_TRUE(results[2].empty());
+
+    solution_thread.join();
+}
+
+TEST_F(DlxTcpServerTest, ReuseFrameWithoutACoverClosesTheConnection)
+{
+    binary::DlxCoverHeader reuse_header = {
+        .magic = DLX_COVER_MAGIC,
+        .version = DLX_BINARY_VERSION,
+        .flags = DLX_COVER_FLAG_REUSE_MATRIX | DLX_COVER_FLAG_REPLY_INLINE,
+        .column_count = 0,
+        .row_count = 0,
+    };
+    dlx::SearchAssumptions forced;
+    forced.forced_rows = {1};
+    std::ostringstream query;
+    binary::DlxProblemStreamWriter writer(query, reuse_header, forced);
+    ASSERT_EQ(writer.finish(), 0);
+    const std::string query_bytes = query.str();
+
+    // Nothing was sent to reuse, so instead of an answer the client sees the connection close.
+    int fd = ConnectToPort(server().request_port());
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(send(fd, query_bytes.data(), query_bytes.size(), 0), static_cast<ssize_t>(query_bytes.size()));
+    timeval timeout = {5, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    char byte;
+    EXPECT_EQ(recv(fd, &byte, 1, 0), 0);
+    close(fd);
+}
+
+TEST_F(DlxTcpServerTest, OverstatedRowCountDoesNotSizeTheArena)
+{
+    // A frame of a few dozen bytes claiming four billion rows is refused without reserving room for them.
+    std::vector<uint8_t> frame = DoublingCover(2);
+    for (size_t i = 12; i < 16; i++)
+    {
+        frame[i] = 0xFF;
+    }
+    int fd = ConnectToPort(server().request_port());
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(send(fd, frame.data(), frame.size(), 0), static_cast<ssize_t>(frame.size()));
+    shutdown(fd, SHUT_WR);
+    timeval timeout = {5, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    char byte;
+    EXPECT_EQ(recv(fd, &byte, 1, 0), 0);
+    close(fd);
+}
+
+TEST_F(DlxTcpServerTest, ReassemblesFramesSplitAcrossReads)
+{
+    auto expected = ParseRowList(kExpectedSudokuRows);
+    std::promise<std::vector<std::vector<uint32_t>>> promise;
+    auto future = promise.get_future();
+
+    std::thread solution_thread([&]() {
+        int fd = ConnectToPort(server().solution_port());
+        ASSERT_GE(fd, 0);
+        DescriptorInputStream stream(fd);
+
+        std::vector<std::vector<uint32_t>> results;
+        results.push_back(ReadProblemSolution(stream));
+        results.push_back(ReadProblemSolution(stream));
+        close(fd);
+        promise.set_value(results);
+    });
+
+    std::vector<uint8_t> payload = AsciiCoverToBytes(ReadFileToString("tests/sudoku_example/sudoku_cover.txt"));
+    ASSERT_FALSE(payload.empty());
+
+    // Two frames on one connection, cut so that neither the header nor the frame boundary lands on a read
+    // boundary, with pauses so the reactor sees every piece on its own.
+    std::vector<uint8_t> bytes = payload;
+    bytes.insert(bytes.end(), payload.begin(), payload.end());
+    const size_t cuts[] = {0, 5, payload.size() / 2, payload.size() - 3, payload.size() + 9, bytes.size()};
+
+    int fd = ConnectToPort(server().request_port());
+    ASSERT_GE(fd, 0);
+    for (size_t i = 0; i + 1 < sizeof(cuts) / sizeof(cuts[0]); i++)
+    {
+        const size_t length = cuts[i + 1] - cuts[i];
+        ASSERT_EQ(send(fd, bytes.data() + cuts[i], length, 0), static_cast<ssize_t>(length));
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    close(fd);
+
+    ASSERT_EQ(future.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    const auto& results = future.get();
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_EQ(results[0], expected);
+    EXPECT_EQ(results[1], expected);
+
+    solution_thread.join();
+}
+
+TEST(DlxTcpServerWorkerPoolTest, KeepsStreamsDelimitedAcrossWorkers)
+{
+    dlx::TcpServerConfig config{0, 0, 4};
+    dlx::DlxTcpServer server(config);
+    if (!server.start())
+    {
+        GTEST_SKIP() << "Unable to bind TCP server sockets in this environment";
+    }
+    EXPECT_EQ(server.worker_count(), 4u);
+
+    auto expected = ParseRowList(kExpectedSudokuRows);
+    constexpr uint32_t kColumns = 14;
+    constexpr size_t kSections = 5;
+
+    std::promise<std::vector<binary::DlxSolution>> promise;
+    auto future = promise.get_future();
+    std::thread solution_thread([&]() {
+        int fd = ConnectToPort(server.solution_port());
+        ASSERT_GE(fd, 0);
+        DescriptorInputStream stream(fd);
+        std::vector<binary::DlxSolution> sections(kSections);
+        for (auto& section : sections)
+        {
+            if (binary::dlx_read_solution(stream, &section) != 0)
+            {
+                break;
+            }
+        }
+        close(fd);
+        promise.set_value(std::move(sections));
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // Three connections at once: a cover with many solutions, a Sudoku, and a Sudoku followed by two reuse frames
+    // that must come back in order (full cover, forced row, forbidden row).
+    const std::vector<uint8_t> doubling = DoublingCover(kColumns);
+    const std::vector<uint8_t> sudoku = AsciiCoverToBytes(ReadFileToString("tests/sudoku_example/sudoku_cover.txt"));
+    ASSERT_FALSE(sudoku.empty());
+
+    std::ostringstream queries;
+    binary::DlxCoverHeader reuse_header = {
+        .magic = DLX_COVER_MAGIC,
+        .version = DLX_BINARY_VERSION,
+        .flags = DLX_COVER_FLAG_REUSE_MATRIX,
+        .column_count = 0,
+        .row_count = 0,
+    };
+    dlx::SearchAssumptions forced;
+    forced.forced_rows = {expected[0]};
+    dlx::SearchAssumptions forbidden;
+    forbidden.forbidden_rows = {expected[0]};
+    {
+        binary::DlxProblemStreamWriter writer(queries, reuse_header, forced);
+        writer.finish();
+        ASSERT_EQ(writer.start(reuse_header, forbidden), 0);
+        writer.finish();
+    }
+    std::vector<uint8_t> reuse_payload = sudoku;
+    const std::string query_bytes = queries.str();
+    reuse_payload.insert(reuse_payload.end(), query_bytes.begin(), query_bytes.end());
+
+    std::vector<std::thread> senders;
+    senders.emplace_back([&]() { EXPECT_TRUE(SendProblem(server.request_port(), doubling)); });
+    senders.emplace_back([&]() { EXPECT_TRUE(SendProblem(server.request_port(), sudoku)); });
+    senders.emplace_back([&]() { EXPECT_TRUE(SendProblem(server.request_port(), reuse_payload)); });
+    for (auto& sender : senders)
+    {
+        sender.join();
+    }
+
+    ASSERT_EQ(future.wait_for(std::chrono::seconds(30)), std::future_status::ready);
+    auto sections = future.get();
+    solution_thread.join();
+    server.stop();
+    server.wait();
+
+    // Every section must be one whole problem; the forbidden-row query follows at least two full Sudoku answers.
+    size_t doubling_sections = 0;
+    size_t sudoku_answers = 0;
+    size_t empty_sections = 0;
+    for (const auto& section : sections)
+    {
+        if (section.header.column_count == kColumns)
+        {
+            doubling_sections++;
+            EXPECT_EQ(section.rows.size(), 1u << kColumns);
+            continue;
+        }
+
+        ASSERT_EQ(section.header.column_count, 324u);
+        if (section.rows.empty())
+        {
+            empty_sections++;
+            EXPECT_GE(sudoku_answers, 2u);
+            continue;
+        }
+
+        ASSERT_EQ(section.rows.size(), 1u);
+        std::vector<uint32_t> rows(section.rows[0].row_indices,
+                                   section.rows[0].row_indices + section.rows[0].entry_count);
+        EXPECT_EQ(rows[0], expected[0]);
+        std::sort(rows.begin(), rows.end());
+        auto sorted_expected = expected;
+        std::sort(sorted_expected.begin(), sorted_expected.end());
+        EXPECT_EQ(rows, sorted_expected);
+        sudoku_answers++;
+    }
+    EXPECT_EQ(doubling_sections, 1u);
+    EXPECT_EQ(sudoku_answers, 3u);
+    EXPECT_EQ(empty_sections, 1u);
+}
+
+TEST(DlxTcpServerWorkerPoolTest, ConnectionsMoveToIdleWorkersBetweenFrames)
+{
+    dlx::TcpServerConfig config{0, 0, 2};
+    config.result_cache_bytes = 0;
+    dlx::DlxTcpServer server(config);
+    if (!server.start())
+    {
+        GTEST_SKIP() << "Unable to bind TCP server sockets in this environment";
+    }
+
+    // Searches that count 2^40 solutions without streaming any, until their deadline stops them.
+    auto blocker = [&](uint32_t problem_id, uint32_t deadline_ms) {
+        binary::DlxSolveOptions options = {0};
+        options.deadline_ms = deadline_ms;
+        options.flags = DLX_SOLVE_FLAG_COUNT_ONLY;
+        int fd = ConnectToPort(server.request_port());
+        const std::vector<uint8_t> frame = BoundedCover(40, problem_id, options);
+        EXPECT_EQ(send(fd, frame.data(), frame.size(), 0), static_cast<ssize_t>(frame.size()));
+        return fd;
+    };
+    auto answered = [](int fd) {
+        DescriptorInputStream stream(fd);
+        binary::DlxSolution section;
+        EXPECT_EQ(binary::dlx_read_solution(stream, &section), 0);
+        return std::chrono::steady_clock::now();
+    };
+
+    // The short blocker takes one worker, so the connection's first frame runs on the other.
+    const int short_fd = blocker(1, 1000);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    const int fd = ConnectToPort(server.request_port());
+    ASSERT_GE(fd, 0);
+    const std::vector<uint8_t> frame = TagFrame(DoublingCover(2), 3, DLX_COVER_FLAG_REPLY_INLINE);
+    ASSERT_EQ(send(fd, frame.data(), frame.size(), 0), static_cast<ssize_t>(frame.size()));
+    answered(fd);
+
+    // The long blocker can only take the worker that answered it; the next frame must not wait behind it but
+    // move to the other worker as soon as the short blocker ends.
+    const int long_fd = blocker(2, 5000);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_EQ(send(fd, frame.data(), frame.size(), 0), static_cast<ssize_t>(frame.size()));
+    std::future<std::chrono::steady_clock::time_point> long_done = std::async(std::launch::async, answered, long_fd);
+    const auto second = answered(fd);
+    EXPECT_LT(second, long_done.get()) << "the frame waited behind the long blocker";
+
+    answered(short_fd);
+    for (int open_fd : {fd, short_fd, long_fd})
+    {
+        close(open_fd);
+    }
+    server.stop();
+    server.wait();
+}
+
+TEST(DlxTcpServerBackendTest, EpollAndIoUringStreamTheSameSolutions)
+{
+    constexpr uint32_t kColumns = 12;
+    const std::vector<uint8_t> doubling = DoublingCover(kColumns);
+
+    for (bool io_uring : {false, true})
+    {
+        dlx::TcpServerConfig config{0, 0, 2};
+        config.io_uring = io_uring;
+        config.slow_clients = dlx::SlowClientPolicy::Block; // Subscribers send through the io_uring slot queue.
+        dlx::DlxTcpServer server(config);
+        if (!server.start())
+        {
+            GTEST_SKIP() << "Unable to bind TCP server sockets in this environment";
+        }
+        // io_uring may still be refused at run time (seccomp, sysctl), in which case the server falls back to epoll.
+        EXPECT_TRUE(!server.uses_io_uring() || (io_uring && dlx::io::io_uring_built_in()));
+
+        // Two subscribers so every broadcast goes out to more than one socket per submission.
+        std::vector<std::promise<binary::DlxSolution>> promises(2);
+        std::vector<std::thread> subscribers;
+        for (auto& promise : promises)
+        {
+            subscribers.emplace_back([&server, &promise]() {
+                int fd = ConnectToPort(server.solution_port());
+                ASSERT_GE(fd, 0);
+                DescriptorInputStream stream(fd);
+                binary::DlxSolution section;
+                binary::dlx_read_solution(stream, &section);
+                close(fd);
+                promise.set_value(std::move(section));
+            });
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        ASSERT_TRUE(SendProblem(server.request_port(), doubling));
+        for (auto& promise : promises)
+        {
+            auto future = promise.get_future();
+            ASSERT_EQ(future.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+            const binary::DlxSolution section = future.get();
+            EXPECT_EQ(section.header.column_count, kColumns);
+            ASSERT_EQ(section.rows.size(), 1u << kColumns) << (io_uring ? "io_uring" : "epoll");
+            std::vector<bool> seen(1u << kColumns, false);
+            for (const auto& row : section.rows)
+            {
+                ASSERT_EQ(row.entry_count, kColumns);
+                uint32_t choice = 0;
+                for (uint32_t i = 0; i < row.entry_count; i++)
+                {
+                    const uint32_t column = (row.row_indices[i] - 1) / 2;
+                    choice |= ((row.row_indices[i] - 1) % 2) << column;
+                }
+                EXPECT_FALSE(seen[choice]);
+                seen[choice] = true;
+            }
+        }
+        for (auto& subscriber : subscribers)
+        {
+            subscriber.join();
+        }
+        server.stop();
+        server.wait();
+    }
+}
+
+TEST(DlxTcpServerBackpressureTest, SlowSubscribersAreDroppedOrSpilled)
+{
+    // 2^20 solutions: megabytes of DLXS even compacted, far more than the stalled subscriber's socket buffers and
+    // its 64 KiB memory backlog.
+    constexpr uint32_t kColumns = 20;
+    const std::vector<uint8_t> doubling = DoublingCover(kColumns);
+
+    for (dlx::SlowClientPolicy policy : {dlx::SlowClientPolicy::Drop, dlx::SlowClientPolicy::Spill})
+    {
+        const bool spill = (policy == dlx::SlowClientPolicy::Spill);
+        dlx::TcpServerConfig config{0, 0, 1};
+        config.slow_clients = policy;
+        config.client_buffer_bytes = 64u << 10;
+        dlx::DlxTcpServer server(config);
+        if (!server.start())
+        {
+            GTEST_SKIP() << "Unable to bind TCP server sockets in this environment";
+        }
+
+        // The stalled subscriber shrinks its receive window and reads nothing until the reader has everything.
+        int stalled_fd = ConnectToPort(server.solution_port(), 4096);
+        ASSERT_GE(stalled_fd, 0);
+
+        std::promise<binary::DlxSolution> promise;
+        auto future = promise.get_future();
+        std::thread reader([&server, &promise]() {
+            int fd = ConnectToPort(server.solution_port());
+            ASSERT_GE(fd, 0);
+            DescriptorInputStream stream(fd);
+            binary::DlxSolution section;
+            binary::dlx_read_solution(stream, &section);
+            close(fd);
+            promise.set_value(std::move(section));
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        EXPECT_EQ(server.stats().subscribers, 2u);
+
+        ASSERT_TRUE(SendProblem(server.request_port(), doubling));
+        ASSERT_EQ(future.wait_for(std::chrono::seconds(60)), std::future_status::ready);
+        EXPECT_EQ(future.get().rows.size(), 1u << kColumns);
+        reader.join();
+
+        const dlx::TcpServerStats stats = server.stats();
+        EXPECT_LE(stats.queued_slabs, stats.slab_capacity);
+        if (spill)
+        {
+            // The stalled subscriber is still owed the rest of the stream, from memory and the spill file.
+            EXPECT_EQ(stats.dropped_clients, 0u);
+            EXPECT_GT(stats.spilled_bytes, 0u);
+
+            DescriptorInputStream stream(stalled_fd);
+            binary::DlxSolution section;
+            ASSERT_EQ(binary::dlx_read_solution(stream, &section), 0);
+            EXPECT_EQ(section.rows.size(), 1u << kColumns);
+        }
+        else
+        {
+            EXPECT_EQ(stats.dropped_clients, 1u);
+        }
+        close(stalled_fd);
+
+        server.stop();
+        server.wait();
+        EXPECT_EQ(server.stats().backlog_bytes, 0u);
+        EXPECT_EQ(server.stats().spilled_bytes, 0u);
+    }
+}
+
+TEST(DlxTcpServerBackpressureTest, StalledSubscriberIsCutOffAfterTheLagLimit)
+{
+    constexpr uint32_t kColumns = 20;
+    const std::vector<uint8_t> doubling = DoublingCover(kColumns);
+
+    // Spill has room for the whole stream, so only the lag limit can cut the stalled subscriber off.
+    dlx::TcpServerConfig config{0, 0, 1};
+    config.slow_clients = dlx::SlowClientPolicy::Spill;
+    config.client_lag_ms = 200;
+    dlx::DlxTcpServer server(config);
+    if (!server.start())
+    {
+        GTEST_SKIP() << "Unable to bind TCP server sockets in this environment";
+    }
+
+    int stalled_fd = ConnectToPort(server.solution_port(), 4096);
+    ASSERT_GE(stalled_fd, 0);
+    std::promise<binary::DlxSolution> promise;
+    auto future = promise.get_future();
+    std::thread reader([&server, &promise]() {
+        int fd = ConnectToPort(server.solution_port());
+        ASSERT_GE(fd, 0);
+        DescriptorInputStream stream(fd);
+        binary::DlxSolution section;
+        binary::dlx_read_solution(stream, &section);
+        close(fd);
+        promise.set_value(std::move(section));
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    ASSERT_TRUE(SendProblem(server.request_port(), doubling));
+    ASSERT_EQ(future.wait_for(std::chrono::seconds(60)), std::future_status::ready);
+    EXPECT_EQ(future.get().rows.size(), 1u << kColumns);
+    reader.join();
+
+    // The output thread notices the stalled backlog on its idle sweeps.
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (server.stats().dropped_clients == 0 && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    const dlx::TcpServerStats stats = server.stats();
+    EXPECT_EQ(stats.dropped_clients, 1u);
+    EXPECT_EQ(stats.backlog_bytes, 0u);
+    EXPECT_EQ(stats.spilled_bytes, 0u);
+
+    close(stalled_fd);
+    server.stop();
+    server.wait();
+}
+
+TEST_F(DlxTcpServerTest, SubscriptionsReceiveOnlyMatchingProblems)
+{
+    // Two tenants subscribe to their own id ranges; a client that never subscribes still sees every problem.
+    struct Subscriber
+    {
+        int fd = -1;
+        std::vector<std::pair<uint32_t, uint32_t>> sections; // (problem index, column count)
+    };
+    std::vector<Subscriber> subscribers(3);
+    for (auto& subscriber : subscribers)
+    {
+        subscriber.fd = ConnectToPort(server().solution_port());
+        ASSERT_GE(subscriber.fd, 0);
+    }
+    ASSERT_TRUE(SendSubscription(subscribers[0].fd, 0x100, 0xFFFFFF00u));
+    ASSERT_TRUE(SendSubscription(subscribers[1].fd, 0x200, 0xFFFFFF00u));
+    ASSERT_TRUE(SendSubscription(subscribers[1].fd, 0x7, UINT32_MAX));
+
+    std::promise<void> all_seen;
+    std::vector<std::thread> readers;
+    for (size_t i = 0; i < subscribers.size(); i++)
+    {
+        readers.emplace_back([&, i]() {
+            DescriptorInputStream stream(subscribers[i].fd);
+            binary::DlxSolution section;
+            while (binary::dlx_read_solution(stream, &section) == 0)
+            {
+                EXPECT_NE(section.header.flags & DLX_SOLUTION_FLAG_PROBLEM_INDEX, 0);
+                EXPECT_EQ(section.rows.size(), 1u << section.header.column_count);
+                subscribers[i].sections.emplace_back(section.problem_index, section.header.column_count);
+                if (i == 2 && subscribers[i].sections.size() == 3)
+                {
+                    all_seen.set_value();
+                }
+            }
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    ASSERT_TRUE(SendProblem(server().request_port(), TagFrame(DoublingCover(3), 0x101)));
+    ASSERT_TRUE(SendProblem(server().request_port(), TagFrame(DoublingCover(4), 0x202)));
+    ASSERT_TRUE(SendProblem(server().request_port(), TagFrame(DoublingCover(5), 0x7)));
+
+    // Once the unsubscribed client has all three sections, the subscribers' sections have been sent too.
+    auto future = all_seen.get_future();
+    ASSERT_EQ(future.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+    server().stop();
+    for (auto& reader : readers)
+    {
+        reader.join();
+    }
+    for (auto& subscriber : subscribers)
+    {
+        close(subscriber.fd);
+    }
+
+    using Sections = std::vector<std::pair<uint32_t, uint32_t>>;
+    EXPECT_EQ(subscribers[0].sections, (Sections{{0x101, 3}}));
+    std::sort(subscribers[1].sections.begin(), subscribers[1].sections.end());
+    EXPECT_EQ(subscribers[1].sections, (Sections{{0x7, 5}, {0x202, 4}}));
+    std::sort(subscribers[2].sections.begin(), subscribers[2].sections.end());
+    EXPECT_EQ(subscribers[2].sections, (Sections{{0x7, 5}, {0x101, 3}, {0x202, 4}}));
+}
+
+TEST_F(DlxTcpServerTest, SubscriptionsAreCappedPerClient)
+{
+    // Repeats of a subscription, even with other bits outside its mask, do not count against the limit.
+    int capped_fd = ConnectToPort(server().solution_port());
+    ASSERT_GE(capped_fd, 0);
+    for (uint32_t id = 0; id < DLX_SUBSCRIPTION_LIMIT; id++)
+    {
+        ASSERT_TRUE(SendSubscription(capped_fd, id << 8, 0xFFFFFF00u));
+        ASSERT_TRUE(SendSubscription(capped_fd, (id << 8) | 0x42, 0xFFFFFF00u));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // One more distinct subscription takes the client past the limit, so the server drops it.
+    int over_fd = ConnectToPort(server().solution_port());
+    ASSERT_GE(over_fd, 0);
+    for (uint32_t id = 0; id <= DLX_SUBSCRIPTION_LIMIT; id++)
+    {
+        ASSERT_TRUE(SendSubscription(over_fd, id, UINT32_MAX));
+    }
+    timeval timeout = {5, 0};
+    setsockopt(over_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    char byte;
+    const ssize_t received = recv(over_fd, &byte, 1, 0);
+    EXPECT_TRUE(received == 0 || (received < 0 && errno == ECONNRESET));
+    close(over_fd);
+
+    // The client at the limit keeps every subscription it holds, the last one included.
+    ASSERT_TRUE(SendProblem(server().request_port(), TagFrame(DoublingCover(3), ((DLX_SUBSCRIPTION_LIMIT - 1) << 8) | 1)));
+    DescriptorInputStream stream(capped_fd);
+    binary::DlxSolution section;
+    ASSERT_EQ(binary::dlx_read_solution(stream, &section), 0);
+    EXPECT_EQ(section.problem_index, ((DLX_SUBSCRIPTION_LIMIT - 1u) << 8) | 1);
+    close(capped_fd);
+}
+
+TEST_F(DlxTcpServerTest, RepliesInlineOnTheRequestConnection)
+{
+    auto expected = ParseRowList(kExpectedSudokuRows);
+
+    int subscriber_fd = ConnectToPort(server().solution_port());
+    ASSERT_GE(subscriber_fd, 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    std::vector<uint8_t> sudoku = AsciiCoverToBytes(ReadFileToString("tests/sudoku_example/sudoku_cover.txt"));
+    ASSERT_FALSE(sudoku.empty());
+    const std::vector<uint8_t> payload = TagFrame(sudoku, 42, DLX_COVER_FLAG_REPLY_INLINE);
+
+    // The client half-closes after its frame; the answer still comes back on the same socket, followed by EOF.
+    int fd = ConnectToPort(server().request_port());
+    ASSERT_GE(fd, 0);
+    size_t offset = 0;
+    while (offset < payload.size())
+    {
+        const ssize_t written = send(fd, payload.data() + offset, payload.size() - offset, 0);
+        ASSERT_GT(written, 0);
+        offset += static_cast<size_t>(written);
+    }
+    shutdown(fd, SHUT_WR);
+
+    DescriptorInputStream stream(fd);
+    binary::DlxSolution section;
+    ASSERT_EQ(binary::dlx_read_solution(stream, &section), 0);
+    EXPECT_EQ(section.problem_index, 42u);
+    ASSERT_EQ(section.rows.size(), 1u);
+    EXPECT_EQ(std::vector<uint32_t>(section.rows[0].row_indices, section.rows[0].row_indices + section.rows[0].entry_count),
+              expected);
+    char byte;
+    EXPECT_EQ(recv(fd, &byte, 1, 0), 0);
+    close(fd);
+
+    // Nothing was published to the solution port.
+    EXPECT_EQ(recv(subscriber_fd, &byte, 1, MSG_DONTWAIT), -1);
+    EXPECT_TRUE(errno == EAGAIN || errno == EWOULDBLOCK);
+    close(subscriber_fd);
+}
+
+TEST(DlxTcpServerFlushTest, EveryFlushPolicyDeliversTheSameStream)
+{
+    constexpr uint32_t kColumns = 16;
+    const std::vector<uint8_t> doubling = DoublingCover(kColumns);
+
+    // The server flushes for latency, with solvers publishing every solution; two clients override that with the
+    // bulk preset (corked megabyte batches) and the default one.
+    dlx::TcpServerConfig config{0, 0, 1};
+    config.flush = dlx::kDlxLatencyFlush;
+    dlx::DlxTcpServer server(config);
+    if (!server.start())
+    {
+        GTEST_SKIP() << "Unable to bind TCP server sockets in this environment";
+    }
+
+    std::vector<int> fds;
+    for (int i = 0; i < 3; i++)
+    {
+        fds.push_back(ConnectToPort(server.solution_port()));
+        ASSERT_GE(fds.back(), 0);
+    }
+    ASSERT_TRUE(SendFlushPolicy(fds[1], dlx::kDlxBulkFlush));
+    ASSERT_TRUE(SendFlushPolicy(fds[2], dlx::kDlxDefaultFlush));
+
+    std::vector<binary::DlxSolution> sections(fds.size());
+    std::vector<std::thread> readers;
+    for (size_t i = 0; i < fds.size(); i++)
+    {
+        readers.emplace_back([&, i]() {
+            DescriptorInputStream stream(fds[i]);
+            EXPECT_EQ(binary::dlx_read_solution(stream, &sections[i]), 0);
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    ASSERT_TRUE(SendProblem(server.request_port(), doubling));
+    for (auto& reader : readers)
+    {
+        reader.join();
+    }
+
+    auto rows = [](const binary::DlxSolution& section) {
+        std::vector<std::vector<uint32_t>> result;
+        for (const auto& row : section.rows)
+        {
+            result.emplace_back(row.row_indices, row.row_indices + row.entry_count);
+        }
+        return result;
+    };
+    ASSERT_EQ(sections[0].rows.size(), 1u << kColumns);
+    EXPECT_EQ(rows(sections[1]), rows(sections[0]));
+    EXPECT_EQ(rows(sections[2]), rows(sections[0]));
+
+    for (int fd : fds)
+    {
+        close(fd);
+    }
+    server.stop();
+    server.wait();
+}
+
+TEST(DlxTcpServerFlushTest, LatencyFlushDoesNotHoldOtherWorkersBehindASilentSearch)
+{
+    dlx::TcpServerConfig config{0, 0, 2};
+    config.flush = dlx::kDlxLatencyFlush;
+    config.result_cache_bytes = 0;
+    dlx::DlxTcpServer server(config);
+    if (!server.start())
+    {
+        GTEST_SKIP() << "Unable to bind TCP server sockets in this environment";
+    }
+
+    int subscriber_fd = ConnectToPort(server.solution_port());
+    ASSERT_GE(subscriber_fd, 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // A search that counts 2^40 solutions without streaming any holds one worker until its deadline.
+    binary::DlxSolveOptions options = {0};
+    options.deadline_ms = 3000;
+    options.flags = DLX_SOLVE_FLAG_COUNT_ONLY;
+    const int blocker_fd = ConnectToPort(server.request_port());
+    ASSERT_GE(blocker_fd, 0);
+    const std::vector<uint8_t> blocker = BoundedCover(40, 1, options);
+    ASSERT_EQ(send(blocker_fd, blocker.data(), blocker.size(), 0), static_cast<ssize_t>(blocker.size()));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // The other worker's broadcast must reach the subscriber long before the blocker gives up.
+    const auto sent = std::chrono::steady_clock::now();
+    ASSERT_TRUE(SendProblem(server.request_port(), DoublingCover(2)));
+    DescriptorInputStream stream(subscriber_fd);
+    binary::DlxSolution section;
+    ASSERT_EQ(binary::dlx_read_solution(stream, &section), 0);
+    EXPECT_EQ(section.rows.size(), 4u);
+    EXPECT_LT(std::chrono::steady_clock::now() - sent, std::chrono::milliseconds(1500))
+        << "the broadcast waited behind the silent search";
+
+    DescriptorInputStream blocker_stream(blocker_fd);
+    EXPECT_EQ(binary::dlx_read_solution(blocker_stream, &section), 0);
+    close(blocker_fd);
+    close(subscriber_fd);
+    server.stop();
+    server.wait();
+}
+
+TEST(DlxTcpServerLocalTest, AnswersInlineOnTheUnixSocket)
+{
+    auto expected = ParseRowList(kExpectedSudokuRows);
+    std::vector<uint8_t> sudoku = AsciiCoverToBytes(ReadFileToString("tests/sudoku_example/sudoku_cover.txt"));
+    ASSERT_FALSE(sudoku.empty());
+    const std::vector<uint8_t> payload = TagFrame(sudoku, 7, DLX_COVER_FLAG_REPLY_INLINE);
+
+    // Without a segment, a local connection behaves like a problem connection on the TCP port.
+    for (bool io_uring : {false, true})
+    {
+        dlx::TcpServerConfig config{0, 0, 1};
+        config.io_uring = io_uring;
+        config.local_socket_path = LocalSocketPath();
+        dlx::DlxTcpServer server(config);
+        if (!server.start())
+        {
+            GTEST_SKIP() << "Unable to bind server sockets in this environment";
+        }
+
+        int fd = ConnectToLocalSocket(server.local_socket_path());
+        ASSERT_GE(fd, 0);
+        ASSERT_EQ(send(fd, payload.data(), payload.size(), 0), static_cast<ssize_t>(payload.size()));
+        shutdown(fd, SHUT_WR);
+
+        DescriptorInputStream stream(fd);
+        binary::DlxSolution section;
+        ASSERT_EQ(binary::dlx_read_solution(stream, &section), 0);
+        EXPECT_EQ(section.problem_index, 7u);
+        ASSERT_EQ(section.rows.size(), 1u);
+        EXPECT_EQ(std::vector<uint32_t>(section.rows[0].row_indices,
+                                        section.rows[0].row_indices + section.rows[0].entry_count),
+                  expected);
+        close(fd);
+
+        server.stop();
+        server.wait();
+        EXPECT_NE(access(config.local_socket_path.c_str(), F_OK), 0);
+    }
+}
+
+TEST(DlxTcpServerLocalTest, LocalClientStreamsAnswersThroughSharedMemory)
+{
+    constexpr uint32_t kColumns = 14;
+    auto expected = ParseRowList(kExpectedSudokuRows);
+    std::vector<uint8_t> sudoku = AsciiCoverToBytes(ReadFileToString("tests/sudoku_example/sudoku_cover.txt"));
+    ASSERT_FALSE(sudoku.empty());
+    const std::vector<uint8_t> doubling = DoublingCover(kColumns);
+
+    for (bool io_uring : {false, true})
+    {
+        dlx::TcpServerConfig config{0, 0, 1};
+        config.io_uring = io_uring;
+        config.local_socket_path = LocalSocketPath();
+        dlx::DlxTcpServer server(config);
+        if (!server.start())
+        {
+            GTEST_SKIP() << "Unable to bind server sockets in this environment";
+        }
+
+        // The doubling cover's answer is several times larger than the ring, so the server has to wait for the
+        // client to read it; both problems are submitted before any answer is read.
+        dlx::DlxLocalClient client;
+        ASSERT_EQ(client.connect(server.local_socket_path(), 1u << 20, 64u << 10), 0);
+        const std::vector<const std::vector<uint8_t>*> problems = {&sudoku, &doubling, &sudoku};
+        for (const std::vector<uint8_t>* problem : problems)
+        {
+            std::ostream& frame = client.problem();
+            frame.write(reinterpret_cast<const char*>(problem->data()), static_cast<std::streamsize>(problem->size()));
+            ASSERT_EQ(client.submit(), 0);
+        }
+        client.finish();
+
+        for (size_t index = 0; index < problems.size(); index++)
+        {
+            binary::DlxSolution section;
+            ASSERT_EQ(binary::dlx_read_solution(client.solutions(), &section), 0) << "problem " << index;
+            if (problems[index] == &doubling)
+            {
+                EXPECT_EQ(section.rows.size(), 1u << kColumns);
+                continue;
+            }
+            ASSERT_EQ(section.rows.size(), 1u);
+            EXPECT_EQ(std::vector<uint32_t>(section.rows[0].row_indices,
+                                            section.rows[0].row_indices + section.rows[0].entry_count),
+                      expected);
+        }
+        EXPECT_EQ(client.solutions().peek(), std::char_traits<char>::eof());
+
+        client.close();
+        server.stop();
+        server.wait();
+    }
+}
+
 } // namespace
+
+TEST(DlxTcpServerResultCacheTest, IdenticalProblemsAreSolvedOnce)
+{
+    constexpr uint32_t kColumns = 12;
+    constexpr size_t kCopies = 4;
+
+    // The same cover with its rows written last to first, and each pair of interchangeable rows swapped.
+    binary::DlxCoverHeader header = {
+        .magic = DLX_COVER_MAGIC,
+        .version = DLX_BINARY_VERSION,
+        .flags = 0,
+        .column_count = kColumns,
+        .row_count = kColumns * 2,
+    };
+    std::ostringstream reordered;
+    {
+        binary::DlxProblemStreamWriter writer(reordered, header);
+        for (uint32_t column = kColumns; column-- > 0;)
+        {
+            writer.write_row(column * 2 + 1, &column, 1);
+            writer.write_row(column * 2 + 2, &column, 1);
+        }
+        writer.finish();
+    }
+    const std::string reordered_bytes = reordered.str();
+
+    std::vector<std::vector<uint8_t>> frames(kCopies, TagFrame(DoublingCover(kColumns), 1, DLX_COVER_FLAG_REPLY_INLINE));
+    frames.push_back(TagFrame(std::vector<uint8_t>(reordered_bytes.begin(), reordered_bytes.end()),
+                              2,
+                              DLX_COVER_FLAG_REPLY_INLINE));
+
+    dlx::TcpServerConfig config{0, 0, 2};
+    dlx::DlxTcpServer server(config);
+    if (!server.start())
+    {
+        GTEST_SKIP() << "Unable to bind TCP server sockets in this environment";
+    }
+
+    // Every copy goes out at once on its own connection, so later ones find the first still being solved or done.
+    std::vector<std::set<std::vector<uint32_t>>> answers(frames.size());
+    std::vector<std::thread> clients;
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        clients.emplace_back([&, i]() {
+            int fd = ConnectToPort(server.request_port());
+            ASSERT_GE(fd, 0);
+            size_t offset = 0;
+            while (offset < frames[i].size())
+            {
+                const ssize_t written = send(fd, frames[i].data() + offset, frames[i].size() - offset, 0);
+                ASSERT_GT(written, 0);
+                offset += static_cast<size_t>(written);
+            }
+            shutdown(fd, SHUT_WR);
+
+            DescriptorInputStream stream(fd);
+            binary::DlxSolution section;
+            EXPECT_EQ(binary::dlx_read_solution(stream, &section), 0);
+            for (const auto& row : section.rows)
+            {
+                std::vector<uint32_t> ids(row.row_indices, row.row_indices + row.entry_count);
+                std::sort(ids.begin(), ids.end());
+                answers[i].insert(std::move(ids));
+            }
+            close(fd);
+        });
+    }
+    for (auto& client : clients)
+    {
+        client.join();
+    }
+
+    ASSERT_EQ(answers[0].size(), 1u << kColumns);
+    for (size_t i = 1; i < answers.size(); i++)
+    {
+        EXPECT_EQ(answers[i], answers[0]);
+    }
+
+    // Only the first copy was searched; the reordered cover shares its entry.
+    const dlx::TcpServerStats stats = server.stats();
+    EXPECT_EQ(stats.cache_hits + stats.coalesced, frames.size() - 1);
+    EXPECT_GT(stats.cached_bytes, 0u);
+
+    server.stop();
+    server.wait();
+}
+
+TEST(DlxTcpServerResultCacheTest, RecordingsInFlightShareTheBudget)
+{
+    // Two words of key each: the column count and the empty forced-row count.
+    auto key_for = [](uint32_t columns) {
+        return dlx::make_result_key(std::make_shared<const std::vector<uint32_t>>(1, columns), dlx::SearchAssumptions());
+    };
+    dlx::ResultCache cache(4096);
+    bool leader = false;
+    auto first = cache.acquire(key_for(3), &leader);
+    ASSERT_TRUE(leader);
+    auto second = cache.acquire(key_for(4), &leader);
+    ASSERT_TRUE(leader);
+
+    // Neither leader may take what the other has already reserved.
+    EXPECT_TRUE(cache.reserve(*first, 600));
+    EXPECT_FALSE(cache.reserve(*second, 600));
+    EXPECT_TRUE(cache.reserve(*second, 300));
+
+    first->records.assign(600, 1);
+    cache.finish(first, true);
+    EXPECT_EQ(first->state.load(), dlx::SolvedProblem::State::Complete);
+    EXPECT_EQ(first->reserved, 0u);
+    EXPECT_EQ(cache.cached_bytes(), first->bytes());
+
+    // A growing recording evicts complete entries to make room.
+    EXPECT_TRUE(cache.reserve(*second, 500));
+    EXPECT_EQ(cache.cached_bytes(), 0u);
+    EXPECT_EQ(cache.lookup(first->key), nullptr);
+
+    cache.finish(second, false);
+    EXPECT_EQ(second->state.load(), dlx::SolvedProblem::State::Abandoned);
+    EXPECT_TRUE(cache.reserve(*cache.acquire(key_for(5), &leader), 1000));
+}
+
+TEST_F(DlxTcpServerTest, SolveOptionsBoundTheSearchAndReportHowItEnded)
+{
+    constexpr uint32_t kColumns = 12;
+    struct Case
+    {
+        binary::DlxSolveOptions options;
+        uint32_t code;
+        size_t rows;
+        uint64_t solutions;
+    };
+    const Case cases[] = {
+        {{1, 0, 0, 0, 0}, DLX_SOLVE_LIMIT_REACHED, 1, 1},
+        {{0, 0, 0, DLX_SOLVE_FLAG_COUNT_ONLY, 0}, DLX_SOLVE_COMPLETE, 0, 1u << kColumns},
+        {{0, 5, 0, 0, 0}, DLX_SOLVE_NODE_BUDGET, 0, 0},
+        {{0, 0, 0, 0, 7}, DLX_SOLVE_UNSUPPORTED, 0, 0},
+        // 2^24 solutions take far longer than a millisecond to count.
+        {{0, 0, 1, DLX_SOLVE_FLAG_COUNT_ONLY, DLX_SOLVE_ENGINE_DANCING_LINKS}, DLX_SOLVE_DEADLINE, 0, 0},
+        {{0, 0, 0, 0, 0}, DLX_SOLVE_COMPLETE, 1u << kColumns, 1u << kColumns},
+        // By now the complete answer is cached, so this one is a replay cut short at the limit.
+        {{3, 0, 0, 0, 0}, DLX_SOLVE_LIMIT_REACHED, 3, 3},
+    };
+
+    int fd = ConnectToPort(server().request_port());
+    ASSERT_GE(fd, 0);
+    DescriptorInputStream stream(fd);
+    binary::DlxSolutionStreamReader reader(stream);
+    for (uint32_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        const Case& expected = cases[i];
+        if (i + 1 == sizeof(cases) / sizeof(cases[0]))
+        {
+            for (int attempt = 0; attempt < 200 && server().stats().cached_bytes == 0; attempt++)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+        }
+        const std::vector<uint8_t> frame =
+            BoundedCover(expected.code == DLX_SOLVE_DEADLINE ? 24 : kColumns, i, expected.options);
+        ASSERT_EQ(send(fd, frame.data(), frame.size(), 0), static_cast<ssize_t>(frame.size()));
+
+        binary::DlxSolutionHeader header = {0};
+        ASSERT_EQ(reader.read_header(&header), 0);
+        EXPECT_EQ(reader.problem_index(), i);
+        EXPECT_NE(header.flags & DLX_SOLUTION_FLAG_STATUS, 0);
+        uint64_t solution_id = 0;
+        std::vector<uint32_t> rows;
+        size_t count = 0;
+        int status;
+        while ((status = reader.read_row(&solution_id, &rows)) == 1)
+        {
+            count++;
+        }
+        ASSERT_EQ(status, 0);
+        EXPECT_EQ(count, expected.rows) << "case " << i;
+        EXPECT_EQ(reader.status().code, expected.code) << "case " << i;
+        if (expected.code != DLX_SOLVE_DEADLINE)
+        {
+            EXPECT_EQ(reader.status().solutions, expected.solutions) << "case " << i;
+        }
+        if (expected.code == DLX_SOLVE_NODE_BUDGET)
+        {
+            EXPECT_EQ(reader.status().nodes, 5u);
+        }
+        else if (expected.options.solution_limit == 3)
+        {
+            EXPECT_EQ(reader.status().nodes, 0u);
+        }
+    }
+    close(fd);
+}
+
+TEST_F(DlxTcpServerTest, AnswersCoversWithNothingToSearch)
+{
+    // An empty cover, a cover without columns and a row outside its cover, each once plain and once with options.
+    struct Case
+    {
+        uint32_t columns;
+        std::vector<uint32_t> row;
+        uint32_t code;
+    };
+    const Case cases[] = {
+        {3, {}, DLX_SOLVE_COMPLETE},
+        {0, {}, DLX_SOLVE_INVALID},
+        {2, {5}, DLX_SOLVE_INVALID},
+    };
+
+    int fd = ConnectToPort(server().request_port());
+    ASSERT_GE(fd, 0);
+    uint32_t problem_id = 0;
+    for (const Case& tested : cases)
+    {
+        for (bool options : {false, true})
+        {
+            binary::DlxCoverHeader header = {
+                .magic = DLX_COVER_MAGIC,
+                .version = DLX_BINARY_VERSION,
+                .flags = DLX_COVER_FLAG_PROBLEM_ID | DLX_COVER_FLAG_REPLY_INLINE,
+                .column_count = tested.columns,
+                .row_count = tested.row.empty() ? 0u : 1u,
+            };
+            std::ostringstream cover;
+            {
+                binary::DlxProblemStreamWriter writer(cover);
+                const int started = options
+                                        ? writer.start(header, dlx::SearchAssumptions(), problem_id, binary::DlxSolveOptions{})
+                                        : writer.start(header, dlx::SearchAssumptions(), problem_id);
+                ASSERT_EQ(started, 0);
+                if (!tested.row.empty())
+                {
+                    ASSERT_EQ(writer.write_row(1, tested.row.data(), static_cast<uint16_t>(tested.row.size())), 0);
+                }
+                ASSERT_EQ(writer.finish(), 0);
+            }
+            const std::string frame = cover.str();
+            ASSERT_EQ(send(fd, frame.data(), frame.size(), 0), static_cast<ssize_t>(frame.size()));
+            problem_id++;
+        }
+    }
+    shutdown(fd, SHUT_WR);
+
+    // Every frame comes back as a terminated, empty section, in order.
+    DescriptorInputStream stream(fd);
+    binary::DlxSolutionStreamReader reader(stream);
+    problem_id = 0;
+    for (const Case& tested : cases)
+    {
+        for (bool options : {false, true})
+        {
+            binary::DlxSolutionHeader header = {0};
+            ASSERT_EQ(reader.read_header(&header), 0) << "problem " << problem_id;
+            EXPECT_EQ(reader.problem_index(), problem_id);
+            EXPECT_EQ(header.flags & DLX_SOLUTION_FLAG_STATUS, options ? DLX_SOLUTION_FLAG_STATUS : 0u);
+            uint64_t solution_id = 0;
+            std::vector<uint32_t> rows;
+            EXPECT_EQ(reader.read_row(&solution_id, &rows), 0);
+            if (options)
+            {
+                EXPECT_EQ(reader.status().code, tested.code) << "problem " << problem_id;
+                EXPECT_EQ(reader.status().solutions, 0u);
+            }
+            problem_id++;
+        }
+    }
+    char byte;
+    EXPECT_EQ(recv(fd, &byte, 1, 0), 0);
+    close(fd);
+}
+
+TEST(DlxTcpServerScheduleTest, PriorityAndEstimatedCostOrderTheQueue)
+{
+    std::vector<uint8_t> sudoku = AsciiCoverToBytes(ReadFileToString("tests/sudoku_example/sudoku_cover.txt"));
+    ASSERT_FALSE(sudoku.empty());
+
+    // While the only worker streams a large problem, three more queue up on their own connections: a doubling
+    // cover, a sudoku, and a smaller doubling cover at priority 1.
+    const std::vector<uint8_t> blocker = TagFrame(DoublingCover(18), 1);
+    const std::vector<std::vector<uint8_t>> queued = {
+        TagFrame(DoublingCover(14), 2),
+        TagFrame(sudoku, 3),
+        TagFrame(DoublingCover(12), 4, 1u << DLX_COVER_PRIORITY_SHIFT),
+    };
+
+    for (dlx::ProblemSchedule schedule : {dlx::ProblemSchedule::Fifo, dlx::ProblemSchedule::ShortestFirst})
+    {
+        dlx::TcpServerConfig config{0, 0, 1};
+        config.schedule = schedule;
+        config.result_cache_bytes = 0;
+        dlx::DlxTcpServer server(config);
+        if (!server.start())
+        {
+            GTEST_SKIP() << "Unable to bind TCP server sockets in this environment";
+        }
+
+        int subscriber_fd = ConnectToPort(server.solution_port());
+        ASSERT_GE(subscriber_fd, 0);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        std::vector<uint32_t> order;
+        std::thread reader([&]() {
+            DescriptorInputStream stream(subscriber_fd);
+            for (size_t i = 0; i <= queued.size(); i++)
+            {
+                binary::DlxSolution section;
+                ASSERT_EQ(binary::dlx_read_solution(stream, &section), 0);
+                order.push_back(section.problem_index);
+            }
+        });
+
+        // Waits until the blocker has been taken and @p depth frames are queued behind it.
+        auto wait_for_queue = [&](size_t depth) {
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (std::chrono::steady_clock::now() < deadline)
+            {
+                const dlx::TcpServerStats stats = server.stats();
+                if (stats.waits[0].problems == 1 && stats.queued_problems == depth)
+                {
+                    return true;
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+            return false;
+        };
+        ASSERT_TRUE(SendProblem(server.request_port(), blocker));
+        ASSERT_TRUE(wait_for_queue(0));
+        for (size_t i = 0; i < queued.size(); i++)
+        {
+            ASSERT_TRUE(SendProblem(server.request_port(), queued[i]));
+            ASSERT_TRUE(wait_for_queue(i + 1));
+        }
+        reader.join();
+
+        // Priority passes everything else; the sudoku only passes the larger cover when costs decide.
+        const std::vector<uint32_t> expected = schedule == dlx::ProblemSchedule::Fifo
+                                                   ? std::vector<uint32_t>{1, 4, 2, 3}
+                                                   : std::vector<uint32_t>{1, 4, 3, 2};
+        EXPECT_EQ(order, expected);
+
+        const dlx::TcpServerStats stats = server.stats();
+        EXPECT_EQ(stats.waits[0].problems, 3u);
+        EXPECT_EQ(stats.waits[1].problems, 1u);
+        EXPECT_GE(stats.waits[0].max_micros, stats.waits[0].p99_micros);
+        EXPECT_GE(stats.waits[0].p99_micros, stats.waits[0].mean_micros / 2);
+
+        close(subscriber_fd);
+        server.stop();
+        server.wait();
+    }
+}
+
+TEST(DlxTcpServerScheduleTest, CostEstimateStaysLinearOnDeepCovers)
+{
+    // One row per column: a single solution 20000 levels deep. Walking every probe to its leaf would rescan all
+    // columns at each level; the cut-off probes extrapolate the same path instead.
+    constexpr uint32_t kColumns = 20000;
+    binary::DlxCsrProblem problem;
+    problem.header = {DLX_COVER_MAGIC, DLX_BINARY_VERSION, 0, kColumns, kColumns};
+    for (uint32_t column = 0; column < kColumns; column++)
+    {
+        ASSERT_EQ(problem.append_row(column + 1, &column, 1), 0);
+    }
+
+    // The linking cost, the root, and one node per level.
+    EXPECT_EQ(dlx::estimate_search_cost(problem), uint64_t{kColumns} + 1 + kColumns);
+}
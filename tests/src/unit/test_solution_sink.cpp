@@ -1,5 +1,9 @@
+#include "core/async_output.h"
+#include "core/binary.h"
 #include "core/solution_sink.h"
 #include <gtest/gtest.h>
+#include <stdio.h>
+#include <unistd.h>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -23,6 +27,59 @@ TEST(SolutionSinkTest, OstreamSinkSerializesValues)
     EXPECT_EQ(output.str(), "42 84\n");
 }
 
+std::string read_descriptor(int fd)
+{
+    std::string contents;
+    char chunk[256];
+    ssize_t bytes = 0;
+    lseek(fd, 0, SEEK_SET);
+    while ((bytes = read(fd, chunk, sizeof(chunk))) > 0)
+    {
+        contents.append(chunk, static_cast<size_t>(bytes));
+    }
+    return contents;
+}
+
+TEST(SolutionSinkTest, FdTextSinkBatchesWritesWithCustomSeparators)
+{
+    FILE* file = tmpfile();
+    ASSERT_NE(file, nullptr);
+    const int fd = fileno(file);
+
+    dlx::sink::TextSinkConfig config;
+    config.value_separator = ", ";
+    config.solution_separator = ";\n";
+    config.flush_interval = std::chrono::hours(1);
+    {
+        dlx::sink::FdTextSolutionSink sink(fd, config);
+        const uint32_t rows[] = {4294967295u, 0, 17};
+        sink.on_solution(rows, 3);
+        char value1[] = "8";
+        char* values[] = {value1};
+        sink.on_solution(dlx::sink::SolutionView{values, 1});
+
+        // Neither the size nor the age threshold is reached, so flush leaves the descriptor alone.
+        sink.flush();
+        EXPECT_EQ(read_descriptor(fd), "");
+        EXPECT_EQ(sink.sync(), 0);
+        EXPECT_EQ(read_descriptor(fd), "4294967295, 0, 17;\n8;\n");
+
+        sink.on_solution(rows + 2, 1);
+    }
+    EXPECT_EQ(read_descriptor(fd), "4294967295, 0, 17;\n8;\n17;\n");
+
+    // A tiny size threshold makes flush write on every solution, and solutions larger than the buffer still fit.
+    config.flush_bytes = 1;
+    dlx::sink::FdTextSolutionSink eager(fd, config);
+    const std::vector<uint32_t> wide(2000, 123456);
+    eager.on_solution(wide.data(), static_cast<int>(wide.size()));
+    eager.flush();
+    // 26 bytes from above, then six digits per id, ", " between ids and ";\n" at the end.
+    EXPECT_EQ(read_descriptor(fd).size(), 26u + wide.size() * 8);
+    EXPECT_FALSE(eager.failed());
+    fclose(file);
+}
+
 class RecordingSink : public dlx::sink::SolutionSink
 {
 public:
@@ -68,4 +125,47 @@ TEST(SolutionSinkTest, CompositeSinkBroadcastsToAllSinks)
     EXPECT_EQ(second.flush_count, 1);
 }
 
+TEST(SolutionSinkTest, AsyncWriterDrainsSmallRingInOrder)
+{
+    std::ostringstream text;
+    std::stringstream binary_output;
+    dlx::sink::AsyncOutputConfig config;
+    config.ring_words = 16;
+    config.text_batch_bytes = 32;
+
+    std::string expected_text;
+    {
+        dlx::sink::AsyncSolutionWriter writer(&text, &binary_output, config);
+        ASSERT_EQ(writer.begin_section(9), 0);
+        for (uint32_t i = 0; i < 500; i++)
+        {
+            const uint32_t rows[] = {i, i + 1, 3 * i};
+            ASSERT_TRUE(writer.push(rows, 3));
+            expected_text += std::to_string(i) + " " + std::to_string(i + 1) + " " + std::to_string(3 * i) + "\n";
+        }
+
+        // The sink interface parses the textual ids; a solution larger than the ring is dropped, never blocked on.
+        char value1[] = "42";
+        char value2[] = "84";
+        char* values[] = {value1, value2};
+        writer.on_solution(dlx::sink::SolutionView{values, 2});
+        expected_text += "42 84\n";
+        const std::vector<uint32_t> oversized(20, 1);
+        EXPECT_FALSE(writer.push(oversized.data(), static_cast<int>(oversized.size())));
+        EXPECT_EQ(writer.dropped(), 1u);
+
+        ASSERT_EQ(writer.stop(), 0);
+    }
+    EXPECT_EQ(text.str(), expected_text);
+
+    dlx::binary::DlxSolution solution;
+    ASSERT_EQ(dlx::binary::dlx_read_solution(binary_output, &solution), 0);
+    EXPECT_EQ(solution.header.column_count, 9u);
+    ASSERT_EQ(solution.rows.size(), 501u);
+    EXPECT_EQ(solution.rows[499].solution_id, 500u);
+    ASSERT_EQ(solution.rows[499].entry_count, 3);
+    EXPECT_EQ(solution.rows[499].row_indices[2], 3u * 499u);
+    EXPECT_EQ(solution.rows[500].row_indices[1], 84u);
+}
+
 } // namespace
@@ -87,7 +87,7 @@ TEST(SudokuDecoderTest, ReconstructsBinarySolution)
     binary::DlxSolution solution;
     solution.header = {
         .magic = DLX_SOLUTION_MAGIC,
-        .version = DLX_BINARY_VERSION,
+        .version = DLX_SOLUTION_VERSION,
         .flags = 0,
         .column_count = COLUMN_COUNT,
     };
@@ -51,3 +51,25 @@ TEST(SudokuPipelineTest, BinaryPipelineProducesAnswersFile)
 
     std::remove(answers_path.c_str());
 }
+
+TEST(SudokuPipelineTest, BatchModeWritesOneSectionPerProblem)
+{
+    const std::string single_path = "build/pipeline_single.dlxs";
+    const std::string batch_path = "build/pipeline_batch.dlxs";
+    std::remove(single_path.c_str());
+    std::remove(batch_path.c_str());
+
+    run_pipeline_and_expect_success(
+        "build/sudoku_encoder tests/sudoku_tests/sudoku_test.txt | build/dlx - " + single_path);
+    run_pipeline_and_expect_success(
+        "(build/sudoku_encoder tests/sudoku_tests/sudoku_test.txt; "
+        "build/sudoku_encoder tests/sudoku_tests/sudoku_test.txt) | "
+        "build/dlx --batch - " + batch_path);
+
+    const std::string single = read_file_to_string(single_path);
+    ASSERT_FALSE(single.empty());
+    EXPECT_EQ(read_file_to_string(batch_path), single + single);
+
+    std::remove(single_path.c_str());
+    std::remove(batch_path.c_str());
+}